@@ -15,24 +15,57 @@
 #include <zephyr/bluetooth/direction.h>
 #include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+#if defined(CONFIG_SETTINGS)
+#include <zephyr/settings/settings.h>
+#endif
+
+#include "telemetry.h"
 
 /* Length of CTE in unit of 8[us] */
 #define CTE_LEN (0x14U)
 /* Number of CTE send in single periodic advertising train */
 #define PER_ADV_EVENT_CTE_COUNT 5
+/* Length of CTE in unit of 8[us], for the tracking advertising set */
+#define CTE_LEN_TRACKING (0x0AU)
+/* Type of CTE. With 1[us] slots, the locator takes an IQ sample every 2[us]
+ * instead of every 4[us], so a CTE of the maximum length gives 74 instead of
+ * 37 antenna snapshots. Use BT_DF_CTE_TYPE_AOD_2US for locators that can not
+ * sample 1[us] slots.
+ */
+#define CTE_TYPE BT_DF_CTE_TYPE_AOD_1US
+
+/* Valid CTE lengths, see the Bluetooth Core Specification, Vol 4, Part E,
+ * Section 7.8.80.
+ */
+BUILD_ASSERT(CTE_LEN >= 0x02U && CTE_LEN <= 0x14U, "CTE_LEN must be in range 0x02 to 0x14");
+BUILD_ASSERT(CTE_LEN_TRACKING >= 0x02U && CTE_LEN_TRACKING <= 0x14U,
+	     "CTE_LEN_TRACKING must be in range 0x02 to 0x14");
 
 static const struct bt_data ad[] = {
 	BT_DATA(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME, sizeof(CONFIG_BT_DEVICE_NAME) - 1),
 };
 
-static void adv_sent_cb(struct bt_le_ext_adv *adv,
-			struct bt_le_ext_adv_sent_info *info);
-
-const static struct bt_le_ext_adv_cb adv_callbacks = {
-	.sent = adv_sent_cb,
-};
+/* Manufacturer specific data in the periodic advertising data, telling the
+ * locator which antenna pattern the CTEs are transmitted with. The format must
+ * match the locator, see locator/src/beacon_adv_data.h:
+ * octets 0-1: Company ID 0xFFFF (reserved for internal use), little-endian.
+ * octet  2:   Format version.
+ * octet  3:   Antenna pattern ID, see enum ant_pattern_id.
+ */
+#define BEACON_ADV_DATA_COMPANY_ID 0xFFFF
+#define BEACON_ADV_DATA_VERSION 1
+#define BEACON_ADV_DATA_LENGTH 4
 
-static struct bt_le_ext_adv *adv_set;
+/* Advertising set identifiers. The locator picks the advertising set to sync
+ * to by the SID. Must match the locator, see locator/src/beacon_adv_data.h.
+ */
+#define ADV_SET_SID_ACCURACY 0
+#define ADV_SET_SID_TRACKING 1
 
 const static struct bt_le_adv_param param =
 		BT_LE_ADV_PARAM_INIT(BT_LE_ADV_OPT_EXT_ADV | BT_LE_ADV_OPT_USE_IDENTITY,
@@ -40,35 +73,46 @@ const static struct bt_le_adv_param param =
 				     BT_GAP_ADV_FAST_INT_MAX_2,
 				     NULL);
 
+/* Advertise without a timeout or an event limit. The extended advertising
+ * sent callback only fires when one of them ends the advertising set, so no
+ * callbacks are registered, see telemetry.h.
+ */
 static struct bt_le_ext_adv_start_param ext_adv_start_param = {
 	.timeout = 0,
 	.num_events = 0,
 };
 
-const static struct bt_le_per_adv_param per_adv_param = {
-	.interval_min = BT_GAP_ADV_SLOW_INT_MIN,
-	.interval_max = BT_GAP_ADV_SLOW_INT_MAX,
-	.options = BT_LE_ADV_OPT_USE_TX_POWER,
-};
-
 static const struct gpio_dt_spec aodtx_mode_enable =
 		GPIO_DT_SPEC_GET(DT_NODELABEL(switch0_aodtx_mode_enable), gpios);
 static const struct gpio_dt_spec chip_enable =
 		GPIO_DT_SPEC_GET(DT_NODELABEL(switch0_chip_enable), gpios);
 
-// Only use a single antenna?
-#define BT_CTLR_DF_AOD_ANT_SINGLE_MODE 0
+/* Antenna pattern IDs. The antenna pattern is selected at runtime, see the
+ * ant_pattern_apply() function, and advertised in the periodic advertising
+ * data. The IDs must match the chw1010_ant2_pattern enum of the locator, see
+ * locator/src/chw1010_ant2_specs.h.
+ */
+enum ant_pattern_id {
+	// Use all 16 antennas.
+	ANT_PATTERN_ALL = 0,
+
+	// Only use an antenna row.
+	ANT_PATTERN_ROW = 1,
 
-// Only use an antenna row?
-#define BT_CTLR_DF_AOD_ANT_ROW_MODE 0
+	// Only use an antenna column.
+	ANT_PATTERN_COLUMN = 2,
 
-// Only use an antenna column?
-#define BT_CTLR_DF_AOD_ANT_COLUMN_MODE 0
+	// Only use the outer antennas.
+	ANT_PATTERN_OUTER = 3,
 
-// Only use the outer antennas?
-#define BT_CTLR_DF_AOD_ANT_OUTER_MODE 0
+	// Only use a single antenna.
+	ANT_PATTERN_SINGLE = 4,
+
+	ANT_PATTERN_COUNT,
+};
 
-// Use all 16 antennas if none of the above antenna modes are set to 1.
+// Antenna pattern at boot, unless another pattern is stored in settings.
+#define ANT_PATTERN_DEFAULT ANT_PATTERN_ALL
 
 /* Sequence of antenna switch patterns for a CoreHW CHW1010-ANT2-1.1 antenna
  * array board. A switch pattern is defined as an octet (8 bits). Each bit
@@ -83,10 +127,12 @@ static const struct gpio_dt_spec chip_enable =
  * See the radio_df_ant_switch_pattern_set() function in
  * zephyr/subsys/bluetooth/controller/ll_sw/nordic/hal/nrf5/radio/radio_df.c.
  * 
- * The following list is for the default sample spacing of 4 μs where CTEType
- * field value is 2 for "AoD Constant Tone Extension with 2 μs slots":
+ * The following lists are for a sample spacing of 4 μs where CTEType field
+ * value is 2 for "AoD Constant Tone Extension with 2 μs slots", with 37 sample
+ * slots. With the default CTE_TYPE, CTEType field value 1 for "AoD Constant
+ * Tone Extension with 1 μs slots", the sample spacing is 2 μs, and the lists
+ * continue in the same order up to 74 sample slots:
  */
-#if BT_CTLR_DF_AOD_ANT_SINGLE_MODE
 /* CoreHW CHW1010-ANT2-1.1 antenna grid for a single antenna:
  *  +----+----+----+----+
  *  |    |    |    |    |
@@ -138,10 +184,10 @@ static const struct gpio_dt_spec chip_enable =
  * SWITCHPATTERN[3]  = 0xA,  ant_patterns[0],        36th sample slot.
  * SWITCHPATTERN[2]  = 0xA,  ant_patterns[1],        37th sample slot.
  */
-static uint8_t ant_patterns[2] = {
+static uint8_t ant_patterns_single[2] = {
 	0xA, 0xA
 };
-#elif BT_CTLR_DF_AOD_ANT_ROW_MODE
+
 /* CoreHW CHW1010-ANT2-1.1 antenna grid for an antenna row:
  *  +----+----+----+----+
  *  |    |    |    |    |
@@ -193,10 +239,10 @@ static uint8_t ant_patterns[2] = {
  * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],        36th sample slot.
  * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],        37th sample slot.
  */
-static uint8_t ant_patterns[4] = {
+static uint8_t ant_patterns_row[4] = {
 	0x2, 0x3, 0x4, 0x6
 };
-#elif BT_CTLR_DF_AOD_ANT_COLUMN_MODE
+
 /* CoreHW CHW1010-ANT2-1.1 antenna grid for an antenna column:
  *  +----+----+----+----+
  *  |    |    |    |  9 |
@@ -248,10 +294,10 @@ static uint8_t ant_patterns[4] = {
  * SWITCHPATTERN[5]  = 0x6,  ant_patterns[0],        36th sample slot.
  * SWITCHPATTERN[2]  = 0x7,  ant_patterns[1],        37th sample slot.
  */
-static uint8_t ant_patterns[4] = {
+static uint8_t ant_patterns_column[4] = {
 	0x6, 0x7, 0x8, 0x9
 };
-#elif BT_CTLR_DF_AOD_ANT_OUTER_MODE
+
 /* CoreHW CHW1010-ANT2-1.1 antenna grid for the outer antennas:
  *  +----+----+----+----+
  *  | 13 | 12 | 11 |  9 |
@@ -303,11 +349,11 @@ static uint8_t ant_patterns[4] = {
  * SWITCHPATTERN[13] = 0x1,  ant_patterns[0],        36th sample slot.
  * SWITCHPATTERN[2]  = 0x2,  ant_patterns[1],        37th sample slot.
  */
-static uint8_t ant_patterns[12] = {
+static uint8_t ant_patterns_outer[12] = {
 	0x1, 0x2, 0x3, 0x4, 0x6, 0x7, 0x8, 0x9,
 	0xB, 0xC, 0xD, 0xE
 };
-#else
+
 /* CoreHW CHW1010-ANT2-1.1 antenna grid for all antennas:
  *  +----+----+----+----+
  *  | 13 | 12 | 11 |  9 |
@@ -359,143 +405,641 @@ static uint8_t ant_patterns[12] = {
  * SWITCHPATTERN[5]  = 0x4,  ant_patterns[4],        36th sample slot.
  * SWITCHPATTERN[6]  = 0x5,  ant_patterns[5],        37th sample slot.
  */
-static uint8_t ant_patterns[16] = {
+static uint8_t ant_patterns_all[16] = {
 	0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7,
 	0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF
 };
-#endif
 
-struct bt_df_adv_cte_tx_param cte_params = { .cte_len = CTE_LEN,
-										     .cte_count = PER_ADV_EVENT_CTE_COUNT,
-										     .cte_type = BT_DF_CTE_TYPE_AOD_2US,
-										     .num_ant_ids = ARRAY_SIZE(ant_patterns),
-										     .ant_ids = ant_patterns
+static const struct ant_pattern {
+	const char *name;
+	uint8_t *ant_ids;
+	uint8_t num_ant_ids;
+} ant_pattern_table[ANT_PATTERN_COUNT] = {
+	[ANT_PATTERN_ALL] = { "all", ant_patterns_all, ARRAY_SIZE(ant_patterns_all) },
+	[ANT_PATTERN_ROW] = { "row", ant_patterns_row, ARRAY_SIZE(ant_patterns_row) },
+	[ANT_PATTERN_COLUMN] = { "column", ant_patterns_column, ARRAY_SIZE(ant_patterns_column) },
+	[ANT_PATTERN_OUTER] = { "outer", ant_patterns_outer, ARRAY_SIZE(ant_patterns_outer) },
+	[ANT_PATTERN_SINGLE] = { "single", ant_patterns_single, ARRAY_SIZE(ant_patterns_single) },
+};
+
+/* Configuration of a periodic advertising set. Each set has its own SID,
+ * periodic advertising interval, CTE count, CTE length, and antenna pattern,
+ * so a locator can sync to the set with the update rate it needs.
+ */
+struct adv_set_config {
+	uint8_t sid;
+	uint16_t per_adv_interval_min;
+	uint16_t per_adv_interval_max;
+	uint8_t cte_len;
+	uint8_t cte_type;
+	uint8_t cte_count;
+	uint8_t ant_pattern_id;
+};
+
+static const struct adv_set_config adv_set_configs[] = {
+	/* Slow set with several long CTEs per event, for accuracy. The SID is the
+	 * SID of the single advertising set of older beacons.
+	 */
+	{
+		.sid = ADV_SET_SID_ACCURACY,
+		.per_adv_interval_min = BT_GAP_ADV_SLOW_INT_MIN,
+		.per_adv_interval_max = BT_GAP_ADV_SLOW_INT_MAX,
+		.cte_len = CTE_LEN,
+		.cte_type = CTE_TYPE,
+		.cte_count = PER_ADV_EVENT_CTE_COUNT,
+		.ant_pattern_id = ANT_PATTERN_DEFAULT,
+	},
+	/* Fast set with a single short CTE per event, for tracking. */
+	{
+		.sid = ADV_SET_SID_TRACKING,
+		.per_adv_interval_min = BT_GAP_PER_ADV_FAST_INT_MIN_2,
+		.per_adv_interval_max = BT_GAP_PER_ADV_FAST_INT_MAX_2,
+		.cte_len = CTE_LEN_TRACKING,
+		.cte_type = CTE_TYPE,
+		.cte_count = 1,
+		.ant_pattern_id = ANT_PATTERN_DEFAULT,
+	},
+};
+
+#define ADV_SET_COUNT ARRAY_SIZE(adv_set_configs)
+
+BUILD_ASSERT(ARRAY_SIZE(adv_set_configs) <= CONFIG_BT_EXT_ADV_MAX_ADV_SET,
+	     "CONFIG_BT_EXT_ADV_MAX_ADV_SET is less than the number of advertising sets");
+
+/* State of a periodic advertising set. The CTE parameters, the advertised
+ * antenna pattern ID, and whether CTE transmission is enabled are protected by
+ * ant_pattern_mutex, since the antenna pattern is changed from the shell
+ * thread and the system work queue.
+ */
+struct adv_set {
+	struct bt_le_ext_adv *adv;
+	struct bt_df_adv_cte_tx_param cte_params;
+	uint8_t per_ad_mfg_data[BEACON_ADV_DATA_LENGTH];
+	struct bt_data per_ad[1];
+	uint8_t ant_pattern_id;
+	bool cte_tx_enabled;
 };
 
-static void adv_sent_cb(struct bt_le_ext_adv *adv,
-			struct bt_le_ext_adv_sent_info *info)
+static struct adv_set adv_sets[ADV_SET_COUNT];
+static K_MUTEX_DEFINE(ant_pattern_mutex);
+
+/* Antenna pattern rotation. The patterns in ant_pattern_rotation[] are applied
+ * to all advertising sets in turn, each for ant_pattern_rotation_events
+ * periodic advertising events of the first advertising set. The rotation state
+ * is protected by ant_pattern_rotation_mutex, since it is changed from the
+ * shell thread and read and advanced by the rotation work on the system work
+ * queue. The rotation work holds it while applying a pattern, so a shell
+ * command never interleaves with a rotation step. Lock order is
+ * ant_pattern_rotation_mutex, then ant_pattern_mutex.
+ */
+static K_MUTEX_DEFINE(ant_pattern_rotation_mutex);
+static uint8_t ant_pattern_rotation[ANT_PATTERN_COUNT];
+static uint8_t ant_pattern_rotation_count;
+static uint8_t ant_pattern_rotation_next;
+static uint32_t ant_pattern_rotation_events;
+static struct k_work_delayable ant_pattern_rotation_work;
+/* Uptime when the next rotation is due, in ticks, for the telemetry. */
+static int64_t ant_pattern_rotation_due_ticks;
+
+/* Periodic advertising interval of the first advertising set in milliseconds,
+ * for the rotation period. The interval is in units of 1.25 ms.
+ */
+#define PER_ADV_INTERVAL_MS (adv_set_configs[0].per_adv_interval_max * 5U / 4U)
+
+/* Initialize the state of the advertising sets from the configurations. */
+static void adv_sets_init(void)
 {
-	printk("Advertiser[%d] %p sent %d\n", bt_le_ext_adv_get_index(adv),
-	       adv, info->num_sent);
+	for (size_t i = 0; i < ADV_SET_COUNT; i++) {
+		struct adv_set *set = &adv_sets[i];
+		const struct adv_set_config *config = &adv_set_configs[i];
+		const struct ant_pattern *pattern = &ant_pattern_table[config->ant_pattern_id];
+
+		set->adv = NULL;
+		set->cte_params.cte_len = config->cte_len;
+		set->cte_params.cte_count = config->cte_count;
+		set->cte_params.cte_type = config->cte_type;
+		set->cte_params.num_ant_ids = pattern->num_ant_ids;
+		set->cte_params.ant_ids = pattern->ant_ids;
+
+		set->per_ad_mfg_data[0] = BEACON_ADV_DATA_COMPANY_ID & 0xFF;
+		set->per_ad_mfg_data[1] = (BEACON_ADV_DATA_COMPANY_ID >> 8) & 0xFF;
+		set->per_ad_mfg_data[2] = BEACON_ADV_DATA_VERSION;
+		set->per_ad_mfg_data[3] = config->ant_pattern_id;
+		set->per_ad[0] = (struct bt_data)BT_DATA(BT_DATA_MANUFACTURER_DATA,
+							 set->per_ad_mfg_data,
+							 sizeof(set->per_ad_mfg_data));
+
+		set->ant_pattern_id = config->ant_pattern_id;
+		set->cte_tx_enabled = false;
+	}
 }
 
-int main(void)
+/* Apply an antenna pattern to an advertising set. The CTE parameters can only
+ * be set while CTE transmission is disabled, so CTE transmission is disabled,
+ * the parameters and the advertised antenna pattern ID are set, and CTE
+ * transmission is enabled again. Before advertising is started, the pattern is
+ * only stored.
+ */
+static int ant_pattern_apply(size_t set_index, uint8_t pattern_id)
+{
+	struct adv_set *set;
+	int err = 0;
+
+	if (set_index >= ADV_SET_COUNT || pattern_id >= ANT_PATTERN_COUNT) {
+		return -EINVAL;
+	}
+
+	set = &adv_sets[set_index];
+
+	k_mutex_lock(&ant_pattern_mutex, K_FOREVER);
+
+	set->cte_params.ant_ids = ant_pattern_table[pattern_id].ant_ids;
+	set->cte_params.num_ant_ids = ant_pattern_table[pattern_id].num_ant_ids;
+	set->per_ad_mfg_data[3] = pattern_id;
+	set->ant_pattern_id = pattern_id;
+
+	if (!set->cte_tx_enabled) {
+		goto unlock;
+	}
+
+	err = bt_df_adv_cte_tx_disable(set->adv);
+	if (err) {
+		goto unlock;
+	}
+	set->cte_tx_enabled = false;
+
+	err = bt_df_set_adv_cte_tx_param(set->adv, &set->cte_params);
+	if (err) {
+		goto unlock;
+	}
+
+	err = bt_le_per_adv_set_data(set->adv, set->per_ad, ARRAY_SIZE(set->per_ad));
+	if (err) {
+		goto unlock;
+	}
+
+	err = bt_df_adv_cte_tx_enable(set->adv);
+	if (err) {
+		goto unlock;
+	}
+	set->cte_tx_enabled = true;
+
+unlock:
+	k_mutex_unlock(&ant_pattern_mutex);
+
+	if (set->adv != NULL) {
+		telemetry_cte_updated(set_index, err);
+	}
+
+	return err;
+}
+
+/* Apply an antenna pattern to all advertising sets. */
+static int ant_pattern_apply_all(uint8_t pattern_id)
 {
-	char addr_s[BT_ADDR_LE_STR_LEN];
-	struct bt_le_oob oob_local;
 	int err;
 
-	printk("Starting Connectionless Beacon Demo\n");
+	for (size_t i = 0; i < ADV_SET_COUNT; i++) {
+		err = ant_pattern_apply(i, pattern_id);
+		if (err) {
+			return err;
+		}
+	}
 
-	printk("Antenna Switch 0 D0 AoDTX-mode Enable GPIO initialization...");
-	if (!gpio_is_ready_dt(&aodtx_mode_enable)) {
-		printk("failed (AoDTX-mode Enable GPIO spec is not ready for use.)\n");
+	return 0;
+}
+
+static void ant_pattern_rotation_work_handler(struct k_work *work)
+{
+	int err;
+
+	k_mutex_lock(&ant_pattern_rotation_mutex, K_FOREVER);
+
+	if (ant_pattern_rotation_count == 0) {
+		k_mutex_unlock(&ant_pattern_rotation_mutex);
+		return;
+	}
+
+	uint8_t pattern_id = ant_pattern_rotation[ant_pattern_rotation_next];
+	int64_t now_ticks = k_uptime_ticks();
+
+	if (ant_pattern_rotation_due_ticks > 0) {
+		telemetry_work_late(now_ticks > ant_pattern_rotation_due_ticks
+					    ? (uint32_t)k_ticks_to_us_floor64(
+						      now_ticks - ant_pattern_rotation_due_ticks)
+					    : 0);
+	}
+
+	ant_pattern_rotation_next = (ant_pattern_rotation_next + 1) % ant_pattern_rotation_count;
+
+	err = ant_pattern_apply_all(pattern_id);
+	if (err) {
+		printk("Antenna pattern %s apply failed (err %d)\n",
+		       ant_pattern_table[pattern_id].name, err);
+	}
+
+	ant_pattern_rotation_due_ticks =
+		now_ticks + k_ms_to_ticks_ceil64(ant_pattern_rotation_events * PER_ADV_INTERVAL_MS);
+	k_work_reschedule(&ant_pattern_rotation_work,
+			  K_MSEC(ant_pattern_rotation_events * PER_ADV_INTERVAL_MS));
+
+	k_mutex_unlock(&ant_pattern_rotation_mutex);
+}
+
+#if defined(CONFIG_SETTINGS)
+static int ant_pattern_settings_set(const char *name, size_t len,
+				    settings_read_cb read_cb, void *cb_arg)
+{
+	uint8_t pattern_ids[ADV_SET_COUNT];
+	ssize_t ret;
+	int err;
+
+	if (strcmp(name, "pattern") != 0) {
+		return -ENOENT;
+	}
+
+	// One antenna pattern ID per advertising set. Patterns saved with another
+	// number of advertising sets are ignored.
+	if (len != sizeof(pattern_ids)) {
+		return -EINVAL;
+	}
+
+	ret = read_cb(cb_arg, pattern_ids, sizeof(pattern_ids));
+	if (ret != sizeof(pattern_ids)) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < ADV_SET_COUNT; i++) {
+		err = ant_pattern_apply(i, pattern_ids[i]);
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(ant, "ant", NULL, ant_pattern_settings_set, NULL, NULL);
+#endif
+
+#if defined(CONFIG_SHELL)
+static int ant_pattern_parse(const char *name)
+{
+	for (int i = 0; i < ANT_PATTERN_COUNT; i++) {
+		if (strcmp(name, ant_pattern_table[i].name) == 0) {
+			return i;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static int cmd_ant_show(const struct shell *sh, size_t argc, char **argv)
+{
+	for (size_t i = 0; i < ADV_SET_COUNT; i++) {
+		uint8_t pattern_id = adv_sets[i].ant_pattern_id;
+
+		shell_print(sh, "Advertising set %zu (SID %u): %s (id %u, %u antenna IDs)",
+			    i, adv_set_configs[i].sid, ant_pattern_table[pattern_id].name,
+			    pattern_id, ant_pattern_table[pattern_id].num_ant_ids);
+	}
+
+	k_mutex_lock(&ant_pattern_rotation_mutex, K_FOREVER);
+	uint8_t rotation_count = ant_pattern_rotation_count;
+	uint32_t rotation_events = ant_pattern_rotation_events;
+	k_mutex_unlock(&ant_pattern_rotation_mutex);
+
+	if (rotation_count > 0) {
+		shell_print(sh, "Rotating %u patterns every %u events", rotation_count,
+			    rotation_events);
+	}
+
+	return 0;
+}
+
+static int cmd_ant_set(const struct shell *sh, size_t argc, char **argv)
+{
+	int pattern_id = ant_pattern_parse(argv[1]);
+	long set_index = -1;
+	int err;
+
+	if (pattern_id < 0) {
+		shell_error(sh, "Unknown antenna pattern %s", argv[1]);
+		return -EINVAL;
+	}
+
+	if (argc > 2) {
+		set_index = strtol(argv[2], NULL, 10);
+		if (set_index < 0 || set_index >= (long)ADV_SET_COUNT) {
+			shell_error(sh, "Unknown advertising set %s", argv[2]);
+			return -EINVAL;
+		}
+	}
+
+	// A fixed pattern stops the rotation. A rotation step in progress completes
+	// before the fixed pattern is applied.
+	k_mutex_lock(&ant_pattern_rotation_mutex, K_FOREVER);
+	ant_pattern_rotation_count = 0;
+	k_work_cancel_delayable(&ant_pattern_rotation_work);
+	k_mutex_unlock(&ant_pattern_rotation_mutex);
+
+	if (set_index < 0) {
+		err = ant_pattern_apply_all(pattern_id);
+	} else {
+		err = ant_pattern_apply(set_index, pattern_id);
+	}
+	if (err) {
+		shell_error(sh, "Antenna pattern apply failed (err %d)", err);
+		return err;
+	}
+
+#if defined(CONFIG_SETTINGS)
+	uint8_t pattern_ids[ADV_SET_COUNT];
+
+	for (size_t i = 0; i < ADV_SET_COUNT; i++) {
+		pattern_ids[i] = adv_sets[i].ant_pattern_id;
+	}
+
+	err = settings_save_one("ant/pattern", pattern_ids, sizeof(pattern_ids));
+	if (err) {
+		shell_warn(sh, "Antenna pattern not saved (err %d)", err);
+	}
+#endif
+
+	shell_print(sh, "Antenna pattern: %s", ant_pattern_table[pattern_id].name);
+
+	return 0;
+}
+
+static int cmd_ant_rotate(const struct shell *sh, size_t argc, char **argv)
+{
+	uint8_t pattern_ids[ANT_PATTERN_COUNT];
+	size_t count = argc - 2;
+
+	if (strcmp(argv[1], "off") == 0) {
+		k_mutex_lock(&ant_pattern_rotation_mutex, K_FOREVER);
+		ant_pattern_rotation_count = 0;
+		k_work_cancel_delayable(&ant_pattern_rotation_work);
+		k_mutex_unlock(&ant_pattern_rotation_mutex);
+		shell_print(sh, "Antenna pattern rotation off");
 		return 0;
 	}
-	err = gpio_pin_configure_dt(&aodtx_mode_enable, GPIO_OUTPUT_INACTIVE);
+
+	long events = strtol(argv[1], NULL, 10);
+
+	if (events <= 0 || argc < 3) {
+		shell_error(sh, "Usage: ant rotate <events> <pattern>... | ant rotate off");
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		int pattern_id = ant_pattern_parse(argv[i + 2]);
+
+		if (pattern_id < 0) {
+			shell_error(sh, "Unknown antenna pattern %s", argv[i + 2]);
+			return -EINVAL;
+		}
+		pattern_ids[i] = pattern_id;
+	}
+
+	k_mutex_lock(&ant_pattern_rotation_mutex, K_FOREVER);
+	memcpy(ant_pattern_rotation, pattern_ids, count);
+	ant_pattern_rotation_count = count;
+	ant_pattern_rotation_next = 0;
+	ant_pattern_rotation_events = events;
+	ant_pattern_rotation_due_ticks = 0;
+	k_work_reschedule(&ant_pattern_rotation_work, K_NO_WAIT);
+	k_mutex_unlock(&ant_pattern_rotation_mutex);
+
+	shell_print(sh, "Rotating %zu patterns every %ld events", count, events);
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(ant_cmds,
+	SHELL_CMD_ARG(show, NULL, "Show the antenna pattern", cmd_ant_show, 1, 0),
+	SHELL_CMD_ARG(set, NULL, "Set and save the antenna pattern of all advertising sets, "
+		      "or of one set: set <all|row|column|outer|single> [<set>]", cmd_ant_set, 2, 1),
+	SHELL_CMD_ARG(rotate, NULL, "Rotate antenna patterns of all advertising sets: "
+		      "rotate <events> <pattern>... | rotate off", cmd_ant_rotate, 2,
+		      ANT_PATTERN_COUNT),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(ant, &ant_cmds, "Antenna pattern commands", NULL);
+#endif
+
+/* Create and start a periodic advertising set with CTE transmission. */
+static int adv_set_start(size_t set_index)
+{
+	struct adv_set *set = &adv_sets[set_index];
+	const struct adv_set_config *config = &adv_set_configs[set_index];
+	struct bt_le_adv_param adv_param = param;
+	const struct bt_le_per_adv_param per_adv_param = {
+		.interval_min = config->per_adv_interval_min,
+		.interval_max = config->per_adv_interval_max,
+		.options = BT_LE_ADV_OPT_USE_TX_POWER,
+	};
+	int err;
+
+	adv_param.sid = config->sid;
+
+	printk("Advertising set %zu (SID %u, %u CTEs of length %u with %u us slots, "
+	       "antenna pattern %s)\n",
+	       set_index, config->sid, config->cte_count, config->cte_len,
+	       config->cte_type == BT_DF_CTE_TYPE_AOD_1US ? 1 : 2,
+	       ant_pattern_table[set->ant_pattern_id].name);
+
+	printk("Advertising set create...");
+	err = bt_le_ext_adv_create(&adv_param, NULL, &set->adv);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return 0;
+		return err;
 	}
 	printk("success\n");
 
-	printk("Antenna Switch 0 EN Chip Enable GPIO initialization...");
-	if (!gpio_is_ready_dt(&chip_enable)) {
-		printk("failed (Chip Enable GPIO spec is not ready for use.)\n");
-		return 0;
+	printk("Set advertising data...");
+	err = bt_le_ext_adv_set_data(set->adv, ad, ARRAY_SIZE(ad), NULL, 0);
+	if (err) {
+		printk("failed (err %d)\n", err);
+		return err;
 	}
-	err = gpio_pin_configure_dt(&chip_enable, GPIO_OUTPUT_INACTIVE);
+	printk("success\n");
+
+	k_mutex_lock(&ant_pattern_mutex, K_FOREVER);
+
+	printk("Update CTE params...");
+	err = bt_df_set_adv_cte_tx_param(set->adv, &set->cte_params);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return 0;
+		goto unlock;
 	}
 	printk("success\n");
 
-	printk("Enable AoDTX-mode...");
-	err = gpio_pin_set_dt(&aodtx_mode_enable, 1);
+	printk("Periodic advertising params set...");
+	err = bt_le_per_adv_set_param(set->adv, &per_adv_param);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return 0;
+		goto unlock;
 	}
 	printk("success\n");
 
-	printk("Enable antenna switch...");
-	err = gpio_pin_set_dt(&chip_enable, 1);
+	printk("Set periodic advertising data...");
+	err = bt_le_per_adv_set_data(set->adv, set->per_ad, ARRAY_SIZE(set->per_ad));
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return 0;
+		goto unlock;
 	}
 	printk("success\n");
 
-	/* Initialize the Bluetooth Subsystem */
-	printk("Bluetooth initialization...");
-	err = bt_enable(NULL);
+	printk("Enable CTE...");
+	err = bt_df_adv_cte_tx_enable(set->adv);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return 0;
+		goto unlock;
 	}
+	set->cte_tx_enabled = true;
 	printk("success\n");
 
-	printk("Advertising set create...");
-	err = bt_le_ext_adv_create(&param, &adv_callbacks, &adv_set);
+unlock:
+	k_mutex_unlock(&ant_pattern_mutex);
+	if (err) {
+		return err;
+	}
+
+	printk("Periodic advertising enable...");
+	err = bt_le_per_adv_start(set->adv);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return 0;
+		return err;
 	}
 	printk("success\n");
 
-	printk("Set advertising data...");
-	err = bt_le_ext_adv_set_data(adv_set, ad, ARRAY_SIZE(ad), NULL, 0);
+	printk("Extended advertising enable...");
+	err = bt_le_ext_adv_start(set->adv, &ext_adv_start_param);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return 0;
+		return err;
 	}
 	printk("success\n");
 
-	printk("Update CTE params...");
-	err = bt_df_set_adv_cte_tx_param(adv_set, &cte_params);
+	telemetry_set_started(set_index);
+
+	return 0;
+}
+
+int main(void)
+{
+	char addr_s[BT_ADDR_LE_STR_LEN];
+	struct bt_le_oob oob_local;
+	int err;
+
+	printk("Starting Connectionless Beacon Demo\n");
+
+	printk("Antenna Switch 0 D0 AoDTX-mode Enable GPIO initialization...");
+	if (!gpio_is_ready_dt(&aodtx_mode_enable)) {
+		printk("failed (AoDTX-mode Enable GPIO spec is not ready for use.)\n");
+		return 0;
+	}
+	err = gpio_pin_configure_dt(&aodtx_mode_enable, GPIO_OUTPUT_INACTIVE);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	printk("Periodic advertising params set...");
-	err = bt_le_per_adv_set_param(adv_set, &per_adv_param);
+	printk("Antenna Switch 0 EN Chip Enable GPIO initialization...");
+	if (!gpio_is_ready_dt(&chip_enable)) {
+		printk("failed (Chip Enable GPIO spec is not ready for use.)\n");
+		return 0;
+	}
+	err = gpio_pin_configure_dt(&chip_enable, GPIO_OUTPUT_INACTIVE);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	printk("Enable CTE...");
-	err = bt_df_adv_cte_tx_enable(adv_set);
+	printk("Enable AoDTX-mode...");
+	err = gpio_pin_set_dt(&aodtx_mode_enable, 1);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	printk("Periodic advertising enable...");
-	err = bt_le_per_adv_start(adv_set);
+	printk("Enable antenna switch...");
+	err = gpio_pin_set_dt(&chip_enable, 1);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	printk("Extended advertising enable...");
-	err = bt_le_ext_adv_start(adv_set, &ext_adv_start_param);
+	/* The identity address must be created before Bluetooth is enabled, to
+	 * be used as the default identity. See CONFIG_BEACON_IDENTITY_ADDR.
+	 */
+	if (sizeof(CONFIG_BEACON_IDENTITY_ADDR) > 1) {
+		bt_addr_le_t identity_addr;
+
+		printk("Set identity address %s...", CONFIG_BEACON_IDENTITY_ADDR);
+		err = bt_addr_le_from_str(CONFIG_BEACON_IDENTITY_ADDR, "random", &identity_addr);
+		if (err) {
+			printk("failed (err %d)\n", err);
+			return 0;
+		}
+		err = bt_id_create(&identity_addr, NULL);
+		if (err < 0) {
+			printk("failed (err %d)\n", err);
+			return 0;
+		}
+		printk("success\n");
+	}
+
+	/* Initialize the Bluetooth Subsystem */
+	printk("Bluetooth initialization...");
+	err = bt_enable(NULL);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	bt_le_ext_adv_oob_get_local(adv_set, &oob_local);
+	k_work_init_delayable(&ant_pattern_rotation_work, ant_pattern_rotation_work_handler);
+
+	telemetry_init();
+
+	adv_sets_init();
+
+#if defined(CONFIG_SETTINGS)
+	printk("Load antenna pattern settings...");
+	err = settings_subsys_init();
+	if (!err) {
+		err = settings_load_subtree("ant");
+	}
+	if (err) {
+		printk("failed (err %d)\n", err);
+	} else {
+		printk("success\n");
+	}
+#endif
+
+	for (size_t i = 0; i < ADV_SET_COUNT; i++) {
+		err = adv_set_start(i);
+		if (err) {
+			return 0;
+		}
+	}
+
+	bt_le_ext_adv_oob_get_local(adv_sets[0].adv, &oob_local);
 	bt_addr_le_to_str(&oob_local.addr, addr_s, sizeof(addr_s));
 
 	printk("Started extended advertising as %s\n", addr_s);
 
+#if !defined(CONFIG_SHELL)
+	/* Without the telemetry shell command, print the telemetry periodically. */
+	telemetry_summary_set(TELEMETRY_SUMMARY_DEFAULT_INTERVAL_MS);
+#endif
+
 	return 0;
 }
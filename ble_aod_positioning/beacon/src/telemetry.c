@@ -0,0 +1,262 @@
+#include "telemetry.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/printk.h>
+#if defined(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+
+/* Telemetry state of an advertising set. */
+struct telemetry_set {
+	bool started;
+	/* Start of the set, or of the telemetry after a reset. */
+	int64_t start_ms;
+	uint32_t cte_updates;
+	uint32_t cte_update_errors;
+};
+
+static struct telemetry_set telemetry_sets[TELEMETRY_SET_COUNT_MAX];
+static struct telemetry_jitter telemetry_work_jitter;
+static uint32_t telemetry_work_last_late_us;
+static struct k_spinlock telemetry_lock;
+
+static uint32_t telemetry_summary_interval_ms;
+static struct k_work_delayable telemetry_summary_work;
+/* Uptime when the next summary is due, in ticks, for the work jitter. */
+static int64_t telemetry_summary_due_ticks;
+
+/* Update a jitter with the difference between two consecutive samples. */
+static void telemetry_jitter_update(struct telemetry_jitter *jitter, uint32_t previous_us,
+				    uint32_t sample_us)
+{
+	uint32_t diff_us = sample_us > previous_us ? sample_us - previous_us
+						   : previous_us - sample_us;
+
+	/* J += (|D| - J) / 16, see RFC 3550, Section 6.4.1. */
+	jitter->jitter_us = (uint32_t)((int32_t)jitter->jitter_us +
+				       ((int32_t)diff_us - (int32_t)jitter->jitter_us) / 16);
+	if (diff_us > jitter->max_us) {
+		jitter->max_us = diff_us;
+	}
+	jitter->count++;
+}
+
+/* Schedule the next summary in telemetry_summary_interval_ms. */
+static void telemetry_summary_schedule(void)
+{
+	telemetry_summary_due_ticks =
+		k_uptime_ticks() + k_ms_to_ticks_ceil64(telemetry_summary_interval_ms);
+	k_work_reschedule(&telemetry_summary_work, K_MSEC(telemetry_summary_interval_ms));
+}
+
+static void telemetry_summary_work_handler(struct k_work *work)
+{
+	struct telemetry_set_stats stats;
+	struct telemetry_jitter work_jitter;
+	int64_t now_ticks = k_uptime_ticks();
+
+	if (now_ticks > telemetry_summary_due_ticks) {
+		telemetry_work_late(
+			(uint32_t)k_ticks_to_us_floor64(now_ticks - telemetry_summary_due_ticks));
+	} else {
+		telemetry_work_late(0);
+	}
+
+	for (size_t i = 0; i < TELEMETRY_SET_COUNT_MAX; i++) {
+		if (telemetry_get(i, &stats) != 0 || stats.uptime_ms == 0) {
+			continue;
+		}
+		printk("Telemetry set %zu: %u s, %u CTE updates (%u failed)\n", i,
+		       stats.uptime_ms / 1000U, stats.cte_updates, stats.cte_update_errors);
+	}
+
+	telemetry_get_work_jitter(&work_jitter);
+	if (work_jitter.count > 0) {
+		printk("Telemetry work: %u samples, jitter %u us (max %u us)\n", work_jitter.count,
+		       work_jitter.jitter_us, work_jitter.max_us);
+	}
+
+	if (telemetry_summary_interval_ms > 0) {
+		telemetry_summary_schedule();
+	}
+}
+
+void telemetry_init(void)
+{
+	memset(telemetry_sets, 0, sizeof(telemetry_sets));
+	memset(&telemetry_work_jitter, 0, sizeof(telemetry_work_jitter));
+	telemetry_work_last_late_us = 0;
+	telemetry_summary_interval_ms = 0;
+	telemetry_summary_due_ticks = 0;
+	k_work_init_delayable(&telemetry_summary_work, telemetry_summary_work_handler);
+}
+
+void telemetry_set_started(size_t set_index)
+{
+	if (set_index >= TELEMETRY_SET_COUNT_MAX) {
+		return;
+	}
+
+	int64_t now_ms = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+	struct telemetry_set *set = &telemetry_sets[set_index];
+
+	memset(set, 0, sizeof(*set));
+	set->started = true;
+	set->start_ms = now_ms;
+
+	k_spin_unlock(&telemetry_lock, key);
+}
+
+void telemetry_cte_updated(size_t set_index, int err)
+{
+	if (set_index >= TELEMETRY_SET_COUNT_MAX) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+	struct telemetry_set *set = &telemetry_sets[set_index];
+
+	if (err) {
+		set->cte_update_errors++;
+	} else {
+		set->cte_updates++;
+	}
+
+	k_spin_unlock(&telemetry_lock, key);
+}
+
+void telemetry_work_late(uint32_t late_us)
+{
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+
+	telemetry_jitter_update(&telemetry_work_jitter, telemetry_work_last_late_us, late_us);
+	telemetry_work_last_late_us = late_us;
+
+	k_spin_unlock(&telemetry_lock, key);
+}
+
+int telemetry_get(size_t set_index, struct telemetry_set_stats *stats)
+{
+	if (set_index >= TELEMETRY_SET_COUNT_MAX || stats == NULL) {
+		return -EINVAL;
+	}
+
+	int64_t now_ms = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+	const struct telemetry_set *set = &telemetry_sets[set_index];
+
+	stats->uptime_ms = set->started ? (uint32_t)(now_ms - set->start_ms) : 0;
+	stats->cte_updates = set->cte_updates;
+	stats->cte_update_errors = set->cte_update_errors;
+
+	k_spin_unlock(&telemetry_lock, key);
+
+	return 0;
+}
+
+void telemetry_get_work_jitter(struct telemetry_jitter *jitter)
+{
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+
+	*jitter = telemetry_work_jitter;
+
+	k_spin_unlock(&telemetry_lock, key);
+}
+
+void telemetry_reset(void)
+{
+	int64_t now_ms = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+
+	for (size_t i = 0; i < TELEMETRY_SET_COUNT_MAX; i++) {
+		struct telemetry_set *set = &telemetry_sets[i];
+
+		set->start_ms = now_ms;
+		set->cte_updates = 0;
+		set->cte_update_errors = 0;
+	}
+	memset(&telemetry_work_jitter, 0, sizeof(telemetry_work_jitter));
+	telemetry_work_last_late_us = 0;
+
+	k_spin_unlock(&telemetry_lock, key);
+}
+
+void telemetry_summary_set(uint32_t interval_ms)
+{
+	telemetry_summary_interval_ms = interval_ms;
+
+	if (interval_ms > 0) {
+		telemetry_summary_schedule();
+	} else {
+		k_work_cancel_delayable(&telemetry_summary_work);
+	}
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_telemetry_show(const struct shell *sh, size_t argc, char **argv)
+{
+	struct telemetry_set_stats stats;
+	struct telemetry_jitter work_jitter;
+
+	for (size_t i = 0; i < TELEMETRY_SET_COUNT_MAX; i++) {
+		if (telemetry_get(i, &stats) != 0 || stats.uptime_ms == 0) {
+			continue;
+		}
+		shell_print(sh, "Advertising set %zu: %u ms", i, stats.uptime_ms);
+		shell_print(sh, "  CTE updates: %u (%u failed)", stats.cte_updates,
+			    stats.cte_update_errors);
+	}
+
+	telemetry_get_work_jitter(&work_jitter);
+	shell_print(sh, "Work jitter: %u us (max %u us, %u samples)", work_jitter.jitter_us,
+		    work_jitter.max_us, work_jitter.count);
+
+	return 0;
+}
+
+static int cmd_telemetry_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	telemetry_reset();
+	shell_print(sh, "Telemetry reset");
+
+	return 0;
+}
+
+static int cmd_telemetry_summary(const struct shell *sh, size_t argc, char **argv)
+{
+	if (strcmp(argv[1], "off") == 0) {
+		telemetry_summary_set(0);
+		shell_print(sh, "Telemetry summary off");
+		return 0;
+	}
+
+	long seconds = strtol(argv[1], NULL, 10);
+
+	if (seconds <= 0) {
+		shell_error(sh, "Usage: telemetry summary <seconds> | telemetry summary off");
+		return -EINVAL;
+	}
+
+	telemetry_summary_set((uint32_t)seconds * 1000U);
+	shell_print(sh, "Telemetry summary every %ld s", seconds);
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(telemetry_cmds,
+	SHELL_CMD_ARG(show, NULL, "Show the telemetry of the advertising sets",
+		      cmd_telemetry_show, 1, 0),
+	SHELL_CMD_ARG(reset, NULL, "Reset the telemetry", cmd_telemetry_reset, 1, 0),
+	SHELL_CMD_ARG(summary, NULL, "Print a periodic summary: summary <seconds> | summary off",
+		      cmd_telemetry_summary, 2, 0),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(telemetry, &telemetry_cmds, "Beacon telemetry commands", NULL);
+#endif
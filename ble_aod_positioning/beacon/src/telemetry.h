@@ -0,0 +1,81 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Beacon telemetry. Counters of the advertising sets and the timing jitter of
+ * the scheduled work items are kept in RAM and shown on demand with the
+ * telemetry shell command, or as a periodic summary. Nothing is printed per
+ * advertising event, so the beacon can run at short advertising intervals.
+ *
+ * Only what the host observes is reported: the CTE parameter changes and
+ * their failures, and the lateness of the scheduled work items. The
+ * controller reports no periodic advertising events to the host, and the
+ * extended advertising sent callback only fires when a limited advertising set
+ * ends, so periodic advertising events and CTEs sent are not counted.
+ */
+
+/* Maximum number of advertising sets with telemetry. */
+#define TELEMETRY_SET_COUNT_MAX CONFIG_BT_EXT_ADV_MAX_ADV_SET
+
+/* Interval of the periodic summary when the beacon has no shell, in
+ * milliseconds. See the telemetry_summary_set() function.
+ */
+#define TELEMETRY_SUMMARY_DEFAULT_INTERVAL_MS 60000
+
+/* Timing jitter, in microseconds. The jitter is the smoothed difference
+ * between consecutive intervals, with gain 1/16 as in RFC 3550.
+ */
+struct telemetry_jitter {
+	uint32_t count;
+	uint32_t jitter_us;
+	uint32_t max_us;
+};
+
+/* Telemetry of an advertising set. */
+struct telemetry_set_stats {
+	/* Time since the set was started, in milliseconds. 0 if not started. */
+	uint32_t uptime_ms;
+	/* CTE parameter changes, and failed CTE parameter changes. */
+	uint32_t cte_updates;
+	uint32_t cte_update_errors;
+};
+
+/* Initialize the telemetry. Must be called before any other telemetry
+ * function.
+ */
+void telemetry_init(void);
+
+/* Report a started advertising set. */
+void telemetry_set_started(size_t set_index);
+
+/* Report a CTE parameter change of an advertising set, with the result of the
+ * change.
+ */
+void telemetry_cte_updated(size_t set_index, int err);
+
+/* Report the lateness of a scheduled work item, such as the antenna pattern
+ * rotation, in microseconds. The telemetry summary reports its own lateness,
+ * so the jitter of the system work queue is measured while the summary runs.
+ */
+void telemetry_work_late(uint32_t late_us);
+
+/* Get the telemetry of an advertising set.
+ * Returns 0 if stats is set, or -EINVAL if set_index is out of range or stats
+ * is NULL.
+ */
+int telemetry_get(size_t set_index, struct telemetry_set_stats *stats);
+
+/* Get the jitter of the scheduled work items. */
+void telemetry_get_work_jitter(struct telemetry_jitter *jitter);
+
+/* Reset all counters and jitter. Started sets count from now. */
+void telemetry_reset(void);
+
+/* Print a summary of all started advertising sets every interval_ms
+ * milliseconds, or stop printing if interval_ms is 0.
+ */
+void telemetry_summary_set(uint32_t interval_ms);
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,480 @@
+#include "dsp_bench.h"
+#include <errno.h> // For EINVAL (22), ENODATA (61), and ENOTSUP (134).
+#include <math.h> // For sinf().
+#include <stdbool.h> // For bool, false, and true.
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint8_t, uint32_t, uint64_t, and UINT32_MAX.
+#include <stdio.h> // For printf().
+#include "aod_sim.h" // For simulation structure and aod_sim_generate().
+#include "beacon.h" // For beacon structure and beacon_init().
+#include "beacon_database.h" // For beacon database structure.
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "chw1010_ant2_specs.h" // For the chw1010_ant2_pattern enum, chw1010_ant2_measurement_antenna(), and chw1010_ant2_pair_direction().
+#include "directional_statistics.h" // For directional_statistics_circular_mean().
+#include "iq_data.h" // For IQ data structure and iq_data_estimate_direction().
+#include "iq_data_stages.h" // For IQ data processing stages.
+#include "locator.h" // For locator structure and locator_estimate_position_from_skew_lines().
+
+// Seed of the synthetic reports.
+#define BENCH_SEED 1
+
+// Signal-to-noise ratio and carrier frequency offset of the synthetic reports.
+#define BENCH_SNR_DB 20.0f
+#define BENCH_CFO_HZ 10000.0f
+
+// Number of pair phase differences per circular mean, about half of the pairs
+// of a maximum length CTE with 2 us slots.
+#define BENCH_PAIR_COUNT 18
+
+// Antenna pattern ID of the results of stages that do not take IQ samples.
+#define BENCH_PATTERN_NONE CHW1010_ANT2_PATTERN_COUNT
+
+// Number of clock reads for the clock overhead.
+#define BENCH_OVERHEAD_SAMPLES 64
+
+// A stage of IQ data processing, adapted to a common signature.
+typedef void (*bench_stage_t)(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples);
+
+static const char *const pattern_names[CHW1010_ANT2_PATTERN_COUNT] = {
+    "all",
+    "row",
+    "column",
+    "outer",
+    "single",
+};
+
+// Two beacons facing the global Z axis, 10 meters apart, and the locator
+// positions of the bearings of the skew lines stage.
+static const uint8_t bench_beacon_macs[2][BT_ADDR_SIZE] = {
+    {0xF6, 0x66, 0xCD, 0xFD, 0xDC, 0xEB},
+    {0xCE, 0x96, 0xF5, 0x15, 0xD2, 0x45},
+};
+static const float bench_beacon_x[2] = {0.0f, 10.0f};
+
+// Inputs and outputs of the timed calls. Static, since the IQ data structures
+// are too large for the stack of the target.
+static struct beacon bench_beacons[2];
+static struct beacon_database bench_beacon_db;
+static struct locator bench_locator;
+static struct iq_raw_samples bench_raw[DSP_BENCH_REPORTS];
+static struct iq_data bench_iq[DSP_BENCH_REPORTS];
+static struct iq_data bench_scratch[DSP_BENCH_REPORTS];
+static float bench_pair_deltas[DSP_BENCH_REPORTS][BENCH_PAIR_COUNT];
+static float bench_bearings[DSP_BENCH_REPORTS][2][3];
+
+// Results of functions with return values, so that the calls are not removed.
+static volatile float bench_sink;
+
+static void stage_iq_data_init(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
+    iq_data_init(iq_data, iq_raw_samples);
+}
+
+static void stage_temp_fix_ref_samples(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
+    (void)iq_raw_samples;
+    iq_data_temp_fix_ref_samples(iq_data);
+}
+
+static void stage_calculate_reference_phases(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
+    (void)iq_raw_samples;
+    iq_data_calculate_reference_phases(iq_data);
+}
+
+static void stage_unwrap_reference_phases(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
+    (void)iq_raw_samples;
+    iq_data_unwrap_reference_phases(iq_data);
+}
+
+static void stage_estimate_linear_phase_drift_rate(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
+    (void)iq_raw_samples;
+    iq_data_estimate_linear_phase_drift_rate(iq_data);
+}
+
+static void stage_compensate_measurement_samples(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
+    (void)iq_raw_samples;
+    iq_data_compensate_measurement_samples(iq_data);
+}
+
+static void stage_aod_interferometry(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
+    (void)iq_raw_samples;
+    iq_data_aod_interferometry(iq_data);
+}
+
+static void stage_estimate_direction(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
+    bench_sink = (float)iq_data_estimate_direction(iq_data, iq_raw_samples);
+}
+
+// Get the minimum ticks between two clock reads.
+static uint32_t clock_overhead(dsp_bench_clock_t clock) {
+    uint32_t overhead = UINT32_MAX;
+    for (int n = 0; n < BENCH_OVERHEAD_SAMPLES; n++) {
+        uint32_t start = clock();
+        uint32_t end = clock();
+        if (end - start < overhead) {
+            overhead = end - start;
+        }
+    }
+    return overhead;
+}
+
+static void result_init(
+        struct dsp_bench_result *result,
+        const char *stage,
+        uint8_t antenna_pattern_id) {
+    result->stage = stage;
+    result->antenna_pattern_id = antenna_pattern_id;
+    result->calls = 0;
+    result->total_ticks = 0;
+    result->min_batch_ticks = UINT32_MAX;
+    result->batch_calls = DSP_BENCH_REPORTS;
+}
+
+static void result_add_batch(
+        struct dsp_bench_result *result,
+        uint32_t ticks,
+        uint32_t overhead) {
+    ticks = ticks > overhead ? ticks - overhead : 0;
+    result->calls += result->batch_calls;
+    result->total_ticks += ticks;
+    if (ticks < result->min_batch_ticks) {
+        result->min_batch_ticks = ticks;
+    }
+}
+
+// Time a stage over all reports. The first batch warms up the caches and is
+// not counted.
+static void time_stage(
+        const struct dsp_bench_config *config,
+        uint32_t overhead,
+        struct dsp_bench_result *result,
+        const char *name,
+        uint8_t antenna_pattern_id,
+        bench_stage_t stage,
+        struct iq_data *iq_data) {
+    result_init(result, name, antenna_pattern_id);
+
+    for (int round = -1; round < config->rounds; round++) {
+        uint32_t start = config->clock();
+        for (int n = 0; n < DSP_BENCH_REPORTS; n++) {
+            stage(&iq_data[n], &bench_raw[n]);
+        }
+        uint32_t end = config->clock();
+
+        if (round >= 0) {
+            result_add_batch(result, end - start, overhead);
+        }
+    }
+}
+
+// Check if an antenna pattern has antenna pairs, orthogonally adjacent
+// antennas in temporally adjacent sample slots, as paired by the
+// iq_data_aod_interferometry() function. The antennas of the sample slots
+// repeat after one round of the pattern, so one round and the wrap to the next
+// round cover all pairs. A pattern without antenna pairs, such as the single
+// antenna pattern, gives no direction.
+static bool pattern_has_pairs(uint8_t antenna_pattern_id) {
+    int num_ant_ids =
+            chw1010_ant2_switching_patterns[antenna_pattern_id].num_ant_ids;
+    for (int i = 0; i < num_ant_ids; i++) {
+        int antenna_1 = chw1010_ant2_measurement_antenna(antenna_pattern_id, i);
+        int antenna_2 = chw1010_ant2_measurement_antenna(antenna_pattern_id, i + 1);
+        if (antenna_1 >= 0 && antenna_2 >= 0 &&
+                chw1010_ant2_pair_direction(
+                        (uint8_t)antenna_1,
+                        (uint8_t)antenna_2) >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Generate the synthetic reports of an antenna pattern, and estimate their
+// directions, so that bench_iq[] holds the input of every stage.
+// Returns 0 (0 ~ "Success") if the reports are prepared.
+// Returns a negative error number of the simulation or the estimator
+// otherwise.
+static int prepare_reports(
+        const struct dsp_bench_config *config,
+        uint8_t antenna_pattern_id) {
+    struct aod_sim_config sim_config;
+    aod_sim_config_default(&sim_config);
+    sim_config.beacon = &bench_beacons[0];
+    sim_config.locator_x = 0.5f;
+    sim_config.locator_y = 0.5f;
+    sim_config.locator_z = 3.0f;
+    sim_config.antenna_pattern_id = antenna_pattern_id;
+    sim_config.measurement_spacing = config->measurement_spacing;
+    sim_config.sample_count = (uint8_t)aod_sim_sample_count(
+            20,
+            config->measurement_spacing);
+    sim_config.snr_db = BENCH_SNR_DB;
+    sim_config.cfo_hz = BENCH_CFO_HZ;
+
+    static struct aod_sim sim;
+    int ret = aod_sim_init(&sim, &sim_config);
+    if (ret != 0) {
+        return ret;
+    }
+
+    struct aod_sim_rng rng;
+    aod_sim_rng_seed(&rng, BENCH_SEED);
+
+    for (int n = 0; n < DSP_BENCH_REPORTS; n++) {
+        aod_sim_generate(&sim, &rng, 10 * n, &bench_raw[n]);
+
+        ret = iq_data_estimate_direction(&bench_iq[n], &bench_raw[n]);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+// Prepare the beacons, the locator, and the inputs of the circular mean and
+// skew lines stages.
+// Returns 0 (0 ~ "Success") if the inputs are prepared.
+// Returns a negative error number of the simulation or the locator otherwise.
+static int prepare_solver_inputs(void) {
+    int ret = beacon_database_init(&bench_beacon_db);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (int b = 0; b < 2; b++) {
+        ret = beacon_init(
+                &bench_beacons[b],
+                bench_beacon_macs[b],
+                bench_beacon_x[b], 0.0f, 0.0f,
+                0.0f, 0.0f, 0.0f);
+        if (ret != 0) {
+            return ret;
+        }
+
+        ret = beacon_database_put(&bench_beacon_db, &bench_beacons[b]);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    ret = locator_init(&bench_locator, &bench_beacon_db);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (int n = 0; n < DSP_BENCH_REPORTS; n++) {
+        // Pair phase differences scattered around a mean.
+        for (int i = 0; i < BENCH_PAIR_COUNT; i++) {
+            bench_pair_deltas[n][i] = 0.8f + 0.3f * sinf(1.7f * i + n);
+        }
+
+        // Bearings of both beacons toward a locator between the beacons.
+        for (int b = 0; b < 2; b++) {
+            struct aod_sim_config sim_config;
+            aod_sim_config_default(&sim_config);
+            sim_config.beacon = &bench_beacons[b];
+            sim_config.locator_x = 4.0f + 0.25f * n;
+            sim_config.locator_y = 1.0f;
+            sim_config.locator_z = 3.0f;
+
+            static struct aod_sim sim;
+            ret = aod_sim_init(&sim, &sim_config);
+            if (ret != 0) {
+                return ret;
+            }
+
+            bench_bearings[n][b][0] = sim.local_direction_cosine_x;
+            bench_bearings[n][b][1] = sim.local_direction_cosine_y;
+            bench_bearings[n][b][2] = sim.local_direction_cosine_z;
+        }
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+static void time_circular_mean(
+        const struct dsp_bench_config *config,
+        uint32_t overhead,
+        struct dsp_bench_result *result) {
+    result_init(result, "directional_statistics_circular_mean", BENCH_PATTERN_NONE);
+
+    for (int round = -1; round < config->rounds; round++) {
+        float sum = 0.0f;
+        uint32_t start = config->clock();
+        for (int n = 0; n < DSP_BENCH_REPORTS; n++) {
+            // Same iterations and tolerance as the iq_data_aod_interferometry()
+            // function.
+            sum += directional_statistics_circular_mean(
+                    bench_pair_deltas[n],
+                    BENCH_PAIR_COUNT,
+                    5,
+                    0.01f);
+        }
+        uint32_t end = config->clock();
+        bench_sink = sum;
+
+        if (round >= 0) {
+            result_add_batch(result, end - start, overhead);
+        }
+    }
+}
+
+static void time_skew_lines(
+        const struct dsp_bench_config *config,
+        uint32_t overhead,
+        struct dsp_bench_result *result) {
+    result_init(result, "locator_estimate_position_from_skew_lines", BENCH_PATTERN_NONE);
+
+    for (int round = -1; round < config->rounds; round++) {
+        int sum = 0;
+        uint32_t start = config->clock();
+        for (int n = 0; n < DSP_BENCH_REPORTS; n++) {
+            sum += locator_estimate_position_from_skew_lines(
+                    &bench_locator,
+                    bench_beacons[0].mac_little_endian,
+                    bench_bearings[n][0][0],
+                    bench_bearings[n][0][1],
+                    bench_bearings[n][0][2],
+                    bench_beacons[1].mac_little_endian,
+                    bench_bearings[n][1][0],
+                    bench_bearings[n][1][1],
+                    bench_bearings[n][1][2]);
+        }
+        uint32_t end = config->clock();
+        bench_sink = (float)sum;
+
+        if (round >= 0) {
+            result_add_batch(result, end - start, overhead);
+        }
+    }
+}
+
+int dsp_bench_run(
+        const struct dsp_bench_config *config,
+        struct dsp_bench_result *results,
+        int results_max) {
+    if (config == NULL || config->clock == NULL || results == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+    if (config->rounds <= 0 ||
+            (config->measurement_spacing != IQ_MEASUREMENT_SPACING_1US_SLOTS &&
+             config->measurement_spacing != IQ_MEASUREMENT_SPACING_2US_SLOTS) ||
+            results_max < DSP_BENCH_RESULTS_MAX) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    int ret = prepare_solver_inputs();
+    if (ret != 0) {
+        return ret;
+    }
+
+    uint32_t overhead = clock_overhead(config->clock);
+    int count = 0;
+
+    // Stages that do not depend on the antenna pattern. iq_data_init() and
+    // iq_data_temp_fix_ref_samples() modify their input, so they are timed on
+    // scratch copies. The other stages only write their own output fields.
+    ret = prepare_reports(config, CHW1010_ANT2_PATTERN_ALL);
+    if (ret != 0) {
+        return ret;
+    }
+
+    time_stage(config, overhead, &results[count++],
+            "iq_data_init", CHW1010_ANT2_PATTERN_ALL,
+            stage_iq_data_init, bench_scratch);
+    time_stage(config, overhead, &results[count++],
+            "iq_data_temp_fix_ref_samples", CHW1010_ANT2_PATTERN_ALL,
+            stage_temp_fix_ref_samples, bench_scratch);
+    time_stage(config, overhead, &results[count++],
+            "iq_data_calculate_reference_phases", CHW1010_ANT2_PATTERN_ALL,
+            stage_calculate_reference_phases, bench_iq);
+    time_stage(config, overhead, &results[count++],
+            "iq_data_unwrap_reference_phases", CHW1010_ANT2_PATTERN_ALL,
+            stage_unwrap_reference_phases, bench_iq);
+    time_stage(config, overhead, &results[count++],
+            "iq_data_estimate_linear_phase_drift_rate",
+            CHW1010_ANT2_PATTERN_ALL,
+            stage_estimate_linear_phase_drift_rate, bench_iq);
+    time_stage(config, overhead, &results[count++],
+            "iq_data_compensate_measurement_samples", CHW1010_ANT2_PATTERN_ALL,
+            stage_compensate_measurement_samples, bench_iq);
+
+    // Estimator stages for each antenna pattern with antenna pairs. Every
+    // report of such a pattern must give a direction, so that the estimator
+    // stages are timed on the work of a direction.
+    for (uint8_t pattern = 0; pattern < CHW1010_ANT2_PATTERN_COUNT; pattern++) {
+        if (!pattern_has_pairs(pattern)) {
+            continue;
+        }
+
+        ret = prepare_reports(config, pattern);
+        if (ret == -ENOTSUP) {
+            // Not supported by the estimator.
+            continue;
+        }
+        if (ret == -ENODATA) {
+            printf("DSP benchmark: no direction with the %s antenna pattern\n",
+                    pattern_names[pattern]);
+        }
+        if (ret != 0) {
+            return ret;
+        }
+
+        time_stage(config, overhead, &results[count++],
+                "iq_data_aod_interferometry", pattern,
+                stage_aod_interferometry, bench_iq);
+        time_stage(config, overhead, &results[count++],
+                "iq_data_estimate_direction", pattern,
+                stage_estimate_direction, bench_scratch);
+    }
+
+    time_circular_mean(config, overhead, &results[count++]);
+    time_skew_lines(config, overhead, &results[count++]);
+
+    return count;
+}
+
+void dsp_bench_print(
+        const struct dsp_bench_config *config,
+        const struct dsp_bench_result *results,
+        int result_count) {
+    int measurement_sample_count = aod_sim_sample_count(
+            20,
+            config->measurement_spacing) - IQ_REFERENCE_MAX;
+
+    printf("DSP benchmark, %d measurement samples, %d calls x %d rounds, %s per call\n",
+            measurement_sample_count, DSP_BENCH_REPORTS, config->rounds,
+            config->unit);
+    printf("%-42s %-7s %10s %10s\n", "stage", "pattern", "mean", "min");
+
+    for (int r = 0; r < result_count; r++) {
+        const struct dsp_bench_result *result = &results[r];
+        uint32_t mean = result->calls > 0 ?
+                (uint32_t)(result->total_ticks / result->calls) : 0;
+        uint32_t min = result->min_batch_ticks / result->batch_calls;
+
+        printf("%-42s %-7s %10u %10u\n",
+                result->stage,
+                result->antenna_pattern_id < CHW1010_ANT2_PATTERN_COUNT ?
+                        pattern_names[result->antenna_pattern_id] : "-",
+                (unsigned int)mean,
+                (unsigned int)min);
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef DSP_BENCH_H
+#define DSP_BENCH_H
+
+#include <stdint.h> // For uint8_t, uint32_t, and uint64_t.
+
+// Microbenchmark of the DSP stages of the locator core.
+//
+// Each stage of IQ data processing, see iq_data.h, and the solver functions
+// that follow it, are timed on fixed synthetic inputs. The inputs are
+// DSP_BENCH_REPORTS IQ samples reports of one beacon, generated with a fixed
+// seed, see aod_sim.h, so every run times the same work. Each stage is timed
+// in batches of DSP_BENCH_REPORTS calls, one call per report, and the clock
+// overhead is subtracted from each batch.
+//
+// The clock is platform specific. The benchmark app times with the DWT cycle
+// counter on the target, see benchmark/src/main.c, and the aod_bench host tool
+// times with a high-resolution clock in nanoseconds, see host/aod_bench.c.
+
+// Number of IQ samples reports per batch.
+#define DSP_BENCH_REPORTS 8
+
+// Maximum number of results of one run.
+// See the dsp_bench_run() function.
+#define DSP_BENCH_RESULTS_MAX 32
+
+// Clock of the benchmark. A free-running counter of ticks, such as cycles or
+// nanoseconds. Only differences are used, so the counter may wrap, but a
+// batch must take less than one wrap period.
+typedef uint32_t (*dsp_bench_clock_t)(void);
+
+// Benchmark configuration structure.
+// See the dsp_bench_run() function.
+struct dsp_bench_config {
+    dsp_bench_clock_t clock;
+
+    // Unit of the clock ticks, for example "cycles" or "ns".
+    const char *unit;
+
+    // Number of timed batches per stage.
+    int rounds;
+
+    // Interval between samples in the measurement period of the synthetic
+    // reports, IQ_MEASUREMENT_SPACING_1US_SLOTS or
+    // IQ_MEASUREMENT_SPACING_2US_SLOTS.
+    uint8_t measurement_spacing;
+};
+
+// Benchmark result structure, the timing of one stage.
+struct dsp_bench_result {
+    // Name of the stage, the name of the timed function.
+    const char *stage;
+
+    // Antenna pattern of the reports, see the chw1010_ant2_pattern enum.
+    // CHW1010_ANT2_PATTERN_COUNT if the stage does not take IQ samples.
+    uint8_t antenna_pattern_id;
+
+    // Number of timed calls, and the total ticks of all calls.
+    uint32_t calls;
+    uint64_t total_ticks;
+
+    // Ticks of the fastest batch, and the number of calls per batch.
+    uint32_t min_batch_ticks;
+    uint32_t batch_calls;
+};
+
+// Run the benchmark.
+// The stages up to iq_data_compensate_measurement_samples() do not depend on
+// the antenna pattern, and are timed with CHW1010_ANT2_PATTERN_ALL. The
+// iq_data_aod_interferometry() stage and the iq_data_estimate_direction()
+// stage, all stages in one call, are timed for each antenna pattern with
+// antenna pairs, the all, row, column, and outer patterns.
+// directional_statistics_circular_mean() is timed on one set of pair phase
+// differences per call, and locator_estimate_position_from_skew_lines() on the
+// bearings of two beacons.
+// Returns the number of results (> 0).
+// Returns -EINVAL (-22 ~ "Invalid argument") if a pointer is NULL, or if a
+// configuration value is out of range.
+// Returns -ENODATA (-61 ~ "No data available") if a report of an antenna
+// pattern with antenna pairs gives no direction.
+// Returns a negative error number of the simulation or the locator if the
+// inputs can not be prepared.
+int dsp_bench_run(
+        const struct dsp_bench_config *config,
+        struct dsp_bench_result *results,
+        int results_max);
+
+// Print benchmark results as a table, with the mean and minimum ticks per
+// call of each stage.
+void dsp_bench_print(
+        const struct dsp_bench_config *config,
+        const struct dsp_bench_result *results,
+        int result_count);
+
+#endif // DSP_BENCH_H
@@ -0,0 +1,89 @@
+// Microbenchmark of the DSP stages of the locator core on the target.
+//
+// Runs the DSP benchmark, see dsp_bench.h, with the DWT cycle counter of the
+// Cortex-M4 (nRF52833) or Cortex-M33 (nRF5340), and prints the mean and
+// minimum CPU cycles per call of each stage, for 2 us and 1 us sample slots.
+// Without a DWT, the hardware cycle counter of the system timer is used, at a
+// much lower resolution.
+
+#include <stddef.h> // For size_t.
+#include <stdint.h> // For uint8_t and uint32_t.
+#include <stdio.h> // For printf().
+#include <zephyr/kernel.h> // For k_cycle_get_32() and sys_clock_hw_cycles_per_sec().
+#if defined(CONFIG_CPU_CORTEX_M_HAS_DWT)
+#include <cmsis_core.h> // For CoreDebug, DWT, and SystemCoreClock.
+#endif
+#include "dsp_bench.h" // For dsp_bench_run() and dsp_bench_print().
+#include "iq_data.h" // For IQ_MEASUREMENT_SPACING_2US_SLOTS and IQ_MEASUREMENT_SPACING_1US_SLOTS.
+
+// Number of timed batches per stage. A batch of the slowest stage takes a few
+// milliseconds, far less than the wrap period of the cycle counter.
+#define BENCH_ROUNDS 64
+
+#if defined(CONFIG_CPU_CORTEX_M_HAS_DWT)
+// Enable the DWT cycle counter.
+static void cycle_counter_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycle_counter_get(void) {
+    return DWT->CYCCNT;
+}
+
+// CPU clock frequency, in hertz.
+static uint32_t cycle_counter_frequency(void) {
+    return SystemCoreClock;
+}
+
+#define CYCLE_COUNTER_UNIT "cycles"
+#else
+static void cycle_counter_init(void) {
+}
+
+static uint32_t cycle_counter_get(void) {
+    return k_cycle_get_32();
+}
+
+// System timer frequency, in hertz.
+static uint32_t cycle_counter_frequency(void) {
+    return (uint32_t)sys_clock_hw_cycles_per_sec();
+}
+
+#define CYCLE_COUNTER_UNIT "timer cycles"
+#endif
+
+int main(void) {
+    cycle_counter_init();
+
+    static const uint8_t spacings[] = {
+        IQ_MEASUREMENT_SPACING_2US_SLOTS,
+        IQ_MEASUREMENT_SPACING_1US_SLOTS,
+    };
+
+    printf("AoD DSP benchmark, %s at %u Hz\n",
+            CYCLE_COUNTER_UNIT,
+            (unsigned int)cycle_counter_frequency());
+
+    for (size_t s = 0; s < sizeof(spacings) / sizeof(spacings[0]); s++) {
+        struct dsp_bench_config config = {
+            .clock = cycle_counter_get,
+            .unit = CYCLE_COUNTER_UNIT,
+            .rounds = BENCH_ROUNDS,
+            .measurement_spacing = spacings[s],
+        };
+
+        static struct dsp_bench_result results[DSP_BENCH_RESULTS_MAX];
+        int count = dsp_bench_run(&config, results, DSP_BENCH_RESULTS_MAX);
+        if (count < 0) {
+            printf("DSP benchmark failed (err %d)\n", count);
+            return 0;
+        }
+
+        printf("\n");
+        dsp_bench_print(&config, results, count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+
+# Timing of the BabbleSim scenario, see README.rst.
+#
+# Usage: bsim_timing.py LOCATOR_LOG [MAC=TX_DUMP ...]
+#
+# LOCATOR_LOG is the output of the locator, with the TIMING lines of
+# CONFIG_LOCATOR_TIMING_LOG. Each MAC=TX_DUMP pair is the identity address of
+# a simulated beacon and the Tx dump of its device by the 2G4 phy (-dump),
+# which has the air time of each periodic advertising event. Without Tx dumps,
+# only the sync establishment times and the report rates are printed.
+#
+# All times are in microseconds of simulated time. The devices boot at time 0,
+# so the uptime of the locator is the time of the phy.
+
+import csv
+import os
+import sys
+
+# Access address of the advertising channel PDUs. All other packets of a
+# beacon are periodic advertising PDUs, AUX_SYNC_IND and AUX_CHAIN_IND.
+ADV_ACCESS_ADDRESS = 0x8E89BED6
+
+# Minimum gap between two periodic advertising events, in microseconds. The
+# packets of an event, AUX_SYNC_IND and its chain of AUX_CHAIN_IND with CTEs,
+# are closer than this, and the minimum periodic advertising interval is
+# 7.5 ms.
+EVENT_GAP_US = 5000
+
+
+def parse_locator_log(filename):
+    events = []
+
+    with open(filename, 'r', errors='replace') as input_file:
+        for line in input_file:
+            if "TIMING " not in line:
+                continue
+            words = line.split("TIMING ")[1].split()
+            if len(words) < 2:
+                continue
+            try:
+                words[-1] = int(words[-1])
+            except ValueError:
+                continue
+            events.append(words)
+
+    return events
+
+
+def parse_tx_dump(filename):
+    # Start times of the packets of each periodic advertising train, keyed by
+    # the access address of the train.
+    trains = {}
+
+    with open(filename, 'r') as input_file:
+        reader = csv.DictReader(input_file)
+        fields = reader.fieldnames or []
+        time_field = next((f for f in ("start_time", "start_tx_time") if f in fields), None)
+        if time_field is None or "phy_address" not in fields:
+            print(f"Error: {filename} is not a Tx dump of the 2G4 phy")
+            return {}
+
+        for row in reader:
+            address = int(row["phy_address"], 16)
+            if address == ADV_ACCESS_ADDRESS:
+                continue
+            trains.setdefault(address, []).append(int(float(row[time_field])))
+
+    # Start time of each periodic advertising event, the first packet after a
+    # gap. The index of an event is its periodic advertising event counter.
+    event_trains = {}
+    for address, times in trains.items():
+        times.sort()
+        event_times = [times[0]]
+        for t in times[1:]:
+            if t - event_times[-1] > EVENT_GAP_US:
+                event_times.append(t)
+        event_trains[address] = event_times
+
+    return event_trains
+
+
+def median_interval(event_times):
+    if len(event_times) < 2:
+        return None
+    intervals = sorted(b - a for a, b in zip(event_times, event_times[1:]))
+    return intervals[len(intervals) // 2]
+
+
+def event_time(event_times, counter, t):
+    # Latest event with the counter (modulo 2^16) that is not after t.
+    index = counter
+    best = None
+    while index < len(event_times) and event_times[index] <= t:
+        best = event_times[index]
+        index += 65536
+    return best
+
+
+def summary(values):
+    if len(values) == 0:
+        return "-"
+    values = sorted(values)
+    mean = sum(values) / len(values)
+    median = values[len(values) // 2]
+    p95 = values[min(len(values) - 1, (95 * len(values) + 99) // 100 - 1)]
+    return (f"n {len(values)}, mean {mean / 1000:.2f} ms, median {median / 1000:.2f} ms, "
+            f"p95 {p95 / 1000:.2f} ms, max {values[-1] / 1000:.2f} ms")
+
+
+def calculate_timing(events, tx_dumps):
+    end_time = max((e[-1] for e in events), default=0)
+
+    # Sync establishment.
+    scan_start = None
+    sync_create = {}
+    synced = {}
+    sync_of_index = {}
+    sync_of_mac = {}
+    cte = {}
+    processed = []
+
+    for e in events:
+        kind = e[0]
+        t = e[-1]
+        if kind == "scan_start" and scan_start is None:
+            scan_start = t
+        elif kind == "sync_create" and len(e) >= 3:
+            sync_create[e[1]] = t
+        elif kind == "synced" and len(e) >= 6:
+            index, mac, sid, interval = int(e[1]), e[2], int(e[3]), int(e[4])
+            created = sync_create.get(mac, sync_create.get("list"))
+            synced.setdefault(mac, []).append((t, created, sid, interval))
+            sync_of_index[index] = (mac, sid, interval)
+            sync_of_mac[mac] = (sid, interval)
+        elif kind == "sync_term" and len(e) >= 3:
+            sync_of_index.pop(int(e[1]), None)
+        elif kind == "cte" and len(e) >= 4:
+            sync = sync_of_index.get(int(e[1]))
+            if sync is not None:
+                cte.setdefault(sync[0], []).append((int(e[2]), t))
+        elif kind == "processed" and len(e) >= 5:
+            processed.append((e[1], int(e[2]), int(e[3]), t))
+
+    print("Sync establishment:")
+    for mac, syncs in sorted(synced.items()):
+        t, created, sid, interval = syncs[0]
+        first = f"{(t - scan_start) / 1000:.1f} ms after scan start" if scan_start is not None else "-"
+        create = f"{(t - created) / 1000:.1f} ms after sync create" if created is not None else "-"
+        print(f"  {mac} SID {sid}, interval {interval * 1.25:.2f} ms: "
+              f"synced {first}, {create}, {len(syncs)} syncs")
+    if len(synced) == 0:
+        print("  no syncs")
+
+    print("CTE reports:")
+    total = 0
+    for mac, reports in sorted(cte.items()):
+        first = synced[mac][0][0]
+        duration = (end_time - first) / 1e6
+        rate = len(reports) / duration if duration > 0 else 0.0
+        total += len(reports)
+        print(f"  {mac}: {len(reports)} reports, {rate:.2f} reports/s")
+    positions = sum(1 for p in processed if p[2])
+    print(f"  total {total} reports, {len(processed)} processed, {positions} positions")
+
+    # End-to-end latency, from the air time of the advertising event.
+    trains = {}
+    for mac, filename in tx_dumps.items():
+        if mac not in sync_of_mac:
+            continue
+        event_trains = parse_tx_dump(filename)
+        interval_us = sync_of_mac[mac][1] * 1250
+        best = None
+        for event_times in event_trains.values():
+            median = median_interval(event_times)
+            if median is None:
+                continue
+            if best is None or abs(median - interval_us) < abs(median_interval(best) - interval_us):
+                best = event_times
+        if best is not None:
+            trains[mac] = best
+
+    if len(trains) == 0:
+        return None
+
+    report_latencies = []
+    for mac, reports in cte.items():
+        if mac not in trains:
+            continue
+        for counter, t in reports:
+            air = event_time(trains[mac], counter, t)
+            if air is not None:
+                report_latencies.append(t - air)
+
+    processed_latencies = []
+    position_latencies = []
+    for mac, counter, position, t in processed:
+        if mac not in trains:
+            continue
+        air = event_time(trains[mac], counter, t)
+        if air is None:
+            continue
+        processed_latencies.append(t - air)
+        if position:
+            position_latencies.append(t - air)
+
+    print("Latency from advertising event:")
+    print(f"  to CTE report:  {summary(report_latencies)}")
+    print(f"  to processed:   {summary(processed_latencies)}")
+    print(f"  to position:    {summary(position_latencies)}")
+
+    return None
+
+
+def main():
+    if len(sys.argv) < 2 or not os.path.isfile(sys.argv[1]):
+        print("Usage: bsim_timing.py LOCATOR_LOG [MAC=TX_DUMP ...]")
+        sys.exit(1)
+
+    tx_dumps = {}
+    for argument in sys.argv[2:]:
+        mac, _, filename = argument.partition("=")
+        if not os.path.isfile(filename):
+            print(f"Error: {filename} is not a file")
+            continue
+        tx_dumps[mac.upper()] = filename
+
+    calculate_timing(parse_locator_log(sys.argv[1]), tx_dumps)
+
+
+if __name__ == "__main__":
+    main()
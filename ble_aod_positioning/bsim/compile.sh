@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# Build the beacon and locator images for the BabbleSim nRF52833 model
+# (nrf52_bsim), and copy them to ${BSIM_OUT_PATH}/bin. See README.rst.
+#
+# Usage: compile.sh
+#
+# Requires ZEPHYR_BASE, BSIM_OUT_PATH and BSIM_COMPONENTS_PATH, and west.
+# Builds in ${BUILD_ROOT}, by default build/ next to this script.
+
+set -ue
+
+: "${ZEPHYR_BASE:?ZEPHYR_BASE must be set}"
+: "${BSIM_OUT_PATH:?BSIM_OUT_PATH must be set}"
+: "${BSIM_COMPONENTS_PATH:?BSIM_COMPONENTS_PATH must be set}"
+
+script_dir=$(cd "$(dirname "$0")" && pwd)
+app_root=$(dirname "${script_dir}")
+build_root=${BUILD_ROOT:-${script_dir}/build}
+bin_dir=${BSIM_OUT_PATH}/bin
+
+# Identity addresses of the simulated beacons, beacons 1 and 2 of the beacon
+# deployment of the locator, see locator/src/beacon_deployment.c. One image per
+# beacon, since the nRF52833 model has no fixed device address.
+beacon_addrs=("F6:66:CD:FD:DC:EB" "CE:96:F5:15:D2:45")
+
+mkdir -p "${bin_dir}"
+
+for i in "${!beacon_addrs[@]}"; do
+  n=$((i + 1))
+  west build -p auto -b nrf52_bsim --no-sysbuild -d "${build_root}/beacon_${n}" \
+    "${app_root}/beacon" -- -DCONFIG_BEACON_IDENTITY_ADDR=\"${beacon_addrs[$i]}\"
+  cp "${build_root}/beacon_${n}/zephyr/zephyr.exe" "${bin_dir}/bs_nrf52_bsim_aod_beacon_${n}"
+done
+
+west build -p auto -b nrf52_bsim --no-sysbuild -d "${build_root}/locator" \
+  "${app_root}/locator" -- -DSNIPPET=bt-ll-sw-split
+cp "${build_root}/locator/zephyr/zephyr.exe" "${bin_dir}/bs_nrf52_bsim_aod_locator"
@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+# Run the BabbleSim scenario, the beacon images and the locator image against
+# each other on the 2G4 phy, and print the timing. See README.rst.
+#
+# Usage: run.sh [SECONDS] [BEACONS]
+#   SECONDS   Simulated time (default 30).
+#   BEACONS   Number of simulated beacons, 1 or 2 (default 2). The locator
+#             estimates positions from two beacons.
+#
+# Requires BSIM_OUT_PATH, and the images of compile.sh. The logs are written
+# to ${RESULTS_DIR}, by default results/ next to this script.
+
+set -ue
+
+: "${BSIM_OUT_PATH:?BSIM_OUT_PATH must be set}"
+
+sim_seconds=${1:-30}
+beacon_count=${2:-2}
+simulation_id=aod_e2e
+
+script_dir=$(cd "$(dirname "$0")" && pwd)
+results_dir=${RESULTS_DIR:-${script_dir}/results}
+phy_results_dir=${BSIM_OUT_PATH}/results/${simulation_id}
+
+# Identity addresses of the beacon images, see compile.sh.
+beacon_addrs=("F6:66:CD:FD:DC:EB" "CE:96:F5:15:D2:45")
+
+if [ "${beacon_count}" -lt 1 ] || [ "${beacon_count}" -gt "${#beacon_addrs[@]}" ]; then
+  echo "run.sh: BEACONS must be 1 to ${#beacon_addrs[@]}" >&2
+  exit 1
+fi
+
+mkdir -p "${results_dir}"
+cd "${BSIM_OUT_PATH}/bin"
+
+pids=()
+
+# Devices 0 to BEACONS-1 are the beacons, and device BEACONS is the locator.
+for ((d = 0; d < beacon_count; d++)); do
+  ./bs_nrf52_bsim_aod_beacon_$((d + 1)) -s="${simulation_id}" -d="${d}" \
+    -rs=$((d + 1)) -RealEncryption=0 > "${results_dir}/beacon_$((d + 1)).log" 2>&1 &
+  pids+=($!)
+done
+
+./bs_nrf52_bsim_aod_locator -s="${simulation_id}" -d="${beacon_count}" \
+  -rs=100 -RealEncryption=0 > "${results_dir}/locator.log" 2>&1 &
+pids+=($!)
+
+# The phy dumps the activity of each device, with the air time of each
+# periodic advertising event in the Tx dumps.
+./bs_2G4_phy_v1 -s="${simulation_id}" -D=$((beacon_count + 1)) \
+  -sim_length=$((sim_seconds * 1000000)) -dump > "${results_dir}/phy.log" 2>&1 &
+pids+=($!)
+
+status=0
+for pid in "${pids[@]}"; do
+  wait "${pid}" || status=1
+done
+if [ "${status}" -ne 0 ]; then
+  echo "run.sh: a device or the phy failed, see ${results_dir}" >&2
+fi
+
+tx_dumps=()
+for ((d = 0; d < beacon_count; d++)); do
+  tx_dump=$(ls "${phy_results_dir}"/d_*"$(printf "%02d" "${d}")".Tx.csv 2>/dev/null | head -n 1 || true)
+  if [ -n "${tx_dump}" ]; then
+    tx_dumps+=("${beacon_addrs[$d]}=${tx_dump}")
+  fi
+done
+
+python3 "${script_dir}/bsim_timing.py" "${results_dir}/locator.log" ${tx_dumps[@]+"${tx_dumps[@]}"}
@@ -0,0 +1,276 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "line_intersection.h"
+#include "robust_line_intersection.h"
+
+/*
+Offline benchmark of robust position estimation against the test coordinates.
+
+Each test coordinate is a fix from one bearing from beacon 1 (10, 0, 0) and one
+bearing from beacon 3 (0, 0, 0). The bearings are reconstructed as the lines
+from each beacon through the fix. Windows of consecutive fixes are then
+combined, once with a plain least squares intersection of all lines, and once
+with the robust line intersection solver of the locator.
+
+$ gcc -O2 -I../../../locator/src -o benchmark_robust_estimation \
+        benchmark_robust_estimation.c \
+        ../../../locator/src/line_intersection.c \
+        ../../../locator/src/robust_line_intersection.c -lm
+$ ./benchmark_robust_estimation ../data/test_1_coordinates.csv \
+        ../data/test_2_coordinates.csv ../data/test_3_coordinates.csv
+
+Add -DINLIER_DISTANCE=2.0f to the gcc command to benchmark another inlier
+distance, in meters.
+*/
+
+#define TEST_COUNT 3
+#define COORDINATES_MAX 256
+#define WINDOW_SIZE 4
+
+#ifndef INLIER_DISTANCE
+#define INLIER_DISTANCE ROBUST_LINE_INTERSECTION_DEFAULT_INLIER_DISTANCE
+#endif
+
+static const float test_ground_truths[TEST_COUNT][3] = {
+    {3.30f, 0.0f, 9.06f},
+    {9.69f, 0.0f, 9.40f},
+    {-1.53f, 0.0f, 9.27f}
+};
+
+static const float test_beacons[2][3] = {
+    {10.0f, 0.0f, 0.0f},
+    {0.0f, 0.0f, 0.0f}
+};
+
+static int read_coordinates(const char *filename, float coordinates[][3]) {
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) {
+        return -1;
+    }
+
+    int count = 0;
+    while (count < COORDINATES_MAX &&
+            fscanf(file, "%f,%f,%f",
+                    &coordinates[count][0],
+                    &coordinates[count][1],
+                    &coordinates[count][2]) == 3) {
+        count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+// Lines from both beacons through each fix in coordinates[first, first+count).
+static int make_lines(
+        float coordinates[][3],
+        int first,
+        int count,
+        struct robust_line *lines) {
+    int line_count = 0;
+    for (int i = first; i < first + count; i++) {
+        for (int b = 0; b < 2; b++) {
+            float dx = coordinates[i][0] - test_beacons[b][0];
+            float dy = coordinates[i][1] - test_beacons[b][1];
+            float dz = coordinates[i][2] - test_beacons[b][2];
+            float length = sqrtf(dx*dx + dy*dy + dz*dz);
+
+            struct robust_line *line = &lines[line_count];
+            line->px = test_beacons[b][0];
+            line->py = test_beacons[b][1];
+            line->pz = test_beacons[b][2];
+            line->dx = dx / length;
+            line->dy = dy / length;
+            line->dz = dz / length;
+            line->weight = 1.0f;
+            line->group = b;
+            line_count++;
+        }
+    }
+    return line_count;
+}
+
+static int solve_least_squares(
+        const struct robust_line *lines,
+        int line_count,
+        struct line_intersection_result *result) {
+    struct line_intersection line_intersection;
+    line_intersection_init(&line_intersection);
+    for (int i = 0; i < line_count; i++) {
+        line_intersection_add_line(
+                &line_intersection,
+                lines[i].px, lines[i].py, lines[i].pz,
+                lines[i].dx, lines[i].dy, lines[i].dz,
+                lines[i].weight);
+    }
+    return line_intersection_solve(&line_intersection, result);
+}
+
+static float error(const float truth[3], float x, float y, float z) {
+    float dx = x - truth[0];
+    float dy = y - truth[1];
+    float dz = z - truth[2];
+    return sqrtf(dx*dx + dy*dy + dz*dz);
+}
+
+static int compare_floats(const void *a, const void *b) {
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static float median(float *values, int count) {
+    qsort(values, count, sizeof(float), compare_floats);
+    if (count % 2 == 1) {
+        return values[count / 2];
+    }
+    return (values[count / 2 - 1] + values[count / 2]) / 2.0f;
+}
+
+static float mean(const float *values, int count) {
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sum = sum + values[i];
+    }
+    return sum / count;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s test_1.csv [test_2.csv] [test_3.csv]\n",
+                argv[0]);
+        return 1;
+    }
+
+    static float coordinates[COORDINATES_MAX][3];
+    static struct robust_line lines[2 * COORDINATES_MAX];
+    static float fix_errors[COORDINATES_MAX];
+    static float least_squares_errors[COORDINATES_MAX];
+    static float robust_errors[COORDINATES_MAX];
+
+    struct robust_line_intersection_config config;
+    robust_line_intersection_config_default(&config);
+    config.inlier_distance = INLIER_DISTANCE;
+
+    for (int t = 0; t < argc - 1 && t < TEST_COUNT; t++) {
+        const float *truth = test_ground_truths[t];
+        int count = read_coordinates(argv[t + 1], coordinates);
+        if (count < WINDOW_SIZE) {
+            fprintf(stderr, "%s: too few coordinates\n", argv[t + 1]);
+            continue;
+        }
+
+        // Single fixes, and the mean of all fixes as in
+        // process_test_coordinates.py.
+        float mean_x = 0.0f;
+        float mean_y = 0.0f;
+        float mean_z = 0.0f;
+        for (int i = 0; i < count; i++) {
+            mean_x = mean_x + coordinates[i][0] / count;
+            mean_y = mean_y + coordinates[i][1] / count;
+            mean_z = mean_z + coordinates[i][2] / count;
+            fix_errors[i] = error(
+                    truth,
+                    coordinates[i][0],
+                    coordinates[i][1],
+                    coordinates[i][2]);
+        }
+
+        // Sliding windows of WINDOW_SIZE fixes.
+        int window_count = 0;
+        int robust_count = 0;
+        int iterations_max = 0;
+        for (int i = 0; i + WINDOW_SIZE <= count; i++) {
+            int line_count = make_lines(coordinates, i, WINDOW_SIZE, lines);
+
+            struct line_intersection_result least_squares;
+            if (solve_least_squares(lines, line_count, &least_squares) == 0) {
+                least_squares_errors[window_count] = error(
+                        truth,
+                        least_squares.x,
+                        least_squares.y,
+                        least_squares.z);
+                window_count++;
+            }
+
+            struct robust_line_intersection_result robust;
+            int ret = robust_line_intersection_solve(
+                    lines,
+                    line_count,
+                    &config,
+                    &robust,
+                    NULL);
+            if (ret == 0) {
+                robust_errors[robust_count] = error(
+                        truth,
+                        robust.solution.x,
+                        robust.solution.y,
+                        robust.solution.z);
+                robust_count++;
+                if (robust.iteration_count > iterations_max) {
+                    iterations_max = robust.iteration_count;
+                }
+            }
+        }
+
+        // All fixes of the test at once, up to the line limit of the robust
+        // solver.
+        int all_count = count;
+        if (2 * all_count > ROBUST_LINE_INTERSECTION_LINES_MAX) {
+            all_count = ROBUST_LINE_INTERSECTION_LINES_MAX / 2;
+        }
+        int line_count = make_lines(coordinates, 0, all_count, lines);
+        struct line_intersection_result all_least_squares;
+        struct robust_line_intersection_result all_robust;
+        int ret_least_squares =
+                solve_least_squares(lines, line_count, &all_least_squares);
+        int ret_robust = robust_line_intersection_solve(
+                lines,
+                line_count,
+                &config,
+                &all_robust,
+                NULL);
+
+        printf("Test %d (%d fixes):\n", t + 1, count);
+        printf("    single fix:            mean %.3f, median %.3f meters\n",
+                mean(fix_errors, count),
+                median(fix_errors, count));
+        if (window_count > 0) {
+            printf("    %d-fix least squares:   mean %.3f, median %.3f meters\n",
+                    WINDOW_SIZE,
+                    mean(least_squares_errors, window_count),
+                    median(least_squares_errors, window_count));
+        }
+        if (robust_count > 0) {
+            printf("    %d-fix robust:          mean %.3f, median %.3f meters"
+                    " (%d/%d windows, max %d iterations)\n",
+                    WINDOW_SIZE,
+                    mean(robust_errors, robust_count),
+                    median(robust_errors, robust_count),
+                    robust_count,
+                    count - WINDOW_SIZE + 1,
+                    iterations_max);
+        }
+        printf("    mean of all fixes:     %.3f meters\n",
+                error(truth, mean_x, mean_y, mean_z));
+        if (ret_least_squares == 0) {
+            printf("    all least squares:     %.3f meters\n",
+                    error(truth,
+                            all_least_squares.x,
+                            all_least_squares.y,
+                            all_least_squares.z));
+        }
+        if (ret_robust == 0) {
+            printf("    all robust:            %.3f meters (%d/%d inliers)\n",
+                    error(truth,
+                            all_robust.solution.x,
+                            all_robust.solution.y,
+                            all_robust.solution.z),
+                    all_robust.inlier_count,
+                    line_count);
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
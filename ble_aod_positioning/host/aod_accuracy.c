@@ -0,0 +1,575 @@
+// Accuracy and throughput benchmark of the locator pipeline, against the
+// tests of the Skaarlia tunnel experiment.
+//
+// The three tests of experiments/2025_04_24_skaarlia_tunnel have a ground
+// truth position, and bearings from beacon 1 (10, 0, 0) and beacon 3 (0, 0, 0)
+// of the beacon deployment, see beacon_deployment.c. The IQ samples reports of
+// each test are processed by the same two stages as on the locator,
+// iq_data_estimate_direction() and iq_data_update_locator(). Each new position
+// of the locator is a fix. For each test, the mean, median, and 95th
+// percentile of the fix errors against the ground truth are written to
+// stdout, with the error of the mean position, which is the mean positioning
+// error of the experiment README. The reports processed per second are
+// measured in the same run, over the two stages only.
+//
+// Without files, the reports of each test are synthetic, see aod_sim.h. The
+// reports of beacon 1 and beacon 3 alternate, as received by a locator at the
+// ground truth. With files, FILE i is an IQ capture of test i, see
+// iq_capture.h, replayed as recorded.
+//
+// Usage: aod_accuracy [options] [FILE...]
+//   -m, --mode MODE        Locator mode: snapshot (default), tracking or
+//                          robust.
+//   -n, --count N          Synthetic reports per beacon and test (default
+//                          1000).
+//   -c, --channel N|hop    Channel index, or hop over channels 0-36 (default
+//                          hop).
+//   -p, --pattern N[,N...] Antenna pattern ID (default 0). With several IDs,
+//                          the patterns are rotated, as by the "ant rotate"
+//                          shell command of the beacon.
+//       --rotate N         Reports per beacon of each rotated pattern
+//                          (default 10).
+//       --snr DB           Signal-to-noise ratio per sample (default 20).
+//       --cfo HZ           Carrier frequency offset (default 10000).
+//       --seed N           Random seed (default 1).
+
+#include <errno.h> // For ENOENT (2), EAGAIN (11), ENOMEM (12), and errno.
+#include <fcntl.h> // For open().
+#include <getopt.h> // For getopt_long().
+#include <math.h> // For sqrtf() and ceil().
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0) and size_t.
+#include <stdint.h> // For uint8_t, uint16_t, uint64_t, and int64_t.
+#include <stdio.h> // For printf() and fprintf().
+#include <stdlib.h> // For malloc(), realloc(), qsort(), strtoul(), and EXIT_SUCCESS.
+#include <string.h> // For memcmp(), strcmp(), and strerror().
+#include <sys/mman.h> // For mmap() and munmap().
+#include <sys/stat.h> // For fstat().
+#include <time.h> // For clock_gettime().
+#include <unistd.h> // For close().
+#include "aod_sim.h" // For simulation structure and aod_sim_generate().
+#include "beacon.h" // For beacon structure.
+#include "beacon_database.h" // For beacon database structure.
+#include "beacon_deployment.h" // For beacon_deployment_put_all().
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "iq_capture.h" // For iq_capture_record_decode().
+#include "iq_data.h" // For IQ data structure and IQ data processing stages.
+#include "locator.h" // For locator structure.
+
+#define TEST_COUNT 3
+
+// Channels 0-36, the secondary advertising channels of periodic advertising.
+#define HOP_CHANNEL_COUNT 37
+
+// Time between synthetic reports, in milliseconds.
+#define REPORT_INTERVAL_MS 10
+
+// Maximum number of rotated antenna patterns.
+#define ROTATION_MAX 8
+
+// Test of the Skaarlia tunnel experiment. See the experiment README.
+struct accuracy_test {
+    // Ground truth, the global position of the locator, in meters.
+    float x;
+    float y;
+    float z;
+
+    // Beacons with bearings to the locator, by MAC address in big-endian
+    // format, and their global positions in meters.
+    uint8_t beacon_macs[2][BT_ADDR_SIZE];
+    float beacon_positions[2][3];
+};
+
+static const struct accuracy_test accuracy_tests[TEST_COUNT] = {
+    // Test 1.
+    {
+        .x = 3.30f, .y = 0.0f, .z = 9.06f,
+        .beacon_macs = {
+            {0xF6, 0x66, 0xCD, 0xFD, 0xDC, 0xEB},
+            {0xD5, 0x55, 0x32, 0x1F, 0x94, 0x9F},
+        },
+        .beacon_positions = {{10.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}},
+    },
+    // Test 2.
+    {
+        .x = 9.69f, .y = 0.0f, .z = 9.40f,
+        .beacon_macs = {
+            {0xF6, 0x66, 0xCD, 0xFD, 0xDC, 0xEB},
+            {0xD5, 0x55, 0x32, 0x1F, 0x94, 0x9F},
+        },
+        .beacon_positions = {{10.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}},
+    },
+    // Test 3.
+    {
+        .x = -1.53f, .y = 0.0f, .z = 9.27f,
+        .beacon_macs = {
+            {0xF6, 0x66, 0xCD, 0xFD, 0xDC, 0xEB},
+            {0xD5, 0x55, 0x32, 0x1F, 0x94, 0x9F},
+        },
+        .beacon_positions = {{10.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}},
+    },
+};
+
+// Synthetic report options.
+struct synthetic_options {
+    uint64_t count;
+    bool hop;
+    uint8_t channel_index;
+    // Antenna pattern IDs, rotated every rotation_reports reports per beacon.
+    uint8_t antenna_pattern_ids[ROTATION_MAX];
+    int antenna_pattern_count;
+    uint64_t rotation_reports;
+    float snr_db;
+    float cfo_hz;
+    uint64_t seed;
+};
+
+// Reports of one test.
+struct report_list {
+    struct iq_raw_samples *reports;
+    size_t count;
+    size_t capacity;
+};
+
+// Result of one test.
+struct test_result {
+    uint64_t reports;
+    uint64_t positions;
+    float mean_error;
+    float median_error;
+    float p95_error;
+    float mean_position_error;
+    double reports_per_s;
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int report_list_add(
+        struct report_list *list,
+        const struct iq_raw_samples *iq_raw_samples) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity > 0 ? 2 * list->capacity : 1024;
+        struct iq_raw_samples *reports =
+                realloc(list->reports, capacity * sizeof(*reports));
+        if (reports == NULL) {
+            return -ENOMEM; // -12 ~ "Cannot allocate memory".
+        }
+        list->reports = reports;
+        list->capacity = capacity;
+    }
+    list->reports[list->count++] = *iq_raw_samples;
+    return 0; // 0 ~ "Success".
+}
+
+// Find a beacon of a test in the beacon database, and check that it is where
+// the test expects it.
+static const struct beacon *find_test_beacon(
+        const struct beacon_database *beacon_db,
+        const struct accuracy_test *test,
+        int b) {
+    for (int n = 0; n < beacon_db->count; n++) {
+        const struct beacon *beacon = &beacon_db->beacons[n];
+        if (memcmp(beacon->mac_big_endian, test->beacon_macs[b], BT_ADDR_SIZE) != 0) {
+            continue;
+        }
+        if (beacon->x != test->beacon_positions[b][0] ||
+                beacon->y != test->beacon_positions[b][1] ||
+                beacon->z != test->beacon_positions[b][2]) {
+            return NULL;
+        }
+        return beacon;
+    }
+    return NULL;
+}
+
+// Generate the synthetic reports of a test, alternating between the beacons.
+// Returns 0 (0 ~ "Success") if the reports are generated.
+// Returns a negative error number otherwise.
+static int generate_reports(
+        const struct accuracy_test *test,
+        int test_index,
+        const struct beacon_database *beacon_db,
+        const struct synthetic_options *options,
+        struct report_list *list) {
+    struct aod_sim_config config;
+    aod_sim_config_default(&config);
+    config.locator_x = test->x;
+    config.locator_y = test->y;
+    config.locator_z = test->z;
+    config.snr_db = options->snr_db;
+    config.cfo_hz = options->cfo_hz;
+
+    struct aod_sim_rng rng;
+    aod_sim_rng_seed(&rng, options->seed + (uint64_t)test_index);
+
+    static struct aod_sim sim;
+    for (uint64_t n = 0; n < 2 * options->count; n++) {
+        int b = (int)(n % 2);
+        config.beacon = find_test_beacon(beacon_db, test, b);
+        if (config.beacon == NULL) {
+            return -ENOENT; // -2 ~ "No such file or directory".
+        }
+        config.channel_index = options->hop ?
+                (uint8_t)((n / 2) % HOP_CHANNEL_COUNT) : options->channel_index;
+        config.antenna_pattern_id = options->antenna_pattern_ids[
+                (n / 2 / options->rotation_reports) %
+                (uint64_t)options->antenna_pattern_count];
+
+        int ret = aod_sim_init(&sim, &config);
+        if (ret != 0) {
+            return ret;
+        }
+
+        struct iq_raw_samples iq_raw_samples;
+        aod_sim_generate(&sim, &rng, (int64_t)(n * REPORT_INTERVAL_MS), &iq_raw_samples);
+        ret = report_list_add(list, &iq_raw_samples);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+// Decode the records of an IQ capture file. Octets that are not records are
+// skipped, as by aod_replay.
+// Returns 0 (0 ~ "Success") if the file is read.
+// Returns a negative error number otherwise.
+static int read_capture(const char *path, struct report_list *list) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        return -err;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return 0; // 0 ~ "Success".
+    }
+
+    size_t size = (size_t)st.st_size;
+    const uint8_t *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -errno;
+    }
+
+    int err = 0;
+    size_t offset = 0;
+    while (offset < size) {
+        struct iq_raw_samples iq_raw_samples;
+        uint16_t sequence;
+        int ret = iq_capture_record_decode(
+                &data[offset],
+                size - offset,
+                &iq_raw_samples,
+                &sequence);
+        if (ret == -EAGAIN) {
+            break;
+        }
+        if (ret < 0) {
+            offset++;
+            continue;
+        }
+        offset += (size_t)ret;
+
+        err = report_list_add(list, &iq_raw_samples);
+        if (err != 0) {
+            break;
+        }
+    }
+
+    munmap((void *)data, size);
+    return err;
+}
+
+static int compare_floats(const void *a, const void *b) {
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Process the reports of a test through the locator pipeline, and summarize
+// the fix errors against the ground truth.
+// Returns 0 (0 ~ "Success") if the reports are processed.
+// Returns -ENOMEM (-12 ~ "Cannot allocate memory") otherwise.
+static int run_test(
+        const struct accuracy_test *test,
+        const struct report_list *list,
+        struct beacon_database *beacon_db,
+        enum locator_mode mode,
+        struct test_result *result) {
+    static struct locator locator;
+    locator_init(&locator, beacon_db);
+    locator_set_mode(&locator, mode, NULL);
+
+    struct locator_position *positions = malloc(
+            (list->count > 0 ? list->count : 1) * sizeof(*positions));
+    if (positions == NULL) {
+        return -ENOMEM; // -12 ~ "Cannot allocate memory".
+    }
+
+    // Only the two stages are timed. Positions are copied from the position
+    // history, a ring buffer, as they are estimated.
+    uint64_t position_count = 0;
+    uint64_t start_ns = monotonic_ns();
+    for (size_t n = 0; n < list->count; n++) {
+        struct iq_data iq_data;
+        if (iq_data_estimate_direction(&iq_data, &list->reports[n]) != 0) {
+            continue;
+        }
+
+        int history_next = locator.history_next;
+        iq_data_update_locator(&iq_data, &locator);
+        if (locator.history_next != history_next &&
+                locator_get_latest_position(&locator, &positions[position_count]) == 0) {
+            position_count++;
+        }
+    }
+    uint64_t elapsed_ns = monotonic_ns() - start_ns;
+
+    float *errors = malloc((position_count > 0 ? position_count : 1) * sizeof(*errors));
+    if (errors == NULL) {
+        free(positions);
+        return -ENOMEM; // -12 ~ "Cannot allocate memory".
+    }
+
+    double sum_x = 0.0;
+    double sum_y = 0.0;
+    double sum_z = 0.0;
+    double sum_error = 0.0;
+    for (uint64_t n = 0; n < position_count; n++) {
+        float dx = positions[n].x - test->x;
+        float dy = positions[n].y - test->y;
+        float dz = positions[n].z - test->z;
+        errors[n] = sqrtf(dx*dx + dy*dy + dz*dz);
+        sum_error += errors[n];
+        sum_x += positions[n].x;
+        sum_y += positions[n].y;
+        sum_z += positions[n].z;
+    }
+
+    result->reports = list->count;
+    result->positions = position_count;
+    result->reports_per_s = elapsed_ns > 0 ?
+            (double)list->count / ((double)elapsed_ns / 1e9) : 0.0;
+
+    if (position_count == 0) {
+        result->mean_error = NAN;
+        result->median_error = NAN;
+        result->p95_error = NAN;
+        result->mean_position_error = NAN;
+    } else {
+        qsort(errors, position_count, sizeof(*errors), compare_floats);
+
+        // Nearest-rank percentiles.
+        uint64_t median_rank = (position_count + 1) / 2;
+        uint64_t p95_rank = (uint64_t)ceil(0.95 * (double)position_count);
+        result->mean_error = (float)(sum_error / (double)position_count);
+        result->median_error = errors[median_rank - 1];
+        result->p95_error = errors[p95_rank - 1];
+
+        float dx = (float)(sum_x / (double)position_count) - test->x;
+        float dy = (float)(sum_y / (double)position_count) - test->y;
+        float dz = (float)(sum_z / (double)position_count) - test->z;
+        result->mean_position_error = sqrtf(dx*dx + dy*dy + dz*dz);
+    }
+
+    free(errors);
+    free(positions);
+    return 0; // 0 ~ "Success".
+}
+
+static void usage(FILE *stream) {
+    fprintf(stream,
+            "Usage: aod_accuracy [options] [FILE...]\n"
+            "Accuracy and throughput of the locator pipeline against the tests of the\n"
+            "Skaarlia tunnel experiment. FILE i is an IQ capture of test i. Without\n"
+            "files, the reports are synthetic.\n"
+            "  -m, --mode MODE       Locator mode: snapshot (default), tracking or robust.\n"
+            "  -n, --count N         Synthetic reports per beacon and test (default 1000).\n"
+            "  -c, --channel N|hop   Channel index, or hop over channels 0-36 (default hop).\n"
+            "  -p, --pattern N[,N...] Antenna pattern ID (default 0). Several IDs are\n"
+            "                        rotated.\n"
+            "      --rotate N        Reports per beacon of each rotated pattern\n"
+            "                        (default 10).\n"
+            "      --snr DB          Signal-to-noise ratio per sample (default 20).\n"
+            "      --cfo HZ          Carrier frequency offset (default 10000).\n"
+            "      --seed N          Random seed (default 1).\n"
+            "  -h, --help            Show this help.\n");
+}
+
+enum {
+    OPTION_SNR = 256,
+    OPTION_CFO,
+    OPTION_SEED,
+    OPTION_ROTATE,
+};
+
+int main(int argc, char **argv) {
+    enum locator_mode mode = LOCATOR_MODE_SNAPSHOT;
+    struct synthetic_options options = {
+        .count = 1000,
+        .hop = true,
+        .channel_index = 18,
+        .antenna_pattern_ids = {0},
+        .antenna_pattern_count = 1,
+        .rotation_reports = 10,
+        .snr_db = 20.0f,
+        .cfo_hz = 10000.0f,
+        .seed = 1,
+    };
+
+    static const struct option long_options[] = {
+        {"mode", required_argument, NULL, 'm'},
+        {"count", required_argument, NULL, 'n'},
+        {"channel", required_argument, NULL, 'c'},
+        {"pattern", required_argument, NULL, 'p'},
+        {"snr", required_argument, NULL, OPTION_SNR},
+        {"cfo", required_argument, NULL, OPTION_CFO},
+        {"seed", required_argument, NULL, OPTION_SEED},
+        {"rotate", required_argument, NULL, OPTION_ROTATE},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:n:c:p:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                if (strcmp(optarg, "snapshot") == 0) {
+                    mode = LOCATOR_MODE_SNAPSHOT;
+                } else if (strcmp(optarg, "tracking") == 0) {
+                    mode = LOCATOR_MODE_TRACKING;
+                } else if (strcmp(optarg, "robust") == 0) {
+                    mode = LOCATOR_MODE_ROBUST;
+                } else {
+                    fprintf(stderr, "aod_accuracy: unknown mode %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'n':
+                options.count = strtoull(optarg, NULL, 0);
+                break;
+            case 'c':
+                if (strcmp(optarg, "hop") == 0) {
+                    options.hop = true;
+                } else {
+                    options.hop = false;
+                    options.channel_index = (uint8_t)atoi(optarg);
+                }
+                break;
+            case 'p': {
+                options.antenna_pattern_count = 0;
+                char *id = optarg;
+                while (options.antenna_pattern_count < ROTATION_MAX) {
+                    char *end;
+                    options.antenna_pattern_ids[options.antenna_pattern_count++] =
+                            (uint8_t)strtoul(id, &end, 10);
+                    if (end == id || (*end != ',' && *end != '\0')) {
+                        fprintf(stderr, "aod_accuracy: invalid pattern %s\n", optarg);
+                        return EXIT_FAILURE;
+                    }
+                    if (*end == '\0') {
+                        break;
+                    }
+                    id = end + 1;
+                }
+                break;
+            }
+            case OPTION_ROTATE:
+                options.rotation_reports = strtoull(optarg, NULL, 0);
+                if (options.rotation_reports == 0) {
+                    fprintf(stderr, "aod_accuracy: invalid rotation %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_SNR:
+                options.snr_db = strtof(optarg, NULL);
+                break;
+            case OPTION_CFO:
+                options.cfo_hz = strtof(optarg, NULL);
+                break;
+            case OPTION_SEED:
+                options.seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'h':
+                usage(stdout);
+                return EXIT_SUCCESS;
+            default:
+                usage(stderr);
+                return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind > TEST_COUNT) {
+        usage(stderr);
+        return EXIT_FAILURE;
+    }
+    bool synthetic = optind == argc;
+    int test_count = synthetic ? TEST_COUNT : argc - optind;
+
+    static struct beacon_database beacon_db;
+    beacon_database_init(&beacon_db);
+    int ret = beacon_deployment_put_all(&beacon_db);
+    if (ret != 0) {
+        fprintf(stderr, "aod_accuracy: beacon deployment failed (err %d)\n", ret);
+        return EXIT_FAILURE;
+    }
+
+    printf("test,source,reports,positions,mean_error_m,median_error_m,p95_error_m,"
+            "mean_position_error_m,reports_per_s\n");
+
+    int status = EXIT_SUCCESS;
+    for (int t = 0; t < test_count; t++) {
+        const struct accuracy_test *test = &accuracy_tests[t];
+        const char *source = synthetic ? "synthetic" : argv[optind + t];
+
+        struct report_list list = {0};
+        if (synthetic) {
+            ret = generate_reports(test, t, &beacon_db, &options, &list);
+            if (ret == -ENOENT) {
+                fprintf(stderr, "aod_accuracy: test %d: the beacons of the test "
+                        "are not in the beacon deployment\n", t + 1);
+            }
+        } else {
+            ret = read_capture(source, &list);
+        }
+        if (ret != 0) {
+            fprintf(stderr, "aod_accuracy: test %d: %s\n", t + 1, strerror(-ret));
+            free(list.reports);
+            status = EXIT_FAILURE;
+            continue;
+        }
+
+        struct test_result result;
+        ret = run_test(test, &list, &beacon_db, mode, &result);
+        free(list.reports);
+        if (ret != 0) {
+            fprintf(stderr, "aod_accuracy: test %d: %s\n", t + 1, strerror(-ret));
+            status = EXIT_FAILURE;
+            continue;
+        }
+
+        printf("%d,%s,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.0f\n",
+                t + 1,
+                source,
+                (unsigned long long)result.reports,
+                (unsigned long long)result.positions,
+                result.mean_error,
+                result.median_error,
+                result.p95_error,
+                result.mean_position_error,
+                result.reports_per_s);
+    }
+
+    return status;
+}
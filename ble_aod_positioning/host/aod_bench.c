@@ -0,0 +1,87 @@
+// Microbenchmark of the DSP stages of the locator core on the host.
+//
+// Runs the DSP benchmark of the benchmark app, see benchmark/src/dsp_bench.h,
+// with the monotonic clock of the host, and prints the mean and minimum
+// nanoseconds per call of each stage, for 2 us and 1 us sample slots.
+// This is also the benchmark for native_sim, where the simulated time does
+// not advance while code runs.
+//
+// Usage: aod_bench [options]
+//   -r, --rounds N   Number of timed batches per stage (default 1000).
+
+#include <getopt.h> // For getopt_long().
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint8_t and uint32_t.
+#include <stdio.h> // For printf() and fprintf().
+#include <stdlib.h> // For strtol() and EXIT_SUCCESS.
+#include <string.h> // For strerror().
+#include <time.h> // For clock_gettime().
+#include "dsp_bench.h" // For dsp_bench_run() and dsp_bench_print().
+#include "iq_data.h" // For IQ_MEASUREMENT_SPACING_2US_SLOTS and IQ_MEASUREMENT_SPACING_1US_SLOTS.
+
+// Monotonic clock in nanoseconds, truncated to 32 bits. A batch takes far
+// less than the wrap period of about 4.3 seconds.
+static uint32_t clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+}
+
+static void usage(FILE *stream) {
+    fprintf(stream,
+            "Usage: aod_bench [options]\n"
+            "  -r, --rounds N   Number of timed batches per stage (default 1000).\n");
+}
+
+int main(int argc, char **argv) {
+    int rounds = 1000;
+
+    static const struct option long_options[] = {
+        {"rounds", required_argument, NULL, 'r'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "r:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'r':
+                rounds = (int)strtol(optarg, NULL, 0);
+                break;
+            case 'h':
+                usage(stdout);
+                return EXIT_SUCCESS;
+            default:
+                usage(stderr);
+                return EXIT_FAILURE;
+        }
+    }
+
+    static const uint8_t spacings[] = {
+        IQ_MEASUREMENT_SPACING_2US_SLOTS,
+        IQ_MEASUREMENT_SPACING_1US_SLOTS,
+    };
+
+    for (size_t s = 0; s < sizeof(spacings) / sizeof(spacings[0]); s++) {
+        struct dsp_bench_config config = {
+            .clock = clock_ns,
+            .unit = "ns",
+            .rounds = rounds,
+            .measurement_spacing = spacings[s],
+        };
+
+        struct dsp_bench_result results[DSP_BENCH_RESULTS_MAX];
+        int count = dsp_bench_run(&config, results, DSP_BENCH_RESULTS_MAX);
+        if (count < 0) {
+            fprintf(stderr, "aod_bench: %s\n", strerror(-count));
+            return EXIT_FAILURE;
+        }
+
+        if (s > 0) {
+            printf("\n");
+        }
+        dsp_bench_print(&config, results, count);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,417 @@
+#include "aod_golden.h"
+#include <errno.h> // For EINVAL (22), ENODATA (61), and EBADMSG (74).
+#include <math.h> // For INFINITY, NAN, M_PI, fabs(), isnan(), and remainder().
+#include <stddef.h> // For NULL ((void *)0) and size_t.
+#include <stdio.h> // For fprintf(), fgets(), feof(), snprintf(), and sscanf().
+#include <stdlib.h> // For strtod(), strtof(), strtol(), strtoul(), and strtoull().
+#include <string.h> // For memset(), strchr(), strcmp(), strcspn(), strlen(), strncmp(), and strrchr().
+
+#define RADIANS_TO_DEGREES (180.0 / M_PI)
+
+// Maximum length of a line of a golden file.
+#define GOLDEN_LINE_MAX 512
+
+// Number of columns of a golden record, before the field values.
+#define GOLDEN_KEY_COLUMNS 6
+
+static const char *const field_names[AOD_GOLDEN_FIELD_COUNT] = {
+    [AOD_GOLDEN_AZIMUTH] = "azimuth",
+    [AOD_GOLDEN_ELEVATION] = "elevation",
+    [AOD_GOLDEN_QUALITY] = "quality",
+    [AOD_GOLDEN_COSINE_X] = "cosine_x",
+    [AOD_GOLDEN_COSINE_Y] = "cosine_y",
+    [AOD_GOLDEN_COSINE_Z] = "cosine_z",
+    [AOD_GOLDEN_X] = "x",
+    [AOD_GOLDEN_Y] = "y",
+    [AOD_GOLDEN_Z] = "z",
+    [AOD_GOLDEN_ERROR_RADIUS] = "error_radius",
+    [AOD_GOLDEN_GDOP] = "gdop",
+};
+
+static const char golden_columns[] =
+        "file,index,sequence,direction_ret,locator_ret,position,"
+        "azimuth,elevation,quality,cosine_x,cosine_y,cosine_z,"
+        "x,y,z,error_radius,gdop";
+
+const char *aod_golden_field_name(enum aod_golden_field field) {
+    if (field < 0 || field >= AOD_GOLDEN_FIELD_COUNT) {
+        return "unknown";
+    }
+    return field_names[field];
+}
+
+// Returns true if the field of the golden record is valid.
+static bool field_valid(
+        const struct aod_golden_record *record,
+        enum aod_golden_field field) {
+    if (field < AOD_GOLDEN_POSITION_FIELDS) {
+        return record->direction_ret == 0;
+    }
+    return record->position;
+}
+
+// Absolute difference of a field, in degrees for the azimuth and the
+// elevation. The azimuth difference is wrapped to [0, 180] degrees.
+static double field_diff(enum aod_golden_field field, float golden, float replayed) {
+    if (isnan(golden) && isnan(replayed)) {
+        return 0.0;
+    }
+    if (isnan(golden) || isnan(replayed)) {
+        return INFINITY;
+    }
+
+    double diff = (double)replayed - (double)golden;
+    if (field == AOD_GOLDEN_AZIMUTH) {
+        diff = remainder(diff, 2.0 * M_PI);
+    }
+    if (field == AOD_GOLDEN_AZIMUTH || field == AOD_GOLDEN_ELEVATION) {
+        diff *= RADIANS_TO_DEGREES;
+    }
+    return fabs(diff);
+}
+
+void aod_golden_record_init(
+        struct aod_golden_record *record,
+        const char *path,
+        uint64_t index,
+        uint16_t sequence,
+        int direction_ret,
+        const struct iq_data *iq_data,
+        int locator_ret,
+        const struct locator_position *position) {
+    memset(record, 0, sizeof(struct aod_golden_record));
+
+    // File name without directories. Commas would split the CSV column.
+    const char *name = strrchr(path, '/');
+    name = name != NULL ? name + 1 : path;
+    snprintf(record->file, sizeof(record->file), "%s", name);
+    for (char *c = record->file; *c != '\0'; c++) {
+        if (*c == ',') {
+            *c = '_';
+        }
+    }
+
+    record->index = index;
+    record->sequence = sequence;
+    record->direction_ret = direction_ret;
+    record->locator_ret = direction_ret == 0 ? locator_ret : 0;
+    record->position = position != NULL;
+
+    for (int f = 0; f < AOD_GOLDEN_FIELD_COUNT; f++) {
+        record->values[f] = NAN;
+    }
+    if (direction_ret == 0 && iq_data != NULL) {
+        record->values[AOD_GOLDEN_AZIMUTH] = iq_data->aod_azimuth;
+        record->values[AOD_GOLDEN_ELEVATION] = iq_data->aod_elevation;
+        record->values[AOD_GOLDEN_QUALITY] = iq_data->aod_quality;
+        record->values[AOD_GOLDEN_COSINE_X] = iq_data->local_direction_cosine_x;
+        record->values[AOD_GOLDEN_COSINE_Y] = iq_data->local_direction_cosine_y;
+        record->values[AOD_GOLDEN_COSINE_Z] = iq_data->local_direction_cosine_z;
+    }
+    if (position != NULL) {
+        record->values[AOD_GOLDEN_X] = position->x;
+        record->values[AOD_GOLDEN_Y] = position->y;
+        record->values[AOD_GOLDEN_Z] = position->z;
+        record->values[AOD_GOLDEN_ERROR_RADIUS] = position->error_radius;
+        record->values[AOD_GOLDEN_GDOP] = position->gdop;
+    }
+}
+
+void aod_golden_write_header(FILE *stream, const char *mode) {
+    fprintf(stream, "# aod_replay golden output, version %d\n", AOD_GOLDEN_VERSION);
+    fprintf(stream, "# mode %s\n", mode);
+    fprintf(stream, "%s\n", golden_columns);
+}
+
+void aod_golden_write(FILE *stream, const struct aod_golden_record *record) {
+    fprintf(stream, "%s,%llu,%u,%d,%d,%d",
+            record->file,
+            (unsigned long long)record->index,
+            record->sequence,
+            record->direction_ret,
+            record->locator_ret,
+            record->position ? 1 : 0);
+    for (int f = 0; f < AOD_GOLDEN_FIELD_COUNT; f++) {
+        if (field_valid(record, (enum aod_golden_field)f)) {
+            // 9 significant digits read back as the same float.
+            fprintf(stream, ",%.9g", (double)record->values[f]);
+        } else {
+            fprintf(stream, ",");
+        }
+    }
+    fprintf(stream, "\n");
+}
+
+// Read a line without the line terminator.
+// Returns 0 on success, -ENODATA at the end of the stream, or -EBADMSG if the
+// line is too long.
+static int read_line(FILE *stream, char *line, size_t size) {
+    if (fgets(line, (int)size, stream) == NULL) {
+        return -ENODATA; // -61 ~ "No data available".
+    }
+    size_t length = strcspn(line, "\r\n");
+    if (line[length] == '\0' && !feof(stream)) {
+        return -EBADMSG; // -74 ~ "Bad message".
+    }
+    line[length] = '\0';
+    return 0; // 0 ~ "Success".
+}
+
+int aod_golden_read_header(FILE *stream, char *mode, size_t mode_size) {
+    char line[GOLDEN_LINE_MAX];
+    int version = -1;
+
+    if (mode_size > 0) {
+        mode[0] = '\0';
+    }
+
+    while (read_line(stream, line, sizeof(line)) == 0) {
+        if (line[0] != '#') {
+            // The column line ends the header.
+            if (version != AOD_GOLDEN_VERSION || strcmp(line, golden_columns) != 0) {
+                return -EBADMSG; // -74 ~ "Bad message".
+            }
+            return 0; // 0 ~ "Success".
+        }
+        if (sscanf(line, "# aod_replay golden output, version %d", &version) == 1) {
+            continue;
+        }
+        if (strncmp(line, "# mode ", 7) == 0 && mode_size > 0) {
+            snprintf(mode, mode_size, "%s", &line[7]);
+        }
+    }
+
+    return -EBADMSG; // -74 ~ "Bad message".
+}
+
+int aod_golden_read(FILE *stream, struct aod_golden_record *record) {
+    char line[GOLDEN_LINE_MAX];
+    int ret = read_line(stream, line, sizeof(line));
+    if (ret != 0) {
+        return ret;
+    }
+
+    // Split the line into columns, in place.
+    char *columns[GOLDEN_KEY_COLUMNS + AOD_GOLDEN_FIELD_COUNT];
+    int count = 0;
+    char *column = line;
+    while (count < GOLDEN_KEY_COLUMNS + AOD_GOLDEN_FIELD_COUNT) {
+        columns[count++] = column;
+        char *comma = strchr(column, ',');
+        if (comma == NULL) {
+            break;
+        }
+        *comma = '\0';
+        column = comma + 1;
+    }
+    if (count != GOLDEN_KEY_COLUMNS + AOD_GOLDEN_FIELD_COUNT) {
+        return -EBADMSG; // -74 ~ "Bad message".
+    }
+
+    memset(record, 0, sizeof(struct aod_golden_record));
+    snprintf(record->file, sizeof(record->file), "%s", columns[0]);
+    record->index = strtoull(columns[1], NULL, 10);
+    record->sequence = (uint16_t)strtoul(columns[2], NULL, 10);
+    record->direction_ret = (int)strtol(columns[3], NULL, 10);
+    record->locator_ret = (int)strtol(columns[4], NULL, 10);
+    record->position = strtol(columns[5], NULL, 10) != 0;
+
+    for (int f = 0; f < AOD_GOLDEN_FIELD_COUNT; f++) {
+        const char *value = columns[GOLDEN_KEY_COLUMNS + f];
+        if (value[0] == '\0') {
+            record->values[f] = NAN;
+            continue;
+        }
+        char *end;
+        record->values[f] = strtof(value, &end);
+        if (*end != '\0') {
+            return -EBADMSG; // -74 ~ "Bad message".
+        }
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+void aod_golden_compare_init(struct aod_golden_compare *compare) {
+    memset(compare, 0, sizeof(struct aod_golden_compare));
+    compare->aligned = true;
+}
+
+int aod_golden_compare_set_tolerance(
+        struct aod_golden_compare *compare,
+        const char *argument) {
+    const char *equals = strchr(argument, '=');
+    if (equals == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    char *end;
+    double tolerance = strtod(equals + 1, &end);
+    if (end == equals + 1 || *end != '\0' || !(tolerance >= 0.0)) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    size_t length = (size_t)(equals - argument);
+    int first = -1;
+    int last = -1;
+    if (length == 3 && strncmp(argument, "all", 3) == 0) {
+        first = 0;
+        last = AOD_GOLDEN_FIELD_COUNT - 1;
+    } else if (length == 5 && strncmp(argument, "angle", 5) == 0) {
+        first = AOD_GOLDEN_AZIMUTH;
+        last = AOD_GOLDEN_ELEVATION;
+    } else if (length == 6 && strncmp(argument, "cosine", 6) == 0) {
+        first = AOD_GOLDEN_COSINE_X;
+        last = AOD_GOLDEN_COSINE_Z;
+    } else if (length == 8 && strncmp(argument, "position", 8) == 0) {
+        first = AOD_GOLDEN_X;
+        last = AOD_GOLDEN_Z;
+    } else {
+        for (int f = 0; f < AOD_GOLDEN_FIELD_COUNT; f++) {
+            if (strlen(field_names[f]) == length &&
+                    strncmp(argument, field_names[f], length) == 0) {
+                first = f;
+                last = f;
+                break;
+            }
+        }
+    }
+    if (first < 0) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    for (int f = first; f <= last; f++) {
+        compare->tolerances[f] = tolerance;
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+void aod_golden_compare_record(
+        struct aod_golden_compare *compare,
+        const struct aod_golden_record *golden,
+        const struct aod_golden_record *replayed,
+        FILE *stream) {
+    if (golden == NULL) {
+        compare->missing_records++;
+        return;
+    }
+    if (!compare->aligned) {
+        return;
+    }
+    if (strcmp(golden->file, replayed->file) != 0 || golden->index != replayed->index) {
+        // The corpus is not the one of the golden file, or not in the same
+        // order. No later record can be matched.
+        fprintf(stream, "aod_golden: %s:%llu replayed, %s:%llu expected, "
+                "comparison stopped\n",
+                replayed->file, (unsigned long long)replayed->index,
+                golden->file, (unsigned long long)golden->index);
+        compare->aligned = false;
+        return;
+    }
+
+    compare->records++;
+
+    if (golden->direction_ret != replayed->direction_ret ||
+            golden->locator_ret != replayed->locator_ret ||
+            golden->position != replayed->position) {
+        compare->status_mismatches++;
+        if (compare->reported < AOD_GOLDEN_REPORT_MAX) {
+            compare->reported++;
+            fprintf(stream, "aod_golden: %s:%llu direction %d/%d, locator %d/%d, "
+                    "position %d/%d (golden/replayed)\n",
+                    golden->file, (unsigned long long)golden->index,
+                    golden->direction_ret, replayed->direction_ret,
+                    golden->locator_ret, replayed->locator_ret,
+                    golden->position, replayed->position);
+        }
+        return;
+    }
+
+    for (int f = 0; f < AOD_GOLDEN_FIELD_COUNT; f++) {
+        if (!field_valid(golden, (enum aod_golden_field)f)) {
+            continue;
+        }
+
+        struct aod_golden_drift *drift = &compare->drift[f];
+        double diff = field_diff(
+                (enum aod_golden_field)f,
+                golden->values[f],
+                replayed->values[f]);
+
+        drift->count++;
+        drift->total_diff += diff;
+        if (diff > 0.0) {
+            drift->differ_count++;
+        }
+        if (diff > drift->max_diff) {
+            drift->max_diff = diff;
+            snprintf(drift->max_file, sizeof(drift->max_file), "%s", golden->file);
+            drift->max_index = golden->index;
+        }
+        if (diff > compare->tolerances[f]) {
+            drift->exceed_count++;
+            if (compare->reported < AOD_GOLDEN_REPORT_MAX) {
+                compare->reported++;
+                fprintf(stream, "aod_golden: %s:%llu %s %.9g/%.9g (golden/replayed), "
+                        "diff %.3g > %.3g\n",
+                        golden->file, (unsigned long long)golden->index,
+                        field_names[f],
+                        (double)golden->values[f],
+                        (double)replayed->values[f],
+                        diff,
+                        compare->tolerances[f]);
+            }
+        }
+    }
+}
+
+bool aod_golden_compare_passed(const struct aod_golden_compare *compare) {
+    if (!compare->aligned || compare->status_mismatches > 0 ||
+            compare->missing_records > 0 || compare->extra_records > 0) {
+        return false;
+    }
+    for (int f = 0; f < AOD_GOLDEN_FIELD_COUNT; f++) {
+        if (compare->drift[f].exceed_count > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void aod_golden_compare_print(
+        const struct aod_golden_compare *compare,
+        FILE *stream) {
+    fprintf(stream,
+            "aod_golden: %llu records compared, %llu status mismatches, "
+            "%llu missing, %llu extra%s\n",
+            (unsigned long long)compare->records,
+            (unsigned long long)compare->status_mismatches,
+            (unsigned long long)compare->missing_records,
+            (unsigned long long)compare->extra_records,
+            compare->aligned ? "" : ", not aligned");
+
+    for (int f = 0; f < AOD_GOLDEN_FIELD_COUNT; f++) {
+        const struct aod_golden_drift *drift = &compare->drift[f];
+        double mean_diff = drift->count > 0 ?
+                drift->total_diff / (double)drift->count : 0.0;
+        fprintf(stream, "  %-12s n=%llu differ=%llu exceed=%llu "
+                "mean=%.3g max=%.3g tol=%.3g",
+                field_names[f],
+                (unsigned long long)drift->count,
+                (unsigned long long)drift->differ_count,
+                (unsigned long long)drift->exceed_count,
+                mean_diff,
+                drift->max_diff,
+                compare->tolerances[f]);
+        if (drift->max_diff > 0.0) {
+            fprintf(stream, " at %s:%llu",
+                    drift->max_file,
+                    (unsigned long long)drift->max_index);
+        }
+        fprintf(stream, "\n");
+    }
+
+    fprintf(stream, "aod_golden: %s\n",
+            aod_golden_compare_passed(compare) ? "PASS" : "FAIL");
+}
@@ -0,0 +1,196 @@
+#ifndef AOD_GOLDEN_H
+#define AOD_GOLDEN_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For uint16_t and uint64_t.
+#include <stdio.h> // For FILE.
+#include "iq_data.h" // For IQ data structure.
+#include "locator.h" // For locator position structure.
+
+// Golden output of the replay of a corpus of IQ captures, see aod_replay.c.
+//
+// A golden file holds the reference result of each record of each capture of
+// the corpus: the return values of iq_data_estimate_direction() and
+// iq_data_update_locator(), the estimated angles and local direction cosines,
+// and the new position, if the record gave one. A golden file is written by a
+// reference build, and the replay of an optimized build is compared with it,
+// field by field, with a tolerance per field.
+//
+// The golden file is CSV text. Values are written with 9 significant digits,
+// which is enough to read back the exact float, so a comparison with zero
+// tolerance is bit exact. Fields that the record did not give, such as the
+// position of a record that gave no position, are empty. The first lines are
+// comments with the format version and the locator mode.
+//
+// Records are matched by the file name of the capture, without directories,
+// and the index of the record in the capture, so the corpus must be replayed
+// in the same order as when the golden file was written.
+
+// Golden file format version.
+#define AOD_GOLDEN_VERSION 1
+
+// Maximum length of the file name of a capture, including the terminating
+// null character. Longer names are truncated.
+#define AOD_GOLDEN_FILE_MAX 64
+
+// Maximum number of differences printed by the aod_golden_compare_record()
+// function. Later differences are only counted.
+#define AOD_GOLDEN_REPORT_MAX 10
+
+// Compared fields of a golden record.
+enum aod_golden_field {
+    // Azimuth and elevation, in radians. Compared in degrees.
+    AOD_GOLDEN_AZIMUTH,
+    AOD_GOLDEN_ELEVATION,
+    // Quality of the estimated direction, 0 to 1.
+    AOD_GOLDEN_QUALITY,
+    // Local direction cosines.
+    AOD_GOLDEN_COSINE_X,
+    AOD_GOLDEN_COSINE_Y,
+    AOD_GOLDEN_COSINE_Z,
+    // Position, in meters.
+    AOD_GOLDEN_X,
+    AOD_GOLDEN_Y,
+    AOD_GOLDEN_Z,
+    AOD_GOLDEN_ERROR_RADIUS,
+    AOD_GOLDEN_GDOP,
+    AOD_GOLDEN_FIELD_COUNT,
+};
+
+// First position field. Fields before it are direction fields.
+#define AOD_GOLDEN_POSITION_FIELDS AOD_GOLDEN_X
+
+// Golden record structure, the result of one IQ capture record.
+struct aod_golden_record {
+    // File name of the capture, without directories.
+    char file[AOD_GOLDEN_FILE_MAX];
+
+    // Index of the record in the capture, from 0, and its sequence number.
+    uint64_t index;
+    uint16_t sequence;
+
+    // Return values of iq_data_estimate_direction() and
+    // iq_data_update_locator(). The locator return value is 0 if there was no
+    // direction.
+    int direction_ret;
+    int locator_ret;
+
+    // True if the record gave a new position.
+    bool position;
+
+    // Field values. Direction fields are valid if direction_ret is 0, and
+    // position fields are valid if position is true.
+    float values[AOD_GOLDEN_FIELD_COUNT];
+};
+
+// Per-field drift structure.
+struct aod_golden_drift {
+    // Number of compared values.
+    uint64_t count;
+
+    // Number of values that differ, and that differ by more than the
+    // tolerance.
+    uint64_t differ_count;
+    uint64_t exceed_count;
+
+    // Sum and maximum of the absolute differences.
+    double total_diff;
+    double max_diff;
+
+    // Record of the maximum difference.
+    char max_file[AOD_GOLDEN_FILE_MAX];
+    uint64_t max_index;
+};
+
+// Golden comparison structure.
+// See the aod_golden_compare_init() function.
+struct aod_golden_compare {
+    // Tolerance of each field, the largest accepted absolute difference. In
+    // degrees for the azimuth and the elevation. 0 for bit exact comparison.
+    double tolerances[AOD_GOLDEN_FIELD_COUNT];
+
+    // Number of compared records.
+    uint64_t records;
+
+    // Number of records where the return values differ, or where only one of
+    // the results has a position. The fields of such records are not compared.
+    uint64_t status_mismatches;
+
+    // Number of replayed records without a golden record, and golden records
+    // that were not replayed.
+    uint64_t missing_records;
+    uint64_t extra_records;
+
+    // False once a replayed record does not match the file name and index of
+    // the golden record, after which records are no longer compared.
+    bool aligned;
+
+    // Number of printed differences.
+    int reported;
+
+    struct aod_golden_drift drift[AOD_GOLDEN_FIELD_COUNT];
+};
+
+// Name of a field, as in the header of a golden file and in tolerances.
+const char *aod_golden_field_name(enum aod_golden_field field);
+
+// Initialize a golden record with the result of a record.
+// path is the path of the capture, and index is the index of the record in the
+// capture. iq_data is the result of iq_data_estimate_direction(), and position
+// is the new position of the record, or NULL if the record gave no position.
+void aod_golden_record_init(
+        struct aod_golden_record *record,
+        const char *path,
+        uint64_t index,
+        uint16_t sequence,
+        int direction_ret,
+        const struct iq_data *iq_data,
+        int locator_ret,
+        const struct locator_position *position);
+
+// Write the header of a golden file, with the locator mode name.
+void aod_golden_write_header(FILE *stream, const char *mode);
+
+// Write a golden record.
+void aod_golden_write(FILE *stream, const struct aod_golden_record *record);
+
+// Read the header of a golden file. The locator mode name is copied to mode,
+// of size mode_size.
+// Returns 0 on success, or -EBADMSG if the stream is not a golden file of this
+// version.
+int aod_golden_read_header(FILE *stream, char *mode, size_t mode_size);
+
+// Read the next golden record.
+// Returns 0 on success, -ENODATA at the end of the stream, or -EBADMSG if the
+// line is not a golden record.
+int aod_golden_read(FILE *stream, struct aod_golden_record *record);
+
+// Initialize a golden comparison, with zero tolerances.
+void aod_golden_compare_init(struct aod_golden_compare *compare);
+
+// Set a tolerance from a FIELD=VALUE argument. FIELD is a field name, "angle"
+// for the azimuth and the elevation, "cosine" for the direction cosines,
+// "position" for x, y and z, or "all".
+// Returns 0 on success, or -EINVAL if the argument is not valid.
+int aod_golden_compare_set_tolerance(
+        struct aod_golden_compare *compare,
+        const char *argument);
+
+// Compare the result of a replayed record with its golden record. Differences
+// beyond the tolerances are printed to stream, up to AOD_GOLDEN_REPORT_MAX.
+void aod_golden_compare_record(
+        struct aod_golden_compare *compare,
+        const struct aod_golden_record *golden,
+        const struct aod_golden_record *replayed,
+        FILE *stream);
+
+// Returns true if all records were compared, without status mismatches, and
+// without differences beyond the tolerances.
+bool aod_golden_compare_passed(const struct aod_golden_compare *compare);
+
+// Print the summary of the drift of each field.
+void aod_golden_compare_print(
+        const struct aod_golden_compare *compare,
+        FILE *stream);
+
+#endif // AOD_GOLDEN_H
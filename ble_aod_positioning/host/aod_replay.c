@@ -0,0 +1,561 @@
+// Offline replay of IQ captures through the locator pipeline.
+//
+// Each IQ capture record is decoded and processed by the same two stages as
+// on the locator, iq_data_estimate_direction() and iq_data_update_locator(),
+// with the same beacon database, see beacon_deployment.c. One CSV row is
+// written per record, with the estimated angles, the latest position if the
+// record gave a new position, and the time spent in each stage. A summary of
+// the stage timings is written to stderr.
+//
+// Capture files are memory-mapped, so long captures are replayed at disk
+// speed. By default records are replayed as fast as possible. In real-time
+// mode, records are paced by their report timestamps.
+//
+// Each file is replayed with a newly initialized locator, since the report
+// timestamps of a capture start at the boot of the locator.
+//
+// The results of a corpus of captures can be written to a golden file by a
+// reference build, and the replay of another build compared with it, with a
+// tolerance per field and a summary of the drift, see aod_golden.h. The exit
+// status is nonzero if the comparison fails.
+//
+// Usage: aod_replay [options] FILE...
+//   -m, --mode MODE          Locator mode: snapshot (default), tracking or
+//                            robust.
+//   -r, --realtime           Pace records by their report timestamps.
+//   -s, --speed X            Real-time speed factor, implies --realtime.
+//   -q, --quiet              Write only the summary.
+//   -w, --golden-write FILE  Write the results to a golden file.
+//   -g, --golden-check FILE  Compare the results with a golden file.
+//   -t, --tolerance F=X      Tolerance of field F for --golden-check, see
+//                            aod_golden_compare_set_tolerance(). May be given
+//                            several times. Default 0, bit exact.
+
+#include <errno.h> // For EAGAIN (11), ENODATA (61), EBADMSG (74), and ENOTSUP (134).
+#include <fcntl.h> // For open().
+#include <getopt.h> // For getopt_long().
+#include <math.h> // For M_PI.
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0) and size_t.
+#include <stdint.h> // For uint8_t, uint16_t, uint64_t, and int64_t.
+#include <stdio.h> // For printf(), fprintf(), fopen(), and fclose().
+#include <stdlib.h> // For strtod() and EXIT_SUCCESS.
+#include <string.h> // For strcmp() and strerror().
+#include <sys/mman.h> // For mmap(), madvise(), and munmap().
+#include <sys/stat.h> // For fstat().
+#include <time.h> // For clock_gettime() and clock_nanosleep().
+#include <unistd.h> // For close().
+#include "aod_golden.h" // For golden record structure, golden comparison structure, and aod_golden_*() functions.
+#include "beacon_database.h" // For beacon database structure.
+#include "beacon_deployment.h" // For beacon_deployment_put_all().
+#include "iq_capture.h" // For iq_capture_record_decode().
+#include "iq_data.h" // For IQ data structure and IQ data processing stages.
+#include "locator.h" // For locator structure.
+
+#define RADIANS_TO_DEGREES (180.0f / (float)M_PI)
+
+// Replay options.
+struct replay_options {
+    enum locator_mode mode;
+    bool realtime;
+    double speed;
+    bool quiet;
+
+    // Golden file to write, or NULL.
+    FILE *golden_write;
+
+    // Golden file to compare with, or NULL, and the comparison.
+    FILE *golden_check;
+    struct aod_golden_compare *golden_compare;
+};
+
+// Timing of a processing stage, in nanoseconds.
+struct stage_timing {
+    const char *name;
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+// Replay statistics, over all files.
+struct replay_stats {
+    uint64_t records;
+    uint64_t sequence_gaps;
+    uint64_t skipped_octets;
+    uint64_t unsupported_records;
+    uint64_t directions;
+    uint64_t positions;
+    struct stage_timing decode;
+    struct stage_timing direction;
+    struct stage_timing locator;
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t deadline_ns) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline_ns / 1000000000u),
+        .tv_nsec = (long)(deadline_ns % 1000000000u),
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static void stage_timing_add(struct stage_timing *timing, uint64_t ns) {
+    timing->count++;
+    timing->total_ns += ns;
+    if (ns > timing->max_ns) {
+        timing->max_ns = ns;
+    }
+}
+
+static void stage_timing_print(const struct stage_timing *timing) {
+    double mean_us = timing->count > 0 ?
+            (double)timing->total_ns / (double)timing->count / 1000.0 : 0.0;
+    fprintf(stderr, "  %-9s n=%llu mean=%.2f us max=%.2f us total=%.3f s\n",
+            timing->name,
+            (unsigned long long)timing->count,
+            mean_us,
+            (double)timing->max_ns / 1000.0,
+            (double)timing->total_ns / 1e9);
+}
+
+// Compare the result of a record with the next record of the golden file.
+static void golden_check_record(
+        const struct replay_options *options,
+        const struct aod_golden_record *record) {
+    struct aod_golden_record golden;
+    int ret = aod_golden_read(options->golden_check, &golden);
+    if (ret == -EBADMSG) {
+        fprintf(stderr, "aod_replay: golden file record %llu is not valid\n",
+                (unsigned long long)(options->golden_compare->records + 1));
+    }
+    aod_golden_compare_record(
+            options->golden_compare,
+            ret == 0 ? &golden : NULL,
+            record,
+            stderr);
+}
+
+// Count the golden records that were not replayed.
+static void golden_check_end(const struct replay_options *options) {
+    struct aod_golden_record golden;
+    int ret;
+    while ((ret = aod_golden_read(options->golden_check, &golden)) != -ENODATA) {
+        options->golden_compare->extra_records++;
+    }
+}
+
+static const char *mode_name(enum locator_mode mode) {
+    switch (mode) {
+        case LOCATOR_MODE_TRACKING:
+            return "tracking";
+        case LOCATOR_MODE_ROBUST:
+            return "robust";
+        default:
+            return "snapshot";
+    }
+}
+
+static void print_header(void) {
+    printf("file,sequence,timestamp_ms,beacon_mac,channel_index,rssi_dbm,"
+            "packet_status,antenna_pattern_id,sample_count,direction_ret,"
+            "azimuth_deg,elevation_deg,quality,locator_ret,"
+            "x,y,z,error_radius,gdop,"
+            "decode_us,direction_us,locator_us\n");
+}
+
+// Replay one memory-mapped capture file.
+static void replay_buffer(
+        const char *path,
+        const uint8_t *data,
+        size_t size,
+        const struct replay_options *options,
+        struct beacon_database *beacon_db,
+        struct replay_stats *stats) {
+    static struct locator locator;
+    locator_init(&locator, beacon_db);
+    locator_set_mode(&locator, options->mode, NULL);
+
+    bool first_record = true;
+    uint16_t next_sequence = 0;
+    int64_t first_timestamp = 0;
+    uint64_t start_ns = 0;
+    uint64_t record_index = 0;
+
+    size_t offset = 0;
+    while (offset < size) {
+        struct iq_raw_samples iq_raw_samples;
+        uint16_t sequence;
+
+        uint64_t t0 = monotonic_ns();
+        int ret = iq_capture_record_decode(
+                &data[offset],
+                size - offset,
+                &iq_raw_samples,
+                &sequence);
+        uint64_t t1 = monotonic_ns();
+
+        if (ret == -EAGAIN) {
+            // Truncated record at the end of the file.
+            stats->skipped_octets += size - offset;
+            break;
+        }
+        if (ret < 0) {
+            // Not a record, or a record of another format version. Skip one
+            // octet and look for the next sync octets.
+            if (ret == -ENOTSUP) {
+                stats->unsupported_records++;
+            }
+            stats->skipped_octets++;
+            offset++;
+            continue;
+        }
+        offset += (size_t)ret;
+        stats->records++;
+        stage_timing_add(&stats->decode, t1 - t0);
+
+        if (!first_record && sequence != next_sequence) {
+            stats->sequence_gaps++;
+        }
+        next_sequence = (uint16_t)(sequence + 1);
+
+        if (options->realtime) {
+            if (first_record) {
+                first_timestamp = iq_raw_samples.report_timestamp;
+                start_ns = monotonic_ns();
+            }
+            double elapsed_ms = (double)(iq_raw_samples.report_timestamp -
+                    first_timestamp) / options->speed;
+            if (elapsed_ms > 0.0) {
+                sleep_until_ns(start_ns + (uint64_t)(elapsed_ms * 1e6));
+            }
+        }
+        first_record = false;
+
+        // The two stages of iq_data_process_locator(), timed separately.
+        struct iq_data iq_data;
+        uint64_t t2 = monotonic_ns();
+        int direction_ret = iq_data_estimate_direction(&iq_data, &iq_raw_samples);
+        uint64_t t3 = monotonic_ns();
+        stage_timing_add(&stats->direction, t3 - t2);
+
+        int locator_ret = 0;
+        bool new_position = false;
+        uint64_t locator_ns = 0;
+        if (direction_ret == 0) {
+            stats->directions++;
+            int history_next = locator.history_next;
+            uint64_t t4 = monotonic_ns();
+            locator_ret = iq_data_update_locator(&iq_data, &locator);
+            uint64_t t5 = monotonic_ns();
+            locator_ns = t5 - t4;
+            stage_timing_add(&stats->locator, locator_ns);
+            new_position = locator.history_next != history_next;
+        }
+
+        struct locator_position position;
+        if (new_position && locator_get_latest_position(&locator, &position) == 0) {
+            stats->positions++;
+        } else {
+            new_position = false;
+        }
+
+        if (options->golden_write != NULL || options->golden_check != NULL) {
+            struct aod_golden_record record;
+            aod_golden_record_init(
+                    &record,
+                    path,
+                    record_index,
+                    sequence,
+                    direction_ret,
+                    &iq_data,
+                    locator_ret,
+                    new_position ? &position : NULL);
+            if (options->golden_write != NULL) {
+                aod_golden_write(options->golden_write, &record);
+            }
+            if (options->golden_check != NULL) {
+                golden_check_record(options, &record);
+            }
+        }
+        record_index++;
+
+        if (options->quiet) {
+            continue;
+        }
+
+        const uint8_t *mac = iq_raw_samples.beacon_mac;
+        printf("%s,%u,%lld,%02X:%02X:%02X:%02X:%02X:%02X,%u,%.1f,%u,%u,%u,%d,",
+                path,
+                sequence,
+                (long long)iq_raw_samples.report_timestamp,
+                mac[5], mac[4], mac[3], mac[2], mac[1], mac[0],
+                iq_raw_samples.channel_index,
+                iq_raw_samples.rssi / 10.0,
+                iq_raw_samples.packet_status,
+                iq_raw_samples.antenna_pattern_id,
+                iq_raw_samples.sample_count,
+                direction_ret);
+        if (direction_ret == 0) {
+            printf("%.2f,%.2f,%.3f,%d,",
+                    iq_data.aod_azimuth * RADIANS_TO_DEGREES,
+                    iq_data.aod_elevation * RADIANS_TO_DEGREES,
+                    iq_data.aod_quality,
+                    locator_ret);
+        } else {
+            printf(",,,,");
+        }
+        if (new_position) {
+            printf("%.3f,%.3f,%.3f,%.3f,%.3f,",
+                    position.x, position.y, position.z,
+                    position.error_radius, position.gdop);
+        } else {
+            printf(",,,,,");
+        }
+        printf("%.2f,%.2f,", (double)(t1 - t0) / 1000.0, (double)(t3 - t2) / 1000.0);
+        if (direction_ret == 0) {
+            printf("%.2f\n", (double)locator_ns / 1000.0);
+        } else {
+            printf("\n");
+        }
+    }
+}
+
+// Memory-map and replay one capture file.
+// Returns 0 on success, or -1 if the file could not be mapped.
+static int replay_file(
+        const char *path,
+        const struct replay_options *options,
+        struct beacon_database *beacon_db,
+        struct replay_stats *stats) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "aod_replay: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "aod_replay: %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "aod_replay: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    // The file is read once, front to back.
+    (void)madvise(data, size, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+    replay_buffer(path, data, size, options, beacon_db, stats);
+
+    munmap(data, size);
+    return 0;
+}
+
+static void usage(FILE *stream) {
+    fprintf(stream,
+            "Usage: aod_replay [options] FILE...\n"
+            "Replay IQ capture files through the locator pipeline.\n"
+            "  -m, --mode MODE          Locator mode: snapshot (default), tracking or\n"
+            "                           robust.\n"
+            "  -r, --realtime           Pace records by their report timestamps.\n"
+            "  -s, --speed X            Real-time speed factor, implies --realtime.\n"
+            "  -q, --quiet              Write only the summary.\n"
+            "  -w, --golden-write FILE  Write the results to a golden file.\n"
+            "  -g, --golden-check FILE  Compare the results with a golden file.\n"
+            "  -t, --tolerance F=X      Tolerance of field F for --golden-check, in\n"
+            "                           degrees for angles and meters for positions.\n"
+            "                           F is a field of the golden file, angle, cosine,\n"
+            "                           position or all. Default 0, bit exact.\n"
+            "  -h, --help               Show this help.\n");
+}
+
+int main(int argc, char **argv) {
+    struct replay_options options = {
+        .mode = LOCATOR_MODE_SNAPSHOT,
+        .realtime = false,
+        .speed = 1.0,
+        .quiet = false,
+        .golden_write = NULL,
+        .golden_check = NULL,
+        .golden_compare = NULL,
+    };
+    const char *golden_write_path = NULL;
+    const char *golden_check_path = NULL;
+    static struct aod_golden_compare golden_compare;
+    aod_golden_compare_init(&golden_compare);
+
+    static const struct option long_options[] = {
+        {"mode", required_argument, NULL, 'm'},
+        {"realtime", no_argument, NULL, 'r'},
+        {"speed", required_argument, NULL, 's'},
+        {"quiet", no_argument, NULL, 'q'},
+        {"golden-write", required_argument, NULL, 'w'},
+        {"golden-check", required_argument, NULL, 'g'},
+        {"tolerance", required_argument, NULL, 't'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:rs:qw:g:t:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                if (strcmp(optarg, "snapshot") == 0) {
+                    options.mode = LOCATOR_MODE_SNAPSHOT;
+                } else if (strcmp(optarg, "tracking") == 0) {
+                    options.mode = LOCATOR_MODE_TRACKING;
+                } else if (strcmp(optarg, "robust") == 0) {
+                    options.mode = LOCATOR_MODE_ROBUST;
+                } else {
+                    fprintf(stderr, "aod_replay: unknown mode %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'r':
+                options.realtime = true;
+                break;
+            case 's':
+                options.speed = strtod(optarg, NULL);
+                if (!(options.speed > 0.0)) {
+                    fprintf(stderr, "aod_replay: invalid speed %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                options.realtime = true;
+                break;
+            case 'q':
+                options.quiet = true;
+                break;
+            case 'w':
+                golden_write_path = optarg;
+                break;
+            case 'g':
+                golden_check_path = optarg;
+                break;
+            case 't':
+                if (aod_golden_compare_set_tolerance(&golden_compare, optarg) != 0) {
+                    fprintf(stderr, "aod_replay: invalid tolerance %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'h':
+                usage(stdout);
+                return EXIT_SUCCESS;
+            default:
+                usage(stderr);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc) {
+        usage(stderr);
+        return EXIT_FAILURE;
+    }
+
+    static struct beacon_database beacon_db;
+    beacon_database_init(&beacon_db);
+    int ret = beacon_deployment_put_all(&beacon_db);
+    if (ret != 0) {
+        fprintf(stderr, "aod_replay: beacon deployment failed (err %d)\n", ret);
+        return EXIT_FAILURE;
+    }
+
+    if (golden_write_path != NULL) {
+        options.golden_write = fopen(golden_write_path, "w");
+        if (options.golden_write == NULL) {
+            fprintf(stderr, "aod_replay: %s: %s\n", golden_write_path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        aod_golden_write_header(options.golden_write, mode_name(options.mode));
+    }
+
+    if (golden_check_path != NULL) {
+        options.golden_check = fopen(golden_check_path, "r");
+        if (options.golden_check == NULL) {
+            fprintf(stderr, "aod_replay: %s: %s\n", golden_check_path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        char golden_mode[16];
+        if (aod_golden_read_header(options.golden_check, golden_mode, sizeof(golden_mode)) != 0) {
+            fprintf(stderr, "aod_replay: %s is not a golden file of version %d\n",
+                    golden_check_path, AOD_GOLDEN_VERSION);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(golden_mode, mode_name(options.mode)) != 0) {
+            fprintf(stderr, "aod_replay: %s is of mode %s, not %s\n",
+                    golden_check_path, golden_mode, mode_name(options.mode));
+            return EXIT_FAILURE;
+        }
+        options.golden_compare = &golden_compare;
+    }
+
+    struct replay_stats stats = {
+        .decode = {.name = "decode"},
+        .direction = {.name = "direction"},
+        .locator = {.name = "locator"},
+    };
+
+    if (!options.quiet) {
+        print_header();
+    }
+
+    int status = EXIT_SUCCESS;
+    uint64_t start_ns = monotonic_ns();
+    for (int n = optind; n < argc; n++) {
+        if (replay_file(argv[n], &options, &beacon_db, &stats) != 0) {
+            status = EXIT_FAILURE;
+        }
+    }
+    double elapsed_s = (double)(monotonic_ns() - start_ns) / 1e9;
+
+    fflush(stdout);
+    fprintf(stderr,
+            "aod_replay: %llu records, %llu directions, %llu positions in %.3f s "
+            "(%.0f records/s)\n",
+            (unsigned long long)stats.records,
+            (unsigned long long)stats.directions,
+            (unsigned long long)stats.positions,
+            elapsed_s,
+            elapsed_s > 0.0 ? (double)stats.records / elapsed_s : 0.0);
+    fprintf(stderr,
+            "aod_replay: %llu sequence gaps, %llu octets skipped, "
+            "%llu records of unsupported version\n",
+            (unsigned long long)stats.sequence_gaps,
+            (unsigned long long)stats.skipped_octets,
+            (unsigned long long)stats.unsupported_records);
+    stage_timing_print(&stats.decode);
+    stage_timing_print(&stats.direction);
+    stage_timing_print(&stats.locator);
+
+    if (options.golden_write != NULL) {
+        if (fclose(options.golden_write) != 0) {
+            fprintf(stderr, "aod_replay: %s: %s\n", golden_write_path, strerror(errno));
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (options.golden_check != NULL) {
+        golden_check_end(&options);
+        fclose(options.golden_check);
+        aod_golden_compare_print(&golden_compare, stderr);
+        if (!aod_golden_compare_passed(&golden_compare)) {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    return status;
+}
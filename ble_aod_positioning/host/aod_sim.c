@@ -0,0 +1,241 @@
+#include "aod_sim.h"
+#include <errno.h> // For EDOM (33) and EINVAL (22).
+#include <math.h> // For cosf(), sinf(), sqrtf(), logf(), powf(), and M_PI.
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint8_t, int8_t, uint64_t, and int64_t.
+#include <string.h> // For memset().
+#include "beacon.h" // For beacon structure.
+#include "ble_channel_constants.h" // For ble_channel_wavenumbers[].
+#include "chw1010_ant2_specs.h" // For antenna_positions_xyz[] and the antenna switching patterns.
+#include "iq_data.h" // For raw IQ samples structure and iq_raw_samples_init_interleaved().
+
+#define SAMPLE_COUNT_MAX (IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX)
+
+// Phase advance of the baseband in the reference period, in radians per
+// microsecond. See the iq_data_temp_fix_ref_samples() function.
+#define BASEBAND_RAD_PER_US ((float)M_PI)
+
+// Guard period and reference period of a CTE, in microseconds.
+#define CTE_GUARD_US 4
+#define CTE_REFERENCE_US 8
+
+int aod_sim_sample_count(uint8_t cte_length, uint8_t measurement_spacing) {
+    if (cte_length < 2 || cte_length > 20) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+    if (measurement_spacing != IQ_MEASUREMENT_SPACING_1US_SLOTS &&
+            measurement_spacing != IQ_MEASUREMENT_SPACING_2US_SLOTS) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // A switch slot and a sample slot per measurement sample.
+    int slots_us = 8 * cte_length - CTE_GUARD_US - CTE_REFERENCE_US;
+    return IQ_REFERENCE_MAX + slots_us / measurement_spacing;
+}
+
+void aod_sim_config_default(struct aod_sim_config *config) {
+    memset(config, 0, sizeof(*config));
+    config->channel_index = 18;
+    config->antenna_pattern_id = CHW1010_ANT2_PATTERN_ALL;
+    config->measurement_spacing = IQ_MEASUREMENT_SPACING_2US_SLOTS;
+    config->sample_count = (uint8_t)aod_sim_sample_count(
+            20,
+            IQ_MEASUREMENT_SPACING_2US_SLOTS);
+    config->snr_db = INFINITY;
+    config->amplitude = AOD_SIM_DEFAULT_AMPLITUDE;
+}
+
+int aod_sim_init(struct aod_sim *sim, const struct aod_sim_config *config) {
+    if (sim == NULL || config == NULL || config->beacon == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+    if (config->channel_index >= 40 ||
+            config->antenna_pattern_id >= CHW1010_ANT2_PATTERN_COUNT ||
+            (config->measurement_spacing != IQ_MEASUREMENT_SPACING_1US_SLOTS &&
+             config->measurement_spacing != IQ_MEASUREMENT_SPACING_2US_SLOTS) ||
+            config->sample_count <= IQ_REFERENCE_MAX ||
+            config->sample_count > SAMPLE_COUNT_MAX ||
+            config->ray_count < 0 ||
+            config->ray_count > AOD_SIM_RAYS_MAX) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    memset(sim, 0, sizeof(*sim));
+    sim->config = *config;
+
+    // Global direction from the beacon toward the locator.
+    const struct beacon *beacon = config->beacon;
+    float dx = config->locator_x - beacon->x;
+    float dy = config->locator_y - beacon->y;
+    float dz = config->locator_z - beacon->z;
+    float distance = sqrtf(dx*dx + dy*dy + dz*dz);
+    if (!(distance > 0.0f)) {
+        return -EDOM; // -33 ~ "Numerical argument out of domain".
+    }
+    dx /= distance;
+    dy /= distance;
+    dz /= distance;
+
+    // Local direction cosines. R transforms local to global, so the transpose
+    // of R transforms global to local, a projection on each local axis.
+    float ux = beacon->i_x*dx + beacon->i_y*dy + beacon->i_z*dz;
+    float uy = beacon->j_x*dx + beacon->j_y*dy + beacon->j_z*dz;
+    float uz = beacon->k_x*dx + beacon->k_y*dy + beacon->k_z*dz;
+    if (!(uz > 0.0f)) {
+        return -EDOM; // -33 ~ "Numerical argument out of domain".
+    }
+
+    sim->local_direction_cosine_x = ux;
+    sim->local_direction_cosine_y = uy;
+    sim->local_direction_cosine_z = uz;
+    sim->azimuth = atan2f(ux, uz);
+    sim->elevation = asinf(uy);
+    sim->distance = distance;
+
+    // Free-space path loss at 2.4 GHz, 20 log10(d) + 40.05 dB at d meters.
+    float rssi_dbm = config->tx_power_dbm - (20.0f * log10f(distance) + 40.05f);
+    sim->rssi = (int16_t)lrintf(rssi_dbm * 10.0f);
+
+    // Sum of the direct ray and the multipath rays at each antenna.
+    float k = ble_channel_wavenumbers[config->channel_index];
+    for (int a = 0; a < 16; a++) {
+        const float *p = antenna_positions_xyz[a];
+
+        float phase = k * (p[0]*ux + p[1]*uy + p[2]*uz);
+        float re = config->amplitude * cosf(phase);
+        float im = config->amplitude * sinf(phase);
+
+        for (int r = 0; r < config->ray_count; r++) {
+            const struct aod_sim_ray *ray = &config->rays[r];
+            float rx = cosf(ray->elevation) * sinf(ray->azimuth);
+            float ry = sinf(ray->elevation);
+            float rz = cosf(ray->elevation) * cosf(ray->azimuth);
+            float ray_phase = k * (p[0]*rx + p[1]*ry + p[2]*rz) + ray->phase;
+            re += config->amplitude * ray->amplitude * cosf(ray_phase);
+            im += config->amplitude * ray->amplitude * sinf(ray_phase);
+        }
+
+        sim->antenna_gain_re[a] = re;
+        sim->antenna_gain_im[a] = im;
+    }
+
+    // Antenna and time of each sample. The reference samples are taken each
+    // microsecond from the first antenna ID, and the measurement samples at
+    // the end of each sample slot, after the switch slot.
+    const struct chw1010_ant2_switching_pattern *pattern =
+            &chw1010_ant2_switching_patterns[config->antenna_pattern_id];
+    for (int n = 0; n < config->sample_count; n++) {
+        if (n < IQ_REFERENCE_MAX) {
+            sim->sample_antenna[n] = pattern->ant_ids[0];
+            sim->sample_time_us[n] = (float)n;
+        } else {
+            int m = n - IQ_REFERENCE_MAX;
+            sim->sample_antenna[n] =
+                    (uint8_t)chw1010_ant2_measurement_antenna(
+                            config->antenna_pattern_id,
+                            m);
+            sim->sample_time_us[n] = (float)(IQ_REFERENCE_MAX +
+                    (m + 1) * config->measurement_spacing - 1);
+        }
+    }
+
+    // Noise per I and Q component, for the SNR of the direct ray.
+    if (isinf(config->snr_db) && config->snr_db > 0.0f) {
+        sim->noise_sigma = 0.0f;
+    } else {
+        float snr = powf(10.0f, config->snr_db / 10.0f);
+        sim->noise_sigma = config->amplitude / sqrtf(2.0f * snr);
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+void aod_sim_rng_seed(struct aod_sim_rng *rng, uint64_t seed) {
+    // splitmix64, so that nearby seeds give unrelated states.
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+    // xorshift64* must not have a zero state.
+    rng->state = z != 0 ? z : 1;
+}
+
+static uint64_t rng_next(struct aod_sim_rng *rng) {
+    uint64_t x = rng->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng->state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+// Uniform in (0, 1].
+static float rng_uniform(struct aod_sim_rng *rng) {
+    return (float)((rng_next(rng) >> 40) + 1) * (1.0f / 16777216.0f);
+}
+
+// Pair of independent standard normal values, Box-Muller transform.
+static void rng_normal_pair(struct aod_sim_rng *rng, float *n1, float *n2) {
+    float radius = sqrtf(-2.0f * logf(rng_uniform(rng)));
+    float angle = 2.0f * (float)M_PI * rng_uniform(rng);
+    *n1 = radius * cosf(angle);
+    *n2 = radius * sinf(angle);
+}
+
+static int8_t saturate_int8(float value) {
+    long rounded = lrintf(value);
+    if (rounded > 127) {
+        return 127;
+    }
+    if (rounded < -128) {
+        return -128;
+    }
+    return (int8_t)rounded;
+}
+
+void aod_sim_generate(
+        const struct aod_sim *sim,
+        struct aod_sim_rng *rng,
+        int64_t report_timestamp,
+        struct iq_raw_samples *iq_raw_samples) {
+    const struct aod_sim_config *config = &sim->config;
+
+    // Baseband phase rate with the carrier frequency offset, in radians per
+    // microsecond, and a random initial phase.
+    float rate = BASEBAND_RAD_PER_US + 2.0f * (float)M_PI * config->cfo_hz * 1e-6f;
+    float initial_phase = 2.0f * (float)M_PI * rng_uniform(rng);
+
+    int8_t iq[2 * SAMPLE_COUNT_MAX];
+    for (int n = 0; n < config->sample_count; n++) {
+        float theta = initial_phase + rate * sim->sample_time_us[n];
+        float c = cosf(theta);
+        float s = sinf(theta);
+
+        uint8_t a = sim->sample_antenna[n];
+        float re = sim->antenna_gain_re[a]*c - sim->antenna_gain_im[a]*s;
+        float im = sim->antenna_gain_re[a]*s + sim->antenna_gain_im[a]*c;
+
+        if (sim->noise_sigma > 0.0f) {
+            float n1;
+            float n2;
+            rng_normal_pair(rng, &n1, &n2);
+            re += sim->noise_sigma * n1;
+            im += sim->noise_sigma * n2;
+        }
+
+        iq[2 * n] = saturate_int8(re);
+        iq[2 * n + 1] = saturate_int8(im);
+    }
+
+    iq_raw_samples_init_interleaved(
+            iq_raw_samples,
+            config->channel_index,
+            sim->rssi,
+            0, // BT_DF_CTE_CRC_OK.
+            config->measurement_spacing,
+            iq,
+            config->sample_count,
+            config->beacon->mac_little_endian,
+            config->antenna_pattern_id,
+            report_timestamp);
+}
@@ -0,0 +1,162 @@
+#ifndef AOD_SIM_H
+#define AOD_SIM_H
+
+#include <stdint.h> // For uint8_t, uint64_t, and int64_t.
+#include "beacon.h" // For beacon structure.
+#include "iq_data.h" // For raw IQ samples structure.
+
+// Synthetic CTE IQ samples for the CoreHW CHW1010-ANT2-1.1 antenna array.
+//
+// Raw IQ samples are generated as received by the locator from a beacon, with
+// the antenna positions, channel wavenumbers, and antenna switching patterns
+// of the locator core, see chw1010_ant2_specs.h and ble_channel_constants.h.
+// The signal model matches the model of the estimator, see iq_data.c:
+// - The phase of antenna a for a ray in the local direction u of the beacon is
+//   k * (p_a . u), where k is the channel wavenumber and p_a is the antenna
+//   position. The rays add up at each antenna.
+// - The baseband phase advances by 180 degrees per microsecond, as assumed by
+//   the iq_data_temp_fix_ref_samples() function, plus the carrier frequency
+//   offset, which the estimator sees as linear phase drift.
+// - The reference samples are taken each microsecond from the first antenna
+//   of the switching pattern, and the measurement samples each measurement
+//   spacing from the antennas of the sample slots, see the
+//   chw1010_ant2_measurement_antenna() function.
+// - Each report has a random initial phase, and complex Gaussian noise at the
+//   signal-to-noise ratio. Samples are rounded and saturated to int8_t.
+
+// Maximum number of multipath rays, in addition to the direct ray.
+#define AOD_SIM_RAYS_MAX 8
+
+// Default amplitude of the direct ray, in int8_t sample units. Leaves headroom
+// for noise and multipath before saturation.
+#define AOD_SIM_DEFAULT_AMPLITUDE 64.0f
+
+// Multipath ray structure, in the local coordinate system of the beacon.
+struct aod_sim_ray {
+    // Direction of departure of the ray, in radians. See the azimuth and
+    // elevation convention of chw1010_ant2_specs.h.
+    float azimuth;
+    float elevation;
+
+    // Amplitude relative to the direct ray, and phase relative to the direct
+    // ray in radians.
+    float amplitude;
+    float phase;
+};
+
+// Simulation configuration structure.
+// See the aod_sim_init() function.
+struct aod_sim_config {
+    // Beacon pose, the global position and orientation of the beacon.
+    const struct beacon *beacon;
+
+    // Global position of the locator, in meters.
+    float locator_x;
+    float locator_y;
+    float locator_z;
+
+    // Bluetooth LE channel index, 0-39.
+    uint8_t channel_index;
+
+    // Antenna pattern of the CTE, see the chw1010_ant2_pattern enum.
+    uint8_t antenna_pattern_id;
+
+    // Interval between samples in the measurement period,
+    // IQ_MEASUREMENT_SPACING_1US_SLOTS or IQ_MEASUREMENT_SPACING_2US_SLOTS.
+    uint8_t measurement_spacing;
+
+    // Raw IQ sample count, reference samples and measurement samples.
+    // See the aod_sim_sample_count() function.
+    uint8_t sample_count;
+
+    // Signal-to-noise ratio per sample, in dB. INFINITY for no noise.
+    float snr_db;
+
+    // Carrier frequency offset between the beacon and the locator, in hertz.
+    float cfo_hz;
+
+    // Amplitude of the direct ray, in int8_t sample units.
+    float amplitude;
+
+    // Transmit power of the beacon, in dBm, for the free-space RSSI.
+    float tx_power_dbm;
+
+    // Multipath rays, in addition to the direct ray.
+    int ray_count;
+    struct aod_sim_ray rays[AOD_SIM_RAYS_MAX];
+};
+
+// Simulation structure, prepared from a simulation configuration.
+// See the aod_sim_init() function.
+struct aod_sim {
+    struct aod_sim_config config;
+
+    // Ground truth. Local direction cosines of the direct ray, from the beacon
+    // toward the locator, and the azimuth and elevation in radians.
+    float local_direction_cosine_x;
+    float local_direction_cosine_y;
+    float local_direction_cosine_z;
+    float azimuth;
+    float elevation;
+
+    // Distance from the beacon to the locator, in meters.
+    float distance;
+
+    // Free-space RSSI at the distance, in units of 0.1 dBm.
+    int16_t rssi;
+
+    // Sum of the rays at each antenna, as a complex gain (re, im), in int8_t
+    // sample units.
+    float antenna_gain_re[16];
+    float antenna_gain_im[16];
+
+    // Antenna of each raw IQ sample.
+    uint8_t sample_antenna[IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX];
+
+    // Time of each raw IQ sample from the first reference sample, in
+    // microseconds.
+    float sample_time_us[IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX];
+
+    // Standard deviation of the noise per I and Q component.
+    float noise_sigma;
+};
+
+// Random number generator structure. xorshift64*, seeded by splitmix64.
+struct aod_sim_rng {
+    uint64_t state;
+};
+
+// Get the raw IQ sample count of a CTE, from the CTE length in units of 8
+// microseconds (2-20) and the measurement spacing. The CTE has a 4
+// microsecond guard period, an 8 microsecond reference period, and sample and
+// switch slots in the rest of the CTE.
+// Returns the raw IQ sample count (> 0).
+// Returns -EINVAL (-22 ~ "Invalid argument") if cte_length or
+// measurement_spacing is out of range.
+int aod_sim_sample_count(uint8_t cte_length, uint8_t measurement_spacing);
+
+// Set default values in a simulation configuration. No multipath, no noise,
+// no carrier frequency offset, channel 18, the full antenna pattern, and the
+// maximum CTE length with 2 us slots.
+void aod_sim_config_default(struct aod_sim_config *config);
+
+// Initialize a simulation structure from a simulation configuration.
+// Returns 0 (0 ~ "Success") if the simulation structure is initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if a pointer is NULL, or if a
+// configuration value is out of range.
+// Returns -EDOM (-33 ~ "Numerical argument out of domain") if the locator is
+// at the beacon, or behind the antenna array of the beacon (local z <= 0).
+int aod_sim_init(struct aod_sim *sim, const struct aod_sim_config *config);
+
+// Seed a random number generator.
+void aod_sim_rng_seed(struct aod_sim_rng *rng, uint64_t seed);
+
+// Generate the raw IQ samples of one IQ samples report. Thread safe, given a
+// random number generator per thread.
+void aod_sim_generate(
+        const struct aod_sim *sim,
+        struct aod_sim_rng *rng,
+        int64_t report_timestamp,
+        struct iq_raw_samples *iq_raw_samples);
+
+#endif // AOD_SIM_H
@@ -0,0 +1,392 @@
+// Synthetic CTE IQ samples for the CoreHW CHW1010-ANT2-1.1 antenna array.
+//
+// Generates the IQ samples reports of a beacon of the beacon deployment, see
+// beacon_deployment.c, as received by a locator at a given global position,
+// and writes them as IQ capture records, see iq_capture.h. The captures can
+// be replayed with aod_replay. The ground truth is written to stderr. See
+// aod_sim.h for the signal model.
+//
+// Reports are generated by several threads. Each report is seeded by its
+// index, so the output does not depend on the thread count. All records have
+// the same length, so each thread writes its records in place with pwrite().
+//
+// Usage: aod_simulate [options]
+//   -o, --output FILE      IQ capture file. Without a file, reports are only
+//                          generated, to measure the generation rate.
+//   -n, --count N          Number of reports (default 1000).
+//   -j, --threads N        Number of threads (default 1, 0 for all CPUs).
+//   -b, --beacon N         Beacon deployment index (default 0).
+//   -l, --locator X,Y,Z    Global locator position in meters (default
+//                          0.5,0.5,3).
+//   -c, --channel N|hop    Channel index, or hop over channels 0-36 (default
+//                          18).
+//   -p, --pattern N        Antenna pattern ID (default 0).
+//       --slots 1|2        Sample slot duration in microseconds (default 2).
+//       --cte-length N     CTE length in units of 8 us, 2-20 (default 20).
+//       --snr DB           Signal-to-noise ratio per sample (default none).
+//       --cfo HZ           Carrier frequency offset (default 0).
+//       --ray AZ,EL,A,PH   Multipath ray, azimuth and elevation in degrees,
+//                          relative amplitude, and relative phase in degrees.
+//                          May be given up to AOD_SIM_RAYS_MAX times.
+//       --interval MS      Time between reports (default 10).
+//       --seed N           Random seed (default 1).
+
+#include <errno.h> // For errno.
+#include <fcntl.h> // For open().
+#include <getopt.h> // For getopt_long().
+#include <math.h> // For INFINITY and M_PI.
+#include <pthread.h> // For pthread_create() and pthread_join().
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0) and size_t.
+#include <stdint.h> // For uint8_t, uint64_t, and int64_t.
+#include <stdio.h> // For fprintf() and sscanf().
+#include <stdlib.h> // For strtoull(), malloc(), and free().
+#include <string.h> // For strcmp() and strerror().
+#include <time.h> // For clock_gettime().
+#include <unistd.h> // For pwrite(), close(), and sysconf().
+#include "aod_sim.h" // For simulation structure and aod_sim_generate().
+#include "beacon_database.h" // For beacon database structure.
+#include "beacon_deployment.h" // For beacon_deployment_put_all().
+#include "iq_capture.h" // For iq_capture_record_encode().
+
+#define DEGREES_TO_RADIANS ((float)M_PI / 180.0f)
+#define RADIANS_TO_DEGREES (180.0f / (float)M_PI)
+
+// Channels of the periodic advertising, hopped over by --channel hop.
+#define HOP_CHANNEL_COUNT 37
+
+// Records encoded per pwrite().
+#define RECORDS_PER_WRITE 256
+
+// Simulation of each channel. A single channel uses index 0.
+static struct aod_sim sims[HOP_CHANNEL_COUNT];
+static int sim_count;
+
+// Work of a thread, a contiguous range of report indices.
+struct thread_work {
+    pthread_t thread;
+    uint64_t first;
+    uint64_t count;
+    uint64_t seed;
+    int64_t interval_ms;
+    int fd;
+    size_t record_size;
+    int err;
+};
+
+static void *thread_main(void *arg) {
+    struct thread_work *work = arg;
+
+    uint8_t *buffer = NULL;
+    if (work->fd >= 0) {
+        buffer = malloc(RECORDS_PER_WRITE * work->record_size);
+        if (buffer == NULL) {
+            work->err = -ENOMEM;
+            return NULL;
+        }
+    }
+
+    size_t buffered = 0;
+    uint64_t buffered_first = work->first;
+
+    for (uint64_t n = 0; n < work->count; n++) {
+        uint64_t index = work->first + n;
+
+        struct aod_sim_rng rng;
+        aod_sim_rng_seed(&rng, work->seed ^ (index * 0xD1B54A32D192ED03ull));
+
+        struct iq_raw_samples iq_raw_samples;
+        aod_sim_generate(
+                &sims[index % (uint64_t)sim_count],
+                &rng,
+                (int64_t)index * work->interval_ms,
+                &iq_raw_samples);
+
+        if (buffer == NULL) {
+            continue;
+        }
+
+        (void)iq_capture_record_encode(
+                &iq_raw_samples,
+                (uint16_t)index,
+                &buffer[buffered * work->record_size],
+                work->record_size);
+        buffered++;
+
+        if (buffered == RECORDS_PER_WRITE || n + 1 == work->count) {
+            size_t length = buffered * work->record_size;
+            off_t offset = (off_t)(buffered_first * work->record_size);
+            if (pwrite(work->fd, buffer, length, offset) != (ssize_t)length) {
+                work->err = -errno;
+                break;
+            }
+            buffered_first += buffered;
+            buffered = 0;
+        }
+    }
+
+    free(buffer);
+    return NULL;
+}
+
+static double monotonic_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void usage(FILE *stream) {
+    fprintf(stream,
+            "Usage: aod_simulate [options]\n"
+            "Generate synthetic CTE IQ samples reports as IQ capture records.\n"
+            "  -o, --output FILE      IQ capture file (default none).\n"
+            "  -n, --count N          Number of reports (default 1000).\n"
+            "  -j, --threads N        Number of threads (default 1, 0 for all CPUs).\n"
+            "  -b, --beacon N         Beacon deployment index (default 0).\n"
+            "  -l, --locator X,Y,Z    Global locator position in meters (default 0.5,0.5,3).\n"
+            "  -c, --channel N|hop    Channel index, or hop over channels 0-36 (default 18).\n"
+            "  -p, --pattern N        Antenna pattern ID (default 0).\n"
+            "      --slots 1|2        Sample slot duration in microseconds (default 2).\n"
+            "      --cte-length N     CTE length in units of 8 us, 2-20 (default 20).\n"
+            "      --snr DB           Signal-to-noise ratio per sample (default none).\n"
+            "      --cfo HZ           Carrier frequency offset (default 0).\n"
+            "      --ray AZ,EL,A,PH   Multipath ray (degrees, relative amplitude, degrees).\n"
+            "      --interval MS      Time between reports (default 10).\n"
+            "      --seed N           Random seed (default 1).\n"
+            "  -h, --help             Show this help.\n");
+}
+
+enum long_only_option {
+    OPTION_SLOTS = 256,
+    OPTION_CTE_LENGTH,
+    OPTION_SNR,
+    OPTION_CFO,
+    OPTION_RAY,
+    OPTION_INTERVAL,
+    OPTION_SEED,
+};
+
+int main(int argc, char **argv) {
+    const char *output = NULL;
+    uint64_t count = 1000;
+    long threads = 1;
+    int beacon_index = 0;
+    bool hop = false;
+    int channel_index = 18;
+    int slots_us = 2;
+    int cte_length = 20;
+    int64_t interval_ms = 10;
+    uint64_t seed = 1;
+
+    struct aod_sim_config config;
+    aod_sim_config_default(&config);
+    config.locator_x = 0.5f;
+    config.locator_y = 0.5f;
+    config.locator_z = 3.0f;
+
+    static const struct option long_options[] = {
+        {"output", required_argument, NULL, 'o'},
+        {"count", required_argument, NULL, 'n'},
+        {"threads", required_argument, NULL, 'j'},
+        {"beacon", required_argument, NULL, 'b'},
+        {"locator", required_argument, NULL, 'l'},
+        {"channel", required_argument, NULL, 'c'},
+        {"pattern", required_argument, NULL, 'p'},
+        {"slots", required_argument, NULL, OPTION_SLOTS},
+        {"cte-length", required_argument, NULL, OPTION_CTE_LENGTH},
+        {"snr", required_argument, NULL, OPTION_SNR},
+        {"cfo", required_argument, NULL, OPTION_CFO},
+        {"ray", required_argument, NULL, OPTION_RAY},
+        {"interval", required_argument, NULL, OPTION_INTERVAL},
+        {"seed", required_argument, NULL, OPTION_SEED},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "o:n:j:b:l:c:p:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+            case 'n':
+                count = strtoull(optarg, NULL, 0);
+                break;
+            case 'j':
+                threads = strtol(optarg, NULL, 0);
+                break;
+            case 'b':
+                beacon_index = atoi(optarg);
+                break;
+            case 'l':
+                if (sscanf(optarg, "%f,%f,%f", &config.locator_x,
+                        &config.locator_y, &config.locator_z) != 3) {
+                    fprintf(stderr, "aod_simulate: invalid locator position %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                if (strcmp(optarg, "hop") == 0) {
+                    hop = true;
+                } else {
+                    hop = false;
+                    channel_index = atoi(optarg);
+                }
+                break;
+            case 'p':
+                config.antenna_pattern_id = (uint8_t)atoi(optarg);
+                break;
+            case OPTION_SLOTS:
+                slots_us = atoi(optarg);
+                break;
+            case OPTION_CTE_LENGTH:
+                cte_length = atoi(optarg);
+                break;
+            case OPTION_SNR:
+                config.snr_db = strtof(optarg, NULL);
+                break;
+            case OPTION_CFO:
+                config.cfo_hz = strtof(optarg, NULL);
+                break;
+            case OPTION_RAY: {
+                if (config.ray_count >= AOD_SIM_RAYS_MAX) {
+                    fprintf(stderr, "aod_simulate: at most %d rays\n", AOD_SIM_RAYS_MAX);
+                    return EXIT_FAILURE;
+                }
+                struct aod_sim_ray *ray = &config.rays[config.ray_count];
+                if (sscanf(optarg, "%f,%f,%f,%f", &ray->azimuth, &ray->elevation,
+                        &ray->amplitude, &ray->phase) != 4) {
+                    fprintf(stderr, "aod_simulate: invalid ray %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                ray->azimuth *= DEGREES_TO_RADIANS;
+                ray->elevation *= DEGREES_TO_RADIANS;
+                ray->phase *= DEGREES_TO_RADIANS;
+                config.ray_count++;
+                break;
+            }
+            case OPTION_INTERVAL:
+                interval_ms = strtoll(optarg, NULL, 0);
+                break;
+            case OPTION_SEED:
+                seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'h':
+                usage(stdout);
+                return EXIT_SUCCESS;
+            default:
+                usage(stderr);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind < argc) {
+        usage(stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    static struct beacon_database beacon_db;
+    beacon_database_init(&beacon_db);
+    int ret = beacon_deployment_put_all(&beacon_db);
+    if (ret != 0) {
+        fprintf(stderr, "aod_simulate: beacon deployment failed (err %d)\n", ret);
+        return EXIT_FAILURE;
+    }
+    if (beacon_index < 0 || beacon_index >= beacon_db.count) {
+        fprintf(stderr, "aod_simulate: no beacon %d in the deployment\n", beacon_index);
+        return EXIT_FAILURE;
+    }
+    config.beacon = &beacon_db.beacons[beacon_index];
+
+    config.measurement_spacing = slots_us == 1 ?
+            IQ_MEASUREMENT_SPACING_1US_SLOTS : IQ_MEASUREMENT_SPACING_2US_SLOTS;
+    ret = aod_sim_sample_count((uint8_t)cte_length, config.measurement_spacing);
+    if ((slots_us != 1 && slots_us != 2) || ret < 0) {
+        fprintf(stderr, "aod_simulate: invalid slots or CTE length\n");
+        return EXIT_FAILURE;
+    }
+    config.sample_count = (uint8_t)ret;
+
+    sim_count = hop ? HOP_CHANNEL_COUNT : 1;
+    for (int n = 0; n < sim_count; n++) {
+        config.channel_index = (uint8_t)(hop ? n : channel_index);
+        ret = aod_sim_init(&sims[n], &config);
+        if (ret != 0) {
+            fprintf(stderr, "aod_simulate: invalid simulation (err %d)%s\n", ret,
+                    ret == -EDOM ? ", locator is behind the beacon" : "");
+            return EXIT_FAILURE;
+        }
+    }
+
+    const struct aod_sim *truth = &sims[0];
+    fprintf(stderr,
+            "aod_simulate: truth azimuth %.3f deg, elevation %.3f deg, "
+            "local direction cosines (%.6f, %.6f, %.6f), distance %.3f m, "
+            "locator (%.3f, %.3f, %.3f)\n",
+            truth->azimuth * RADIANS_TO_DEGREES,
+            truth->elevation * RADIANS_TO_DEGREES,
+            truth->local_direction_cosine_x,
+            truth->local_direction_cosine_y,
+            truth->local_direction_cosine_z,
+            truth->distance,
+            config.locator_x, config.locator_y, config.locator_z);
+
+    int fd = -1;
+    size_t record_size = IQ_CAPTURE_HEADER_SIZE + 2 * (size_t)config.sample_count +
+            IQ_CAPTURE_CRC_SIZE;
+    if (output != NULL) {
+        fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, (off_t)(count * record_size)) != 0) {
+            fprintf(stderr, "aod_simulate: %s: %s\n", output, strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    struct thread_work *work = calloc((size_t)threads, sizeof(*work));
+    if (work == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    double start_s = monotonic_s();
+    uint64_t first = 0;
+    for (long t = 0; t < threads; t++) {
+        work[t].first = first;
+        work[t].count = count / (uint64_t)threads +
+                ((uint64_t)t < count % (uint64_t)threads ? 1 : 0);
+        work[t].seed = seed;
+        work[t].interval_ms = interval_ms;
+        work[t].fd = fd;
+        work[t].record_size = record_size;
+        first += work[t].count;
+        pthread_create(&work[t].thread, NULL, thread_main, &work[t]);
+    }
+
+    int status = EXIT_SUCCESS;
+    for (long t = 0; t < threads; t++) {
+        pthread_join(work[t].thread, NULL);
+        if (work[t].err != 0) {
+            fprintf(stderr, "aod_simulate: thread %ld failed (err %d)\n", t, work[t].err);
+            status = EXIT_FAILURE;
+        }
+    }
+    double elapsed_s = monotonic_s() - start_s;
+
+    if (fd >= 0 && close(fd) != 0) {
+        status = EXIT_FAILURE;
+    }
+    free(work);
+
+    fprintf(stderr, "aod_simulate: %llu reports in %.3f s (%.0f reports/min, %ld threads)\n",
+            (unsigned long long)count,
+            elapsed_s,
+            elapsed_s > 0.0 ? (double)count / elapsed_s * 60.0 : 0.0,
+            threads);
+
+    return status;
+}
@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+# Golden check of the direction estimation of each antenna pattern with pairs,
+# the full, row, column and outer patterns. See ../README.rst.
+#
+# Usage: check_patterns.sh BUILD_DIR [--write]
+#
+# Generates synthetic IQ captures of each pattern with aod_simulate, with fixed
+# seeds, and replays the captures with aod_replay against patterns.csv. The
+# captures cover 2 us and 1 us sample slots, with the longest CTE, 160 us, and
+# the shortest CTE that gives a direction, 24 us, which leaves 3 measurement
+# samples with 2 us slots. Every record must give a direction. With --write, patterns.csv is written from
+# BUILD_DIR instead, for a reference build.
+#
+# Then rotates the beacons of the tests of aod_accuracy through the four
+# patterns, as with "ant rotate 10 all row column outer" on the beacons, and
+# checks that fixes continue through the rotation.
+
+set -ue
+
+if [ $# -lt 1 ]; then
+  echo "Usage: check_patterns.sh BUILD_DIR [--write]"
+  exit 1
+fi
+
+build_dir=$1
+write=${2:-}
+script_dir=$(cd "$(dirname "$0")" && pwd)
+golden=${script_dir}/patterns.csv
+
+work_dir=$(mktemp -d)
+trap 'rm -rf "${work_dir}"' EXIT
+
+# Patterns 0-3 of the chw1010_ant2_pattern enum. The single pattern has no
+# antenna pairs, and gives no direction. CTE lengths are in units of 8 us. The
+# locator is off both axes of beacon 0, at an azimuth of -36.5 degrees and an
+# elevation of 12.5 degrees, so the row pattern has an azimuth to estimate and
+# the column pattern an elevation.
+captures=()
+for pattern in 0 1 2 3; do
+  for slots in 2 1; do
+    for cte_length in 20 3; do
+      capture=${work_dir}/pattern_${pattern}_slots_${slots}_length_${cte_length}.bin
+      "${build_dir}/aod_simulate" -o "${capture}" -n 20 -p "${pattern}" \
+        --slots "${slots}" --cte-length "${cte_length}" \
+        --beacon 0 --locator 3.3,2.5,9.06 --channel hop --snr 20 --cfo 10000 \
+        --seed 1 2> /dev/null
+      captures+=("${capture}")
+    done
+  done
+done
+
+if [ "${write}" = "--write" ]; then
+  "${build_dir}/aod_replay" -q --golden-write "${golden}" "${captures[@]}"
+  exit 0
+fi
+
+# Tolerances for other compilers and C libraries than the reference build.
+"${build_dir}/aod_replay" -q --golden-check "${golden}" \
+  -t angle=0.01 -t quality=0.0001 -t cosine=0.0002 "${captures[@]}"
+
+# Each report after the first of a test gives a fix when both beacons have a
+# direction, and the bearings are not parallel. A pattern without directions
+# drops the fixes of its turn of the rotation, a quarter of the reports, so at
+# least three quarters of the reports must give a fix. With the column
+# pattern, bearings from the beacons of a test are close to parallel, and
+# some of its fixes are rejected.
+"${build_dir}/aod_accuracy" -p 0,1,2,3 --rotate 10 -n 200 | tee "${work_dir}/rotation.csv"
+awk -F, 'NR > 1 && $4 * 4 < $3 * 3 {
+  print "check_patterns.sh: test " $1 ", " $4 " fixes of " $3 " reports with pattern rotation"
+  failed = 1
+} END { exit failed }' "${work_dir}/rotation.csv"
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+
+# Timeline of the hot path trace of the locator, see src/aod_trace.h and
+# README.rst.
+#
+# Usage: aod_trace_timeline.py TRACE_DIR [OUTPUT_JSON]
+#
+# TRACE_DIR is a CTF trace of CONFIG_LOCATOR_TRACE, a directory with the
+# metadata file of the Zephyr CTF tracing format and the captured stream,
+# channel0_0. The trace is read with the Python bindings of Babeltrace 2 (bt2).
+#
+# Prints the count, mean and maximum duration of each traced stage, and the
+# count of each instant trace point. If OUTPUT_JSON is given, the trace points
+# are also written as a timeline in the Chrome trace event format, with one
+# track per thread, which can be opened in Perfetto (ui.perfetto.dev) or in
+# chrome://tracing.
+
+import json
+import os
+import sys
+
+# Phases of a trace point, the first argument of a named event. See
+# AOD_TRACE_PHASE_* in src/aod_trace.h.
+PHASE_BEGIN = 0
+PHASE_END = 1
+PHASE_INSTANT = 2
+
+
+def field_string(field):
+    # A bounded string of the Zephyr CTF format is an array of 8-bit
+    # characters, which Babeltrace 2 may give as a string or as an array.
+    try:
+        return str(field).rstrip("\0")
+    except TypeError:
+        pass
+    return "".join(chr(int(c)) for c in field if int(c) != 0)
+
+
+def read_trace(trace_dir):
+    # Events as (time in nanoseconds, thread, name, phase, value), in time
+    # order. The thread is the last thread switched in, or "-" before the
+    # first thread switch.
+    import bt2
+
+    events = []
+    thread = "-"
+    for msg in bt2.TraceCollectionMessageIterator(trace_dir):
+        if type(msg) is not bt2._EventMessageConst:
+            continue
+        event = msg.event
+        t = msg.default_clock_snapshot.ns_from_origin
+        if event.name == "thread_switched_in":
+            name = field_string(event.payload_field["name"])
+            thread = name if name else str(int(event.payload_field["thread_id"]))
+        elif event.name == "named_event":
+            name = field_string(event.payload_field["name"])
+            phase = int(event.payload_field["arg0"])
+            value = int(event.payload_field["arg1"])
+            events.append((t, thread, name, phase, value))
+
+    return events
+
+
+def summarize(events):
+    # Durations of each stage, in nanoseconds, from a begin to the next end of
+    # the same name on the same thread. Stages do not nest with themselves.
+    open_stages = {}
+    durations = {}
+    instants = {}
+    unmatched = 0
+
+    for t, thread, name, phase, value in events:
+        if phase == PHASE_BEGIN:
+            if (thread, name) in open_stages:
+                unmatched += 1
+            open_stages[(thread, name)] = t
+        elif phase == PHASE_END:
+            begin = open_stages.pop((thread, name), None)
+            if begin is None:
+                unmatched += 1
+                continue
+            durations.setdefault(name, []).append(t - begin)
+        elif phase == PHASE_INSTANT:
+            instants[name] = instants.get(name, 0) + 1
+
+    unmatched += len(open_stages)
+
+    print("Stages:")
+    for name, values in durations.items():
+        mean = sum(values) / len(values)
+        print(f"  {name:<20} n {len(values)}, mean {mean / 1000:.1f} us, "
+              f"max {max(values) / 1000:.1f} us")
+    if len(durations) == 0:
+        print("  no stages")
+
+    print("Instants:")
+    for name, count in instants.items():
+        print(f"  {name:<20} n {count}")
+    if len(instants) == 0:
+        print("  no instants")
+
+    if unmatched > 0:
+        print(f"{unmatched} unmatched begin or end trace points")
+
+
+def write_timeline(events, filename):
+    threads = {}
+    trace_events = []
+    start = events[0][0] if len(events) > 0 else 0
+
+    for t, thread, name, phase, value in events:
+        tid = threads.setdefault(thread, len(threads) + 1)
+        trace_event = {
+            "name": name,
+            "ts": (t - start) / 1000,
+            "pid": 1,
+            "tid": tid,
+            "args": {"value": value},
+        }
+        if phase == PHASE_BEGIN:
+            trace_event["ph"] = "B"
+        elif phase == PHASE_END:
+            trace_event["ph"] = "E"
+        else:
+            trace_event["ph"] = "i"
+            trace_event["s"] = "t"
+        trace_events.append(trace_event)
+
+    for thread, tid in threads.items():
+        trace_events.append({
+            "name": "thread_name",
+            "ph": "M",
+            "pid": 1,
+            "tid": tid,
+            "args": {"name": thread},
+        })
+
+    with open(filename, 'w') as output_file:
+        json.dump({"traceEvents": trace_events, "displayTimeUnit": "ns"}, output_file)
+
+
+def main():
+    if len(sys.argv) < 2 or not os.path.isdir(sys.argv[1]):
+        print("Usage: aod_trace_timeline.py TRACE_DIR [OUTPUT_JSON]")
+        sys.exit(1)
+
+    try:
+        events = read_trace(sys.argv[1])
+    except ImportError:
+        print("Error: the Python bindings of Babeltrace 2 (bt2) are required")
+        sys.exit(1)
+
+    summarize(events)
+
+    if len(sys.argv) > 2:
+        write_timeline(events, sys.argv[2])
+        print(f"Timeline written to {sys.argv[2]}")
+
+
+if __name__ == "__main__":
+    main()
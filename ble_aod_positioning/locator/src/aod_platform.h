@@ -0,0 +1,36 @@
+#ifndef AOD_PLATFORM_H
+#define AOD_PLATFORM_H
+
+// Platform adapter for the platform-neutral AoD library, the DSP and solver
+// code of the locator. In the Zephyr app target, __ZEPHYR__ is defined and the
+// Zephyr facilities are used. In the host build (plain CMake with gcc or
+// clang), the same facilities are mapped to the C standard library.
+// See host/CMakeLists.txt.
+
+#if defined(__ZEPHYR__)
+#include <zephyr/sys/printk.h> // For printk().
+#elif defined(AOD_PLATFORM_NO_PRINTK)
+// Discard printk() output on the host, as with CONFIG_PRINTK=n. The arguments
+// are still evaluated, so that variables used only for printing stay used.
+static inline void printk(const char *fmt, ...) {
+    (void)fmt;
+}
+#else
+#include <stdio.h> // For printf().
+
+// Zephyr printk() is printf() on the host.
+#define printk(...) printf(__VA_ARGS__)
+#endif
+
+// Debug output of the locator core, a "DEBUG" line for each IQ samples report
+// that gives no direction or no position. In the Zephyr app target, printk()
+// with CONFIG_LOCATOR_DEBUG_LOG, and nothing without it, since the hot path
+// must not print on every report. In the host build, printk(), see the
+// AOD_PRINTK option of host/CMakeLists.txt.
+#if !defined(__ZEPHYR__) || defined(CONFIG_LOCATOR_DEBUG_LOG)
+#define AOD_DEBUG(...) printk(__VA_ARGS__)
+#else
+#define AOD_DEBUG(...) do { } while (0)
+#endif
+
+#endif // AOD_PLATFORM_H
\ No newline at end of file
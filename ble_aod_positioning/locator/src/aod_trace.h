@@ -0,0 +1,53 @@
+#ifndef AOD_TRACE_H
+#define AOD_TRACE_H
+
+// Trace points of the hot path of the locator, from the CTE report callback
+// through the IQ data work queue and the DSP stages to the position solver and
+// the position output.
+//
+// With CONFIG_LOCATOR_TRACE, each trace point is a named event of the Zephyr
+// tracing subsystem, see sys_trace_named_event(), which the CTF tracing format
+// writes as a "named_event" with the name, a timestamp and two arguments. The
+// first argument is the phase of the trace point, AOD_TRACE_PHASE_*, and the
+// second argument is a value of the trace point, such as a sync index, a queue
+// count or a return value. A stage is a pair of AOD_TRACE_BEGIN() and
+// AOD_TRACE_END() with the same name.
+//
+// Without CONFIG_LOCATOR_TRACE, and in the host build, the trace points compile
+// to nothing and their arguments are not evaluated.
+//
+// Trace point names must be shorter than 20 characters, the size of the name
+// field of a CTF named event. Longer names are truncated.
+
+#include <stdint.h> // For uint32_t.
+
+// Phase of a trace point, the first argument of a named event.
+#define AOD_TRACE_PHASE_BEGIN 0
+#define AOD_TRACE_PHASE_END 1
+#define AOD_TRACE_PHASE_INSTANT 2
+
+#if defined(__ZEPHYR__) && defined(CONFIG_LOCATOR_TRACE)
+#include <zephyr/tracing/tracing.h> // For sys_trace_named_event().
+
+#define AOD_TRACE_POINT(name, phase, value) \
+        sys_trace_named_event((name), (phase), (uint32_t)(value))
+#else
+// The sizeof keeps variables that are only traced used, without evaluating
+// them.
+#define AOD_TRACE_POINT(name, phase, value) \
+        do { (void)sizeof(value); } while (0)
+#endif
+
+// Begin a stage.
+#define AOD_TRACE_BEGIN(name, value) \
+        AOD_TRACE_POINT(name, AOD_TRACE_PHASE_BEGIN, value)
+
+// End a stage.
+#define AOD_TRACE_END(name, value) \
+        AOD_TRACE_POINT(name, AOD_TRACE_PHASE_END, value)
+
+// A single point in time.
+#define AOD_TRACE_INSTANT(name, value) \
+        AOD_TRACE_POINT(name, AOD_TRACE_PHASE_INSTANT, value)
+
+#endif // AOD_TRACE_H
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "beacon_adv_data.h" // For BEACON_ADV_DATA_* constants.
+#include <errno.h> // For EINVAL (22) and ENOENT (2).
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint8_t and uint16_t.
+
+int beacon_adv_data_parse(
+        const uint8_t *data,
+        uint16_t length,
+        uint8_t *antenna_pattern_id) {
+    if (data == NULL || antenna_pattern_id == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    uint16_t offset = 0;
+    while (offset < length) {
+        // AD structure length, not counting the length octet. A length of 0
+        // ends the significant part of the data.
+        uint8_t ad_length = data[offset];
+        if (ad_length == 0 || offset + 1 + ad_length > length) {
+            break;
+        }
+
+        uint8_t ad_type = data[offset + 1];
+        const uint8_t *ad_data = &data[offset + 2];
+        uint8_t ad_data_length = ad_length - 1;
+
+        if (ad_type == BEACON_ADV_DATA_AD_TYPE_MANUFACTURER_DATA &&
+                ad_data_length >= BEACON_ADV_DATA_LENGTH) {
+            uint16_t company_id = (uint16_t)(ad_data[0] | (ad_data[1] << 8));
+            if (company_id == BEACON_ADV_DATA_COMPANY_ID &&
+                    ad_data[2] == BEACON_ADV_DATA_VERSION) {
+                *antenna_pattern_id = ad_data[3];
+                return 0; // 0 ~ "Success".
+            }
+        }
+
+        offset += 1 + ad_length;
+    }
+
+    return -ENOENT; // -2 ~ "No such file or directory".
+}
\ No newline at end of file
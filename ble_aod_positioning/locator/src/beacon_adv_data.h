@@ -0,0 +1,49 @@
+#ifndef BEACON_ADV_DATA_H
+#define BEACON_ADV_DATA_H
+
+#include <stdint.h> // For uint8_t and uint16_t.
+
+// Beacon periodic advertising data. The beacon advertises manufacturer
+// specific data in the periodic advertising data:
+// octets 0-1: Company ID BEACON_ADV_DATA_COMPANY_ID, little-endian.
+// octet  2:   Format version BEACON_ADV_DATA_VERSION.
+// octet  3:   Antenna pattern ID, see the chw1010_ant2_pattern enum.
+// The format must match the beacon, see beacon/src/main.c.
+
+// Company ID of the manufacturer specific data. 0xFFFF is reserved for
+// internal use and testing.
+#define BEACON_ADV_DATA_COMPANY_ID 0xFFFF
+
+// Format version of the manufacturer specific data.
+#define BEACON_ADV_DATA_VERSION 1
+
+// Length of the manufacturer specific data, in octets.
+#define BEACON_ADV_DATA_LENGTH 4
+
+// Advertising set identifiers of the periodic advertising sets of a beacon.
+// The accuracy set transmits more and longer CTEs per event at a slow
+// interval, and the tracking set transmits a short CTE at a fast interval.
+// Both sets carry the same data format.
+// See the sync_manager_set_sid() function.
+#define BEACON_ADV_DATA_SID_ACCURACY 0
+#define BEACON_ADV_DATA_SID_TRACKING 1
+
+// AD type of manufacturer specific data.
+// See the Bluetooth Assigned Numbers, Section 2.3.
+#define BEACON_ADV_DATA_AD_TYPE_MANUFACTURER_DATA 0xFF
+
+// Parse the antenna pattern ID from beacon periodic advertising data. The data
+// is a sequence of AD structures, each a length octet followed by an AD type
+// octet and length - 1 data octets.
+// Returns 0 (0 ~ "Success") if antenna_pattern_id is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if data pointer is NULL, or if
+// antenna_pattern_id pointer is NULL.
+// Returns -ENOENT (-2 ~ "No such file or directory") if the data has no
+// manufacturer specific data with BEACON_ADV_DATA_COMPANY_ID and
+// BEACON_ADV_DATA_VERSION, for example data from an older beacon.
+int beacon_adv_data_parse(
+        const uint8_t *data,
+        uint16_t length,
+        uint8_t *antenna_pattern_id);
+
+#endif // BEACON_ADV_DATA_H
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "beacon_angle_cache.h" // For beacon angle cache structure and beacon angle structure.
+#include <errno.h> // For EINVAL (22).
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For int64_t.
+#include "beacon_database.h" // For BEACON_DATABASE_CAPACITY.
+
+// Check if an angle is valid and within window_ms of a timestamp.
+static bool angle_is_fresh(
+        const struct beacon_angle *angle,
+        int64_t timestamp,
+        int64_t window_ms) {
+    if (!angle->valid) {
+        return false;
+    }
+
+    int64_t age = timestamp - angle->timestamp;
+    if (age < 0) {
+        age = -age;
+    }
+
+    return age <= window_ms;
+}
+
+int beacon_angle_cache_init(
+        struct beacon_angle_cache *cache,
+        int64_t window_ms) {
+    if (cache == NULL || window_ms < 0) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    for (int i = 0; i < BEACON_DATABASE_CAPACITY; i++) {
+        cache->angles[i].valid = false;
+        for (int j = 0; j < BEACON_ANGLE_CACHE_HISTORY_DEPTH; j++) {
+            cache->history[i][j].valid = false;
+        }
+        cache->history_next[i] = 0;
+    }
+
+    cache->window_ms = window_ms;
+
+    return 0; // 0 ~ "Success".
+}
+
+int beacon_angle_cache_put(
+        struct beacon_angle_cache *cache,
+        int beacon_index,
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        float quality,
+        int64_t timestamp) {
+    if (cache == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (beacon_index < 0 || beacon_index >= BEACON_DATABASE_CAPACITY) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (!(quality > 0.0f)) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    struct beacon_angle new_angle;
+    new_angle.valid = true;
+    new_angle.timestamp = timestamp;
+    new_angle.local_direction_cosine_x = local_direction_cosine_x;
+    new_angle.local_direction_cosine_y = local_direction_cosine_y;
+    new_angle.local_direction_cosine_z = local_direction_cosine_z;
+    new_angle.quality = quality;
+
+    int next = cache->history_next[beacon_index];
+    cache->history[beacon_index][next] = new_angle;
+    cache->history_next[beacon_index] =
+            (next + 1) % BEACON_ANGLE_CACHE_HISTORY_DEPTH;
+
+    // Keep the newer angle.
+    struct beacon_angle *angle = &cache->angles[beacon_index];
+    if (angle->valid && angle->timestamp > timestamp) {
+        return 0; // 0 ~ "Success".
+    }
+
+    *angle = new_angle;
+
+    return 0; // 0 ~ "Success".
+}
+
+bool beacon_angle_cache_is_fresh(
+        const struct beacon_angle_cache *cache,
+        int beacon_index,
+        int64_t timestamp) {
+    if (cache == NULL) {
+        return false;
+    }
+
+    if (beacon_index < 0 || beacon_index >= BEACON_DATABASE_CAPACITY) {
+        return false;
+    }
+
+    return angle_is_fresh(
+            &cache->angles[beacon_index],
+            timestamp,
+            cache->window_ms);
+}
+
+int beacon_angle_cache_get_history(
+        const struct beacon_angle_cache *cache,
+        int beacon_index,
+        int64_t timestamp,
+        struct beacon_angle *angles,
+        int angles_capacity) {
+    if (cache == NULL || angles == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (beacon_index < 0 || beacon_index >= BEACON_DATABASE_CAPACITY) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    int count = 0;
+    for (int j = 0; j < BEACON_ANGLE_CACHE_HISTORY_DEPTH; j++) {
+        if (count >= angles_capacity) {
+            break;
+        }
+
+        const struct beacon_angle *angle = &cache->history[beacon_index][j];
+        if (angle_is_fresh(angle, timestamp, cache->window_ms)) {
+            angles[count] = *angle;
+            count++;
+        }
+    }
+
+    return count;
+}
\ No newline at end of file
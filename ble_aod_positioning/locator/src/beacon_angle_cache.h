@@ -0,0 +1,107 @@
+#ifndef BEACON_ANGLE_CACHE_H
+#define BEACON_ANGLE_CACHE_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For int64_t.
+#include "beacon_database.h" // For BEACON_DATABASE_CAPACITY.
+
+// Default time window for fresh angles, in milliseconds.
+// See the beacon_angle_cache_is_fresh() function.
+#define BEACON_ANGLE_CACHE_DEFAULT_WINDOW_MS 1000
+
+// Number of recent angles kept per beacon.
+// See the beacon_angle_cache_get_history() function.
+#define BEACON_ANGLE_CACHE_HISTORY_DEPTH 4
+
+// Beacon angle structure.
+// Local direction cosines from a beacon toward the locator.
+// See the beacon_angle_cache_put() function.
+struct beacon_angle {
+    // See the beacon_angle_cache_put() function.
+    bool valid;
+
+    // Timestamp of the IQ samples report, in milliseconds.
+    // See the k_uptime_get() function.
+    int64_t timestamp;
+
+    // Local direction cosines from the beacon toward the locator.
+    float local_direction_cosine_x;
+    float local_direction_cosine_y;
+    float local_direction_cosine_z;
+
+    // Quality of the local direction cosines in the range (0, 1].
+    // See the aod_quality field of the IQ data structure.
+    float quality;
+};
+
+// Beacon angle cache structure.
+// Kept next to a beacon database. Angles are indexed by the index of the
+// beacon in the beacon database. See the beacon_database_index_of() function.
+// Every valid IQ samples report updates the angle of its beacon, and a
+// position can be estimated from the freshest angles of all beacons.
+// See the beacon_angle_cache_init() function.
+struct beacon_angle_cache {
+    // Latest angle of each beacon.
+    struct beacon_angle angles[BEACON_DATABASE_CAPACITY];
+
+    // Ring buffer of recent angles of each beacon, in order of arrival.
+    // See the beacon_angle_cache_get_history() function.
+    struct beacon_angle
+            history[BEACON_DATABASE_CAPACITY][BEACON_ANGLE_CACHE_HISTORY_DEPTH];
+    int history_next[BEACON_DATABASE_CAPACITY];
+
+    // Time window for fresh angles, in milliseconds.
+    // See the beacon_angle_cache_is_fresh() function.
+    int64_t window_ms;
+};
+
+// Initialize a beacon angle cache structure. All angles are set as invalid.
+// Returns 0 (0 ~ "Success") if the beacon angle cache structure is
+// initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if cache pointer is NULL, or if
+// window_ms is negative.
+int beacon_angle_cache_init(
+        struct beacon_angle_cache *cache,
+        int64_t window_ms);
+
+// Put local direction cosines for a beacon into a beacon angle cache.
+// The latest angle is only replaced if it is invalid or not newer than the new
+// angle. IQ samples reports may be processed out of order, see the IQ data
+// work queue. The new angle is always put into the history of the beacon.
+// Returns 0 (0 ~ "Success") if the angle is put, or if the new angle is older
+// than the cached angle.
+// Returns -EINVAL (-22 ~ "Invalid argument") if cache pointer is NULL, or if
+// beacon_index is out of range, or if quality is not positive.
+int beacon_angle_cache_put(
+        struct beacon_angle_cache *cache,
+        int beacon_index,
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        float quality,
+        int64_t timestamp);
+
+// Check if the angle of a beacon is valid and within the time window of a
+// timestamp. The absolute time difference is used, since the timestamp may be
+// older than the cached angle.
+// Returns true if the angle is fresh.
+// Returns false if cache pointer is NULL, or if beacon_index is out of range.
+bool beacon_angle_cache_is_fresh(
+        const struct beacon_angle_cache *cache,
+        int beacon_index,
+        int64_t timestamp);
+
+// Get the recent angles of a beacon that are within the time window of a
+// timestamp. See the beacon_angle_cache_is_fresh() function.
+// At most angles_capacity angles are copied to angles.
+// Returns the number of angles copied (>= 0).
+// Returns -EINVAL (-22 ~ "Invalid argument") if cache pointer is NULL, or if
+// angles pointer is NULL, or if beacon_index is out of range.
+int beacon_angle_cache_get_history(
+        const struct beacon_angle_cache *cache,
+        int beacon_index,
+        int64_t timestamp,
+        struct beacon_angle *angles,
+        int angles_capacity);
+
+#endif // BEACON_ANGLE_CACHE_H
\ No newline at end of file
@@ -72,5 +72,25 @@ int beacon_database_get(
         }
     }
 
+    return -ENOENT; // -2 ~ "No such file or directory".
+}
+
+int beacon_database_index_of(
+        const struct beacon_database *beacon_db,
+        const uint8_t mac_little_endian[BT_ADDR_SIZE]) {
+    if (beacon_db == NULL || mac_little_endian == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    int ret;
+    for (int i = 0; i < beacon_db->count; i++) {
+        ret = bt_addr_mac_compare(
+                mac_little_endian,
+                beacon_db->beacons[i].mac_little_endian);
+        if (ret == 1) {
+            return i;
+        }
+    }
+
     return -ENOENT; // -2 ~ "No such file or directory".
 }
\ No newline at end of file
@@ -51,4 +51,17 @@ int beacon_database_get(
         struct beacon *beacon,
         const uint8_t mac_little_endian[BT_ADDR_SIZE]);
 
+// Get the index of a beacon by MAC address, in a beacon database.
+// The index is stable until the database is reinitialized, since beacons are
+// only ever updated in place or appended. The index is in the range
+// [0, BEACON_DATABASE_CAPACITY), and can be used to index data kept next to
+// the database. See the beacon angle cache structure.
+// Returns the index (>= 0) if a beacon is found.
+// Returns -ENOENT (-2 ~ "No such file or directory") if no beacon is found.
+// Returns -EINVAL (-22 ~ "Invalid argument") if beacon_db pointer is NULL, or
+// if mac_little_endian pointer is NULL.
+int beacon_database_index_of(
+        const struct beacon_database *beacon_db,
+        const uint8_t mac_little_endian[BT_ADDR_SIZE]);
+
 #endif // BEACON_DATABASE_H
\ No newline at end of file
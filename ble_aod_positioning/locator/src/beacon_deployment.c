@@ -0,0 +1,66 @@
+#include "beacon_deployment.h" // For beacon deployment entry structure.
+#include <errno.h> // For EINVAL (22).
+#include <stddef.h> // For NULL ((void *)0).
+#include "beacon.h" // For beacon structure and beacon_init().
+#include "beacon_database.h" // For beacon database structure and beacon_database_put().
+
+const struct beacon_deployment_entry beacon_deployment[] = {
+    // Beacon 1, 1050638918, F6:66:CD:FD:DC:EB.
+    {
+        .serial_number = 1050638918,
+        .mac_big_endian = {0xF6, 0x66, 0xCD, 0xFD, 0xDC, 0xEB},
+        .global_x = 10, .global_y = 0, .global_z = 0,
+        .yaw = 0, .pitch = 0, .roll = 0,
+    },
+    // TODO(wathne): The debugger on Beacon 2 has become unresponsive. It may be
+    // possible to flash Beacon 2 from another NRF52833DK. Beacon 2 is currently
+    // decomissioned.
+    // Beacon 2, 1050625843, CE:96:F5:15:D2:45.
+    {
+        .serial_number = 1050625843,
+        .mac_big_endian = {0xCE, 0x96, 0xF5, 0x15, 0xD2, 0x45},
+        .global_x = 0, .global_y = 0, .global_z = 0,
+        .yaw = 0, .pitch = 0, .roll = 0,
+    },
+    // Beacon 3,  685689749, D5:55:32:1F:94:9F.
+    {
+        .serial_number = 685689749,
+        .mac_big_endian = {0xD5, 0x55, 0x32, 0x1F, 0x94, 0x9F},
+        .global_x = 0, .global_y = 0, .global_z = 0,
+        .yaw = 0, .pitch = 0, .roll = 0,
+    },
+};
+
+const int beacon_deployment_count =
+        sizeof(beacon_deployment) / sizeof(beacon_deployment[0]);
+
+int beacon_deployment_put_all(struct beacon_database *beacon_db) {
+    if (beacon_db == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    for (int n = 0; n < beacon_deployment_count; n++) {
+        const struct beacon_deployment_entry *entry = &beacon_deployment[n];
+
+        struct beacon beacon;
+        int ret = beacon_init(
+                &beacon,
+                entry->mac_big_endian,
+                entry->global_x,
+                entry->global_y,
+                entry->global_z,
+                entry->yaw,
+                entry->pitch,
+                entry->roll);
+        if (ret != 0) {
+            return ret;
+        }
+
+        ret = beacon_database_put(beacon_db, &beacon);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
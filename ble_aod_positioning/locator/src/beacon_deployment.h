@@ -0,0 +1,48 @@
+#ifndef BEACON_DEPLOYMENT_H
+#define BEACON_DEPLOYMENT_H
+
+#include <stdint.h> // For uint8_t and uint32_t.
+#include "beacon_database.h" // For beacon database structure.
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+
+// TODO(wathne): Populating the beacon database with compiled-in beacon data is
+// a temporary solution. Beacon data for the beacon database should instead be
+// sourced from a local file or from an external server.
+
+// Beacon deployment. The beacons of the test site, shared by the locator
+// application and the host tools, so that IQ captures are replayed with the
+// same beacon database as on the locator.
+
+// Beacon deployment entry structure.
+// See the beacon_init() function for the global position and orientation.
+struct beacon_deployment_entry {
+    // Serial number of the development kit of the beacon.
+    uint32_t serial_number;
+
+    // Bluetooth LE device address (MAC address) of the beacon in big-endian
+    // format (human-readable octet order).
+    uint8_t mac_big_endian[BT_ADDR_SIZE];
+
+    // Global position, in meters, and global orientation, in radians.
+    float global_x;
+    float global_y;
+    float global_z;
+    float yaw;
+    float pitch;
+    float roll;
+};
+
+// Beacon deployment entries.
+extern const struct beacon_deployment_entry beacon_deployment[];
+
+// Number of beacon deployment entries.
+extern const int beacon_deployment_count;
+
+// Initialize and add all beacon deployment entries, to a beacon database.
+// Returns 0 (0 ~ "Success") if all beacons are added.
+// Returns -EINVAL (-22 ~ "Invalid argument") if beacon_db pointer is NULL, or
+// if an entry is invalid. See the beacon_init() function.
+// Returns -ENOSPC (-28 ~ "No space left on device") if the database is full.
+int beacon_deployment_put_all(struct beacon_database *beacon_db);
+
+#endif // BEACON_DEPLOYMENT_H
\ No newline at end of file
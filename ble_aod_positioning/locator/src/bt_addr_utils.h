@@ -2,7 +2,9 @@
 #define BT_ADDR_UTILS_H
 
 #include <stdint.h> // For uint8_t.
+#if defined(__ZEPHYR__)
 #include <zephyr/bluetooth/addr.h> // For BT_ADDR_SIZE (6).
+#endif
 
 #ifndef BT_ADDR_SIZE
 #define BT_ADDR_SIZE 6
@@ -1,4 +1,6 @@
 #include "chw1010_ant2_specs.h"
+#include <math.h> // For fabsf().
+#include <stdint.h> // For uint8_t.
 
 const float antenna_spacing_orthogonal = 37.5f;
 
@@ -98,4 +100,72 @@ const float antenna_positions_y[16] = {
      56.25f, // antenna 13, in top left quadrant.
      18.75f, // antenna 14, in top left quadrant.
      18.75f  // antenna 15, in top left quadrant.
-};
\ No newline at end of file
+};
+
+// Antenna IDs of the antenna patterns, as in beacon/src/main.c.
+static const uint8_t ant_ids_all[16] = {
+    0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7,
+    0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF
+};
+static const uint8_t ant_ids_row[4] = {0x2, 0x3, 0x4, 0x6};
+static const uint8_t ant_ids_column[4] = {0x6, 0x7, 0x8, 0x9};
+static const uint8_t ant_ids_outer[12] = {
+    0x1, 0x2, 0x3, 0x4, 0x6, 0x7, 0x8, 0x9,
+    0xB, 0xC, 0xD, 0xE
+};
+static const uint8_t ant_ids_single[2] = {0xA, 0xA};
+
+const struct chw1010_ant2_switching_pattern
+        chw1010_ant2_switching_patterns[CHW1010_ANT2_PATTERN_COUNT] = {
+    [CHW1010_ANT2_PATTERN_ALL] = {ant_ids_all, 16},
+    [CHW1010_ANT2_PATTERN_ROW] = {ant_ids_row, 4},
+    [CHW1010_ANT2_PATTERN_COLUMN] = {ant_ids_column, 4},
+    [CHW1010_ANT2_PATTERN_OUTER] = {ant_ids_outer, 12},
+    [CHW1010_ANT2_PATTERN_SINGLE] = {ant_ids_single, 2},
+};
+
+int chw1010_ant2_measurement_antenna(
+        uint8_t pattern_id,
+        int measurement_index) {
+    if (pattern_id >= CHW1010_ANT2_PATTERN_COUNT || measurement_index < 0) {
+        return -1;
+    }
+
+    const struct chw1010_ant2_switching_pattern *pattern =
+            &chw1010_ant2_switching_patterns[pattern_id];
+
+    // The first antenna ID is used in the guard period and the reference
+    // period, so sample slot i uses antenna ID i + 1.
+    return pattern->ant_ids[(measurement_index + 1) % pattern->num_ant_ids];
+}
+
+int chw1010_ant2_pair_direction(
+        uint8_t antenna_1,
+        uint8_t antenna_2) {
+    if (antenna_1 >= 16 || antenna_2 >= 16) {
+        return -1;
+    }
+
+    // Antenna positions are multiples of half the orthogonal antenna spacing,
+    // so a tolerance of 1 mm is exact enough.
+    float dx = antenna_positions_x[antenna_2] - antenna_positions_x[antenna_1];
+    float dy = antenna_positions_y[antenna_2] - antenna_positions_y[antenna_1];
+
+    if (fabsf(dy) < 1.0f) {
+        if (fabsf(dx - antenna_spacing_orthogonal) < 1.0f) {
+            return CHW1010_ANT2_PAIR_LEFT_TO_RIGHT;
+        }
+        if (fabsf(dx + antenna_spacing_orthogonal) < 1.0f) {
+            return CHW1010_ANT2_PAIR_RIGHT_TO_LEFT;
+        }
+    } else if (fabsf(dx) < 1.0f) {
+        if (fabsf(dy - antenna_spacing_orthogonal) < 1.0f) {
+            return CHW1010_ANT2_PAIR_BOTTOM_TO_TOP;
+        }
+        if (fabsf(dy + antenna_spacing_orthogonal) < 1.0f) {
+            return CHW1010_ANT2_PAIR_TOP_TO_BOTTOM;
+        }
+    }
+
+    return -1;
+}
\ No newline at end of file
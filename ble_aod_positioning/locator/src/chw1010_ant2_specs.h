@@ -1,6 +1,8 @@
 #ifndef CHW1010_ANT2_SPECS_H
 #define CHW1010_ANT2_SPECS_H
 
+#include <stdint.h> // For uint8_t.
+
 // CoreHW CHW1010-ANT2-1.1 antenna grid:
 //  +----+----+----+----+
 //  | 13 | 12 | 11 |  9 |
@@ -44,6 +46,75 @@
 // (Alt.) Azimuth is the angle in the XY-plane with respect to the X-axis.
 // (Alt.) Elevation is the angle from the XY-plane toward the Z-axis.
 
+// CoreHW CHW1010-ANT2-1.1 antenna patterns. The beacon transmits CTEs with one
+// of these antenna switching patterns, and advertises the pattern ID in the
+// periodic advertising data. The IDs must match the ant_pattern_id enum of the
+// beacon, see beacon/src/main.c.
+// See the beacon_adv_data_parse() function.
+enum chw1010_ant2_pattern {
+    // All 16 antennas, in the antenna number order 0 to 15.
+    CHW1010_ANT2_PATTERN_ALL = 0,
+
+    // The bottom antenna row, antennas 2, 3, 4, and 6.
+    CHW1010_ANT2_PATTERN_ROW = 1,
+
+    // The right antenna column, antennas 6, 7, 8, and 9.
+    CHW1010_ANT2_PATTERN_COLUMN = 2,
+
+    // The 12 outer antennas.
+    CHW1010_ANT2_PATTERN_OUTER = 3,
+
+    // A single antenna, antenna 10.
+    CHW1010_ANT2_PATTERN_SINGLE = 4,
+
+    CHW1010_ANT2_PATTERN_COUNT,
+};
+
+// CoreHW CHW1010-ANT2-1.1 antenna switching pattern structure.
+// The first antenna ID is used in the guard period and the reference period,
+// and the antenna IDs are then used in turn in the sample slots, starting with
+// the second antenna ID and wrapping around. The antenna switching patterns
+// must match the antenna patterns of the beacon, see beacon/src/main.c.
+// See the chw1010_ant2_measurement_antenna() function.
+struct chw1010_ant2_switching_pattern {
+    const uint8_t *ant_ids;
+    uint8_t num_ant_ids;
+};
+
+// CoreHW CHW1010-ANT2-1.1 antenna switching patterns, indexed by the
+// chw1010_ant2_pattern enum.
+extern const struct chw1010_ant2_switching_pattern
+        chw1010_ant2_switching_patterns[CHW1010_ANT2_PATTERN_COUNT];
+
+// Direction of a pair of orthogonally adjacent antennas, from the first
+// antenna to the second antenna.
+// See the chw1010_ant2_pair_direction() function.
+enum chw1010_ant2_pair_direction {
+    CHW1010_ANT2_PAIR_LEFT_TO_RIGHT = 0,
+    CHW1010_ANT2_PAIR_RIGHT_TO_LEFT = 1,
+    CHW1010_ANT2_PAIR_BOTTOM_TO_TOP = 2,
+    CHW1010_ANT2_PAIR_TOP_TO_BOTTOM = 3,
+};
+
+// Get the antenna of a measurement sample, for a CTE transmitted with an
+// antenna pattern. Measurement sample i is taken in sample slot i, regardless
+// of the sample slot duration.
+// Returns the antenna number (0-15).
+// Returns -1 if pattern_id is not a valid chw1010_ant2_pattern, or if
+// measurement_index is negative.
+int chw1010_ant2_measurement_antenna(
+        uint8_t pattern_id,
+        int measurement_index);
+
+// Get the direction of a pair of antennas.
+// Returns the chw1010_ant2_pair_direction (>= 0) if the antennas are
+// orthogonally adjacent.
+// Returns -1 if the antennas are not orthogonally adjacent, or if an antenna
+// number is out of range.
+int chw1010_ant2_pair_direction(
+        uint8_t antenna_1,
+        uint8_t antenna_2);
+
 // CoreHW CHW1010-ANT2-1.1 antenna spacing for orthogonally adjacent antennas,
 // from antenna center to antenna center, in millimeters.
 extern const float antenna_spacing_orthogonal;
@@ -0,0 +1,71 @@
+#include "cte_report.h"
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint8_t and int64_t.
+#include <zephyr/bluetooth/direction.h> // For BLE direction finding IQ samples report structure.
+#include <zephyr/kernel.h> // For k_uptime_get().
+#include <zephyr/spinlock.h> // For k_spinlock_key_t.
+#include "aod_trace.h" // For AOD_TRACE_BEGIN() and AOD_TRACE_END().
+#include "iq_data.h" // For raw IQ samples structure and iq_raw_samples_init().
+#include "iq_data_work_queue.h" // For IQ data work queue structure, iq_data_work_queue_acquire(), and iq_data_work_queue_commit().
+#if defined(CONFIG_LOCATOR_IQ_CAPTURE)
+#include "iq_capture_stream.h" // For iq_capture_stream_put().
+#endif
+#include "sync_context.h" // For sync context structure, sync context table structure, and sync_context_table_get().
+
+void cte_report_handle(
+        const struct sync_context_table *sync_context_table,
+        struct iq_data_work_queue *iq_data_work_queue,
+        uint8_t sync_index,
+        const struct bt_df_per_adv_sync_iq_samples_report *report) {
+    // Timestamp of when the IQ samples report arrived in the cte_recv_cb()
+    // callback function. Elapsed time since the system booted, in milliseconds.
+    int64_t report_timestamp = k_uptime_get();
+
+    AOD_TRACE_BEGIN("cte_report", sync_index);
+
+    // Constant time lookup of the beacon of the sync. Reports from syncs that
+    // are not established, or not to a known beacon, are dropped.
+    const struct sync_context *context = sync_context_table_get(
+            sync_context_table,
+            sync_index);
+    if (context == NULL) {
+        AOD_TRACE_END("cte_report", false);
+        return;
+    }
+
+    // Initialize the raw IQ samples structure in place, in the next slot of the
+    // IQ data work queue. This is a specialized work queue with LIFO processing
+    // and FIFO eviction. The work queue is unfair and will process the most
+    // recently submitted work first (LIFO processing). It is expected that more
+    // work will be submitted to the work queue than the work queue is able to
+    // process. The oldest work will be evicted from the work queue when the work
+    // queue is full (FIFO eviction).
+    k_spinlock_key_t key;
+    struct iq_raw_samples *iq_raw_samples = iq_data_work_queue_acquire(
+            iq_data_work_queue,
+            &key);
+    if (iq_raw_samples == NULL) {
+        AOD_TRACE_END("cte_report", false);
+        return;
+    }
+
+    iq_raw_samples_init(
+            iq_raw_samples,
+            report,
+            context->beacon_mac,
+            context->antenna_pattern_id,
+            report_timestamp);
+
+    iq_data_work_queue_commit(iq_data_work_queue, key);
+
+#if defined(CONFIG_LOCATOR_IQ_CAPTURE)
+    // Stream the raw IQ samples of every report, also of reports that the work
+    // queue will evict. The slot is only rewritten by a later acquire in this
+    // function, so it can be read after the commit, outside of the queue lock.
+    // A dropped record is a gap in the sequence numbers of the stream.
+    (void)iq_capture_stream_put(iq_raw_samples);
+#endif
+
+    // The end value is true if the report was submitted to the work queue.
+    AOD_TRACE_END("cte_report", true);
+}
\ No newline at end of file
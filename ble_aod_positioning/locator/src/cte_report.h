@@ -0,0 +1,25 @@
+#ifndef CTE_REPORT_H
+#define CTE_REPORT_H
+
+#include <stdint.h> // For uint8_t.
+#include <zephyr/bluetooth/direction.h> // For BLE direction finding IQ samples report structure.
+#include "iq_data_work_queue.h" // For IQ data work queue structure.
+#include "sync_context.h" // For sync context table structure.
+
+// Handle an IQ samples report of a periodic advertising sync. This is the body
+// of the cte_recv_cb() callback function, so that other report sources, such
+// as the simulated CTE report source of native_sim, see cte_sim.h, take the
+// same path into the IQ data work queue as the Bluetooth stack.
+//
+// Reports from syncs without a valid context in the sync context table are
+// dropped. Other reports are timestamped, initialized in place in the next
+// slot of the IQ data work queue, and streamed if CONFIG_LOCATOR_IQ_CAPTURE is
+// enabled. Must not be called concurrently for the same work queue, as
+// cte_recv_cb() is only called from the Bluetooth RX thread.
+void cte_report_handle(
+        const struct sync_context_table *sync_context_table,
+        struct iq_data_work_queue *iq_data_work_queue,
+        uint8_t sync_index,
+        const struct bt_df_per_adv_sync_iq_samples_report *report);
+
+#endif // CTE_REPORT_H
\ No newline at end of file
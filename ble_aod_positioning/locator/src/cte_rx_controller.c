@@ -0,0 +1,84 @@
+#include "cte_rx_controller.h" // For CTE RX controller structure, CTE RX controller input structure, and CTE_RX_CONTROLLER_* constants.
+#include <errno.h> // For EINVAL (22).
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint8_t and uint16_t.
+
+int cte_rx_controller_init(struct cte_rx_controller *controller) {
+    if (controller == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    controller->max_cte_count = CTE_RX_CONTROLLER_MAX_CTE_COUNT_MAX;
+    controller->skip = 0;
+
+    return 0; // 0 ~ "Success".
+}
+
+int cte_rx_controller_update(
+        struct cte_rx_controller *controller,
+        const struct cte_rx_controller_input *input) {
+    if (controller == NULL || input == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (input->interval_ms == 0) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Nothing submitted and nothing processed, nothing to measure.
+    if (input->submitted_count == 0 && input->processed_count == 0) {
+        return 0; // 0 ~ "Success".
+    }
+
+    float demand;
+    if (input->processed_count == 0) {
+        // Reports submitted, but none processed. The pipeline is stalled.
+        demand = CTE_RX_CONTROLLER_LOAD_STALLED;
+    } else {
+        // Processing demand as a fraction of the interval.
+        float time_per_report_us = (float)input->processing_time_us_total /
+                (float)input->processed_count;
+        demand = time_per_report_us * (float)input->submitted_count /
+                ((float)input->interval_ms * 1000.0f);
+    }
+
+    float load_low = input->position_quality_poor ?
+            CTE_RX_CONTROLLER_LOAD_LOW_POOR_QUALITY :
+            CTE_RX_CONTROLLER_LOAD_LOW;
+
+    const uint8_t max_cte_count = controller->max_cte_count;
+    const uint16_t skip = controller->skip;
+
+    if (demand > CTE_RX_CONTROLLER_LOAD_HIGH) {
+        if (controller->max_cte_count > CTE_RX_CONTROLLER_MAX_CTE_COUNT_MIN) {
+            // Multiplicative decrease. The report rate is about proportional
+            // to the maximum CTE count.
+            int count = (int)((float)controller->max_cte_count *
+                    CTE_RX_CONTROLLER_LOAD_TARGET / demand);
+            if (count >= controller->max_cte_count) {
+                count = controller->max_cte_count - 1;
+            }
+            if (count < CTE_RX_CONTROLLER_MAX_CTE_COUNT_MIN) {
+                count = CTE_RX_CONTROLLER_MAX_CTE_COUNT_MIN;
+            }
+            controller->max_cte_count = (uint8_t)count;
+        } else if (controller->skip < CTE_RX_CONTROLLER_SKIP_MAX) {
+            controller->skip++;
+        }
+    } else if (demand < load_low) {
+        if (controller->skip > 0) {
+            controller->skip--;
+        } else if (controller->max_cte_count <
+                CTE_RX_CONTROLLER_MAX_CTE_COUNT_MAX) {
+            // Additive increase.
+            controller->max_cte_count++;
+        }
+    }
+
+    if (controller->max_cte_count != max_cte_count ||
+            controller->skip != skip) {
+        return 1;
+    }
+
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
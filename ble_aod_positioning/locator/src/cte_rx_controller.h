@@ -0,0 +1,106 @@
+#ifndef CTE_RX_CONTROLLER_H
+#define CTE_RX_CONTROLLER_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For uint8_t, uint16_t, and uint32_t.
+
+// Interval between CTE RX controller updates, in milliseconds.
+// See the cte_rx_controller_update() function.
+#define CTE_RX_CONTROLLER_UPDATE_INTERVAL_MS 1000
+
+// Range of the maximum number of CTEs sampled per periodic advertising event.
+// The beacons transmit PER_ADV_EVENT_CTE_COUNT (5) CTEs per event, so a
+// larger count gives no more IQ samples reports.
+// See the bt_df_per_adv_sync_cte_rx_param structure.
+#define CTE_RX_CONTROLLER_MAX_CTE_COUNT_MIN 1
+#define CTE_RX_CONTROLLER_MAX_CTE_COUNT_MAX 5
+
+// Maximum number of periodic advertising events that can be skipped.
+// See the bt_le_per_adv_sync_param structure.
+#define CTE_RX_CONTROLLER_SKIP_MAX 3
+
+// Processing demand thresholds, as a fraction of the update interval.
+// Overloaded above LOAD_HIGH. Headroom below LOAD_LOW, or below
+// LOAD_LOW_POOR_QUALITY if the position quality is poor, since more IQ
+// samples reports are then worth a fuller pipeline.
+#define CTE_RX_CONTROLLER_LOAD_HIGH 0.8f
+#define CTE_RX_CONTROLLER_LOAD_LOW 0.4f
+#define CTE_RX_CONTROLLER_LOAD_LOW_POOR_QUALITY 0.6f
+
+// Processing demand aimed for when overloaded.
+#define CTE_RX_CONTROLLER_LOAD_TARGET 0.6f
+
+// Processing demand of a stalled pipeline, with reports submitted but none
+// processed over the interval. Maximum overload, the maximum CTE count is
+// decreased to CTE_RX_CONTROLLER_MAX_CTE_COUNT_MIN in one update, or the skip
+// is increased if the maximum CTE count is already there.
+#define CTE_RX_CONTROLLER_LOAD_STALLED \
+        ((float)CTE_RX_CONTROLLER_MAX_CTE_COUNT_MAX * \
+        CTE_RX_CONTROLLER_LOAD_TARGET / \
+        (float)CTE_RX_CONTROLLER_MAX_CTE_COUNT_MIN)
+
+// Position quality is poor above this GDOP, in meters per radian.
+// See the gdop field of the locator position structure.
+#define CTE_RX_CONTROLLER_GDOP_POOR 20.0f
+
+// CTE RX controller input structure.
+// Pipeline measurements over one update interval.
+// See the cte_rx_controller_update() function.
+struct cte_rx_controller_input {
+    // Length of the interval, in milliseconds.
+    uint32_t interval_ms;
+
+    // Number of IQ samples reports submitted to the pipeline, and processed.
+    // See the IQ data work queue statistics structure.
+    uint32_t submitted_count;
+    uint32_t processed_count;
+
+    // Total processing time of the processed reports, in microseconds.
+    uint32_t processing_time_us_total;
+
+    // The position quality is poor, for example no new position, or a
+    // position with a GDOP above CTE_RX_CONTROLLER_GDOP_POOR.
+    bool position_quality_poor;
+};
+
+// CTE RX controller structure.
+// Adapts the CTE RX parameters to the load of the IQ data pipeline, so the
+// radio never delivers more IQ samples reports than the pipeline can process,
+// and delivers more when there is headroom.
+//
+// The processing demand is the processing time per report times the number of
+// submitted reports, as a fraction of the interval. Evicted reports count
+// toward the demand, since they were delivered but never processed.
+//
+// Overloaded: The maximum CTE count is decreased multiplicatively toward
+// CTE_RX_CONTROLLER_LOAD_TARGET. At CTE_RX_CONTROLLER_MAX_CTE_COUNT_MIN, the
+// skip is increased instead. Reports submitted but none processed is maximum
+// overload, see CTE_RX_CONTROLLER_LOAD_STALLED.
+//
+// Headroom: The skip is decreased first, then the maximum CTE count is
+// increased by 1 (additive increase, multiplicative decrease).
+//
+// The maximum CTE count applies to all syncs when CTE RX is enabled again.
+// The skip only applies to new syncs.
+// See the cte_rx_controller_init() function.
+struct cte_rx_controller {
+    uint8_t max_cte_count;
+    uint16_t skip;
+};
+
+// Initialize a CTE RX controller structure, with
+// CTE_RX_CONTROLLER_MAX_CTE_COUNT_MAX and skip 0.
+// Returns 0 (0 ~ "Success") if the CTE RX controller structure is initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if controller pointer is NULL.
+int cte_rx_controller_init(struct cte_rx_controller *controller);
+
+// Update a CTE RX controller with the measurements of one interval.
+// Returns 1 if max_cte_count or skip changed.
+// Returns 0 (0 ~ "Success") if nothing changed.
+// Returns -EINVAL (-22 ~ "Invalid argument") if controller pointer is NULL, or
+// if input pointer is NULL, or if input->interval_ms is 0.
+int cte_rx_controller_update(
+        struct cte_rx_controller *controller,
+        const struct cte_rx_controller_input *input);
+
+#endif // CTE_RX_CONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "cte_sim.h"
+#include <stdbool.h> // For bool.
+#include <errno.h> // For EINVAL (22), ENOENT (2), EIO (5), ENODATA (61), EPERM (1), and EAGAIN (11).
+#include <stddef.h> // For NULL ((void *)0) and size_t.
+#include <stdint.h> // For uint8_t, uint32_t, uint64_t, and int64_t.
+#include <string.h> // For memcmp(), memcpy(), and memset().
+#include <zephyr/bluetooth/addr.h> // For BLE device address structure and BT_ADDR_LE_RANDOM.
+#include <zephyr/bluetooth/direction.h> // For BLE direction finding IQ samples report structure.
+#include <zephyr/bluetooth/hci_types.h> // For BLE HCI IQ sample structure.
+#include <zephyr/kernel.h> // For k_thread_create(), k_sleep(), k_busy_wait(), k_uptime_get(), and k_uptime_ticks().
+#include <zephyr/spinlock.h> // For k_spinlock_key_t, k_spin_lock(), and k_spin_unlock().
+#include <posix_native_task.h> // For NATIVE_TASK().
+#include "aod_sim.h" // For aod_sim_init(), aod_sim_generate(), and aod_sim_sample_count().
+#include "beacon_database.h" // For beacon database structure.
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "chw1010_ant2_specs.h" // For CHW1010_ANT2_PATTERN_ALL.
+#include "cmdline.h" // For native_add_command_line_opts() and args_struct_t.
+#include "cte_report.h" // For cte_report_handle().
+#include "cte_sim_bottom.h" // For cte_sim_bottom_thread_cpu_time_ns() and cte_sim_bottom_read_file().
+#include "iq_capture.h" // For iq_capture_record_decode().
+#include "iq_data.h" // For raw IQ samples structure, iq_data_process(), and IQ_MEASUREMENT_SPACING_2US_SLOTS.
+#include "iq_data_work_queue.h" // For IQ data work queue structure.
+#include "sync_context.h" // For sync context table structure, sync_context_table_set(), and SYNC_CONTEXT_TABLE_CAPACITY.
+
+// Priority of the source thread. Cooperative, like the Bluetooth RX thread
+// that calls the cte_recv_cb() callback function, so a burst of late reports
+// is delivered before the system work queue processes any of them.
+#define CTE_SIM_THREAD_PRIORITY K_PRIO_COOP(8)
+
+#define CTE_SIM_THREAD_STACK_SIZE 4096
+
+// Synthetic reports. Signal-to-noise ratio, carrier frequency offset, and CTE
+// length in units of 8 microseconds, as in the defaults of the aod_accuracy
+// host tool. The locator is at the ground truth of test 1 of the Skaarlia
+// tunnel experiment, see experiments/2025_04_24_skaarlia_tunnel/README.md.
+#define CTE_SIM_SNR_DB 20.0f
+#define CTE_SIM_CFO_HZ 10000.0f
+#define CTE_SIM_CTE_LENGTH 20
+#define CTE_SIM_LOCATOR_X 3.30f
+#define CTE_SIM_LOCATOR_Y 0.0f
+#define CTE_SIM_LOCATOR_Z 9.06f
+#define CTE_SIM_SEED 1
+
+// Number of data channels, hopped through by the synthetic reports.
+#define CTE_SIM_DATA_CHANNEL_COUNT 37
+
+// Command line options, see cte_sim.h.
+static uint32_t option_rate = CONFIG_LOCATOR_CTE_SIM_RATE;
+static char *option_capture_path = NULL;
+static double option_cpu_scale = 1.0;
+
+static void cte_sim_add_options(void) {
+    static struct args_struct_t options[] = {
+        {
+            .option = "cte-rate",
+            .name = "R",
+            .type = 'u',
+            .dest = (void *)&option_rate,
+            .descript = "Simulated CTE reports per second.",
+        },
+        {
+            .option = "cte-capture",
+            .name = "FILE",
+            .type = 's',
+            .dest = (void *)&option_capture_path,
+            .descript = "Simulated CTE reports from an IQ capture file, "
+                    "instead of synthetic reports.",
+        },
+        {
+            .option = "cte-cpu-scale",
+            .name = "X",
+            .type = 'd',
+            .dest = (void *)&option_cpu_scale,
+            .descript = "Scale of the host CPU time of IQ data processing "
+                    "charged to the simulated time.",
+        },
+        ARG_TABLE_ENDMARKER,
+    };
+
+    native_add_command_line_opts(options);
+}
+
+NATIVE_TASK(cte_sim_add_options, PRE_BOOT_1, 1);
+
+// Source state, set by cte_sim_init().
+static bool initialized;
+static bool started;
+static struct sync_context_table *table;
+static struct iq_data_work_queue *queue;
+static const struct beacon_database *db;
+
+// Number of simulated syncs. Sync i is set to beacon i of the beacon database.
+static int sync_count;
+
+// IQ capture file in host memory, or NULL for synthetic reports.
+static const uint8_t *capture;
+static size_t capture_size;
+static size_t capture_offset;
+
+// Synthetic reports.
+static struct aod_sim_rng rng;
+static uint8_t synthetic_sample_count;
+
+// Spinlock to ensure atomic access to the statistics.
+static struct k_spinlock stats_lock;
+static struct cte_sim_stats source_stats;
+
+K_THREAD_STACK_DEFINE(cte_sim_thread_stack, CTE_SIM_THREAD_STACK_SIZE);
+static struct k_thread cte_sim_thread_data;
+
+// Get the simulated sync of a beacon, from its MAC address in little-endian
+// format.
+// Returns the sync index (>= 0).
+// Returns -ENOENT (-2 ~ "No such file or directory") if the beacon has no
+// simulated sync.
+static int sync_index_of(const uint8_t beacon_mac[BT_ADDR_SIZE]) {
+    for (int s = 0; s < sync_count; s++) {
+        if (memcmp(db->beacons[s].mac_little_endian, beacon_mac, BT_ADDR_SIZE) == 0) {
+            return s;
+        }
+    }
+    return -ENOENT; // -2 ~ "No such file or directory".
+}
+
+// Get the next IQ capture record of a beacon with a simulated sync, looping
+// the capture at the end.
+// Returns the sync index (>= 0) if iq_raw_samples is set.
+// Returns -ENODATA (-61 ~ "No data available") if a whole pass over the
+// capture found no such record.
+static int next_capture_record(struct iq_raw_samples *iq_raw_samples, uint32_t *skipped) {
+    bool wrapped = false;
+
+    while (true) {
+        if (capture_offset >= capture_size) {
+            if (wrapped) {
+                return -ENODATA; // -61 ~ "No data available".
+            }
+            capture_offset = 0;
+            wrapped = true;
+        }
+
+        int length = iq_capture_record_decode(
+                &capture[capture_offset],
+                capture_size - capture_offset,
+                iq_raw_samples,
+                NULL);
+        if (length == -EAGAIN) {
+            // Truncated record at the end of the capture.
+            capture_offset = capture_size;
+            continue;
+        }
+        if (length < 0) {
+            // Not at the start of a valid record. Resynchronize.
+            capture_offset++;
+            continue;
+        }
+        capture_offset += (size_t)length;
+
+        int sync_index = sync_index_of(iq_raw_samples->beacon_mac);
+        if (sync_index < 0) {
+            (*skipped)++;
+            continue;
+        }
+        return sync_index;
+    }
+}
+
+// Generate the next synthetic report. Alternates between the simulated syncs,
+// and hops to the next data channel after each round of syncs.
+// Returns the sync index (>= 0) if iq_raw_samples is set.
+// Returns a negative error number of aod_sim_init() if the beacon of the sync
+// can not see the locator.
+static int next_synthetic_report(struct iq_raw_samples *iq_raw_samples, uint32_t sequence) {
+    int sync_index = (int)(sequence % (uint32_t)sync_count);
+    uint8_t channel_index = (uint8_t)(
+            (sequence / (uint32_t)sync_count) % CTE_SIM_DATA_CHANNEL_COUNT);
+
+    struct aod_sim_config config;
+    aod_sim_config_default(&config);
+    config.beacon = &db->beacons[sync_index];
+    config.locator_x = CTE_SIM_LOCATOR_X;
+    config.locator_y = CTE_SIM_LOCATOR_Y;
+    config.locator_z = CTE_SIM_LOCATOR_Z;
+    config.channel_index = channel_index;
+    config.antenna_pattern_id = CHW1010_ANT2_PATTERN_ALL;
+    config.measurement_spacing = IQ_MEASUREMENT_SPACING_2US_SLOTS;
+    config.sample_count = synthetic_sample_count;
+    config.snr_db = CTE_SIM_SNR_DB;
+    config.cfo_hz = CTE_SIM_CFO_HZ;
+
+    static struct aod_sim sim;
+    int err = aod_sim_init(&sim, &config);
+    if (err) {
+        return err;
+    }
+
+    aod_sim_generate(&sim, &rng, 0, iq_raw_samples);
+    return sync_index;
+}
+
+// Deliver one report to cte_report_handle(), as the Bluetooth stack would.
+static void deliver(uint32_t sequence) {
+    static struct iq_raw_samples iq_raw_samples;
+    static struct bt_hci_le_iq_sample samples[IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX];
+    uint32_t skipped = 0;
+    int sync_index;
+
+    if (capture != NULL) {
+        sync_index = next_capture_record(&iq_raw_samples, &skipped);
+        if (sync_index >= 0) {
+            // The antenna pattern of a sync comes from the periodic advertising
+            // data, which is not simulated. Take it from the record instead.
+            (void)sync_context_table_set_antenna_pattern(
+                    table,
+                    sync_index,
+                    iq_raw_samples.antenna_pattern_id);
+        }
+    } else {
+        sync_index = next_synthetic_report(&iq_raw_samples, sequence);
+    }
+
+    if (sync_index >= 0) {
+        for (int k = 0; k < iq_raw_samples.sample_count; k++) {
+            samples[k].i = iq_raw_samples.i[k];
+            samples[k].q = iq_raw_samples.q[k];
+        }
+
+        bool slots_1us = iq_raw_samples.measurement_spacing == IQ_MEASUREMENT_SPACING_1US_SLOTS;
+        struct bt_df_per_adv_sync_iq_samples_report report = {
+            .chan_idx = iq_raw_samples.channel_index,
+            .rssi = iq_raw_samples.rssi,
+            .rssi_ant_id = 0,
+            .cte_type = slots_1us ? BT_DF_CTE_TYPE_AOD_1US : BT_DF_CTE_TYPE_AOD_2US,
+            .slot_durations = slots_1us ? BT_DF_ANTENNA_SWITCHING_SLOT_1US
+                                        : BT_DF_ANTENNA_SWITCHING_SLOT_2US,
+            .packet_status = iq_raw_samples.packet_status,
+            .per_evt_counter = (uint16_t)sequence,
+            .sample_count = iq_raw_samples.sample_count,
+            .sample_type = BT_DF_IQ_SAMPLE_8_BITS_INT,
+            .sample = samples,
+        };
+
+        cte_report_handle(table, queue, (uint8_t)sync_index, &report);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    if (sync_index >= 0) {
+        source_stats.delivered_count++;
+    }
+    source_stats.skipped_count += skipped;
+    k_spin_unlock(&stats_lock, key);
+}
+
+// Source thread. Delivers the reports that are due at the rate, in simulated
+// time, then sleeps for a tick.
+static void cte_sim_thread(void *p1, void *p2, void *p3) {
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    int64_t start_ticks = k_uptime_ticks();
+    uint64_t sent = 0;
+
+    while (true) {
+        uint64_t elapsed_us = k_ticks_to_us_floor64((uint64_t)(k_uptime_ticks() - start_ticks));
+        uint64_t due = elapsed_us * option_rate / 1000000u;
+
+        if (due - sent > CTE_SIM_BACKLOG_MAX) {
+            k_spinlock_key_t key = k_spin_lock(&stats_lock);
+            source_stats.overrun_count += (uint32_t)(due - sent - CTE_SIM_BACKLOG_MAX);
+            k_spin_unlock(&stats_lock, key);
+            sent = due - CTE_SIM_BACKLOG_MAX;
+        }
+
+        while (sent < due) {
+            deliver((uint32_t)sent);
+            sent++;
+        }
+
+        k_sleep(K_TICKS(1));
+    }
+}
+
+int cte_sim_init(
+        struct sync_context_table *sync_context_table,
+        struct iq_data_work_queue *iq_data_work_queue,
+        const struct beacon_database *beacon_db) {
+    if (sync_context_table == NULL || iq_data_work_queue == NULL || beacon_db == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (option_rate == 0 || option_rate > 1000000u || !(option_cpu_scale >= 0.0)) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (beacon_db->count <= 0) {
+        return -ENOENT; // -2 ~ "No such file or directory".
+    }
+
+    table = sync_context_table;
+    queue = iq_data_work_queue;
+    db = beacon_db;
+
+    sync_count = beacon_db->count < SYNC_CONTEXT_TABLE_CAPACITY
+            ? beacon_db->count
+            : SYNC_CONTEXT_TABLE_CAPACITY;
+    for (int s = 0; s < sync_count; s++) {
+        bt_addr_le_t addr = {.type = BT_ADDR_LE_RANDOM};
+        memcpy(addr.a.val, beacon_db->beacons[s].mac_little_endian, BT_ADDR_SIZE);
+        int err = sync_context_table_set(table, s, &addr, beacon_db);
+        if (err) {
+            return err;
+        }
+    }
+
+    if (option_capture_path != NULL) {
+        uint8_t *data;
+        size_t size;
+        if (cte_sim_bottom_read_file(option_capture_path, &data, &size) != 0) {
+            return -EIO; // -5 ~ "I/O error".
+        }
+        capture = data;
+        capture_size = size;
+        capture_offset = 0;
+
+        // Check for at least one record of a beacon with a simulated sync.
+        static struct iq_raw_samples iq_raw_samples;
+        uint32_t skipped = 0;
+        int err = next_capture_record(&iq_raw_samples, &skipped);
+        if (err < 0) {
+            return err;
+        }
+        capture_offset = 0;
+    } else {
+        int count = aod_sim_sample_count(CTE_SIM_CTE_LENGTH, IQ_MEASUREMENT_SPACING_2US_SLOTS);
+        if (count < 0) {
+            return count;
+        }
+        synthetic_sample_count = (uint8_t)count;
+        aod_sim_rng_seed(&rng, CTE_SIM_SEED);
+    }
+
+    memset(&source_stats, 0, sizeof(source_stats));
+    initialized = true;
+    return 0; // 0 ~ "Success".
+}
+
+int cte_sim_start(void) {
+    if (!initialized || started) {
+        return -EPERM; // -1 ~ "Operation not permitted".
+    }
+
+    k_thread_create(
+            &cte_sim_thread_data,
+            cte_sim_thread_stack,
+            K_THREAD_STACK_SIZEOF(cte_sim_thread_stack),
+            cte_sim_thread,
+            NULL,
+            NULL,
+            NULL,
+            CTE_SIM_THREAD_PRIORITY,
+            0,
+            K_NO_WAIT);
+    k_thread_name_set(&cte_sim_thread_data, "cte_sim");
+    started = true;
+    return 0; // 0 ~ "Success".
+}
+
+void cte_sim_process(const struct iq_raw_samples *iq_raw_samples) {
+    uint64_t cpu_start_ns = cte_sim_bottom_thread_cpu_time_ns();
+    iq_data_process(iq_raw_samples);
+    uint64_t cpu_ns = cte_sim_bottom_thread_cpu_time_ns() - cpu_start_ns;
+
+    // Charge the CPU time to the simulated time. Interrupts still run while
+    // busy waiting, but not the cooperative source thread, as on the target.
+    uint32_t busy_us = (uint32_t)((double)cpu_ns * option_cpu_scale / 1000.0);
+    k_busy_wait(busy_us);
+
+    int64_t latency_ms = k_uptime_get() - iq_raw_samples->report_timestamp;
+
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    source_stats.processed_count++;
+    source_stats.busy_us += busy_us;
+    source_stats.latency_ms_total += latency_ms;
+    if (latency_ms > source_stats.latency_ms_max) {
+        source_stats.latency_ms_max = latency_ms;
+    }
+    k_spin_unlock(&stats_lock, key);
+}
+
+uint32_t cte_sim_get_rate(void) {
+    return option_rate;
+}
+
+int cte_sim_get_stats(struct cte_sim_stats *stats, bool reset) {
+    if (stats == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    *stats = source_stats;
+    if (reset) {
+        memset(&source_stats, 0, sizeof(source_stats));
+    }
+    k_spin_unlock(&stats_lock, key);
+
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
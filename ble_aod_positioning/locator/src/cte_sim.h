@@ -0,0 +1,110 @@
+#ifndef CTE_SIM_H
+#define CTE_SIM_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For uint32_t, uint64_t, and int64_t.
+#include "beacon_database.h" // For beacon database structure.
+#include "iq_data.h" // For raw IQ samples structure.
+#include "iq_data_work_queue.h" // For IQ data work queue structure.
+#include "sync_context.h" // For sync context table structure.
+
+// Simulated CTE report source for the locator on native_sim, see
+// CONFIG_LOCATOR_CTE_SIM and prj_cte_sim.conf.
+//
+// A source thread builds bt_df_per_adv_sync_iq_samples_report structures and
+// hands them to the cte_report_handle() function, the body of the cte_recv_cb()
+// callback function, see cte_report.h. Everything from there on is the real
+// locator: the sync context table, the IQ data work queue on the system work
+// queue, iq_data_process(), and the global locator. Scanning and sync
+// management are not simulated. One simulated sync is set per beacon of the
+// beacon database, up to CONFIG_LOCATOR_CTE_SIM_SYNC_MAX.
+//
+// Reports are either synthetic, see host/aod_sim.h, alternating between the
+// synced beacons with channel hopping, or IQ capture records read from a host
+// file, see iq_capture.h, looped for as long as the simulation runs. Records
+// of beacons without a simulated sync are skipped. Reports are delivered at a
+// fixed rate, in simulated time, from a cooperative thread like the Bluetooth
+// RX thread. A backlog of at most CTE_SIM_BACKLOG_MAX reports is delivered
+// late when the thread is starved, and the rest are overrun, as when the
+// controller runs out of buffers.
+//
+// The simulated time of native_sim does not advance while code runs. The
+// processor of the work queue, cte_sim_process(), therefore charges the host
+// CPU time of each iq_data_process() call to the simulated time, scaled by a
+// CPU scale factor, with k_busy_wait(). The scale factor is the speed of the
+// host relative to the target, see benchmark/README.rst for the target cycle
+// counts. The work queue statistics, the CPU load, and the latency then
+// behave as on a target of that speed.
+//
+// Command line options of the native_sim executable:
+//   --cte-rate=R         Reports per second (default CONFIG_LOCATOR_CTE_SIM_RATE).
+//   --cte-capture=FILE   IQ capture file (default synthetic reports).
+//   --cte-cpu-scale=X    Host CPU time scale factor (default 1.0).
+// The simulated run time is set by the -stop_at=SECONDS option of native_sim.
+
+// Maximum number of reports delivered late, when the source thread is starved.
+#define CTE_SIM_BACKLOG_MAX 8
+
+// Simulated CTE report source statistics structure.
+// Counters since the statistics were last reset.
+// See the cte_sim_get_stats() function.
+struct cte_sim_stats {
+    // Number of reports delivered to cte_report_handle().
+    uint32_t delivered_count;
+
+    // Number of reports not delivered, because the backlog was full.
+    uint32_t overrun_count;
+
+    // Number of IQ capture records skipped, because the beacon has no
+    // simulated sync.
+    uint32_t skipped_count;
+
+    // Number of raw IQ samples structures processed by cte_sim_process().
+    uint32_t processed_count;
+
+    // Simulated time charged to processing, in microseconds.
+    uint64_t busy_us;
+
+    // Total and maximum latency, from the report timestamp to the end of
+    // processing, in milliseconds.
+    int64_t latency_ms_total;
+    int64_t latency_ms_max;
+};
+
+// Initialize the simulated CTE report source. Sets a simulated sync per beacon
+// of the beacon database in the sync context table, and reads the IQ capture
+// file if one is given on the command line.
+// Returns 0 (0 ~ "Success") if the source is initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if a pointer is NULL, or if a
+// command line option is out of range.
+// Returns -ENOENT (-2 ~ "No such file or directory") if the beacon database
+// is empty.
+// Returns -EIO (-5 ~ "I/O error") if the IQ capture file can not be read.
+// Returns -ENODATA (-61 ~ "No data available") if the IQ capture file holds
+// no records of beacons with a simulated sync.
+int cte_sim_init(
+        struct sync_context_table *sync_context_table,
+        struct iq_data_work_queue *iq_data_work_queue,
+        const struct beacon_database *beacon_db);
+
+// Start the source thread.
+// Returns 0 (0 ~ "Success") if the source thread is started.
+// Returns -EPERM (-1 ~ "Operation not permitted") if the source is not
+// initialized, or if the source thread is already started.
+int cte_sim_start(void);
+
+// Process a raw IQ samples structure with iq_data_process(), and charge the
+// host CPU time to the simulated time. This function is compatible with the
+// iq_raw_samples_processor_t function pointer type, and is the processor of
+// the IQ data work queue of the simulated locator.
+void cte_sim_process(const struct iq_raw_samples *iq_raw_samples);
+
+// Get the reports per second of the source.
+uint32_t cte_sim_get_rate(void);
+
+// Get the statistics of the source, and optionally reset them.
+// Returns 0 (0 ~ "Success") if stats is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if stats pointer is NULL.
+int cte_sim_get_stats(struct cte_sim_stats *stats, bool reset);
+
+#endif // CTE_SIM_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "cte_sim_bottom.h"
+#include <errno.h> // For errno.
+#include <stddef.h> // For NULL ((void *)0) and size_t.
+#include <stdint.h> // For uint8_t and uint64_t.
+#include <stdio.h> // For FILE, fopen(), fread(), fseek(), ftell(), fclose(), and fprintf().
+#include <stdlib.h> // For malloc() and free().
+#include <string.h> // For strerror().
+#include <time.h> // For clock_gettime() and CLOCK_THREAD_CPUTIME_ID.
+
+uint64_t cte_sim_bottom_thread_cpu_time_ns(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int cte_sim_bottom_read_file(const char *path, uint8_t **data, size_t *size) {
+    if (path == NULL || data == NULL || size == NULL) {
+        return -1;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "cte_sim: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    if (length < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "cte_sim: %s: %s\n", path, strerror(errno));
+        fclose(file);
+        return -1;
+    }
+
+    uint8_t *buffer = malloc(length > 0 ? (size_t)length : 1);
+    if (buffer == NULL) {
+        fprintf(stderr, "cte_sim: %s: %s\n", path, strerror(ENOMEM));
+        fclose(file);
+        return -1;
+    }
+
+    if (fread(buffer, 1, (size_t)length, file) != (size_t)length) {
+        fprintf(stderr, "cte_sim: %s: short read\n", path);
+        free(buffer);
+        fclose(file);
+        return -1;
+    }
+
+    fclose(file);
+    *data = buffer;
+    *size = (size_t)length;
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
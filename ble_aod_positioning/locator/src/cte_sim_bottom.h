@@ -0,0 +1,24 @@
+#ifndef CTE_SIM_BOTTOM_H
+#define CTE_SIM_BOTTOM_H
+
+#include <stddef.h> // For size_t.
+#include <stdint.h> // For uint8_t and uint64_t.
+
+// Host side of the simulated CTE report source, see cte_sim.h. Built into the
+// native simulator runner with the C library of the host, and called from the
+// embedded side of native_sim. Only plain C types cross this interface, since
+// the host and Zephyr headers do not mix.
+
+// Get the CPU time consumed by the calling host thread, in nanoseconds. Each
+// Zephyr thread of native_sim runs on its own host thread, so this is the CPU
+// time of the calling Zephyr thread, independent of the simulated time.
+uint64_t cte_sim_bottom_thread_cpu_time_ns(void);
+
+// Read a whole host file into memory allocated on the host heap. The memory is
+// kept for the lifetime of the process. The reason of a failure is printed on
+// the standard error of the host.
+// Returns 0 (0 ~ "Success") if data and size are set.
+// Returns -1 if the file can not be read, or if memory can not be allocated.
+int cte_sim_bottom_read_file(const char *path, uint8_t **data, size_t *size);
+
+#endif // CTE_SIM_BOTTOM_H
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "dilution_of_precision.h" // For dilution of precision structure and DILUTION_OF_PRECISION_* constants.
+#include <errno.h> // For EINVAL (22).
+#include <math.h> // For sqrtf().
+#include <stddef.h> // For NULL ((void *)0).
+
+int dilution_of_precision_init(struct dilution_of_precision *dop) {
+    if (dop == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    dop->a_xx = 0.0f;
+    dop->a_xy = 0.0f;
+    dop->a_xz = 0.0f;
+    dop->a_yy = 0.0f;
+    dop->a_yz = 0.0f;
+    dop->a_zz = 0.0f;
+
+    dop->weight_sum = 0.0f;
+
+    dop->bearing_count = 0;
+
+    return 0; // 0 ~ "Success".
+}
+
+int dilution_of_precision_add_bearing(
+        struct dilution_of_precision *dop,
+        float bx,
+        float by,
+        float bz,
+        float x,
+        float y,
+        float z) {
+    if (dop == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // V = X - B
+    float vx = x - bx;
+    float vy = y - by;
+    float vz = z - bz;
+    float r = sqrtf(vx*vx + vy*vy + vz*vz);
+    if (r < DILUTION_OF_PRECISION_RANGE_MIN) {
+        r = DILUTION_OF_PRECISION_RANGE_MIN;
+    }
+
+    // U = V / r
+    float ux = vx / r;
+    float uy = vy / r;
+    float uz = vz / r;
+
+    // (I - U U^T) / r^2
+    float weight = 1.0f / (r * r);
+    dop->a_xx = dop->a_xx + weight * (1.0f - ux*ux);
+    dop->a_xy = dop->a_xy - weight * ux*uy;
+    dop->a_xz = dop->a_xz - weight * ux*uz;
+    dop->a_yy = dop->a_yy + weight * (1.0f - uy*uy);
+    dop->a_yz = dop->a_yz - weight * uy*uz;
+    dop->a_zz = dop->a_zz + weight * (1.0f - uz*uz);
+
+    dop->weight_sum = dop->weight_sum + weight;
+
+    dop->bearing_count++;
+
+    return 0; // 0 ~ "Success".
+}
+
+int dilution_of_precision_get(
+        const struct dilution_of_precision *dop,
+        float *gdop) {
+    if (dop == NULL || gdop == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (dop->bearing_count < 2) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Diagonal cofactors of the symmetric information matrix A. The trace of
+    // A^-1 is the sum of the diagonal cofactors divided by the determinant.
+    float c_xx = dop->a_yy*dop->a_zz - dop->a_yz*dop->a_yz;
+    float c_yy = dop->a_xx*dop->a_zz - dop->a_xz*dop->a_xz;
+    float c_zz = dop->a_xx*dop->a_yy - dop->a_xy*dop->a_xy;
+    float c_xy = dop->a_xz*dop->a_yz - dop->a_xy*dop->a_zz;
+    float c_xz = dop->a_xy*dop->a_yz - dop->a_xz*dop->a_yy;
+
+    float determinant = dop->a_xx*c_xx + dop->a_xy*c_xy + dop->a_xz*c_xz;
+
+    // Reject bearings that are too parallel. See the line_intersection_solve()
+    // function.
+    const float weight_sum = dop->weight_sum;
+    float normalized_determinant =
+            determinant / (weight_sum * weight_sum * weight_sum);
+    if (!(normalized_determinant >= DILUTION_OF_PRECISION_DETERMINANT_MIN)) {
+        return -DILUTION_OF_PRECISION_ERROR_DEGENERATE; // -96 ~ "Degenerate geometry".
+    }
+
+    *gdop = sqrtf((c_xx + c_yy + c_zz) / determinant);
+
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
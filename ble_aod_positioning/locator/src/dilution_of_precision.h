@@ -0,0 +1,76 @@
+#ifndef DILUTION_OF_PRECISION_H
+#define DILUTION_OF_PRECISION_H
+
+#define DILUTION_OF_PRECISION_ERROR_DEGENERATE 96 // An arbitrary error number.
+
+// Minimum range from a beacon to a point, in meters.
+#define DILUTION_OF_PRECISION_RANGE_MIN 0.1f
+
+// Minimum determinant of the range-normalized information matrix. Same role as
+// LINE_INTERSECTION_DETERMINANT_MIN.
+#define DILUTION_OF_PRECISION_DETERMINANT_MIN 0.00025f
+
+// Dilution of precision structure.
+// Geometric dilution of precision (GDOP) of bearings from beacons toward a
+// point X. A bearing from a beacon at B with angular error s (radians) gives a
+// perpendicular position error of about r*s at the range r = |X - B|. With
+// the unit vector U = (X - B) / r, the information matrix of N bearings with
+// equal angular error is:
+//
+// A = sum((I - U(i) U(i)^T) / r(i)^2)
+//
+// The position covariance is s^2 * A^-1, and the GDOP is:
+//
+// GDOP = sqrt(trace(A^-1))
+//
+// The GDOP is in meters per radian. The expected position error is about
+// GDOP * s. A short baseline relative to the range, or nearly parallel
+// bearings, give a large GDOP. Every added bearing reduces the GDOP, but far
+// beacons and bearings parallel to existing bearings reduce it very little.
+// The information matrix is accumulated incrementally, one bearing at a time.
+// See the dilution_of_precision_init() function.
+struct dilution_of_precision {
+    // Symmetric information matrix A, upper triangle.
+    float a_xx, a_xy, a_xz;
+    float a_yy, a_yz;
+    float a_zz;
+
+    // Sum of 1 / r(i)^2, for the normalized determinant.
+    float weight_sum;
+
+    // Number of accumulated bearings.
+    int bearing_count;
+};
+
+// Initialize a dilution of precision structure (bearing_count = 0).
+// Returns 0 (0 ~ "Success") if the dilution of precision structure is
+// initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if dop pointer is NULL.
+int dilution_of_precision_init(struct dilution_of_precision *dop);
+
+// Add a bearing from a beacon at (bx, by, bz) toward the point (x, y, z), to a
+// dilution of precision structure. The range is constrained by
+// DILUTION_OF_PRECISION_RANGE_MIN.
+// Returns 0 (0 ~ "Success") if the bearing is added.
+// Returns -EINVAL (-22 ~ "Invalid argument") if dop pointer is NULL.
+int dilution_of_precision_add_bearing(
+        struct dilution_of_precision *dop,
+        float bx,
+        float by,
+        float bz,
+        float x,
+        float y,
+        float z);
+
+// Get the GDOP of the accumulated bearings of a dilution of precision
+// structure. The dop argument is not modified, more bearings can be added.
+// Returns 0 (0 ~ "Success") if gdop is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if dop pointer is NULL, or if
+// gdop pointer is NULL, or if fewer than 2 bearings are added.
+// Returns -DILUTION_OF_PRECISION_ERROR_DEGENERATE (-96 ~ "Degenerate
+// geometry") if all bearings are nearly parallel.
+int dilution_of_precision_get(
+        const struct dilution_of_precision *dop,
+        float *gdop);
+
+#endif // DILUTION_OF_PRECISION_H
\ No newline at end of file
@@ -158,4 +158,23 @@ float directional_statistics_circular_mean_extrinsic(
             angles_count,
             0,
             0);
+}
+
+float directional_statistics_mean_resultant_length(
+        const float *angles,
+        int angles_count) {
+    if (angles_count < 1) {
+        return 0.0f;
+    }
+
+    float sum_cos_phi = 0.0f;
+    float sum_sin_phi = 0.0f;
+    for (int i = 0; i < angles_count; i++) {
+        sum_cos_phi = sum_cos_phi + cosf(angles[i]);
+        sum_sin_phi = sum_sin_phi + sinf(angles[i]);
+    }
+
+    // R = sqrt(C^2 + S^2) / n
+    return sqrtf(sum_cos_phi*sum_cos_phi + sum_sin_phi*sum_sin_phi) /
+            (float)angles_count;
 }
\ No newline at end of file
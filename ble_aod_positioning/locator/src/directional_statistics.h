@@ -42,4 +42,14 @@ float directional_statistics_circular_mean_extrinsic(
         const float *angles,
         int angles_count);
 
+// Calculate the mean resultant length of a set of angles (radians).
+// The mean resultant length R is the length of the mean of the unit vectors
+// (cos(phi), sin(phi)), and measures how clustered the angles are.
+// Returns R in the range [0, 1], where 1 means identical angles and values
+// near 0 mean scattered angles.
+// Returns 0.0f if angles_count is 0.
+float directional_statistics_mean_resultant_length(
+        const float *angles,
+        int angles_count);
+
 #endif // DIRECTIONAL_STATISTICS_H
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "iq_capture.h" // For IQ_CAPTURE_* constants.
+#include <errno.h> // For EAGAIN (11), EBADMSG (74), EINVAL (22), ENOBUFS (105), and ENOTSUP (134).
+#include <stddef.h> // For NULL ((void *)0) and size_t.
+#include <stdint.h> // For uint8_t, int8_t, uint16_t, int16_t, uint64_t, and int64_t.
+#include <string.h> // For memcpy().
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "iq_data.h" // For raw IQ samples structure and iq_raw_samples_init_interleaved().
+
+// Offsets of the record fields, in octets. See iq_capture.h.
+#define OFFSET_SYNC 0
+#define OFFSET_VERSION 2
+#define OFFSET_SEQUENCE 3
+#define OFFSET_TIMESTAMP 5
+#define OFFSET_CHANNEL_INDEX 13
+#define OFFSET_BEACON_MAC 14
+#define OFFSET_RSSI 20
+#define OFFSET_PACKET_STATUS 22
+#define OFFSET_ANTENNA_PATTERN_ID 23
+#define OFFSET_MEASUREMENT_SPACING 24
+#define OFFSET_SAMPLE_COUNT 25
+#define OFFSET_IQ IQ_CAPTURE_HEADER_SIZE
+
+// CRC-16/CCITT-FALSE, polynomial 0x1021 and initial value 0xFFFF, computed
+// four bits at a time with a 16 entry table. Fast enough to run per IQ samples
+// report, without a 512 octet table.
+static uint16_t crc16_ccitt(const uint8_t *data, size_t length) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+
+    uint16_t crc = 0xFFFF;
+    for (size_t n = 0; n < length; n++) {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[n] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (data[n] & 0x0F)]);
+    }
+    return crc;
+}
+
+static void put_le16(uint8_t *dst, uint16_t value) {
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+static uint16_t get_le16(const uint8_t *src) {
+    return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+int iq_capture_record_encode(
+        const struct iq_raw_samples *iq_raw_samples,
+        uint16_t sequence,
+        uint8_t *buffer,
+        size_t buffer_size) {
+    if (iq_raw_samples == NULL || buffer == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    size_t iq_length = 2 * (size_t)iq_raw_samples->sample_count;
+    size_t record_length =
+            IQ_CAPTURE_HEADER_SIZE + iq_length + IQ_CAPTURE_CRC_SIZE;
+    if (buffer_size < record_length) {
+        return -ENOBUFS; // -105 ~ "No buffer space available".
+    }
+
+    buffer[OFFSET_SYNC] = IQ_CAPTURE_SYNC_0;
+    buffer[OFFSET_SYNC + 1] = IQ_CAPTURE_SYNC_1;
+    buffer[OFFSET_VERSION] = IQ_CAPTURE_VERSION;
+    put_le16(&buffer[OFFSET_SEQUENCE], sequence);
+
+    uint64_t timestamp = (uint64_t)iq_raw_samples->report_timestamp;
+    for (int n = 0; n < 8; n++) {
+        buffer[OFFSET_TIMESTAMP + n] = (uint8_t)(timestamp >> (8 * n));
+    }
+
+    buffer[OFFSET_CHANNEL_INDEX] = iq_raw_samples->channel_index;
+    memcpy(&buffer[OFFSET_BEACON_MAC], iq_raw_samples->beacon_mac, BT_ADDR_SIZE);
+    put_le16(&buffer[OFFSET_RSSI], (uint16_t)iq_raw_samples->rssi);
+    buffer[OFFSET_PACKET_STATUS] = iq_raw_samples->packet_status;
+    buffer[OFFSET_ANTENNA_PATTERN_ID] = iq_raw_samples->antenna_pattern_id;
+    buffer[OFFSET_MEASUREMENT_SPACING] = iq_raw_samples->measurement_spacing;
+    buffer[OFFSET_SAMPLE_COUNT] = iq_raw_samples->sample_count;
+
+    // Interleave the IQ samples, as in an IQ samples report.
+    for (int n = 0; n < iq_raw_samples->sample_count; n++) {
+        buffer[OFFSET_IQ + 2 * n] = (uint8_t)iq_raw_samples->i[n];
+        buffer[OFFSET_IQ + 2 * n + 1] = (uint8_t)iq_raw_samples->q[n];
+    }
+
+    // The CRC covers everything after the sync octets.
+    uint16_t crc = crc16_ccitt(
+            &buffer[OFFSET_VERSION],
+            IQ_CAPTURE_HEADER_SIZE - OFFSET_VERSION + iq_length);
+    put_le16(&buffer[IQ_CAPTURE_HEADER_SIZE + iq_length], crc);
+
+    return (int)record_length;
+}
+
+int iq_capture_record_decode(
+        const uint8_t *buffer,
+        size_t length,
+        struct iq_raw_samples *iq_raw_samples,
+        uint16_t *sequence) {
+    if (buffer == NULL || iq_raw_samples == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Check the sync octets as soon as they are available, so that a reader
+    // of a byte stream can skip octets that are not a record.
+    if (length >= 1 && buffer[OFFSET_SYNC] != IQ_CAPTURE_SYNC_0) {
+        return -EBADMSG; // -74 ~ "Bad message".
+    }
+    if (length >= 2 && buffer[OFFSET_SYNC + 1] != IQ_CAPTURE_SYNC_1) {
+        return -EBADMSG; // -74 ~ "Bad message".
+    }
+    if (length < IQ_CAPTURE_HEADER_SIZE) {
+        return -EAGAIN; // -11 ~ "Resource temporarily unavailable".
+    }
+
+    uint8_t sample_count = buffer[OFFSET_SAMPLE_COUNT];
+    if (sample_count > IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX) {
+        return -EBADMSG; // -74 ~ "Bad message".
+    }
+
+    size_t iq_length = 2 * (size_t)sample_count;
+    size_t record_length =
+            IQ_CAPTURE_HEADER_SIZE + iq_length + IQ_CAPTURE_CRC_SIZE;
+    if (length < record_length) {
+        return -EAGAIN; // -11 ~ "Resource temporarily unavailable".
+    }
+
+    uint16_t crc = crc16_ccitt(
+            &buffer[OFFSET_VERSION],
+            IQ_CAPTURE_HEADER_SIZE - OFFSET_VERSION + iq_length);
+    if (crc != get_le16(&buffer[IQ_CAPTURE_HEADER_SIZE + iq_length])) {
+        return -EBADMSG; // -74 ~ "Bad message".
+    }
+
+    // Only a record with a correct CRC is trusted to have a real version.
+    if (buffer[OFFSET_VERSION] != IQ_CAPTURE_VERSION) {
+        return -ENOTSUP; // -134 ~ "Not supported".
+    }
+
+    uint64_t timestamp = 0;
+    for (int n = 0; n < 8; n++) {
+        timestamp |= (uint64_t)buffer[OFFSET_TIMESTAMP + n] << (8 * n);
+    }
+
+    iq_raw_samples_init_interleaved(
+            iq_raw_samples,
+            buffer[OFFSET_CHANNEL_INDEX],
+            (int16_t)get_le16(&buffer[OFFSET_RSSI]),
+            buffer[OFFSET_PACKET_STATUS],
+            buffer[OFFSET_MEASUREMENT_SPACING],
+            (const int8_t *)&buffer[OFFSET_IQ],
+            sample_count,
+            &buffer[OFFSET_BEACON_MAC],
+            buffer[OFFSET_ANTENNA_PATTERN_ID],
+            (int64_t)timestamp);
+
+    if (sequence != NULL) {
+        *sequence = get_le16(&buffer[OFFSET_SEQUENCE]);
+    }
+
+    return (int)record_length;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef IQ_CAPTURE_H
+#define IQ_CAPTURE_H
+
+#include <stddef.h> // For size_t.
+#include <stdint.h> // For uint8_t and uint16_t.
+#include "iq_data.h" // For raw IQ samples structure.
+
+// IQ capture record format. A raw IQ samples structure is captured as one
+// binary record, so that field tests can be saved and replayed as datasets.
+// Multi-octet fields are little-endian:
+// octets 0-1:   Sync octets IQ_CAPTURE_SYNC_0 and IQ_CAPTURE_SYNC_1.
+// octet  2:     Format version IQ_CAPTURE_VERSION.
+// octets 3-4:   Sequence number, incremented per record. A gap means that
+//               records were dropped.
+// octets 5-12:  Report timestamp, int64_t, in milliseconds.
+// octet  13:    Bluetooth LE channel index.
+// octets 14-19: Beacon MAC address, in little-endian format as received.
+// octets 20-21: RSSI, int16_t, in units of 0.1 dBm.
+// octet  22:    Packet status, see the bt_df_packet_status enum.
+// octet  23:    Antenna pattern ID, see the chw1010_ant2_pattern enum.
+// octet  24:    Measurement spacing, in microseconds per measurement sample.
+// octet  25:    IQ sample count n.
+// octets 26-:   2 * n octets of interleaved int8_t IQ samples, i[0], q[0],
+//               i[1], q[1], and so on.
+// last 2 octets: CRC-16/CCITT-FALSE of all octets from the format version up
+//               to and including the IQ samples.
+// The sync octets and the CRC let a reader find records in a byte stream that
+// also carries text, or that lost octets.
+
+// Sync octets at the start of each record.
+#define IQ_CAPTURE_SYNC_0 0xAD
+#define IQ_CAPTURE_SYNC_1 0x51
+
+// Format version of the record.
+#define IQ_CAPTURE_VERSION 1
+
+// Length of the record header, from the sync octets to the IQ sample count.
+#define IQ_CAPTURE_HEADER_SIZE 26
+
+// Length of the CRC at the end of the record.
+#define IQ_CAPTURE_CRC_SIZE 2
+
+// Maximum length of a record, with the maximum IQ sample count.
+#define IQ_CAPTURE_RECORD_SIZE_MAX (IQ_CAPTURE_HEADER_SIZE + \
+        2 * (IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX) + IQ_CAPTURE_CRC_SIZE)
+
+// Encode a raw IQ samples structure as a record.
+// Returns the length of the record in octets (> 0) if the record is written to
+// buffer.
+// Returns -EINVAL (-22 ~ "Invalid argument") if iq_raw_samples pointer is
+// NULL, or if buffer pointer is NULL.
+// Returns -ENOBUFS (-105 ~ "No buffer space available") if buffer_size is too
+// small for the record.
+int iq_capture_record_encode(
+        const struct iq_raw_samples *iq_raw_samples,
+        uint16_t sequence,
+        uint8_t *buffer,
+        size_t buffer_size);
+
+// Decode a record at the start of a buffer into a raw IQ samples structure.
+// The sequence pointer may be NULL.
+// Returns the length of the record in octets (> 0) if iq_raw_samples is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if buffer pointer is NULL, or if
+// iq_raw_samples pointer is NULL.
+// Returns -EAGAIN (-11 ~ "Resource temporarily unavailable") if the buffer
+// holds the start of a record, but not the whole record.
+// Returns -EBADMSG (-74 ~ "Bad message") if the buffer does not start with the
+// sync octets, if the IQ sample count is too large, or if the CRC is wrong.
+// A reader of a byte stream should then skip one octet and try again.
+// Returns -ENOTSUP (-134 ~ "Not supported") if the format version is not
+// IQ_CAPTURE_VERSION.
+int iq_capture_record_decode(
+        const uint8_t *buffer,
+        size_t length,
+        struct iq_raw_samples *iq_raw_samples,
+        uint16_t *sequence);
+
+#endif // IQ_CAPTURE_H
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "iq_capture_stream.h"
+#include <stdbool.h> // For bool.
+#include <errno.h> // For EINVAL (22), ENOBUFS (105), and ENODEV (19).
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint8_t and uint16_t.
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h> // For k_spinlock_key_t, k_spin_lock(), and k_spin_unlock().
+#include "iq_capture.h" // For iq_capture_record_encode() and IQ_CAPTURE_RECORD_SIZE_MAX.
+#include "iq_data.h" // For raw IQ samples structure.
+
+#if defined(CONFIG_LOCATOR_IQ_CAPTURE_BACKEND_UART)
+#include <zephyr/device.h> // For DEVICE_DT_GET() and device_is_ready().
+#include <zephyr/devicetree.h> // For DT_CHOSEN().
+#include <zephyr/drivers/uart.h> // For the interrupt-driven UART API.
+#include <zephyr/sys/ring_buffer.h> // For RING_BUF_DECLARE() and the ring buffer API.
+#elif defined(CONFIG_LOCATOR_IQ_CAPTURE_BACKEND_RTT)
+#include <SEGGER_RTT.h> // For SEGGER_RTT_ConfigUpBuffer() and SEGGER_RTT_Write().
+#endif
+
+// Spinlock to ensure atomic access to the sequence number and the ring buffer.
+static struct k_spinlock lock;
+
+// Sequence number of the next record. Incremented for dropped records too.
+static uint16_t sequence;
+
+#if defined(CONFIG_LOCATOR_IQ_CAPTURE_BACKEND_UART)
+
+// UART of the stream. The console UART, which should then not be used for
+// text. See overlay-iq-capture.conf.
+static const struct device *const uart_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+
+RING_BUF_DECLARE(ring, CONFIG_LOCATOR_IQ_CAPTURE_RING_SIZE);
+
+// UART interrupt handler. Fill the UART TX FIFO from the ring buffer, and
+// disable the TX interrupt when the ring buffer is empty.
+static void uart_isr(const struct device *dev, void *user_data) {
+    ARG_UNUSED(user_data);
+
+    while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+        if (!uart_irq_tx_ready(dev)) {
+            break;
+        }
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+
+        uint8_t *data;
+        uint32_t size = ring_buf_get_claim(&ring, &data, CONFIG_LOCATOR_IQ_CAPTURE_RING_SIZE);
+        if (size == 0) {
+            uart_irq_tx_disable(dev);
+            k_spin_unlock(&lock, key);
+            break;
+        }
+
+        int sent = uart_fifo_fill(dev, data, (int)size);
+        ring_buf_get_finish(&ring, sent > 0 ? (uint32_t)sent : 0);
+
+        k_spin_unlock(&lock, key);
+    }
+}
+
+int iq_capture_stream_init(void) {
+    if (!device_is_ready(uart_dev)) {
+        return -ENODEV; // -19 ~ "No such device".
+    }
+
+    uart_irq_callback_user_data_set(uart_dev, uart_isr, NULL);
+
+    return 0; // 0 ~ "Success".
+}
+
+#elif defined(CONFIG_LOCATOR_IQ_CAPTURE_BACKEND_RTT)
+
+// RTT up buffer of the stream. The RTT up buffer is the ring buffer, drained
+// by the RTT host.
+static uint8_t rtt_buffer[CONFIG_LOCATOR_IQ_CAPTURE_RING_SIZE];
+
+int iq_capture_stream_init(void) {
+    // Skip a record that does not fit, rather than block or write a part.
+    SEGGER_RTT_ConfigUpBuffer(
+            CONFIG_LOCATOR_IQ_CAPTURE_RTT_CHANNEL,
+            "IQCapture",
+            rtt_buffer,
+            sizeof(rtt_buffer),
+            SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+
+    return 0; // 0 ~ "Success".
+}
+
+#endif
+
+int iq_capture_stream_put(const struct iq_raw_samples *iq_raw_samples) {
+    if (iq_raw_samples == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Take a sequence number, also for a record that is dropped.
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint16_t record_sequence = sequence++;
+    k_spin_unlock(&lock, key);
+
+    // Encode the record outside of the lock.
+    uint8_t record[IQ_CAPTURE_RECORD_SIZE_MAX];
+    int length = iq_capture_record_encode(
+            iq_raw_samples,
+            record_sequence,
+            record,
+            sizeof(record));
+    if (length < 0) {
+        return length;
+    }
+
+#if defined(CONFIG_LOCATOR_IQ_CAPTURE_BACKEND_UART)
+    key = k_spin_lock(&lock);
+
+    bool dropped = ring_buf_space_get(&ring) < (uint32_t)length;
+    if (!dropped) {
+        ring_buf_put(&ring, record, (uint32_t)length);
+    }
+
+    k_spin_unlock(&lock, key);
+
+    if (dropped) {
+        return -ENOBUFS; // -105 ~ "No buffer space available".
+    }
+
+    uart_irq_tx_enable(uart_dev);
+#elif defined(CONFIG_LOCATOR_IQ_CAPTURE_BACKEND_RTT)
+    // SEGGER_RTT_Write() returns 0 if the record was skipped.
+    if (SEGGER_RTT_Write(
+            CONFIG_LOCATOR_IQ_CAPTURE_RTT_CHANNEL,
+            record,
+            (unsigned int)length) == 0) {
+        return -ENOBUFS; // -105 ~ "No buffer space available".
+    }
+#endif
+
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
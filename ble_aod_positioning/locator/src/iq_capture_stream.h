@@ -0,0 +1,29 @@
+#ifndef IQ_CAPTURE_STREAM_H
+#define IQ_CAPTURE_STREAM_H
+
+#include "iq_data.h" // For raw IQ samples structure.
+
+// IQ capture stream. Raw IQ samples are encoded as IQ capture records and
+// streamed over UART or RTT, see iq_capture.h and CONFIG_LOCATOR_IQ_CAPTURE.
+// Records are put in a ring buffer of CONFIG_LOCATOR_IQ_CAPTURE_RING_SIZE
+// octets and drained in the background, by the UART TX interrupt or by the RTT
+// host. A record that does not fit in the ring buffer is dropped whole, and
+// never waited for, so the stream can run at the full IQ samples report rate
+// without stalling the IQ data pipeline. Dropped records show up as gaps in
+// the sequence numbers.
+
+// Initialize the IQ capture stream.
+// Returns 0 (0 ~ "Success") if the stream is ready.
+// Returns -ENODEV (-19 ~ "No such device") if the UART is not ready.
+int iq_capture_stream_init(void);
+
+// Put a raw IQ samples structure in the IQ capture stream, as one record.
+// Safe to call from the cte_recv_cb() callback function.
+// Returns 0 (0 ~ "Success") if the record is put in the stream.
+// Returns -EINVAL (-22 ~ "Invalid argument") if iq_raw_samples pointer is
+// NULL.
+// Returns -ENOBUFS (-105 ~ "No buffer space available") if the record is
+// dropped.
+int iq_capture_stream_put(const struct iq_raw_samples *iq_raw_samples);
+
+#endif // IQ_CAPTURE_STREAM_H
\ No newline at end of file
@@ -1,15 +1,21 @@
 #include "iq_data.h"
+#include <errno.h> // For ENODATA (61) and ENOTSUP (134).
 #include <math.h>
+#include <string.h> // For memcpy().
+#if defined(__ZEPHYR__)
 #include <zephyr/bluetooth/hci_types.h> // For bt_hci_le_iq_sample.
+#endif
+#include "aod_platform.h" // For printk() and AOD_DEBUG().
+#include "aod_trace.h" // For AOD_TRACE_BEGIN() and AOD_TRACE_END().
 #include "ble_channel_constants.h" // For BLE channel lookup tables (LUTs).
 #include "bt_addr_utils.h" // For BT_ADDR_SIZE (6) and bt_addr_mac_compare().
-#include "chw1010_ant2_specs.h" // For antenna_spacing_orthogonal (37.5f).
+#include "chw1010_ant2_specs.h" // For antenna_spacing_orthogonal (37.5f) and CoreHW CHW1010-ANT2-1.1 antenna pattern enum.
 #include "locator.h" // For locator structure and g_locator instance.
-#include "directional_statistics.h" // For directional_statistics_circular_mean().
+#include "directional_statistics.h" // For directional_statistics_circular_mean() and directional_statistics_mean_resultant_length().
+#include "iq_data_stages.h" // For declarations of the IQ data processing stages.
 
 // TODO(wathne): Revise all #include directives, with comments.
 // TODO(wathne): Use sample16 instead of sample?
-// TODO(wathne): Use dynamic IQ sampling settings.
 // TODO(wathne): Rename iq_raw_samples?
 
 #ifndef M_PI
@@ -20,17 +26,23 @@
 #define IQ_DATA_DEGREES_RADIANS_RATIO 57.295776f
 
 // Raw IQ samples are separated into reference samples and measurement samples.
-// By default, each IQ samples report provides a total of 45 raw IQ samples. The
-// first 8 IQ samples are reference samples and the remaining 37 IQ samples are
-// measurement samples.
+// The first 8 IQ samples are reference samples and the remaining IQ samples are
+// measurement samples, 37 for a 160 μs CTE with 2 μs slots, or 74 with 1 μs
+// slots.
 
 // Data pipeline:
 // IQ samples report -> raw IQ samples structure -> IQ data structure.
 
-void iq_raw_samples_init(
+void iq_raw_samples_init_interleaved(
         struct iq_raw_samples *iq_raw_samples,
-        const struct bt_df_per_adv_sync_iq_samples_report *report,
-        const struct bt_le_per_adv_sync_info *info,
+        uint8_t channel_index,
+        int16_t rssi,
+        uint8_t packet_status,
+        uint8_t measurement_spacing,
+        const int8_t *iq,
+        uint8_t sample_count,
+        const uint8_t beacon_mac[BT_ADDR_SIZE],
+        uint8_t antenna_pattern_id,
         int64_t report_timestamp) {
     // Set timestamp of when the IQ samples report arrived in the cte_recv_cb()
     // callback function. Elapsed time since the system booted, in milliseconds.
@@ -38,27 +50,85 @@ void iq_raw_samples_init(
     iq_raw_samples->report_timestamp = report_timestamp;
 
     // Set Bluetooth LE channel index.
-    iq_raw_samples->channel_index = report->chan_idx;
+    iq_raw_samples->channel_index = channel_index;
 
     // Set Bluetooth LE device address (MAC address) of the beacon in
     // little-endian format (protocol/reversed octet order).
-    memcpy(iq_raw_samples->beacon_mac, info->addr.a.val, BT_ADDR_SIZE);
+    memcpy(iq_raw_samples->beacon_mac, beacon_mac, BT_ADDR_SIZE);
+
+    // Set antenna pattern of the CTE.
+    iq_raw_samples->antenna_pattern_id = antenna_pattern_id;
+
+    // Set RSSI and packet status of the packet with the CTE.
+    iq_raw_samples->rssi = rssi;
+    iq_raw_samples->packet_status = packet_status;
+
+    // Set periodic advertising event counter, unknown without a report.
+    iq_raw_samples->event_counter = 0;
+
+    // Set interval between samples in the measurement period.
+    iq_raw_samples->measurement_spacing = measurement_spacing;
 
     static const int MAXIMUM_SAMPLES = IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX;
     // Set sample_count, constrained by maximum IQ sample count constants.
     // sample_count <= (IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX)
-    iq_raw_samples->sample_count = report->sample_count;
+    iq_raw_samples->sample_count = sample_count;
     if (iq_raw_samples->sample_count > MAXIMUM_SAMPLES) {
         iq_raw_samples->sample_count = MAXIMUM_SAMPLES;
     }
 
-    // Set raw IQ samples from IQ samples report.
+    // Set raw IQ samples from interleaved IQ samples.
     for (int i = 0; i < iq_raw_samples->sample_count; i++) {
-        iq_raw_samples->i[i] = report->sample[i].i;
-        iq_raw_samples->q[i] = report->sample[i].q;
+        iq_raw_samples->i[i] = iq[2 * i];
+        iq_raw_samples->q[i] = iq[2 * i + 1];
+    }
+}
+
+#if defined(__ZEPHYR__)
+// Get the interval between samples in the measurement period of an IQ samples
+// report, in microseconds per measurement sample. For AoD, the sample slot
+// duration follows from the CTE type. For AoA, the sample slot duration is
+// set by the receiver and reported as the slot durations.
+static uint8_t iq_measurement_spacing(
+        const struct bt_df_per_adv_sync_iq_samples_report *report) {
+    switch (report->cte_type) {
+        case BT_DF_CTE_TYPE_AOD_1US:
+            return IQ_MEASUREMENT_SPACING_1US_SLOTS;
+        case BT_DF_CTE_TYPE_AOD_2US:
+            return IQ_MEASUREMENT_SPACING_2US_SLOTS;
+        default:
+            if (report->slot_durations == BT_DF_ANTENNA_SWITCHING_SLOT_1US) {
+                return IQ_MEASUREMENT_SPACING_1US_SLOTS;
+            }
+            return IQ_MEASUREMENT_SPACING_2US_SLOTS;
     }
 }
 
+void iq_raw_samples_init(
+        struct iq_raw_samples *iq_raw_samples,
+        const struct bt_df_per_adv_sync_iq_samples_report *report,
+        const uint8_t beacon_mac[BT_ADDR_SIZE],
+        uint8_t antenna_pattern_id,
+        int64_t report_timestamp) {
+    // The samples of an IQ samples report are bt_hci_le_iq_sample structures,
+    // which are interleaved int8_t I and Q samples.
+    iq_raw_samples_init_interleaved(
+            iq_raw_samples,
+            report->chan_idx,
+            report->rssi,
+            report->packet_status,
+            iq_measurement_spacing(report),
+            (const int8_t *)report->sample,
+            report->sample_count,
+            beacon_mac,
+            antenna_pattern_id,
+            report_timestamp);
+
+    // Set periodic advertising event counter of the packet with the CTE.
+    iq_raw_samples->event_counter = report->per_evt_counter;
+}
+#endif
+
 void iq_data_init(
         struct iq_data *iq_data,
         const struct iq_raw_samples *iq_raw_samples) {
@@ -74,6 +144,12 @@ void iq_data_init(
     // little-endian format (protocol/reversed octet order).
     memcpy(iq_data->beacon_mac, iq_raw_samples->beacon_mac, BT_ADDR_SIZE);
 
+    // Set antenna pattern of the CTE.
+    iq_data->antenna_pattern_id = iq_raw_samples->antenna_pattern_id;
+
+    // Set interval between samples in the measurement period.
+    iq_data->measurement_spacing = iq_raw_samples->measurement_spacing;
+
     static const int MAXIMUM_SAMPLES = IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX;
     uint8_t sample_count = iq_raw_samples->sample_count;
     if (sample_count > MAXIMUM_SAMPLES) {
@@ -124,7 +200,7 @@ void iq_data_init(
 // rotating every other reference sample by 180 degrees.
 // The iq_data argument must be a pointer to an initialized IQ data structure.
 // See the iq_data_init() function.
-static void iq_data_temp_fix_ref_samples(struct iq_data *iq_data) {
+void iq_data_temp_fix_ref_samples(struct iq_data *iq_data) {
     if (!iq_data || !iq_data->initialized) {
         return;
     }
@@ -150,7 +226,7 @@ static void iq_data_temp_fix_ref_samples(struct iq_data *iq_data) {
 // Populates reference_phases[] with phase angles in radians.
 // The iq_data argument must be a pointer to an initialized IQ data structure.
 // See the iq_data_init() function.
-static void calculate_reference_phases(struct iq_data *iq_data) {
+void iq_data_calculate_reference_phases(struct iq_data *iq_data) {
     if (!iq_data || !iq_data->initialized) {
         return;
     }
@@ -191,8 +267,8 @@ static void calculate_measurement_phases(struct iq_data *iq_data) {
 // The iq_data argument must be a pointer to an initialized IQ data structure.
 // See the iq_data_init() function.
 // iq_data->reference_phases[] must be populated.
-// See the calculate_reference_phases() function.
-static void unwrap_reference_phases(struct iq_data *iq_data) {
+// See the iq_data_calculate_reference_phases() function.
+void iq_data_unwrap_reference_phases(struct iq_data *iq_data) {
     if (!iq_data || !iq_data->initialized) {
         return;
     }
@@ -233,7 +309,7 @@ static void unwrap_reference_phases(struct iq_data *iq_data) {
 // unwrapped phase angles.
 // The iq_data argument must be a pointer to an initialized IQ data structure.
 // See the iq_data_init() function.
-static void estimate_linear_phase_drift_rate(struct iq_data *iq_data) {
+void iq_data_estimate_linear_phase_drift_rate(struct iq_data *iq_data) {
     if (!iq_data || !iq_data->initialized) {
         return;
     }
@@ -245,11 +321,11 @@ static void estimate_linear_phase_drift_rate(struct iq_data *iq_data) {
 
     // Calculate reference phases and populate reference_phases[] with phase
     // angles in radians.
-    calculate_reference_phases(iq_data);
+    iq_data_calculate_reference_phases(iq_data);
 
     // Unwrap reference phases and populate reference_phases_unwrapped[] with
     // unwrapped phase angles.
-    unwrap_reference_phases(iq_data);
+    iq_data_unwrap_reference_phases(iq_data);
 
     if (iq_data->reference_sample_count == 1) {
         iq_data->linear_phase_drift_rate = 0.0f;
@@ -292,8 +368,8 @@ static void estimate_linear_phase_drift_rate(struct iq_data *iq_data) {
 // The iq_data argument must be a pointer to an initialized IQ data structure.
 // See the iq_data_init() function.
 // iq_data->linear_phase_drift_rate must be set.
-// See the estimate_linear_phase_drift_rate() function.
-static void compensate_measurement_samples(struct iq_data *iq_data) {
+// See the iq_data_estimate_linear_phase_drift_rate() function.
+void iq_data_compensate_measurement_samples(struct iq_data *iq_data) {
     if (!iq_data || !iq_data->initialized) {
         return;
     }
@@ -302,8 +378,9 @@ static void compensate_measurement_samples(struct iq_data *iq_data) {
     // <=>
     // -(radians / microsecond ) * (microseconds / measurement sample)
     // ~>
-    // -linear_phase_drift_rate * IQ_MEASUREMENT_SPACING
-    float rate = -iq_data->linear_phase_drift_rate * IQ_MEASUREMENT_SPACING;
+    // -linear_phase_drift_rate * measurement_spacing
+    float rate = -iq_data->linear_phase_drift_rate *
+            iq_data->measurement_spacing;
     for (int i = 0; i < iq_data->measurement_sample_count; i++) {
         float theta = rate * i;
         float cos_theta = cosf(theta);
@@ -327,7 +404,7 @@ static void compensate_measurement_samples(struct iq_data *iq_data) {
 // See the iq_data_init() function.
 // measurement_i_compensated[] and measurement_q_compensated[] must be
 // populated.
-// See the compensate_measurement_samples() function.
+// See the iq_data_compensate_measurement_samples() function.
 static void calculate_compensated_measurement_phases(struct iq_data *iq_data) {
     if (!iq_data || !iq_data->initialized) {
         return;
@@ -345,7 +422,8 @@ static void calculate_compensated_measurement_phases(struct iq_data *iq_data) {
 }
 
 // Estimate local direction cosines, azimuth, and elevation for an IQ data
-// structure. Single row antenna pattern.
+// structure. Any antenna pattern with orthogonally adjacent antennas in
+// consecutive sample slots, see the chw1010_ant2_pattern enum.
 // Uses interferometry on compensated measurement samples.
 // Sets local_direction_cosine_x, local_direction_cosine_y, and
 // local_direction_cosine_z in the range [0, 1].
@@ -355,19 +433,19 @@ static void calculate_compensated_measurement_phases(struct iq_data *iq_data) {
 // iq_data->measurement_i_compensated[] and iq_data->measurement_q_compensated[]
 // must be populated with measurement samples compensated at a linear phase
 // drift rate.
-// See the compensate_measurement_samples() function.
-static void iq_data_aod_row_interferometry(struct iq_data *iq_data) {
+// See the iq_data_compensate_measurement_samples() function.
+void iq_data_aod_interferometry(struct iq_data *iq_data) {
     if (!iq_data || !iq_data->initialized) {
         return;
     }
 
-    // CoreHW CHW1010-ANT2-1.1 antenna grid for an antenna row:
+    // CoreHW CHW1010-ANT2-1.1 antenna grid:
     //  +----+----+----+----+
-    //  |    |    |    |    |
+    //  | 13 | 12 | 11 |  9 |
     //  +----+----+----+----+
-    //  |    |    |    |    |
+    //  | 14 | 15 | 10 |  8 |
     //  +----+----+----+----+
-    //  |    |    |    |    |
+    //  |  1 |  0 |  5 |  7 |
     //  +----+----+----+----+
     //  |  2 |  3 |  4 |  6 |
     //  +----+----+----+----+
@@ -404,80 +482,31 @@ static void iq_data_aod_row_interferometry(struct iq_data *iq_data) {
     // (Alt.) Azimuth is the angle in the XY-plane with respect to the X-axis.
     // (Alt.) Elevation is the angle from the XY-plane toward the Z-axis.
 
-    //float *phases = iq_data->measurement_phases_compensated;
-
-    // Antenna switching sequence for 37 measurement samples.
-    // This is for the default sample spacing of 4 microseconds where CTEType
-    // field value is 2 for "AoD Constant Tone Extension with 2 μs slots".
-    // antenna_switching_sequence[i] maps measurement index i to the antenna
-    // number stored in antenna_switching_sequence[i].
-    // For example, phases[4] was sampled from antenna 3, because
-    // antenna_switching_sequence[4] = 3.
-    static const uint8_t antenna_switching_sequence[37] = {
-        3,  4,  6,  2,  3,  4,  6,  2,  3,  4,
-        6,  2,  3,  4,  6,  2,  3,  4,  6,  2,
-        3,  4,  6,  2,  3,  4,  6,  2,  3,  4,
-        6,  2,  3,  4,  6,  2,  3
-   };
-    /* SWITCHPATTERN list, for reference, copied from beacon main.c:
-     * 
-     * SWITCHPATTERN[0]  = 0x0,  radio.dfe-pdu-antenna,  idle period (PDU Tx/Rx).
-     * SWITCHPATTERN[1]  = 0x2,  ant_patterns[0],        guard and reference period.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],         1st sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],         2nd sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],         3rd sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],         4th sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],         5th sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],         6th sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],         7th sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],         8th sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],         9th sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],        10th sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],        11th sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],        12th sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],        13th sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],        14th sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],        15th sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],        16th sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],        17th sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],        18th sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],        19th sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],        20th sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],        21st sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],        22nd sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],        23rd sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],        24th sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],        25th sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],        26th sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],        27th sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],        28th sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],        29th sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],        30th sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],        31st sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],        32nd sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],        33rd sample slot.
-     * SWITCHPATTERN[3]  = 0x4,  ant_patterns[2],        34th sample slot.
-     * SWITCHPATTERN[4]  = 0x6,  ant_patterns[3],        35th sample slot.
-     * SWITCHPATTERN[5]  = 0x2,  ant_patterns[0],        36th sample slot.
-     * SWITCHPATTERN[2]  = 0x3,  ant_patterns[1],        37th sample slot.
-     */
-
-    // Selected measurement index pairs for interferometry.
-    // These numbers are measurement indices, not antenna numbers. This sequence
-    // of index pairs is a repeating row pattern on the CoreHW CHW1010-ANT2-1.1
-    // antenna grid. This row pattern ensures temporally adjacent measurements
-    // of physically adjacent antennas. Measurement phases have been compensated
-    // for an estimated linear phase drift, but some residual phase drift may
-    // still remain in the compensated measurements. This row pattern aims to
-    // minimize the effect of residual phase drift on the calculations by only
-    // allowing temporally adjacent measurement pairs. Of the 27 selected pairs,
-    // 0 pairs are vertically adjacent (bottom to top, top to bottom), and 27
-    // pairs are horizontally adjacent (left to right, right to left).
-    // For example, phases[19] and phases[20] make a valid pair, where
-    // phases[19] (antenna 2) is to the left of phases[20] (antenna 3).
-    // The pair encoding {19, 20, 0} is mathematically equivalent to {20, 19, 1}
-    // when computing the phase delta. Both pair encodings represent the same
-    // physical relationship.
+    // Measurement index pairs for interferometry.
+    // The antenna of each measurement sample follows from the antenna
+    // switching pattern of the CTE, see the chw1010_ant2_measurement_antenna()
+    // function. For example, with the full antenna pattern, measurement sample
+    // i was sampled from antenna (i + 1) % 16, and with the row pattern,
+    // measurement samples were sampled from antennas 3, 4, 6, 2, 3, 4, 6, ...
+    // Only temporally adjacent measurement samples of orthogonally adjacent
+    // antennas are paired. Measurement phases have been compensated for an
+    // estimated linear phase drift, but some residual phase drift may still
+    // remain in the compensated measurements. Pairing only temporally adjacent
+    // measurements aims to minimize the effect of residual phase drift on the
+    // calculations. The pairs follow from the antenna pattern and the
+    // measurement sample count alone, so any CTE length and sample slot
+    // duration with at least 3 measurement samples gives a direction, but the
+    // pairs of a short CTE may only cover one axis, as with the first 3
+    // measurement samples of the outer pattern. The full, row, column, and
+    // outer patterns are checked with both sample slot durations, see
+    // host/golden/check_patterns.sh. With the full antenna pattern, this gives a
+    // snake pattern on the CoreHW CHW1010-ANT2-1.1 antenna grid, with the outer
+    // pattern a ring, and with the row and column patterns only horizontally
+    // and only vertically adjacent pairs, respectively.
+    // For example, with the full antenna pattern, measurements 26 and 27 make
+    // a valid pair, where measurement 26 (antenna 11) is to the right of
+    // measurement 27 (antenna 12). Measurements 4 and 5 do not make a valid
+    // pair, since antennas 5 and 6 are diagonally adjacent.
     // The sign convention for phase delta is positive X and positive Y:
     // delta = phases[left antenna] - phases[right antenna], where a positive
     // phase delta means that the AoD locator is to the right of the origin in
@@ -485,56 +514,8 @@ static void iq_data_aod_row_interferometry(struct iq_data *iq_data) {
     // delta = phases[bottom antenna] - phases[top antenna], where a positive
     // phase delta means the AoD locator is above the origin in the AoD beacon
     // coordinate system.
-    // Pair direction encoding:
-    // 0 = left to right
-    // 1 = right to left
-    // 2 = bottom to top
-    // 3 = top to bottom
-    static const struct {
-        uint8_t index_1;
-        uint8_t index_2;
-        uint8_t direction;
-    } measurement_pairs[27] = {
-        { 0,  1, 0}, // left to right, antennas (3, 4).
-        { 1,  2, 0}, // left to right, antennas (4, 6).
-
-        { 3,  4, 0}, // left to right, antennas (2, 3).
-        { 4,  5, 0}, // left to right, antennas (3, 4).
-        { 5,  6, 0}, // left to right, antennas (4, 6).
-
-        { 7,  8, 0}, // left to right, antennas (2, 3).
-        { 8,  9, 0}, // left to right, antennas (3, 4).
-        { 9, 10, 0}, // left to right, antennas (4, 6).
-
-        {11, 12, 0}, // left to right, antennas (2, 3).
-        {12, 13, 0}, // left to right, antennas (3, 4).
-        {13, 14, 0}, // left to right, antennas (4, 6).
-
-        {15, 16, 0}, // left to right, antennas (2, 3).
-        {16, 17, 0}, // left to right, antennas (3, 4).
-        {17, 18, 0}, // left to right, antennas (4, 6).
-
-        {19, 20, 0}, // left to right, antennas (2, 3).
-        {20, 21, 0}, // left to right, antennas (3, 4).
-        {21, 22, 0}, // left to right, antennas (4, 6).
-
-        {23, 24, 0}, // left to right, antennas (2, 3).
-        {24, 25, 0}, // left to right, antennas (3, 4).
-        {25, 26, 0}, // left to right, antennas (4, 6).
-
-        {27, 28, 0}, // left to right, antennas (2, 3).
-        {28, 29, 0}, // left to right, antennas (3, 4).
-        {29, 30, 0}, // left to right, antennas (4, 6).
-
-        {31, 32, 0}, // left to right, antennas (2, 3).
-        {32, 33, 0}, // left to right, antennas (3, 4).
-        {33, 34, 0}, // left to right, antennas (4, 6).
-
-        {35, 36, 0}  // left to right, antennas (2, 3).
-    };
-
-    static const int measurement_pairs_length =
-            sizeof(measurement_pairs) / sizeof(measurement_pairs[0]);
+    // See the chw1010_ant2_pair_direction enum.
+    uint8_t antenna_pattern_id = iq_data->antenna_pattern_id;
 
     uint8_t measurement_sample_count = iq_data->measurement_sample_count;
     if (measurement_sample_count < 3) {
@@ -543,6 +524,7 @@ static void iq_data_aod_row_interferometry(struct iq_data *iq_data) {
         iq_data->local_direction_cosine_z = 1.0f;
         iq_data->aod_azimuth = 0.0f;
         iq_data->aod_elevation = 0.0f;
+        iq_data->aod_quality = 0.0f;
         return;
     }
 
@@ -572,13 +554,16 @@ static void iq_data_aod_row_interferometry(struct iq_data *iq_data) {
     // d_orth_rad = 0.051181 rad/mm * 37.5mm = 1.91928750 rad.
     float d_orth_rad = channel_wavenumber * antenna_spacing_orthogonal;
 
-    // By default, the interval between samples in the measurement period is 4
-    // microseconds and the CTE frequency is 250 kilohertz. This is exactly 1
-    // CTE cycle because (0.25 * 1000000) * (4 / 1000000) = 1. It is effectively
-    // as if all 37 measurement samples are taken at the same time. If the
-    // measurement samples are compensated for systematic linear phase drift,
-    // then any remaining phase differences must be due to signal direction and
-    // antenna positions. This enables conventional interferometry using first
+    // With 2 μs slots, the interval between samples in the measurement period
+    // is 4 microseconds and the CTE frequency is 250 kilohertz. This is exactly
+    // 1 CTE cycle because (0.25 * 1000000) * (4 / 1000000) = 1. It is
+    // effectively as if all measurement samples are taken at the same time.
+    // With 1 μs slots, the interval is 2 microseconds, and the intersample
+    // phase shift of the reference period (180 degrees per microsecond, see
+    // the iq_data_temp_fix_ref_samples() function) is again a whole number of
+    // cycles. If the measurement samples are compensated for systematic linear
+    // phase drift, then any remaining phase differences must be due to signal
+    // direction and antenna positions. This enables conventional interferometry using first
     // differences, Delta(φ)[m] = φ[m] - φ[m-1], effectively emulating the
     // behavior of a conventional interferometer array.
 
@@ -625,22 +610,33 @@ static void iq_data_aod_row_interferometry(struct iq_data *iq_data) {
     // Delta(φ)[m] = φ[m] - φ[m-1]
     float delta;
 
-    float horizontal_deltas[measurement_pairs_length];
+    float horizontal_deltas[IQ_MEASUREMENT_MAX];
     int horizontal_count = 0;
     float horizontal_mean = 0.0f;
 
-    float vertical_deltas[measurement_pairs_length];
+    float vertical_deltas[IQ_MEASUREMENT_MAX];
     int vertical_count = 0;
     float vertical_mean = 0.0f;
 
-    for (int i = 0; i < measurement_pairs_length; i++) {
-        uint8_t index_1 = measurement_pairs[i].index_1;
-        uint8_t index_2 = measurement_pairs[i].index_2;
-        uint8_t direction = measurement_pairs[i].direction;
+    for (int i = 0; i + 1 < measurement_sample_count; i++) {
+        int index_1 = i;
+        int index_2 = i + 1;
+
+        int antenna_1 = chw1010_ant2_measurement_antenna(
+                antenna_pattern_id,
+                index_1);
+        int antenna_2 = chw1010_ant2_measurement_antenna(
+                antenna_pattern_id,
+                index_2);
+        if (antenna_1 < 0 || antenna_2 < 0) {
+            continue;
+        }
 
-        // Check if indices are out of bounds.
-        if (index_1 >= measurement_sample_count ||
-                index_2 >= measurement_sample_count) {
+        // Skip pairs of antennas that are not orthogonally adjacent.
+        int direction = chw1010_ant2_pair_direction(
+                (uint8_t)antenna_1,
+                (uint8_t)antenna_2);
+        if (direction < 0) {
             continue;
         }
 
@@ -676,19 +672,19 @@ static void iq_data_aod_row_interferometry(struct iq_data *iq_data) {
         // 2 = bottom to top
         // 3 = top to bottom
         switch (direction) {
-            case 0:
+            case CHW1010_ANT2_PAIR_LEFT_TO_RIGHT:
                 horizontal_deltas[horizontal_count] = delta;
                 horizontal_count = horizontal_count + 1;
                 break;
-            case 1:
+            case CHW1010_ANT2_PAIR_RIGHT_TO_LEFT:
                 horizontal_deltas[horizontal_count] = -delta;
                 horizontal_count = horizontal_count + 1;
                 break;
-            case 2:
+            case CHW1010_ANT2_PAIR_BOTTOM_TO_TOP:
                 vertical_deltas[vertical_count] = delta;
                 vertical_count = vertical_count + 1;
                 break;
-            case 3:
+            case CHW1010_ANT2_PAIR_TOP_TO_BOTTOM:
                 vertical_deltas[vertical_count] = -delta;
                 vertical_count = vertical_count + 1;
                 break;
@@ -713,420 +709,24 @@ static void iq_data_aod_row_interferometry(struct iq_data *iq_data) {
                 0.01);
     }
 
-    float direction_cosine_x = 0.0f;
-    if (horizontal_count > 0) {
-        direction_cosine_x = -horizontal_mean / d_orth_rad;
-
-        // Clamp to [-1, 1].
-        if (direction_cosine_x > 1.0f) {
-            direction_cosine_x = 1.0f;
-        }
-        if (direction_cosine_x < -1.0f) {
-            direction_cosine_x = -1.0f;
-        }
-    }
-
-    float direction_cosine_y = 0.0f;
-    if (vertical_count > 0) {
-        direction_cosine_y = -vertical_mean / d_orth_rad;
-
-        // Clamp to [-1, 1].
-        if (direction_cosine_y > 1.0f) {
-            direction_cosine_y = 1.0f;
-        }
-        if (direction_cosine_y < -1.0f) {
-            direction_cosine_y = -1.0f;
-        }
-    }
-
-    // Calculate direction_cosine_z from the direction cosine relationship
-    // cos^2(θx) + cos^2(θy) + cos^2(θz) = 1
-    float direction_cosine_z_squared = 1.0f - (
-            direction_cosine_x*direction_cosine_x +
-            direction_cosine_y*direction_cosine_y);
-
-    if (direction_cosine_z_squared < 0.0f) {
-        direction_cosine_z_squared = 0.0f;
-    }
-
-    float direction_cosine_z = sqrtf(direction_cosine_z_squared);
-
-    iq_data->local_direction_cosine_x = direction_cosine_x;
-    iq_data->local_direction_cosine_y = direction_cosine_y;
-    iq_data->local_direction_cosine_z = direction_cosine_z;
-
-    iq_data->aod_azimuth = atan2f(direction_cosine_x, direction_cosine_z);
-    iq_data->aod_elevation = asinf(direction_cosine_y);
-
-    // TODO(wathne): Remove this line.
-    printk("azimuth:   %.2f\n", iq_data->aod_azimuth);
-    // TODO(wathne): Remove this line.
-    printk("elevation: %.2f\n", iq_data->aod_elevation);
-}
-
-// Estimate local direction cosines, azimuth, and elevation for an IQ data
-// structure. Full antenna pattern.
-// Uses interferometry on compensated measurement samples.
-// Sets local_direction_cosine_x, local_direction_cosine_y, and
-// local_direction_cosine_z in the range [0, 1].
-// Sets aod_azimuth and aod_elevation in radians.
-// The iq_data argument must be a pointer to an initialized IQ data structure.
-// See the iq_data_init() function.
-// iq_data->measurement_i_compensated[] and iq_data->measurement_q_compensated[]
-// must be populated with measurement samples compensated at a linear phase
-// drift rate.
-// See the compensate_measurement_samples() function.
-static void iq_data_aod_interferometry(struct iq_data *iq_data) {
-    if (!iq_data || !iq_data->initialized) {
-        return;
-    }
-
-    // CoreHW CHW1010-ANT2-1.1 antenna grid:
-    //  +----+----+----+----+
-    //  | 13 | 12 | 11 |  9 |
-    //  +----+----+----+----+
-    //  | 14 | 15 | 10 |  8 |
-    //  +----+----+----+----+
-    //  |  1 |  0 |  5 |  7 |
-    //  +----+----+----+----+
-    //  |  2 |  3 |  4 |  6 |
-    //  +----+----+----+----+
-
-    // CoreHW CHW1010-ANT2-1.1 antenna coordinate system:
-    //            Y
-    //            |
-    //    13   12 | 11    9
-    //            |
-    //    14   15 | 10    8
-    //            +------------ X
-    //     1    0    5    7
-    //
-    //     2    3    4    6
-    //
-    // Right-handed Cartesian (x, y, z) coordinate system.
-    // X-axis: Points rightward when facing the array.
-    // Y-axis: Points upward when facing the array.
-    // Z-axis: Points outward from the array toward the locator.
-    // Origin (0, 0, 0) is at the center of the array.
-    // 
-    // Azimuth is the angle in the XZ-plane with respect to the Z-axis.
-    //   - Positive when the locator is to the right of the array (x > 0).
-    //   - Negative when the locator is to the left of the array (x < 0).
-    //   - Range is [-pi, pi].
-    // Elevation is the angle from the XZ-plane toward the Y-axis.
-    //   - Positive when the locator is above the XZ-plane (y > 0).
-    //   - Negative when the locator is below the XZ-plane (y < 0).
-    //   - Range is [-pi/2, pi/2].
-    //
-    // The above definition for Azimuth and Elevation is intuitive and
-    // conventional, but note that many BLE direction finding references may use
-    // an alternative convention:
-    // (Alt.) Azimuth is the angle in the XY-plane with respect to the X-axis.
-    // (Alt.) Elevation is the angle from the XY-plane toward the Z-axis.
-
-    //float *phases = iq_data->measurement_phases_compensated;
-
-    // Antenna switching sequence for 37 measurement samples.
-    // This is for the default sample spacing of 4 microseconds where CTEType
-    // field value is 2 for "AoD Constant Tone Extension with 2 μs slots".
-    // antenna_switching_sequence[i] maps measurement index i to the antenna
-    // number stored in antenna_switching_sequence[i].
-    // For example, phases[4] was sampled from antenna 5, because
-    // antenna_switching_sequence[4] = 5.
-    static const uint8_t antenna_switching_sequence[37] = {
-         1,  2,  3,  4,  5,  6,  7,  8,  9, 10,
-        11, 12, 13, 14, 15,  0,  1,  2,  3,  4,
-         5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-        15,  0,  1,  2,  3,  4,  5
-    };
-    /* SWITCHPATTERN list, for reference, copied from beacon main.c:
-     * 
-     * SWITCHPATTERN[0]  = 0x0,  radio.dfe-pdu-antenna,  idle period (PDU Tx/Rx).
-     * SWITCHPATTERN[1]  = 0x0,  ant_patterns[0],        guard and reference period.
-     * SWITCHPATTERN[2]  = 0x1,  ant_patterns[1],         1st sample slot.
-     * SWITCHPATTERN[3]  = 0x2,  ant_patterns[2],         2nd sample slot.
-     * SWITCHPATTERN[4]  = 0x3,  ant_patterns[3],         3rd sample slot.
-     * SWITCHPATTERN[5]  = 0x4,  ant_patterns[4],         4th sample slot.
-     * SWITCHPATTERN[6]  = 0x5,  ant_patterns[5],         5th sample slot.
-     * SWITCHPATTERN[7]  = 0x6,  ant_patterns[6],         6th sample slot.
-     * SWITCHPATTERN[8]  = 0x7,  ant_patterns[7],         7th sample slot.
-     * SWITCHPATTERN[9]  = 0x8,  ant_patterns[8],         8th sample slot.
-     * SWITCHPATTERN[10] = 0x9,  ant_patterns[9],         9th sample slot.
-     * SWITCHPATTERN[11] = 0xA,  ant_patterns[10],       10th sample slot.
-     * SWITCHPATTERN[12] = 0xB,  ant_patterns[11],       11th sample slot.
-     * SWITCHPATTERN[13] = 0xC,  ant_patterns[12],       12th sample slot.
-     * SWITCHPATTERN[14] = 0xD,  ant_patterns[13],       13th sample slot.
-     * SWITCHPATTERN[15] = 0xE,  ant_patterns[14],       14th sample slot.
-     * SWITCHPATTERN[16] = 0xF,  ant_patterns[15],       15th sample slot.
-     * SWITCHPATTERN[17] = 0x0,  ant_patterns[0],        16th sample slot.
-     * SWITCHPATTERN[2]  = 0x1,  ant_patterns[1],        17th sample slot.
-     * SWITCHPATTERN[3]  = 0x2,  ant_patterns[2],        18th sample slot.
-     * SWITCHPATTERN[4]  = 0x3,  ant_patterns[3],        19th sample slot.
-     * SWITCHPATTERN[5]  = 0x4,  ant_patterns[4],        20th sample slot.
-     * SWITCHPATTERN[6]  = 0x5,  ant_patterns[5],        21st sample slot.
-     * SWITCHPATTERN[7]  = 0x6,  ant_patterns[6],        22nd sample slot.
-     * SWITCHPATTERN[8]  = 0x7,  ant_patterns[7],        23rd sample slot.
-     * SWITCHPATTERN[9]  = 0x8,  ant_patterns[8],        24th sample slot.
-     * SWITCHPATTERN[10] = 0x9,  ant_patterns[9],        25th sample slot.
-     * SWITCHPATTERN[11] = 0xA,  ant_patterns[10],       26th sample slot.
-     * SWITCHPATTERN[12] = 0xB,  ant_patterns[11],       27th sample slot.
-     * SWITCHPATTERN[13] = 0xC,  ant_patterns[12],       28th sample slot.
-     * SWITCHPATTERN[14] = 0xD,  ant_patterns[13],       29th sample slot.
-     * SWITCHPATTERN[15] = 0xE,  ant_patterns[14],       30th sample slot.
-     * SWITCHPATTERN[16] = 0xF,  ant_patterns[15],       31st sample slot.
-     * SWITCHPATTERN[17] = 0x0,  ant_patterns[0],        32nd sample slot.
-     * SWITCHPATTERN[2]  = 0x1,  ant_patterns[1],        33rd sample slot.
-     * SWITCHPATTERN[3]  = 0x2,  ant_patterns[2],        34th sample slot.
-     * SWITCHPATTERN[4]  = 0x3,  ant_patterns[3],        35th sample slot.
-     * SWITCHPATTERN[5]  = 0x4,  ant_patterns[4],        36th sample slot.
-     * SWITCHPATTERN[6]  = 0x5,  ant_patterns[5],        37th sample slot.
-     */
-
-    // Selected measurement index pairs for interferometry.
-    // These numbers are measurement indices, not antenna numbers. This sequence
-    // of index pairs resembles a snake pattern on the CoreHW CHW1010-ANT2-1.1
-    // antenna grid. This snake pattern ensures temporally adjacent measurements
-    // of physically adjacent antennas. Measurement phases have been compensated
-    // for an estimated linear phase drift, but some residual phase drift may
-    // still remain in the compensated measurements. This snake pattern aims to
-    // minimize the effect of residual phase drift on the calculations by only
-    // allowing temporally adjacent measurement pairs. Of the 32 selected pairs,
-    // 18 pairs are vertically adjacent (bottom to top, top to bottom), and 14
-    // pairs are horizontally adjacent (left to right, right to left).
-    // For example, phases[26] and phases[27] make a valid pair, where
-    // phases[26] (antenna 11) is to the right of phases[27] (antenna 12).
-    // The pair encoding {26, 27, 1} is mathematically equivalent to {27, 26, 0}
-    // when computing the phase delta. Both pair encodings represent the same
-    // physical relationship.
-    // The sign convention for phase delta is positive X and positive Y:
-    // delta = phases[left antenna] - phases[right antenna], where a positive
-    // phase delta means that the AoD locator is to the right of the origin in
-    // the AoD beacon coordinate system.
-    // delta = phases[bottom antenna] - phases[top antenna], where a positive
-    // phase delta means the AoD locator is above the origin in the AoD beacon
-    // coordinate system.
-    // Pair direction encoding:
-    // 0 = left to right
-    // 1 = right to left
-    // 2 = bottom to top
-    // 3 = top to bottom
-    static const struct {
-        uint8_t index_1;
-        uint8_t index_2;
-        uint8_t direction;
-    } measurement_pairs[32] = {
-        { 0,  1, 3}, // top to bottom, antennas ( 1,  2).
-        { 1,  2, 0}, // left to right, antennas ( 2,  3).
-        { 2,  3, 0}, // left to right, antennas ( 3,  4).
-        { 3,  4, 2}, // bottom to top, antennas ( 4,  5).
-        { 5,  6, 2}, // bottom to top, antennas ( 6,  7).
-        { 6,  7, 2}, // bottom to top, antennas ( 7,  8).
-        { 7,  8, 2}, // bottom to top, antennas ( 8,  9).
-        { 9, 10, 2}, // bottom to top, antennas (10, 11).
-        {10, 11, 1}, // right to left, antennas (11, 12).
-        {11, 12, 1}, // right to left, antennas (12, 13).
-        {12, 13, 3}, // top to bottom, antennas (13, 14).
-        {13, 14, 0}, // left to right, antennas (14, 15).
-        {14, 15, 3}, // top to bottom, antennas (15,  0).
-        {15, 16, 1}, // right to left, antennas ( 0,  1).
-        {16, 17, 3}, // top to bottom, antennas ( 1,  2).
-        {17, 18, 0}, // left to right, antennas ( 2,  3).
-        {18, 19, 0}, // left to right, antennas ( 3,  4).
-        {19, 20, 2}, // bottom to top, antennas ( 4,  5).
-        {21, 22, 2}, // bottom to top, antennas ( 6,  7).
-        {22, 23, 2}, // bottom to top, antennas ( 7,  8).
-        {23, 24, 2}, // bottom to top, antennas ( 8,  9).
-        {25, 26, 2}, // bottom to top, antennas (10, 11).
-        {26, 27, 1}, // right to left, antennas (11, 12).
-        {27, 28, 1}, // right to left, antennas (12, 13).
-        {28, 29, 3}, // top to bottom, antennas (13, 14).
-        {29, 30, 0}, // left to right, antennas (14, 15).
-        {30, 31, 3}, // top to bottom, antennas (15,  0).
-        {31, 32, 1}, // right to left, antennas ( 0,  1).
-        {32, 33, 3}, // top to bottom, antennas ( 1,  2).
-        {33, 34, 0}, // left to right, antennas ( 2,  3).
-        {34, 35, 0}, // left to right, antennas ( 3,  4).
-        {35, 36, 2}  // bottom to top, antennas ( 4,  5).
-    };
-
-    static const int measurement_pairs_length =
-            sizeof(measurement_pairs) / sizeof(measurement_pairs[0]);
-
-    uint8_t measurement_sample_count = iq_data->measurement_sample_count;
-    if (measurement_sample_count < 3) {
-        iq_data->local_direction_cosine_x = 0.0f;
-        iq_data->local_direction_cosine_y = 0.0f;
-        iq_data->local_direction_cosine_z = 1.0f;
-        iq_data->aod_azimuth = 0.0f;
-        iq_data->aod_elevation = 0.0f;
-        return;
-    }
-
-    // BLE channels 0-36 are secondary advertising channels.
-    // BLE channels 37-39 are primary advertising channels.
-    uint8_t channel_index = iq_data->channel_index;
-
-    // BLE channel frequency in MHz.
-    uint16_t channel_frequency = ble_channel_get_frequency(channel_index);
-
-    // BLE channel wavelength in millimeters.
-    // lambda = c/f, where c = 299792458 meters/second, and f is BLE channel
-    // frequency in MHz.
-    float channel_wavelength = ble_channel_get_wavelength(channel_index);
-
-    // BLE channel wavenumber in radians per millimeter.
-    // k = 2*pi/lambda, where pi = 3.1415926535897932384626433832795, and lambda
-    // is BLE channel wavelength in millimeters.
-    float channel_wavenumber = ble_channel_get_wavenumber(channel_index);
-
-    // CoreHW CHW1010-ANT2-1.1 antenna spacing for orthogonally adjacent
-    // antennas, from antenna center to antenna center, in radians, at the BLE
-    // channel frequency.
-    // BLE channel wavenumber multiplied by orthogonal antenna spacing.
-    // d_orth_rad = k * antenna_spacing_orthogonal, in radians.
-    // For BLE channel index 18 (2442 Mhz):
-    // d_orth_rad = 0.051181 rad/mm * 37.5mm = 1.91928750 rad.
-    float d_orth_rad = channel_wavenumber * antenna_spacing_orthogonal;
-
-    // By default, the interval between samples in the measurement period is 4
-    // microseconds and the CTE frequency is 250 kilohertz. This is exactly 1
-    // CTE cycle because (0.25 * 1000000) * (4 / 1000000) = 1. It is effectively
-    // as if all 37 measurement samples are taken at the same time. If the
-    // measurement samples are compensated for systematic linear phase drift,
-    // then any remaining phase differences must be due to signal direction and
-    // antenna positions. This enables conventional interferometry using first
-    // differences, Delta(φ)[m] = φ[m] - φ[m-1], effectively emulating the
-    // behavior of a conventional interferometer array.
-
-    // TODO(wathne): Explain that AoD and AoA calculations are symmetric.
-    // TODO(wathne): Explain how phase shifts at 250 kHz and 2.4 GHz are
-    // related.
-
-    // A note about the unit circle:
-    // In mathematics, the unit circle range is (-pi, pi], where negative pi
-    // is not included in the range. In the C math function atan2f(), the unit
-    // circle range is [-pi, pi], where negative pi is included in the range.
-    // Negative pi represents the case when the negative x-axis boundary
-    // (+/- pi) is approached from below. This design choice is presumably
-    // related to the limited precision of floating point numbers, and it
-    // provides continuity when crossing the boundary.
-
-    // The usual arithmetic mean is not appropriate for calculating the mean on
-    // a unit circle with range (-pi, pi] or range [-pi, pi]. To see how the
-    // arithmetic mean breaks down, consider the case where two angles, +0.9*pi
-    // and -0.9*pi, are clustered around the negative x-axis. Their circular
-    // mean is obviously +/- pi, which is exactly on the negative x-axis. Their
-    // arithmetic mean is 0, which is exactly on the positive x-axis. The
-    // arithmetic mean is 180 degrees off from the circular mean in this simple
-    // example. Another approach is clearly necessary. There are two main
-    // approaches for calculating a circular mean, either an extrinsic mean or
-    // an intrinsic mean. The extrinsic mean is the simplest approach.
-
-    // Extrinsic mean on a circle:
-    // Put the circle in the two-dimensional Euclidean space (R^2), mapping
-    // phase angles to (cos(φ), sin(φ)) coordinates. Calculate the average of
-    // the (cos(φ), sin(φ)) coordinates. This average will be a point inside the
-    // unit circle, but not on the unit circle itself. Finally, project the
-    // point onto the unit circle using the atan2f() function. This extrinsic
-    // mean is a good approximation of the true mean if the phase angles are
-    // clustered.
-
-    // Intrinsic mean on a circle:
-    // TODO(wathne): Explain intrinsic circular mean. For now, see
-    // "directional_statistics.h" and "directional_statistics.h".
-
-    // TODO(wathne): Add more documentation.
-
-    // First difference:
-    // Delta(φ)[m] = φ[m] - φ[m-1]
-    float delta;
-
-    float horizontal_deltas[measurement_pairs_length];
-    int horizontal_count = 0;
-    float horizontal_mean = 0.0f;
-
-    float vertical_deltas[measurement_pairs_length];
-    int vertical_count = 0;
-    float vertical_mean = 0.0f;
-
-    for (int i = 0; i < measurement_pairs_length; i++) {
-        uint8_t index_1 = measurement_pairs[i].index_1;
-        uint8_t index_2 = measurement_pairs[i].index_2;
-        uint8_t direction = measurement_pairs[i].direction;
-
-        // Check if indices are out of bounds.
-        if (index_1 >= measurement_sample_count ||
-                index_2 >= measurement_sample_count) {
-            continue;
-        }
-
-        float i1 = iq_data->measurement_i_compensated[index_1];
-        float q1 = iq_data->measurement_q_compensated[index_1];
-        float i2 = iq_data->measurement_i_compensated[index_2];
-        float q2 = iq_data->measurement_q_compensated[index_2];
-
-        float real_part = i1*i2 + q1*q2;
-        float imag_part = q1*i2 - i1*q2;
-
-        delta = atan2f(imag_part, real_part);
-
-        // TODO(wathne): Remove this limit? Allow more than theoretical max?
-        // Clamp delta if delta is greater than theoretical max, ~ 1.9 radians.
-        // For BLE channel index 18 (2442 Mhz):
-        // d_orth_rad = 0.051181 rad/mm * 37.5mm = 1.91928750 rad.
-        if (delta > d_orth_rad) {
-            // TODO(wathne): Remove this line.
-            printk("Pair %d {%d, %d, %d}: CLAMPING %.6f to %.6f\n",
-                    i, index_1, index_2, direction, delta, d_orth_rad);
-            delta = d_orth_rad;
-        } else if (delta < -d_orth_rad) {
-            // TODO(wathne): Remove this line.
-            printk("Pair %d {%d, %d, %d}: CLAMPING %.6f to %.6f\n",
-                    i, index_1, index_2, direction, delta, -d_orth_rad);
-            delta = -d_orth_rad;
-        }
-
-        // Pair direction decoding:
-        // 0 = left to right
-        // 1 = right to left
-        // 2 = bottom to top
-        // 3 = top to bottom
-        switch (direction) {
-            case 0:
-                horizontal_deltas[horizontal_count] = delta;
-                horizontal_count = horizontal_count + 1;
-                break;
-            case 1:
-                horizontal_deltas[horizontal_count] = -delta;
-                horizontal_count = horizontal_count + 1;
-                break;
-            case 2:
-                vertical_deltas[vertical_count] = delta;
-                vertical_count = vertical_count + 1;
-                break;
-            case 3:
-                vertical_deltas[vertical_count] = -delta;
-                vertical_count = vertical_count + 1;
-                break;
-        }
+    // Agreement between antenna pairs, as the product of the mean resultant
+    // lengths of the axes with pairs. The row and column patterns only have
+    // pairs on one axis, and the direction cosine of the other axis is left
+    // at 0. Without pairs on any axis, there is no agreement.
+    if (horizontal_count > 0 || vertical_count > 0) {
+        iq_data->aod_quality = 1.0f;
+    } else {
+        iq_data->aod_quality = 0.0f;
     }
-
-    // Search for the intrinsic circular mean for horizontal deltas.
     if (horizontal_count > 0) {
-        horizontal_mean = directional_statistics_circular_mean(
+        iq_data->aod_quality *= directional_statistics_mean_resultant_length(
                 horizontal_deltas,
-                horizontal_count,
-                5,
-                0.01);
+                horizontal_count);
     }
-
-    // Search for the intrinsic circular mean for vertical deltas.
     if (vertical_count > 0) {
-        vertical_mean = directional_statistics_circular_mean(
+        iq_data->aod_quality *= directional_statistics_mean_resultant_length(
                 vertical_deltas,
-                vertical_count,
-                5,
-                0.01);
+                vertical_count);
     }
 
     float direction_cosine_x = 0.0f;
@@ -1270,15 +870,13 @@ static void test_float_support(struct iq_data *iq_data) {
     }
 }
 
-// TODO(wathne): Make a better system. This is temporary.
-static struct iq_data previous_iq_data;
-static bool first_iteration = true;
-
-void iq_data_process(const struct iq_raw_samples *iq_raw_samples) {
-    struct iq_data iq_data;
-
+int iq_data_estimate_direction(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples) {
     // Initialize the IQ data structure from the raw IQ samples structure.
-    iq_data_init(&iq_data, iq_raw_samples);
+    AOD_TRACE_BEGIN("iq_init", iq_raw_samples->sample_count);
+    iq_data_init(iq_data, iq_raw_samples);
+    AOD_TRACE_END("iq_init", iq_data->measurement_sample_count);
 
     // TODO(wathne): Why is there a systematic intersample phase shift of 180
     // degrees between samples in the reference period? There is conflicting
@@ -1291,7 +889,9 @@ void iq_data_process(const struct iq_raw_samples *iq_raw_samples) {
     // that this seems to net good estimates for the systematic linear phase
     // drift if a temporary fix is applied to every other reference sample. This
     // issue should be revisited, but the temporary fix works for now.
-    iq_data_temp_fix_ref_samples(&iq_data);
+    AOD_TRACE_BEGIN("iq_ref_fix", iq_data->reference_sample_count);
+    iq_data_temp_fix_ref_samples(iq_data);
+    AOD_TRACE_END("iq_ref_fix", iq_data->reference_sample_count);
 
     // NOTE(wathne): Reference samples are not intended to be used directly in
     // Angle of Departure estimations. If we wanted to include the 8th (last)
@@ -1308,54 +908,126 @@ void iq_data_process(const struct iq_raw_samples *iq_raw_samples) {
     // Set linear_phase_drift_rate to the estimated rate of radians per
     // microsecond.
     // reference_phases[] and reference_phases_unwrapped[] are also populated.
-    estimate_linear_phase_drift_rate(&iq_data);
+    AOD_TRACE_BEGIN("iq_drift", iq_data->reference_sample_count);
+    iq_data_estimate_linear_phase_drift_rate(iq_data);
+    AOD_TRACE_END("iq_drift", iq_data->reference_sample_count);
 
     // Compensate for linear phase drift in measurement samples.
     // Populate measurement_i_compensated[] and measurement_q_compensated[] with
     // measurement samples compensated at the estimated linear phase drift rate.
-    compensate_measurement_samples(&iq_data);
+    AOD_TRACE_BEGIN("iq_compensate", iq_data->measurement_sample_count);
+    iq_data_compensate_measurement_samples(iq_data);
+    AOD_TRACE_END("iq_compensate", iq_data->measurement_sample_count);
 
     // Calculate compensated measurement phases.
     // Populate measurement_phases_compensated[] with measurement phase angles
     // compensated at the estimated linear phase drift rate.
-    //calculate_compensated_measurement_phases(&iq_data);
+    //calculate_compensated_measurement_phases(iq_data);
+
+    // Estimate local direction cosines, azimuth, and elevation, from the
+    // antenna pairs of the antenna pattern of the CTE.
+    if (iq_data->antenna_pattern_id >= CHW1010_ANT2_PATTERN_COUNT) {
+        AOD_DEBUG("DEBUG: antenna pattern %u not supported, skip\n",
+                iq_data->antenna_pattern_id);
+        return -ENOTSUP; // -134 ~ "Not supported".
+    }
+    AOD_TRACE_BEGIN("iq_interferometry", iq_data->antenna_pattern_id);
+    iq_data_aod_interferometry(iq_data);
+    // The quality of the estimated direction, in thousandths.
+    AOD_TRACE_END("iq_interferometry", iq_data->aod_quality * 1000.0f);
+
+    // Skip measurements without an estimated direction.
+    if (!(iq_data->aod_quality > 0.0f)) {
+        AOD_DEBUG("DEBUG: no direction, skip\n");
+        return -ENODATA; // -61 ~ "No data available".
+    }
 
-    // Estimate local direction cosines, azimuth, and elevation.
-    iq_data_aod_interferometry(&iq_data);
-    //iq_data_aod_row_interferometry(&iq_data);
+    return 0; // 0 ~ "Success".
+}
 
-    // TODO(wathne): Make a better system. This is temporary.
-    if (first_iteration) {
-        previous_iq_data = iq_data;
-        first_iteration = false;
-        return;
+int iq_data_update_locator(
+        const struct iq_data *iq_data,
+        struct locator *locator) {
+    int ret;
+
+    // In tracking mode, each measurement updates the tracker directly. There
+    // is no pairing of measurements from different beacons.
+    if (locator->mode == LOCATOR_MODE_TRACKING) {
+        AOD_TRACE_BEGIN("loc_solve", locator->mode);
+        ret = locator_update_tracker(
+                locator,
+                iq_data->beacon_mac,
+                iq_data->local_direction_cosine_x,
+                iq_data->local_direction_cosine_y,
+                iq_data->local_direction_cosine_z,
+                iq_data->report_timestamp);
+        AOD_TRACE_END("loc_solve", ret);
+        if (ret == -LOCATOR_TRACKER_ERROR_OUTLIER) {
+            AOD_DEBUG("DEBUG: tracker update fail, outlier\n");
+        } else if (ret != 0) {
+            AOD_DEBUG("DEBUG: tracker update fail\n");
+        }
+        return ret;
+    }
+
+    // In snapshot mode, each valid measurement updates the angle cache, and a
+    // position is estimated from the freshest angles of all beacons. In robust
+    // mode, a position is estimated from the recent angles of all beacons,
+    // and outlier angles are rejected.
+    AOD_TRACE_BEGIN("loc_angle", locator->mode);
+    ret = locator_put_angle(
+            locator,
+            iq_data->beacon_mac,
+            iq_data->local_direction_cosine_x,
+            iq_data->local_direction_cosine_y,
+            iq_data->local_direction_cosine_z,
+            iq_data->aod_quality,
+            iq_data->report_timestamp);
+    AOD_TRACE_END("loc_angle", ret);
+    if (ret != 0) {
+        AOD_DEBUG("DEBUG: angle cache fail\n");
+        return ret;
     }
 
-    // TODO(wathne): Make a better system. This is temporary.
-    int ret = bt_addr_mac_compare(
-            iq_data.beacon_mac,
-            previous_iq_data.beacon_mac);
-    if (ret == 1) {
-        printk("DEBUG: same mac, no pair\n");
+    AOD_TRACE_BEGIN("loc_solve", locator->mode);
+    if (locator->mode == LOCATOR_MODE_ROBUST) {
+        ret = locator_estimate_position_robust(
+                locator,
+                iq_data->report_timestamp,
+                NULL);
     } else {
-        printk("DEBUG: new mac, have pair\n");
-        ret = locator_estimate_position_from_skew_lines(
-            &g_locator,
-            previous_iq_data.beacon_mac,
-            previous_iq_data.local_direction_cosine_x,
-            previous_iq_data.local_direction_cosine_y,
-            previous_iq_data.local_direction_cosine_z,
-            iq_data.beacon_mac,
-            iq_data.local_direction_cosine_x,
-            iq_data.local_direction_cosine_y,
-            iq_data.local_direction_cosine_z);
-        if (ret == 0) {
-            printk("DEBUG: position success\n");
-        } else if (ret == -LOCATOR_ERROR_PARALLEL_LINES) {
-            printk("DEBUG: position fail, parallel lines\n");
-        } else {
-            printk("DEBUG: position fail\n");
-        }
-        previous_iq_data = iq_data;
+        ret = locator_estimate_position_from_angle_cache(
+                locator,
+                iq_data->report_timestamp,
+                NULL);
     }
+    AOD_TRACE_END("loc_solve", ret);
+    if (ret == 0) {
+        AOD_DEBUG("DEBUG: position success\n");
+    } else if (ret == -ENODATA) {
+        AOD_DEBUG("DEBUG: position fail, too few fresh angles\n");
+    } else if (ret == -LOCATOR_ERROR_PARALLEL_LINES) {
+        AOD_DEBUG("DEBUG: position fail, parallel lines\n");
+    } else if (ret == -ROBUST_LINE_INTERSECTION_ERROR_NO_CONSENSUS) {
+        AOD_DEBUG("DEBUG: position fail, no consensus\n");
+    } else {
+        AOD_DEBUG("DEBUG: position fail\n");
+    }
+    return ret;
+}
+
+void iq_data_process_locator(
+        const struct iq_raw_samples *iq_raw_samples,
+        struct locator *locator) {
+    struct iq_data iq_data;
+
+    if (iq_data_estimate_direction(&iq_data, iq_raw_samples) != 0) {
+        return;
+    }
+
+    (void)iq_data_update_locator(&iq_data, locator);
+}
+
+void iq_data_process(const struct iq_raw_samples *iq_raw_samples) {
+    iq_data_process_locator(iq_raw_samples, &g_locator);
 }
\ No newline at end of file
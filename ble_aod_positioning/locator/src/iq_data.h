@@ -2,42 +2,46 @@
 #define IQ_DATA_H
 
 #include <stdbool.h> // For bool.
-#include <stdint.h> // For uint8_t, int8_t, and int64_t.
-#include <zephyr/bluetooth/bluetooth.h> // For BLE advertising info structure.
+#include <stdint.h> // For uint8_t, int8_t, int16_t, and int64_t.
+#if defined(__ZEPHYR__)
 #include <zephyr/bluetooth/direction.h> // For BLE direction finding IQ samples report structure.
+#endif
 #include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "locator.h" // For locator structure.
 
 // TODO(wathne): Use sample16 instead of sample?
-// TODO(wathne): Use dynamic IQ sampling settings. See report and info.
 // TODO(wathne): Rename iq_raw_samples?
 
 // Raw IQ samples are separated into reference samples and measurement samples.
-// By default, each IQ samples report provides a total of 45 raw IQ samples. The
-// first 8 IQ samples are reference samples and the remaining 37 IQ samples are
-// measurement samples.
+// The first 8 IQ samples are reference samples and the remaining IQ samples are
+// measurement samples. The number of measurement samples depends on the CTE
+// length and the sample slot duration. A CTE of the maximum length (160 μs)
+// gives 37 measurement samples with 2 μs slots, and 74 measurement samples with
+// 1 μs slots.
 
 // "... the receiver shall take an IQ sample each microsecond during the
 // reference period and an IQ sample each sample slot (thus there will be 8
-// reference IQ samples, 1 to 37 IQ samples with 2 μs slots ..."
+// reference IQ samples, 1 to 37 IQ samples with 2 μs slots, and 2 to 74 IQ
+// samples with 1 μs slots)."
 // - Bluetooth Core Specification 5.4
 
 // Interval between samples in the reference period, in microseconds per
 // reference sample.
-// This constant must be set according to IQ sampling settings.
 #define IQ_REFERENCE_SPACING 1
 
 // Interval between samples in the measurement period, in microseconds per
-// measurement sample.
-// This constant must be set according to IQ sampling settings.
-#define IQ_MEASUREMENT_SPACING 4
+// measurement sample. Each sample slot follows a switch slot of the same
+// duration. See the measurement_spacing field of the raw IQ samples structure.
+#define IQ_MEASUREMENT_SPACING_1US_SLOTS 2
+#define IQ_MEASUREMENT_SPACING_2US_SLOTS 4
 
 // Maximium IQ reference sample count.
-// This constant must be set according to IQ sampling settings.
 #define IQ_REFERENCE_MAX 8
 
-// Maximium IQ measurement sample count.
-// This constant must be set according to IQ sampling settings.
-#define IQ_MEASUREMENT_MAX 37
+// Maximium IQ measurement sample count, for the maximum CTE length with 1 μs
+// slots. The controller samples 1 μs slots with
+// CONFIG_BT_CTLR_DF_CTE_RX_SAMPLE_1US, see sysbuild/ipc_radio/prj.conf.
+#define IQ_MEASUREMENT_MAX 74
 
 // Data pipeline:
 // IQ samples report -> raw IQ samples structure -> IQ data structure.
@@ -74,6 +78,33 @@ struct iq_raw_samples {
     // See the iq_raw_samples_init() function.
     uint8_t beacon_mac[BT_ADDR_SIZE];
 
+    // Antenna pattern of the CTE, from the sync context of the sync that
+    // delivered the report. See the chw1010_ant2_pattern enum.
+    // See the iq_raw_samples_init() function.
+    uint8_t antenna_pattern_id;
+
+    // RSSI of the packet with the CTE, in units of 0.1 dBm.
+    // See the iq_raw_samples_init() function.
+    int16_t rssi;
+
+    // Packet status of the packet with the CTE. BT_DF_CTE_CRC_OK (0) if the
+    // CRC of the packet is correct. See the bt_df_packet_status enum.
+    // See the iq_raw_samples_init() function.
+    uint8_t packet_status;
+
+    // Periodic advertising event counter of the packet with the CTE, for
+    // matching the report with the advertising event, see
+    // CONFIG_LOCATOR_TIMING_LOG. 0 if the structure is not initialized from an
+    // IQ samples report. Not part of IQ capture records.
+    // See the iq_raw_samples_init() function.
+    uint16_t event_counter;
+
+    // Interval between samples in the measurement period, in microseconds per
+    // measurement sample. IQ_MEASUREMENT_SPACING_1US_SLOTS or
+    // IQ_MEASUREMENT_SPACING_2US_SLOTS, from the CTE type of the report.
+    // See the iq_raw_samples_init() function.
+    uint8_t measurement_spacing;
+
     // Raw IQ sample count, constrained by maximum IQ sample count constants.
     // sample_count <= (IQ_REFERENCE_MAX + IQ_MEASUREMENT_MAX)
     // See the iq_raw_samples_init() function.
@@ -118,6 +149,15 @@ struct iq_data {
     // See the iq_data_init() function.
     uint8_t beacon_mac[BT_ADDR_SIZE];
 
+    // Antenna pattern of the CTE. See the chw1010_ant2_pattern enum.
+    // See the iq_data_init() function.
+    uint8_t antenna_pattern_id;
+
+    // Interval between samples in the measurement period, in microseconds per
+    // measurement sample.
+    // See the iq_data_init() function.
+    uint8_t measurement_spacing;
+
     // Reference sample count, constrained by IQ_REFERENCE_MAX.
     // See the iq_data_init() function.
     uint8_t reference_sample_count;
@@ -134,7 +174,7 @@ struct iq_data {
     int8_t measurement_q[IQ_MEASUREMENT_MAX];
 
     // Reference phase angles in radians.
-    // See the calculate_reference_phases() function.
+    // See the iq_data_calculate_reference_phases() function.
     float reference_phases[IQ_REFERENCE_MAX];
 
     // Measurement phase angles in radians.
@@ -142,15 +182,15 @@ struct iq_data {
     float measurement_phases[IQ_MEASUREMENT_MAX];
 
     // Unwrapped reference phase angles in radians.
-    // See the unwrap_reference_phases() function.
+    // See the iq_data_unwrap_reference_phases() function.
     float reference_phases_unwrapped[IQ_REFERENCE_MAX];
 
     // Linear phase drift rate in radians per microsecond.
-    // See the estimate_linear_phase_drift_rate() function.
+    // See the iq_data_estimate_linear_phase_drift_rate() function.
     float linear_phase_drift_rate;
 
     // Measurement samples compensated at a linear phase drift rate.
-    // See the compensate_measurement_samples() function.
+    // See the iq_data_compensate_measurement_samples() function.
     float measurement_i_compensated[IQ_MEASUREMENT_MAX];
     float measurement_q_compensated[IQ_MEASUREMENT_MAX];
 
@@ -169,10 +209,21 @@ struct iq_data {
     // TODO(wathne): Add documentation.
     float aod_azimuth;
     float aod_elevation;
+
+    // Quality of the local direction cosines in the range [0, 1]. The product
+    // of the mean resultant lengths of the horizontal and vertical phase
+    // differences. Values near 1 mean that the antenna pairs agree, and 0
+    // means that no direction was estimated.
+    // See the directional_statistics_mean_resultant_length() function.
+    float aod_quality;
 };
 
+#if defined(__ZEPHYR__)
 // Initialize a raw IQ samples structure from an IQ samples report.
-// TODO(wathne): Add a comment about bt_le_per_adv_sync_info.
+// The beacon_mac argument must be the MAC address of the beacon in
+// little-endian format, and the antenna_pattern_id argument must be the
+// antenna pattern of the beacon, for example from the sync context of the sync
+// that delivered the report. See the sync_context_table_get() function.
 // The report_timestamp argument must be a timestamp of when the IQ samples
 // report arrived in the cte_recv_cb() callback function. Elapsed time since the
 // system booted, in milliseconds.
@@ -180,7 +231,31 @@ struct iq_data {
 void iq_raw_samples_init(
         struct iq_raw_samples *iq_raw_samples,
         const struct bt_df_per_adv_sync_iq_samples_report *report,
-        const struct bt_le_per_adv_sync_info *info,
+        const uint8_t beacon_mac[BT_ADDR_SIZE],
+        uint8_t antenna_pattern_id,
+        int64_t report_timestamp);
+#endif
+
+// Initialize a raw IQ samples structure from interleaved IQ samples, i[0],
+// q[0], i[1], q[1], and so on, as in the samples of an IQ samples report and
+// in IQ captures. Platform-neutral, see the iq_raw_samples_init() function for
+// the other arguments.
+// The rssi argument is in units of 0.1 dBm, and the packet_status argument is
+// a bt_df_packet_status value.
+// The measurement_spacing argument must be IQ_MEASUREMENT_SPACING_1US_SLOTS or
+// IQ_MEASUREMENT_SPACING_2US_SLOTS.
+// The sample_count argument is constrained by maximum IQ sample count
+// constants.
+void iq_raw_samples_init_interleaved(
+        struct iq_raw_samples *iq_raw_samples,
+        uint8_t channel_index,
+        int16_t rssi,
+        uint8_t packet_status,
+        uint8_t measurement_spacing,
+        const int8_t *iq,
+        uint8_t sample_count,
+        const uint8_t beacon_mac[BT_ADDR_SIZE],
+        uint8_t antenna_pattern_id,
         int64_t report_timestamp);
 
 // Initialize an IQ data structure from a raw IQ samples structure.
@@ -191,7 +266,45 @@ void iq_data_init(
         struct iq_data *iq_data,
         const struct iq_raw_samples *iq_raw_samples);
 
-// Process IQ data.
+// Estimate the direction of a raw IQ samples structure, the first stage of
+// IQ data processing. The IQ data structure is initialized from the raw IQ
+// samples structure, compensated for linear phase drift, and set with local
+// direction cosines, azimuth, elevation, and quality.
+// Returns 0 (0 ~ "Success") if a direction is estimated.
+// Returns -ENOTSUP (-134 ~ "Not supported") if the antenna pattern of the CTE
+// is not supported.
+// Returns -ENODATA (-61 ~ "No data available") if no direction is estimated.
+int iq_data_estimate_direction(
+        struct iq_data *iq_data,
+        const struct iq_raw_samples *iq_raw_samples);
+
+// Update a locator with the direction of an IQ data structure, the second
+// stage of IQ data processing. The direction updates the tracker in
+// LOCATOR_MODE_TRACKING, and otherwise the angle cache, from which a position
+// is estimated.
+// The iq_data argument must be a pointer to an IQ data structure with an
+// estimated direction. See the iq_data_estimate_direction() function.
+// Returns 0 (0 ~ "Success") if the tracker is updated, or if a position is
+// estimated.
+// Returns a negative error number of the locator otherwise, see the
+// locator_update_tracker(), locator_put_angle(),
+// locator_estimate_position_from_angle_cache(), and
+// locator_estimate_position_robust() functions.
+int iq_data_update_locator(
+        const struct iq_data *iq_data,
+        struct locator *locator);
+
+// Process IQ data, and update a locator with the estimated direction. Both
+// stages of IQ data processing, see the iq_data_estimate_direction() and
+// iq_data_update_locator() functions.
+// The iq_raw_samples argument must be a pointer to an initialized raw IQ
+// samples structure.
+// See the iq_raw_samples_init() function.
+void iq_data_process_locator(
+        const struct iq_raw_samples *iq_raw_samples,
+        struct locator *locator);
+
+// Process IQ data, and update the global locator instance g_locator.
 // This function is compatible with the iq_raw_samples_processor_t function
 // pointer type and can be set as the processor function in an IQ data work
 // queue structure.
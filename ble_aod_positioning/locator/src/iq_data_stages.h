@@ -0,0 +1,20 @@
+#ifndef IQ_DATA_STAGES_H
+#define IQ_DATA_STAGES_H
+
+#include "iq_data.h" // For IQ data structure.
+
+// Internal header of iq_data.c. Not part of the locator API, only included by
+// iq_data.c and the DSP benchmark, see benchmark/src/dsp_bench.c.
+
+// Steps of the first stage of IQ data processing, in order. See iq_data.c for
+// the documentation of each step. Each step takes a pointer to an initialized
+// IQ data structure, with the fields of the earlier steps set. The
+// iq_data_estimate_direction() function of iq_data.h runs all steps.
+void iq_data_temp_fix_ref_samples(struct iq_data *iq_data);
+void iq_data_calculate_reference_phases(struct iq_data *iq_data);
+void iq_data_unwrap_reference_phases(struct iq_data *iq_data);
+void iq_data_estimate_linear_phase_drift_rate(struct iq_data *iq_data);
+void iq_data_compensate_measurement_samples(struct iq_data *iq_data);
+void iq_data_aod_interferometry(struct iq_data *iq_data);
+
+#endif // IQ_DATA_STAGES_H
\ No newline at end of file
@@ -1,10 +1,13 @@
 #include "iq_data_work_queue.h" // For IQ data work queue structure, iq_raw_samples_processor_t, and IQ_DATA_WORK_QUEUE_CAPACITY.
 #include <stdbool.h> // For bool.
+#include <errno.h> // For EINVAL (22).
 #include <stddef.h> // For NULL ((void *)0).
-#include <string.h> // For memcpy().
-#include <zephyr/kernel.h> // For work structure, work queue structure, k_work_init(), and k_work_submit_to_queue().
+#include <stdint.h> // For uint32_t.
+#include <string.h> // For memcpy() and memset().
+#include <zephyr/kernel.h> // For work structure, work queue structure, k_work_init(), k_work_submit_to_queue(), k_cycle_get_32(), and k_cyc_to_us_floor32().
 #include <zephyr/spinlock.h> // For k_spinlock_key_t, k_spin_lock(), and k_spin_unlock().
 #include <zephyr/sys/util.h> // For CONTAINER_OF() macro.
+#include "aod_trace.h" // For AOD_TRACE_BEGIN(), AOD_TRACE_END(), and AOD_TRACE_INSTANT().
 #include "iq_data.h" // For raw IQ samples structure.
 
 // TODO(wathne): Make the IQ data work queue aware of beacon MAC addresses.
@@ -24,6 +27,7 @@ static void iq_data_work_queue_handler(struct k_work *proc_work) {
     struct iq_raw_samples current_item;
     bool current_item_extracted;
     bool queue_exhausted;
+    int remaining_count;
 
     while (true) {
         current_item_extracted = false;
@@ -56,12 +60,33 @@ static void iq_data_work_queue_handler(struct k_work *proc_work) {
         } else {
             queue_exhausted = false;
         }
+        remaining_count = queue->count;
 
         k_spin_unlock(&queue->lock, key);
 
+        if (current_item_extracted) {
+            AOD_TRACE_INSTANT("queue_dequeue", remaining_count);
+        }
+
         // Process the extracted item (raw IQ samples).
         if (current_item_extracted && queue->processor != NULL) {
+            AOD_TRACE_BEGIN("queue_process", remaining_count);
+            uint32_t start_cycles = k_cycle_get_32();
             queue->processor(&current_item);
+            uint32_t processing_time_us =
+                    k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+            AOD_TRACE_END("queue_process", processing_time_us);
+
+            // Ensure atomic access to queue statistics.
+            key = k_spin_lock(&queue->lock);
+
+            queue->stats.processed_count++;
+            queue->stats.processing_time_us_total += processing_time_us;
+            if (processing_time_us > queue->stats.processing_time_us_max) {
+                queue->stats.processing_time_us_max = processing_time_us;
+            }
+
+            k_spin_unlock(&queue->lock, key);
         }
 
         if (queue_exhausted) {
@@ -105,6 +130,8 @@ void iq_data_work_queue_init(
     iq_data_work_queue->tail = 0;
     iq_data_work_queue->count = 0;
 
+    memset(&iq_data_work_queue->stats, 0, sizeof(struct iq_data_work_queue_stats));
+
     k_spin_unlock(&iq_data_work_queue->lock, key);
 
     iq_data_work_queue->target_work_queue = target_work_queue;
@@ -115,17 +142,23 @@ void iq_data_work_queue_init(
             iq_data_work_queue_handler);
 }
 
-void iq_data_work_queue_submit(
+struct iq_raw_samples *iq_data_work_queue_acquire(
         struct iq_data_work_queue *iq_data_work_queue,
-        const struct iq_raw_samples *iq_raw_samples) {
-    if (iq_data_work_queue == NULL || iq_raw_samples == NULL) {
-        return;
+        k_spinlock_key_t *key) {
+    if (iq_data_work_queue == NULL || key == NULL) {
+        return NULL;
     }
 
-    // Ensure atomic access to queue state variables.
-    k_spinlock_key_t key = k_spin_lock(&iq_data_work_queue->lock);
+    // Ensure atomic access to queue state variables. The lock is held until
+    // the iq_data_work_queue_commit() function, so the processor can not
+    // extract the slot while it is written.
+    *key = k_spin_lock(&iq_data_work_queue->lock);
+
+    iq_data_work_queue->stats.submitted_count++;
 
     if (iq_data_work_queue->count == IQ_DATA_WORK_QUEUE_CAPACITY) {
+        iq_data_work_queue->stats.evicted_count++;
+
         // Increment tail by 1 or wrap around.
         iq_data_work_queue->tail =
                 (iq_data_work_queue->tail + 1) % IQ_DATA_WORK_QUEUE_CAPACITY;
@@ -140,10 +173,15 @@ void iq_data_work_queue_submit(
         iq_data_work_queue->count++;
     }
 
-    memcpy(
-            &iq_data_work_queue->buffer[iq_data_work_queue->head],
-            iq_raw_samples,
-            sizeof(struct iq_raw_samples));
+    return &iq_data_work_queue->buffer[iq_data_work_queue->head];
+}
+
+void iq_data_work_queue_commit(
+        struct iq_data_work_queue *iq_data_work_queue,
+        k_spinlock_key_t key) {
+    if (iq_data_work_queue == NULL) {
+        return;
+    }
 
     bool start;
     if (iq_data_work_queue->count == 1) {
@@ -151,12 +189,53 @@ void iq_data_work_queue_submit(
     } else {
         start = false;
     }
+    // A full queue evicted its oldest element in iq_data_work_queue_acquire().
+    int count = iq_data_work_queue->count;
 
     k_spin_unlock(&iq_data_work_queue->lock, key);
 
+    AOD_TRACE_INSTANT("queue_submit", count);
+
     if (start && iq_data_work_queue->target_work_queue != NULL) {
         k_work_submit_to_queue(
                 iq_data_work_queue->target_work_queue,
                 &iq_data_work_queue->processor_work);
     }
+}
+
+int iq_data_work_queue_get_stats(
+        struct iq_data_work_queue *iq_data_work_queue,
+        struct iq_data_work_queue_stats *stats,
+        bool reset) {
+    if (iq_data_work_queue == NULL || stats == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Ensure atomic access to queue statistics.
+    k_spinlock_key_t key = k_spin_lock(&iq_data_work_queue->lock);
+
+    memcpy(stats, &iq_data_work_queue->stats, sizeof(struct iq_data_work_queue_stats));
+    if (reset) {
+        memset(&iq_data_work_queue->stats, 0, sizeof(struct iq_data_work_queue_stats));
+    }
+
+    k_spin_unlock(&iq_data_work_queue->lock, key);
+
+    return 0; // 0 ~ "Success".
+}
+
+void iq_data_work_queue_submit(
+        struct iq_data_work_queue *iq_data_work_queue,
+        const struct iq_raw_samples *iq_raw_samples) {
+    if (iq_data_work_queue == NULL || iq_raw_samples == NULL) {
+        return;
+    }
+
+    k_spinlock_key_t key;
+    struct iq_raw_samples *slot =
+            iq_data_work_queue_acquire(iq_data_work_queue, &key);
+
+    memcpy(slot, iq_raw_samples, sizeof(struct iq_raw_samples));
+
+    iq_data_work_queue_commit(iq_data_work_queue, key);
 }
\ No newline at end of file
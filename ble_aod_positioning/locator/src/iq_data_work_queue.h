@@ -1,8 +1,10 @@
 #ifndef IQ_DATA_WORK_QUEUE_H
 #define IQ_DATA_WORK_QUEUE_H
 
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For uint32_t.
 #include <zephyr/kernel.h> // For work structure and work queue structure.
-#include <zephyr/spinlock.h> // For spinlock structure.
+#include <zephyr/spinlock.h> // For spinlock structure and k_spinlock_key_t.
 #include "iq_data.h" // For raw IQ samples structure.
 
 // TODO(wathne): Make the IQ data work queue aware of beacon MAC addresses.
@@ -14,6 +16,25 @@
 // IQ data work queue capacity.
 #define IQ_DATA_WORK_QUEUE_CAPACITY 8
 
+// IQ data work queue statistics structure.
+// Counters since the statistics were last reset.
+// See the iq_data_work_queue_get_stats() function.
+struct iq_data_work_queue_stats {
+    // Number of raw IQ samples structures submitted to the queue.
+    uint32_t submitted_count;
+
+    // Number of raw IQ samples structures evicted from a full queue.
+    uint32_t evicted_count;
+
+    // Number of raw IQ samples structures processed.
+    uint32_t processed_count;
+
+    // Total and maximum processing time of a raw IQ samples structure, in
+    // microseconds.
+    uint32_t processing_time_us_total;
+    uint32_t processing_time_us_max;
+};
+
 // Function pointer type for processing a raw IQ samples structure.
 typedef void (*iq_raw_samples_processor_t)(
         const struct iq_raw_samples *iq_raw_samples);
@@ -38,6 +59,10 @@ struct iq_data_work_queue {
     // Spinlock to ensure atomic access to queue state variables.
     struct k_spinlock lock;
 
+    // Queue statistics, protected by the queue spinlock.
+    // See the iq_data_work_queue_get_stats() function.
+    struct iq_data_work_queue_stats stats;
+
     // Work structure for submitting processor work to the target work queue.
     struct k_work processor_work;
     // Target work queue structure. For example, the system work queue
@@ -51,6 +76,34 @@ void iq_data_work_queue_init(
         struct k_work_q *target_work_queue,
         iq_raw_samples_processor_t processor);
 
+// Acquire the next slot of an IQ data work queue, for a raw IQ samples
+// structure to be initialized in place. The oldest element is evicted if the
+// queue is full. The queue lock is held until the iq_data_work_queue_commit()
+// function is called with the same key, so the slot must be written quickly
+// and without blocking. This avoids initializing a raw IQ samples structure on
+// the stack and copying it into the queue.
+// Returns a pointer to the slot.
+// Returns NULL if iq_data_work_queue pointer is NULL, or if key pointer is
+// NULL. The lock is not held in that case.
+struct iq_raw_samples *iq_data_work_queue_acquire(
+        struct iq_data_work_queue *iq_data_work_queue,
+        k_spinlock_key_t *key);
+
+// Commit the slot acquired by the iq_data_work_queue_acquire() function, as
+// the newest element of an IQ data work queue, and release the queue lock.
+void iq_data_work_queue_commit(
+        struct iq_data_work_queue *iq_data_work_queue,
+        k_spinlock_key_t key);
+
+// Get the statistics of an IQ data work queue, and optionally reset them.
+// Returns 0 (0 ~ "Success") if stats is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if iq_data_work_queue pointer is
+// NULL, or if stats pointer is NULL.
+int iq_data_work_queue_get_stats(
+        struct iq_data_work_queue *iq_data_work_queue,
+        struct iq_data_work_queue_stats *stats,
+        bool reset);
+
 // TODO(wathne): Add description.
 void iq_data_work_queue_submit(
         struct iq_data_work_queue *iq_data_work_queue,
@@ -0,0 +1,227 @@
+#include "line_intersection.h" // For line intersection structure, line intersection result structure, and LINE_INTERSECTION_ERROR_DEGENERATE (93).
+#include <errno.h> // For EINVAL (22).
+#include <math.h> // For sqrtf().
+#include <stddef.h> // For NULL ((void *)0).
+
+int line_intersection_init(struct line_intersection *line_intersection) {
+    if (line_intersection == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    line_intersection->origin_x = 0.0f;
+    line_intersection->origin_y = 0.0f;
+    line_intersection->origin_z = 0.0f;
+
+    line_intersection->a_xx = 0.0f;
+    line_intersection->a_xy = 0.0f;
+    line_intersection->a_xz = 0.0f;
+    line_intersection->a_yy = 0.0f;
+    line_intersection->a_yz = 0.0f;
+    line_intersection->a_zz = 0.0f;
+
+    line_intersection->b_x = 0.0f;
+    line_intersection->b_y = 0.0f;
+    line_intersection->b_z = 0.0f;
+
+    line_intersection->c = 0.0f;
+
+    line_intersection->weight_sum = 0.0f;
+
+    line_intersection->line_count = 0;
+
+    return 0; // 0 ~ "Success".
+}
+
+int line_intersection_add_line(
+        struct line_intersection *line_intersection,
+        float px,
+        float py,
+        float pz,
+        float dx,
+        float dy,
+        float dz,
+        float weight) {
+    if (line_intersection == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (!(weight > 0.0f)) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    float length = sqrtf(dx*dx + dy*dy + dz*dz);
+    if (!(length > 0.0f)) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Normalize the direction. Direction cosines are already normalized, but
+    // clamping in the AoD estimators may leave them slightly off.
+    dx = dx / length;
+    dy = dy / length;
+    dz = dz / length;
+
+    // The first line sets the reference origin.
+    if (line_intersection->line_count == 0) {
+        line_intersection->origin_x = px;
+        line_intersection->origin_y = py;
+        line_intersection->origin_z = pz;
+    }
+
+    // Line origin relative to the reference origin.
+    px = px - line_intersection->origin_x;
+    py = py - line_intersection->origin_y;
+    pz = pz - line_intersection->origin_z;
+
+    // M = (I - D D^T)
+    //
+    //     [ 1 - dx*dx    -dx*dy    -dx*dz ]
+    // M = [   -dx*dy  1 - dy*dy    -dy*dz ]
+    //     [   -dx*dz    -dy*dz  1 - dz*dz ]
+    float m_xx = 1.0f - dx*dx;
+    float m_xy = -dx*dy;
+    float m_xz = -dx*dz;
+    float m_yy = 1.0f - dy*dy;
+    float m_yz = -dy*dz;
+    float m_zz = 1.0f - dz*dz;
+
+    // M P
+    float mp_x = m_xx*px + m_xy*py + m_xz*pz;
+    float mp_y = m_xy*px + m_yy*py + m_yz*pz;
+    float mp_z = m_xz*px + m_yz*py + m_zz*pz;
+
+    line_intersection->a_xx = line_intersection->a_xx + weight * m_xx;
+    line_intersection->a_xy = line_intersection->a_xy + weight * m_xy;
+    line_intersection->a_xz = line_intersection->a_xz + weight * m_xz;
+    line_intersection->a_yy = line_intersection->a_yy + weight * m_yy;
+    line_intersection->a_yz = line_intersection->a_yz + weight * m_yz;
+    line_intersection->a_zz = line_intersection->a_zz + weight * m_zz;
+
+    line_intersection->b_x = line_intersection->b_x + weight * mp_x;
+    line_intersection->b_y = line_intersection->b_y + weight * mp_y;
+    line_intersection->b_z = line_intersection->b_z + weight * mp_z;
+
+    // P^T M P
+    line_intersection->c = line_intersection->c +
+            weight * (px*mp_x + py*mp_y + pz*mp_z);
+
+    line_intersection->weight_sum = line_intersection->weight_sum + weight;
+
+    line_intersection->line_count++;
+
+    return 0; // 0 ~ "Success".
+}
+
+int line_intersection_solve(
+        const struct line_intersection *line_intersection,
+        struct line_intersection_result *result) {
+    if (line_intersection == NULL || result == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (line_intersection->line_count < 2) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    const float a_xx = line_intersection->a_xx;
+    const float a_xy = line_intersection->a_xy;
+    const float a_xz = line_intersection->a_xz;
+    const float a_yy = line_intersection->a_yy;
+    const float a_yz = line_intersection->a_yz;
+    const float a_zz = line_intersection->a_zz;
+
+    // Cofactors of the symmetric normal matrix A. The inverse of A is the
+    // transposed cofactor matrix (adjugate) divided by the determinant, and
+    // the cofactor matrix of a symmetric matrix is symmetric.
+    float c_xx = a_yy*a_zz - a_yz*a_yz;
+    float c_xy = a_xz*a_yz - a_xy*a_zz;
+    float c_xz = a_xy*a_yz - a_xz*a_yy;
+    float c_yy = a_xx*a_zz - a_xz*a_xz;
+    float c_yz = a_xy*a_xz - a_xx*a_yz;
+    float c_zz = a_xx*a_yy - a_xy*a_xy;
+
+    float determinant = a_xx*c_xx + a_xy*c_xy + a_xz*c_xz;
+
+    // Reject lines that are too parallel.
+    // The determinant of A scales with the cube of the sum of weights, the
+    // determinant of A / weight_sum does not.
+    const float weight_sum = line_intersection->weight_sum;
+    float normalized_determinant =
+            determinant / (weight_sum * weight_sum * weight_sum);
+    if (!(normalized_determinant >= LINE_INTERSECTION_DETERMINANT_MIN)) {
+        return -LINE_INTERSECTION_ERROR_DEGENERATE; // -93 ~ "Degenerate lines".
+    }
+
+    // Inverse of A.
+    float i_xx = c_xx / determinant;
+    float i_xy = c_xy / determinant;
+    float i_xz = c_xz / determinant;
+    float i_yy = c_yy / determinant;
+    float i_yz = c_yz / determinant;
+    float i_zz = c_zz / determinant;
+
+    const float b_x = line_intersection->b_x;
+    const float b_y = line_intersection->b_y;
+    const float b_z = line_intersection->b_z;
+
+    // X = A^-1 b, relative to the reference origin.
+    float x = i_xx*b_x + i_xy*b_y + i_xz*b_z;
+    float y = i_xy*b_x + i_yy*b_y + i_yz*b_z;
+    float z = i_xz*b_x + i_yz*b_y + i_zz*b_z;
+
+    // RSS = X^T A X - 2 X^T b + c
+    // Since A X = b, this simplifies to RSS = c - X^T b.
+    float rss = line_intersection->c - (x*b_x + y*b_y + z*b_z);
+    if (rss < 0.0f) {
+        // Rounding errors, the lines intersect.
+        rss = 0.0f;
+    }
+
+    // A posteriori variance factor, RSS / (2N - 3).
+    float variance_factor =
+            rss / (float)(2 * line_intersection->line_count - 3);
+
+    result->x = x + line_intersection->origin_x;
+    result->y = y + line_intersection->origin_y;
+    result->z = z + line_intersection->origin_z;
+
+    result->covariance[0][0] = variance_factor * i_xx;
+    result->covariance[0][1] = variance_factor * i_xy;
+    result->covariance[0][2] = variance_factor * i_xz;
+    result->covariance[1][0] = variance_factor * i_xy;
+    result->covariance[1][1] = variance_factor * i_yy;
+    result->covariance[1][2] = variance_factor * i_yz;
+    result->covariance[2][0] = variance_factor * i_xz;
+    result->covariance[2][1] = variance_factor * i_yz;
+    result->covariance[2][2] = variance_factor * i_zz;
+
+    result->residual_sum_of_squares = rss;
+    result->residual_rms = sqrtf(rss / weight_sum);
+
+    result->line_count = line_intersection->line_count;
+
+    return 0; // 0 ~ "Success".
+}
+
+float line_intersection_distance(
+        float x,
+        float y,
+        float z,
+        float px,
+        float py,
+        float pz,
+        float dx,
+        float dy,
+        float dz) {
+    // V = X - P
+    float vx = x - px;
+    float vy = y - py;
+    float vz = z - pz;
+
+    // |V x D| is the perpendicular distance from X to the line, since D is
+    // normalized.
+    float cx = vy*dz - vz*dy;
+    float cy = vz*dx - vx*dz;
+    float cz = vx*dy - vy*dx;
+
+    return sqrtf(cx*cx + cy*cy + cz*cz);
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#ifndef LINE_INTERSECTION_H
+#define LINE_INTERSECTION_H
+
+#define LINE_INTERSECTION_ERROR_DEGENERATE 93 // An arbitrary error number.
+
+// Minimum determinant of the weight-normalized normal matrix.
+// For two lines of equal weight, the determinant of the weight-normalized
+// normal matrix is (1 - (D1_dot_D2)^2) / 4, where D1_dot_D2 is the cosine of
+// the angle between the lines. This minimum is therefore equivalent to the
+// |1 - (D1_dot_D2)^2| < 0.001 benchmark for parallelity in the
+// locator_estimate_position_from_skew_lines() function.
+#define LINE_INTERSECTION_DETERMINANT_MIN 0.00025f
+
+// Least squares line intersection structure.
+// Finds the point X that minimizes the weighted sum of squared perpendicular
+// distances to N >= 2 lines. Each line i is given by an origin P(i), a
+// normalized direction D(i), and a weight w(i).
+//
+// The perpendicular distance from X to line i is |M(i) (X - P(i))|, where
+// M(i) = (I - D(i) D(i)^T) is the projection onto the plane orthogonal to
+// D(i). Setting the gradient of the weighted sum of squared distances to zero
+// gives the 3x3 normal equations:
+//
+// A X = b
+// A = sum(w(i) * M(i))
+// b = sum(w(i) * M(i) P(i))
+//
+// The normal equations are accumulated incrementally, one line at a time, and
+// solved once. The cost is linear in the number of lines, and the memory is
+// constant. Line origins are accumulated relative to the origin of the first
+// line to preserve floating point precision when the lines are far away from
+// the global origin.
+// See the line_intersection_init() function.
+struct line_intersection {
+    // Reference origin, set to the origin of the first line.
+    float origin_x;
+    float origin_y;
+    float origin_z;
+
+    // Symmetric normal matrix A, upper triangle.
+    float a_xx, a_xy, a_xz;
+    float a_yy, a_yz;
+    float a_zz;
+
+    // Right-hand side b.
+    float b_x, b_y, b_z;
+
+    // Sum of w(i) * P(i)^T M(i) P(i), for the residual sum of squares.
+    // RSS = X^T A X - 2 X^T b + c
+    float c;
+
+    // Sum of weights.
+    float weight_sum;
+
+    // Number of accumulated lines.
+    int line_count;
+};
+
+// Least squares line intersection result structure.
+// See the line_intersection_solve() function.
+struct line_intersection_result {
+    // Least squares intersection point, in the coordinate system of the lines.
+    float x;
+    float y;
+    float z;
+
+    // Covariance matrix of the intersection point. The weights are treated as
+    // relative weights, and the covariance matrix is scaled by the a posteriori
+    // variance factor RSS / (2N - 3). Each line constrains 2 degrees of
+    // freedom, and the point has 3 degrees of freedom.
+    float covariance[3][3];
+
+    // Weighted residual sum of squares, sum(w(i) * distance(i)^2).
+    float residual_sum_of_squares;
+
+    // Weighted root mean square of perpendicular distances,
+    // sqrt(RSS / sum(w(i))). For two lines of equal weight, this is half the
+    // length of the shortest line between the two lines.
+    float residual_rms;
+
+    // Number of lines in the solution.
+    int line_count;
+};
+
+// Initialize a line intersection structure (line_count = 0).
+// Returns 0 (0 ~ "Success") if the line intersection structure is initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if line_intersection pointer is
+// NULL.
+int line_intersection_init(struct line_intersection *line_intersection);
+
+// Add a line to a line intersection structure.
+// The direction (dx, dy, dz) is normalized before it is accumulated.
+// Returns 0 (0 ~ "Success") if the line is added.
+// Returns -EINVAL (-22 ~ "Invalid argument") if line_intersection pointer is
+// NULL, or if the direction has zero length, or if weight is not positive.
+int line_intersection_add_line(
+        struct line_intersection *line_intersection,
+        float px,
+        float py,
+        float pz,
+        float dx,
+        float dy,
+        float dz,
+        float weight);
+
+// Solve the accumulated normal equations of a line intersection structure.
+// The line_intersection argument is not modified, more lines can be added and
+// the normal equations can be solved again.
+// Returns 0 (0 ~ "Success") if the result is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if line_intersection pointer is
+// NULL, or if result pointer is NULL, or if fewer than 2 lines are added.
+// Returns -LINE_INTERSECTION_ERROR_DEGENERATE (-93 ~ "Degenerate lines") if
+// all lines are nearly parallel. See LINE_INTERSECTION_DETERMINANT_MIN.
+int line_intersection_solve(
+        const struct line_intersection *line_intersection,
+        struct line_intersection_result *result);
+
+// Get the perpendicular distance from a point (x, y, z) to a line with origin
+// (px, py, pz) and normalized direction (dx, dy, dz).
+// Input validation is intentionally omitted.
+float line_intersection_distance(
+        float x,
+        float y,
+        float z,
+        float px,
+        float py,
+        float pz,
+        float dx,
+        float dy,
+        float dz);
+
+#endif // LINE_INTERSECTION_H
\ No newline at end of file
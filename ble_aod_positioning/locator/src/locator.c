@@ -1,12 +1,23 @@
-#include "locator.h" // For locator structure, locator position structure, LOCATOR_ERROR_PARALLEL_LINES (92), and LOCATOR_POSITION_CAPACITY.
-#include <errno.h> // For EINVAL (22).
+#include "locator.h" // For locator structure, locator position structure, LOCATOR_ERROR_PARALLEL_LINES (92), and LOCATOR_* constants.
+#include <errno.h> // For ENOENT (2), EINVAL (22), and ENODATA (61).
 #include <math.h> // For fabsf() and sqrtf().
+#include <stdbool.h> // For bool.
 #include <stddef.h> // For NULL ((void *)0).
-#include <stdint.h> // For uint8_t.
-#include <zephyr/sys/printk.h> // For printk().
+#include <stdint.h> // For uint8_t and int64_t.
+#include "aod_platform.h" // For printk() and AOD_DEBUG().
+#include "aod_trace.h" // For AOD_TRACE_INSTANT().
 #include "beacon.h" // For beacon structure and beacon_get_global_direction_cosines().
-#include "beacon_database.h" // For beacon database structure and beacon_database_get().
+#include "beacon_angle_cache.h" // For beacon angle cache structure, beacon_angle_cache_put(), beacon_angle_cache_is_fresh(), and beacon_angle_cache_get_history().
+#include "beacon_database.h" // For beacon database structure, beacon_database_get(), and beacon_database_index_of().
 #include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "dilution_of_precision.h" // For dilution of precision structure, dilution_of_precision_add_bearing(), and dilution_of_precision_get().
+#include "line_intersection.h" // For line intersection structure, line intersection result structure, and line_intersection_solve().
+#include "locator_tracker.h" // For locator tracker structure, locator_tracker_update(), and locator_tracker_output().
+#include "robust_line_intersection.h" // For robust line structure, robust_line_intersection_config_default(), and robust_line_intersection_solve().
+
+#ifndef ENODATA
+#define ENODATA 61
+#endif
 
 // The global locator instance.
 // See the locator_init_global() function.
@@ -21,6 +32,13 @@ int locator_init(
 
     locator->beacon_db = beacon_db;
 
+    locator->mode = LOCATOR_MODE_SNAPSHOT;
+    beacon_angle_cache_init(
+            &locator->angle_cache,
+            BEACON_ANGLE_CACHE_DEFAULT_WINDOW_MS);
+    robust_line_intersection_config_default(&locator->robust_config);
+    locator_tracker_init(&locator->tracker, NULL);
+
     locator->history_count = 0;
     locator->history_next = 0;
 
@@ -31,6 +49,56 @@ int locator_init_global(struct beacon_database *beacon_db) {
     return locator_init(&g_locator, beacon_db);
 }
 
+int locator_set_mode(
+        struct locator *locator,
+        enum locator_mode mode,
+        const struct locator_tracker_config *tracker_config) {
+    if (locator == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (mode != LOCATOR_MODE_SNAPSHOT &&
+            mode != LOCATOR_MODE_TRACKING &&
+            mode != LOCATOR_MODE_ROBUST) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    locator->mode = mode;
+    locator_tracker_init(&locator->tracker, tracker_config);
+
+    return 0; // 0 ~ "Success".
+}
+
+int locator_put_position(
+        struct locator *locator,
+        const struct locator_position *position) {
+    if (locator == NULL || position == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    locator->position_history[locator->history_next] = *position;
+    locator->history_next =
+            (locator->history_next + 1) % LOCATOR_POSITION_CAPACITY;
+    if (locator->history_count < LOCATOR_POSITION_CAPACITY) {
+        locator->history_count++;
+    }
+
+    AOD_TRACE_INSTANT("loc_position", locator->history_count);
+
+    return 0; // 0 ~ "Success".
+}
+
+// Print a position, with its GDOP if available.
+static void locator_print_position(const struct locator_position *position) {
+    printk("X = %.2f\nY = %.2f\nZ = %.2f\n",
+            position->x, position->y, position->z);
+    if (position->gdop >= 0.0f) {
+        printk("GDOP = %.2f\n", position->gdop);
+    } else {
+        printk("GDOP = n/a\n");
+    }
+}
+
 int locator_estimate_position_from_skew_lines(
         struct locator *locator,
         const uint8_t beacon_1_mac_little_endian[BT_ADDR_SIZE],
@@ -42,12 +110,12 @@ int locator_estimate_position_from_skew_lines(
         float beacon_2_local_direction_cosine_y,
         float beacon_2_local_direction_cosine_z) {
     if (locator == NULL) {
-        printk("DEBUG: locator is NULL\n");
+        AOD_DEBUG("DEBUG: locator is NULL\n");
         return -EINVAL; // -22 ~ "Invalid argument".
     }
 
     if (locator->beacon_db == NULL) {
-        printk("DEBUG: locator->beacon_db is NULL\n");
+        AOD_DEBUG("DEBUG: locator->beacon_db is NULL\n");
         return -EINVAL; // -22 ~ "Invalid argument".
     }
 
@@ -60,7 +128,7 @@ int locator_estimate_position_from_skew_lines(
             &beacon_1,
             beacon_1_mac_little_endian);
     if (ret != 0) {
-        printk("DEBUG: first beacon is not in database\n");
+        AOD_DEBUG("DEBUG: first beacon is not in database\n");
         return ret;
     }
     ret = beacon_database_get(
@@ -68,7 +136,7 @@ int locator_estimate_position_from_skew_lines(
             &beacon_2,
             beacon_2_mac_little_endian);
     if (ret != 0) {
-        printk("DEBUG: second beacon is not in database\n");
+        AOD_DEBUG("DEBUG: second beacon is not in database\n");
         return ret;
     }
 
@@ -258,18 +326,683 @@ int locator_estimate_position_from_skew_lines(
     position.z = midpoint_z;
     position.error_radius = distance_absolute / 2.0f;
 
-    // TODO(wathne): Move this ring buffer logic into a proper put function.
-    struct locator_position *next_position =
-            &locator->position_history[locator->history_next];
-    *next_position = position;
-    locator->history_next =
-            (locator->history_next + 1) % LOCATOR_POSITION_CAPACITY;
-    if (locator->history_count < LOCATOR_POSITION_CAPACITY) {
-        locator->history_count++;
+    struct dilution_of_precision dop;
+    dilution_of_precision_init(&dop);
+    dilution_of_precision_add_bearing(
+            &dop, p1x, p1y, p1z, midpoint_x, midpoint_y, midpoint_z);
+    dilution_of_precision_add_bearing(
+            &dop, p2x, p2y, p2z, midpoint_x, midpoint_y, midpoint_z);
+    if (dilution_of_precision_get(&dop, &position.gdop) != 0) {
+        position.gdop = LOCATOR_POSITION_GDOP_UNAVAILABLE;
     }
 
-    printk("X = %.2f\nY = %.2f\nZ = %.2f\n",
-            position.x, position.y, position.z);
+    locator_put_position(locator, &position);
+
+    locator_print_position(&position);
 
     return 0;
+}
+
+// Solve the least squares intersection of the global lines of bearings,
+// without putting a position into the position history.
+// See the locator_estimate_position_from_bearings() function.
+static int locator_solve_bearings(
+        const struct locator *locator,
+        const struct locator_bearing *bearings,
+        int bearing_count,
+        struct line_intersection_result *result) {
+    int ret;
+
+    struct line_intersection line_intersection;
+    line_intersection_init(&line_intersection);
+
+    struct beacon beacon;
+    for (int i = 0; i < bearing_count; i++) {
+        ret = beacon_database_get(
+                locator->beacon_db,
+                &beacon,
+                bearings[i].beacon_mac_little_endian);
+        if (ret != 0) {
+            AOD_DEBUG("DEBUG: beacon %d is not in database\n", i);
+            return ret;
+        }
+
+        // Global direction cosines from the beacon.
+        float dx;
+        float dy;
+        float dz;
+
+        beacon_get_global_direction_cosines(
+                &beacon,
+                bearings[i].local_direction_cosine_x,
+                bearings[i].local_direction_cosine_y,
+                bearings[i].local_direction_cosine_z,
+                &dx,
+                &dy,
+                &dz);
+
+        // Global line L(t) = P + t*D from the global position of the beacon.
+        ret = line_intersection_add_line(
+                &line_intersection,
+                beacon.x,
+                beacon.y,
+                beacon.z,
+                dx,
+                dy,
+                dz,
+                bearings[i].weight);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    ret = line_intersection_solve(&line_intersection, result);
+    if (ret == -LINE_INTERSECTION_ERROR_DEGENERATE) {
+        return -LOCATOR_ERROR_PARALLEL_LINES; // -92 ~ "Parallel lines".
+    }
+
+    return ret;
+}
+
+// Get the GDOP of bearings at a position (x, y, z).
+// Returns LOCATOR_POSITION_GDOP_UNAVAILABLE if the GDOP is not available.
+static float locator_get_bearings_gdop(
+        const struct locator *locator,
+        const struct locator_bearing *bearings,
+        int bearing_count,
+        float x,
+        float y,
+        float z) {
+    struct dilution_of_precision dop;
+    dilution_of_precision_init(&dop);
+
+    struct beacon beacon;
+    for (int i = 0; i < bearing_count; i++) {
+        if (beacon_database_get(
+                locator->beacon_db,
+                &beacon,
+                bearings[i].beacon_mac_little_endian) != 0) {
+            return LOCATOR_POSITION_GDOP_UNAVAILABLE;
+        }
+        dilution_of_precision_add_bearing(
+                &dop, beacon.x, beacon.y, beacon.z, x, y, z);
+    }
+
+    float gdop;
+    if (dilution_of_precision_get(&dop, &gdop) != 0) {
+        return LOCATOR_POSITION_GDOP_UNAVAILABLE;
+    }
+
+    return gdop;
+}
+
+int locator_estimate_position_from_bearings(
+        struct locator *locator,
+        const struct locator_bearing *bearings,
+        int bearing_count,
+        struct line_intersection_result *result) {
+    if (locator == NULL || bearings == NULL || bearing_count < 2) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (locator->beacon_db == NULL) {
+        AOD_DEBUG("DEBUG: locator->beacon_db is NULL\n");
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    int ret;
+
+    struct line_intersection_result line_intersection_result;
+    ret = locator_solve_bearings(
+            locator,
+            bearings,
+            bearing_count,
+            &line_intersection_result);
+    if (ret != 0) {
+        return ret;
+    }
+
+    struct locator_position position;
+    position.x = line_intersection_result.x;
+    position.y = line_intersection_result.y;
+    position.z = line_intersection_result.z;
+    position.error_radius = line_intersection_result.residual_rms;
+    position.gdop = locator_get_bearings_gdop(
+            locator,
+            bearings,
+            bearing_count,
+            position.x,
+            position.y,
+            position.z);
+
+    locator_put_position(locator, &position);
+
+    if (result != NULL) {
+        *result = line_intersection_result;
+    }
+
+    locator_print_position(&position);
+
+    return 0;
+}
+
+int locator_update_tracker(
+        struct locator *locator,
+        const uint8_t beacon_mac_little_endian[BT_ADDR_SIZE],
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        int64_t timestamp) {
+    if (locator == NULL || beacon_mac_little_endian == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (locator->beacon_db == NULL) {
+        AOD_DEBUG("DEBUG: locator->beacon_db is NULL\n");
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    int ret;
+
+    struct beacon beacon;
+    ret = beacon_database_get(
+            locator->beacon_db,
+            &beacon,
+            beacon_mac_little_endian);
+    if (ret != 0) {
+        AOD_DEBUG("DEBUG: beacon is not in database\n");
+        return ret;
+    }
+
+    ret = locator_tracker_update(
+            &locator->tracker,
+            &beacon,
+            local_direction_cosine_x,
+            local_direction_cosine_y,
+            local_direction_cosine_z,
+            timestamp);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (!locator_tracker_output_due(&locator->tracker, timestamp)) {
+        return 0; // 0 ~ "Success".
+    }
+
+    struct locator_position position;
+    ret = locator_tracker_output(
+            &locator->tracker,
+            timestamp,
+            &position.x,
+            &position.y,
+            &position.z,
+            &position.error_radius);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // A tracker position is not a fix from a set of bearings.
+    position.gdop = LOCATOR_POSITION_GDOP_UNAVAILABLE;
+
+    locator_put_position(locator, &position);
+
+    locator_print_position(&position);
+
+    return 0; // 0 ~ "Success".
+}
+
+int locator_set_angle_window(
+        struct locator *locator,
+        int64_t window_ms) {
+    if (locator == NULL || window_ms < 0) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    locator->angle_cache.window_ms = window_ms;
+
+    return 0; // 0 ~ "Success".
+}
+
+int locator_put_angle(
+        struct locator *locator,
+        const uint8_t beacon_mac_little_endian[BT_ADDR_SIZE],
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        float quality,
+        int64_t timestamp) {
+    if (locator == NULL || beacon_mac_little_endian == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (locator->beacon_db == NULL) {
+        AOD_DEBUG("DEBUG: locator->beacon_db is NULL\n");
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    int beacon_index = beacon_database_index_of(
+            locator->beacon_db,
+            beacon_mac_little_endian);
+    if (beacon_index < 0) {
+        return beacon_index;
+    }
+
+    return beacon_angle_cache_put(
+            &locator->angle_cache,
+            beacon_index,
+            local_direction_cosine_x,
+            local_direction_cosine_y,
+            local_direction_cosine_z,
+            quality,
+            timestamp);
+}
+
+// Select beacons to fuse greedily by GDOP at a reference position (x, y, z).
+// beacon_indices are indices into the beacon database, and selected[i] is set
+// for each beacon_indices[i]. See the
+// locator_estimate_position_from_angle_cache() function.
+// Returns 0 (0 ~ "Success") if at least 2 beacons are selected.
+// Returns -DILUTION_OF_PRECISION_ERROR_DEGENERATE (-96 ~ "Degenerate
+// geometry") if no pair of beacons has a usable geometry.
+static int locator_select_beacons(
+        const struct beacon_database *beacon_db,
+        const int *beacon_indices,
+        int count,
+        float x,
+        float y,
+        float z,
+        bool *selected) {
+    for (int i = 0; i < count; i++) {
+        selected[i] = false;
+    }
+
+    // Pair with the lowest GDOP.
+    int best_a = -1;
+    int best_b = -1;
+    float best_gdop = 0.0f;
+    for (int a = 0; a < count; a++) {
+        const struct beacon *beacon_a = &beacon_db->beacons[beacon_indices[a]];
+        for (int b = a + 1; b < count; b++) {
+            const struct beacon *beacon_b =
+                    &beacon_db->beacons[beacon_indices[b]];
+
+            struct dilution_of_precision dop;
+            dilution_of_precision_init(&dop);
+            dilution_of_precision_add_bearing(
+                    &dop, beacon_a->x, beacon_a->y, beacon_a->z, x, y, z);
+            dilution_of_precision_add_bearing(
+                    &dop, beacon_b->x, beacon_b->y, beacon_b->z, x, y, z);
+
+            float gdop;
+            if (dilution_of_precision_get(&dop, &gdop) != 0) {
+                continue;
+            }
+            if (best_a < 0 || gdop < best_gdop) {
+                best_a = a;
+                best_b = b;
+                best_gdop = gdop;
+            }
+        }
+    }
+
+    if (best_a < 0) {
+        return -DILUTION_OF_PRECISION_ERROR_DEGENERATE; // -96 ~ "Degenerate geometry".
+    }
+
+    struct dilution_of_precision base;
+    dilution_of_precision_init(&base);
+    const int best_pair[2] = {best_a, best_b};
+    for (int k = 0; k < 2; k++) {
+        const struct beacon *beacon =
+                &beacon_db->beacons[beacon_indices[best_pair[k]]];
+        dilution_of_precision_add_bearing(
+                &base, beacon->x, beacon->y, beacon->z, x, y, z);
+        selected[best_pair[k]] = true;
+    }
+    int selected_count = 2;
+    float current_gdop = best_gdop;
+
+    // Add the beacon that reduces the GDOP the most, while the reduction is
+    // worth the extra bearing.
+    while (selected_count < LOCATOR_FUSION_BEACONS_MAX) {
+        int best_c = -1;
+        float best_c_gdop = 0.0f;
+        for (int c = 0; c < count; c++) {
+            if (selected[c]) {
+                continue;
+            }
+
+            const struct beacon *beacon =
+                    &beacon_db->beacons[beacon_indices[c]];
+            struct dilution_of_precision dop = base;
+            dilution_of_precision_add_bearing(
+                    &dop, beacon->x, beacon->y, beacon->z, x, y, z);
+
+            float gdop;
+            if (dilution_of_precision_get(&dop, &gdop) != 0) {
+                continue;
+            }
+            if (best_c < 0 || gdop < best_c_gdop) {
+                best_c = c;
+                best_c_gdop = gdop;
+            }
+        }
+
+        if (best_c < 0) {
+            break;
+        }
+        float reduction = (current_gdop - best_c_gdop) / current_gdop;
+        if (reduction < LOCATOR_FUSION_GDOP_REDUCTION_MIN) {
+            break;
+        }
+
+        const struct beacon *beacon = &beacon_db->beacons[beacon_indices[best_c]];
+        dilution_of_precision_add_bearing(
+                &base, beacon->x, beacon->y, beacon->z, x, y, z);
+        selected[best_c] = true;
+        selected_count++;
+        current_gdop = best_c_gdop;
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+int locator_estimate_position_from_angle_cache(
+        struct locator *locator,
+        int64_t timestamp,
+        struct line_intersection_result *result) {
+    if (locator == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (locator->beacon_db == NULL) {
+        AOD_DEBUG("DEBUG: locator->beacon_db is NULL\n");
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    struct locator_bearing bearings[BEACON_DATABASE_CAPACITY];
+    int beacon_indices[BEACON_DATABASE_CAPACITY];
+    int bearing_count = 0;
+
+    for (int i = 0; i < locator->beacon_db->count; i++) {
+        if (!beacon_angle_cache_is_fresh(&locator->angle_cache, i, timestamp)) {
+            continue;
+        }
+
+        const struct beacon_angle *angle = &locator->angle_cache.angles[i];
+        struct locator_bearing *bearing = &bearings[bearing_count];
+        for (int j = 0; j < BT_ADDR_SIZE; j++) {
+            bearing->beacon_mac_little_endian[j] =
+                    locator->beacon_db->beacons[i].mac_little_endian[j];
+        }
+        bearing->local_direction_cosine_x = angle->local_direction_cosine_x;
+        bearing->local_direction_cosine_y = angle->local_direction_cosine_y;
+        bearing->local_direction_cosine_z = angle->local_direction_cosine_z;
+        bearing->weight = angle->quality;
+        beacon_indices[bearing_count] = i;
+        bearing_count++;
+    }
+
+    if (bearing_count < 2) {
+        return -ENODATA; // -61 ~ "No data available".
+    }
+
+    if (bearing_count == 2) {
+        return locator_estimate_position_from_bearings(
+                locator,
+                bearings,
+                bearing_count,
+                result);
+    }
+
+    // Preliminary position from all candidate bearings, as the reference
+    // position for the GDOP.
+    struct line_intersection_result preliminary;
+    int ret = locator_solve_bearings(
+            locator,
+            bearings,
+            bearing_count,
+            &preliminary);
+    if (ret != 0) {
+        return ret;
+    }
+
+    bool selected[BEACON_DATABASE_CAPACITY];
+    ret = locator_select_beacons(
+            locator->beacon_db,
+            beacon_indices,
+            bearing_count,
+            preliminary.x,
+            preliminary.y,
+            preliminary.z,
+            selected);
+    if (ret != 0) {
+        // No usable geometry at the preliminary position, fuse all bearings.
+        return locator_estimate_position_from_bearings(
+                locator,
+                bearings,
+                bearing_count,
+                result);
+    }
+
+    struct locator_bearing selected_bearings[LOCATOR_FUSION_BEACONS_MAX];
+    int selected_count = 0;
+    for (int i = 0; i < bearing_count; i++) {
+        if (selected[i]) {
+            selected_bearings[selected_count] = bearings[i];
+            selected_count++;
+        }
+    }
+
+    return locator_estimate_position_from_bearings(
+            locator,
+            selected_bearings,
+            selected_count,
+            result);
+}
+
+int locator_estimate_position_robust(
+        struct locator *locator,
+        int64_t timestamp,
+        struct robust_line_intersection_result *result) {
+    if (locator == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (locator->beacon_db == NULL) {
+        AOD_DEBUG("DEBUG: locator->beacon_db is NULL\n");
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    int ret;
+
+    struct robust_line lines[ROBUST_LINE_INTERSECTION_LINES_MAX];
+    int line_count = 0;
+    int beacon_count = 0;
+
+    struct beacon_angle angles[BEACON_ANGLE_CACHE_HISTORY_DEPTH];
+    for (int i = 0; i < locator->beacon_db->count; i++) {
+        int angle_count = beacon_angle_cache_get_history(
+                &locator->angle_cache,
+                i,
+                timestamp,
+                angles,
+                BEACON_ANGLE_CACHE_HISTORY_DEPTH);
+        if (angle_count <= 0) {
+            continue;
+        }
+        beacon_count++;
+
+        const struct beacon *beacon = &locator->beacon_db->beacons[i];
+        for (int j = 0; j < angle_count; j++) {
+            if (line_count >= ROBUST_LINE_INTERSECTION_LINES_MAX) {
+                break;
+            }
+
+            struct robust_line *line = &lines[line_count];
+            line->px = beacon->x;
+            line->py = beacon->y;
+            line->pz = beacon->z;
+            beacon_get_global_direction_cosines(
+                    beacon,
+                    angles[j].local_direction_cosine_x,
+                    angles[j].local_direction_cosine_y,
+                    angles[j].local_direction_cosine_z,
+                    &line->dx,
+                    &line->dy,
+                    &line->dz);
+            line->weight = angles[j].quality;
+            line->group = i;
+            line_count++;
+        }
+    }
+
+    if (beacon_count < 2) {
+        return -ENODATA; // -61 ~ "No data available".
+    }
+
+    struct robust_line_intersection_result robust_result;
+    bool inliers[ROBUST_LINE_INTERSECTION_LINES_MAX];
+    ret = robust_line_intersection_solve(
+            lines,
+            line_count,
+            &locator->robust_config,
+            &robust_result,
+            inliers);
+    if (ret != 0) {
+        return ret;
+    }
+
+    struct locator_position position;
+    position.x = robust_result.solution.x;
+    position.y = robust_result.solution.y;
+    position.z = robust_result.solution.z;
+    position.error_radius = robust_result.solution.residual_rms;
+
+    // GDOP of the consensus set.
+    struct dilution_of_precision dop;
+    dilution_of_precision_init(&dop);
+    for (int i = 0; i < line_count; i++) {
+        if (inliers[i]) {
+            dilution_of_precision_add_bearing(
+                    &dop,
+                    lines[i].px,
+                    lines[i].py,
+                    lines[i].pz,
+                    position.x,
+                    position.y,
+                    position.z);
+        }
+    }
+    if (dilution_of_precision_get(&dop, &position.gdop) != 0) {
+        position.gdop = LOCATOR_POSITION_GDOP_UNAVAILABLE;
+    }
+
+    locator_put_position(locator, &position);
+
+    if (result != NULL) {
+        *result = robust_result;
+    }
+
+    locator_print_position(&position);
+
+    return 0; // 0 ~ "Success".
+}
+
+int locator_get_latest_position(
+        const struct locator *locator,
+        struct locator_position *position) {
+    if (locator == NULL || position == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (locator->history_count == 0) {
+        return -ENODATA; // -61 ~ "No data available".
+    }
+
+    int latest = (locator->history_next + LOCATOR_POSITION_CAPACITY - 1) %
+            LOCATOR_POSITION_CAPACITY;
+    *position = locator->position_history[latest];
+
+    return 0; // 0 ~ "Success".
+}
+
+int locator_get_beacon_geometry_scores(
+        const struct locator *locator,
+        float x,
+        float y,
+        float z,
+        float scores[BEACON_DATABASE_CAPACITY]) {
+    if (locator == NULL || scores == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (locator->beacon_db == NULL) {
+        AOD_DEBUG("DEBUG: locator->beacon_db is NULL\n");
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    const struct beacon_database *beacon_db = locator->beacon_db;
+    const float range_max_squared =
+            LOCATOR_GEOMETRY_RANGE_MAX * LOCATOR_GEOMETRY_RANGE_MAX;
+
+    // Beacons in range.
+    bool in_range[BEACON_DATABASE_CAPACITY];
+    for (int i = 0; i < beacon_db->count; i++) {
+        const struct beacon *beacon = &beacon_db->beacons[i];
+        float dx = x - beacon->x;
+        float dy = y - beacon->y;
+        float dz = z - beacon->z;
+        in_range[i] = (dx*dx + dy*dy + dz*dz) <= range_max_squared;
+    }
+
+    // GDOP with all beacons in range.
+    struct dilution_of_precision dop_all;
+    dilution_of_precision_init(&dop_all);
+    for (int i = 0; i < beacon_db->count; i++) {
+        if (in_range[i]) {
+            const struct beacon *beacon = &beacon_db->beacons[i];
+            dilution_of_precision_add_bearing(
+                    &dop_all, beacon->x, beacon->y, beacon->z, x, y, z);
+        }
+    }
+    float gdop_all;
+    bool all_usable = (dilution_of_precision_get(&dop_all, &gdop_all) == 0);
+
+    for (int i = 0; i < beacon_db->count; i++) {
+        if (!in_range[i]) {
+            scores[i] = 0.0f;
+            continue;
+        }
+
+        if (!all_usable) {
+            // Too few beacons in range, every beacon in range is required.
+            scores[i] = LOCATOR_GEOMETRY_SCORE_MAX;
+            continue;
+        }
+
+        // GDOP without beacon i.
+        struct dilution_of_precision dop;
+        dilution_of_precision_init(&dop);
+        for (int j = 0; j < beacon_db->count; j++) {
+            if (j != i && in_range[j]) {
+                const struct beacon *beacon = &beacon_db->beacons[j];
+                dilution_of_precision_add_bearing(
+                        &dop, beacon->x, beacon->y, beacon->z, x, y, z);
+            }
+        }
+        float gdop;
+        if (dilution_of_precision_get(&dop, &gdop) != 0) {
+            scores[i] = LOCATOR_GEOMETRY_SCORE_MAX;
+            continue;
+        }
+
+        float score = gdop / gdop_all;
+        if (score > LOCATOR_GEOMETRY_SCORE_MAX) {
+            score = LOCATOR_GEOMETRY_SCORE_MAX;
+        }
+        scores[i] = score;
+    }
+
+    return 0; // 0 ~ "Success".
 }
\ No newline at end of file
@@ -1,14 +1,34 @@
 #ifndef LOCATOR_H
 #define LOCATOR_H
 
-#include <stdint.h> // For uint8_t.
+#include <stdint.h> // For uint8_t and int64_t.
+#include "beacon_angle_cache.h" // For beacon angle cache structure.
 #include "beacon_database.h" // For beacon database structure.
 #include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "line_intersection.h" // For line intersection result structure.
+#include "locator_tracker.h" // For locator tracker structure and locator tracker configuration structure.
+#include "robust_line_intersection.h" // For robust line intersection configuration structure and robust line intersection result structure.
 
 #define LOCATOR_ERROR_PARALLEL_LINES 92 // An arbitrary error number.
 
 #define LOCATOR_POSITION_CAPACITY 256
 
+// Maximum number of beacons fused into one position.
+// See the locator_estimate_position_from_angle_cache() function.
+#define LOCATOR_FUSION_BEACONS_MAX 4
+
+// Minimum relative GDOP reduction for fusing one more beacon.
+// See the locator_estimate_position_from_angle_cache() function.
+#define LOCATOR_FUSION_GDOP_REDUCTION_MIN 0.05f
+
+// Maximum range from a beacon to the locator for a useful bearing, in meters.
+// See the locator_get_beacon_geometry_scores() function.
+#define LOCATOR_GEOMETRY_RANGE_MAX 30.0f
+
+// Geometry score of a beacon that is required for a non-degenerate geometry.
+// See the locator_get_beacon_geometry_scores() function.
+#define LOCATOR_GEOMETRY_SCORE_MAX 100.0f
+
 // Locator position structure.
 // Global coordinates and error radius.
 // TODO(wathne): Add more documentation.
@@ -20,6 +40,54 @@ struct locator_position {
     float z; // Global Z coordinate.
 
     float error_radius;
+
+    // Geometric dilution of precision of the bearings of the fix, in meters
+    // per radian. LOCATOR_POSITION_GDOP_UNAVAILABLE if not available, such as
+    // for a position of the tracker, which is updated by one bearing at a
+    // time, or for degenerate bearings.
+    // See the dilution of precision structure.
+    float gdop;
+};
+
+// GDOP of a position without an available GDOP. Any negative GDOP is not
+// available.
+#define LOCATOR_POSITION_GDOP_UNAVAILABLE -1.0f
+
+// Locator bearing structure.
+// A bearing is a line from a beacon toward the locator. The line origin is the
+// global position of the beacon, and the line direction is given by local
+// direction cosines in the local coordinate system of the beacon.
+// See the locator_estimate_position_from_bearings() function.
+struct locator_bearing {
+    // Bluetooth LE device address (MAC address) of the beacon in little-endian
+    // format (protocol/reversed octet order).
+    uint8_t beacon_mac_little_endian[BT_ADDR_SIZE];
+
+    // Local direction cosines from the beacon toward the locator.
+    float local_direction_cosine_x;
+    float local_direction_cosine_y;
+    float local_direction_cosine_z;
+
+    // Relative weight of the bearing, must be positive.
+    float weight;
+};
+
+// Locator mode.
+// See the locator_set_mode() function.
+enum locator_mode {
+    // Each position is an independent fix from a set of bearings from
+    // different beacons. See the locator_estimate_position_from_bearings()
+    // function.
+    LOCATOR_MODE_SNAPSHOT,
+
+    // Each bearing updates a tracker directly, and positions are output at the
+    // output rate of the tracker. See the locator_update_tracker() function.
+    LOCATOR_MODE_TRACKING,
+
+    // Each position is a robust fix from the recent angles of all beacons,
+    // tolerant to outlier angles. See the locator_estimate_position_robust()
+    // function.
+    LOCATOR_MODE_ROBUST,
 };
 
 // Locator structure.
@@ -28,6 +96,23 @@ struct locator_position {
 struct locator {
     struct beacon_database *beacon_db;
 
+    // See the locator_set_mode() function.
+    enum locator_mode mode;
+
+    // Latest and recent angles of all beacons in the beacon database, for
+    // LOCATOR_MODE_SNAPSHOT and LOCATOR_MODE_ROBUST.
+    // See the locator_put_angle() function.
+    struct beacon_angle_cache angle_cache;
+
+    // Robust solver configuration for LOCATOR_MODE_ROBUST. Set to default
+    // values by the locator_init() function, and may be changed directly.
+    // See the locator_estimate_position_robust() function.
+    struct robust_line_intersection_config robust_config;
+
+    // Tracker for LOCATOR_MODE_TRACKING.
+    // See the locator_update_tracker() function.
+    struct locator_tracker tracker;
+
     struct locator_position position_history[LOCATOR_POSITION_CAPACITY];
     int history_count;
     int history_next;
@@ -38,6 +123,9 @@ struct locator {
 extern struct locator g_locator;
 
 // Initialize a locator structure.
+// The locator mode is set to LOCATOR_MODE_SNAPSHOT, the angle cache is
+// initialized with BEACON_ANGLE_CACHE_DEFAULT_WINDOW_MS, and the robust solver
+// and the tracker are initialized with default configuration values.
 // Returns 0 (0 ~ "Success") if the locator structure is initialized.
 // Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
 // beacon_db pointer is NULL.
@@ -50,6 +138,29 @@ int locator_init(
 // Returns -EINVAL (-22 ~ "Invalid argument") if beacon_db pointer is NULL.
 int locator_init_global(struct beacon_database *beacon_db);
 
+// Set the mode of a locator, and the tracker configuration for
+// LOCATOR_MODE_TRACKING.
+// The tracker_config argument is optional. If tracker_config is NULL, then
+// default values are used. See the locator_tracker_config_default() function.
+// The tracker is reinitialized, and the tracker state is set on the next
+// measurement.
+// Returns 0 (0 ~ "Success") if the mode is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
+// mode is not a valid locator mode.
+int locator_set_mode(
+        struct locator *locator,
+        enum locator_mode mode,
+        const struct locator_tracker_config *tracker_config);
+
+// Put a position into the position history ring buffer of a locator.
+// The oldest position is overwritten when the position history is full.
+// Returns 0 (0 ~ "Success") if the position is put.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
+// position pointer is NULL.
+int locator_put_position(
+        struct locator *locator,
+        const struct locator_position *position);
+
 // TODO(wathne): Add documentation.
 int locator_estimate_position_from_skew_lines(
         struct locator *locator,
@@ -62,4 +173,148 @@ int locator_estimate_position_from_skew_lines(
         float beacon_2_local_direction_cosine_y,
         float beacon_2_local_direction_cosine_z);
 
+// Estimate a locator position from N >= 2 bearings.
+// Each bearing is transformed to a global line from the global position of the
+// beacon, in the global direction of the beacon. See the
+// beacon_get_global_direction_cosines() function. The locator position is the
+// weighted least squares intersection of all global lines. See the
+// line_intersection_solve() function. The cost is linear in the number of
+// bearings. The estimated position is put into the position history, with the
+// residual RMS as error radius, and with the GDOP of the bearings at the
+// estimated position.
+// The result argument is optional. If result is not NULL, then result is set
+// to the full least squares result, including the covariance matrix.
+// Returns 0 (0 ~ "Success") if a position is estimated.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
+// bearings pointer is NULL, or if bearing_count is less than 2, or if a weight
+// is not positive.
+// Returns -ENOENT (-2 ~ "No such file or directory") if a beacon is not in the
+// beacon database.
+// Returns -LOCATOR_ERROR_PARALLEL_LINES (-92 ~ "Parallel lines") if all lines
+// are nearly parallel.
+int locator_estimate_position_from_bearings(
+        struct locator *locator,
+        const struct locator_bearing *bearings,
+        int bearing_count,
+        struct line_intersection_result *result);
+
+// Update the tracker of a locator with local direction cosines from a beacon.
+// The beacon pose is taken from the beacon database. The cost of an update is
+// constant. See the locator_tracker_update() function. If a tracker output is
+// due, then the tracker position is put into the position history.
+// Returns 0 (0 ~ "Success") if the tracker is updated.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
+// beacon_mac_little_endian pointer is NULL.
+// Returns -ENOENT (-2 ~ "No such file or directory") if the beacon is not in
+// the beacon database.
+// Returns -LOCATOR_TRACKER_ERROR_OUTLIER (-94 ~ "Outlier") if the measurement
+// is rejected by the innovation gate.
+int locator_update_tracker(
+        struct locator *locator,
+        const uint8_t beacon_mac_little_endian[BT_ADDR_SIZE],
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        int64_t timestamp);
+
+// Set the time window for fresh angles in the angle cache of a locator.
+// See the locator_estimate_position_from_angle_cache() function.
+// Returns 0 (0 ~ "Success") if the time window is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
+// window_ms is negative.
+int locator_set_angle_window(
+        struct locator *locator,
+        int64_t window_ms);
+
+// Put local direction cosines from a beacon into the angle cache of a locator.
+// The angle replaces the previous angle of the same beacon, unless the
+// previous angle is newer. See the beacon_angle_cache_put() function.
+// Returns 0 (0 ~ "Success") if the angle is put.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
+// beacon_mac_little_endian pointer is NULL, or if quality is not positive.
+// Returns -ENOENT (-2 ~ "No such file or directory") if the beacon is not in
+// the beacon database.
+int locator_put_angle(
+        struct locator *locator,
+        const uint8_t beacon_mac_little_endian[BT_ADDR_SIZE],
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        float quality,
+        int64_t timestamp);
+
+// Estimate a locator position from the freshest angles of all beacons in the
+// angle cache of a locator.
+// Each beacon with an angle within the time window of the timestamp is a
+// candidate bearing, weighted by the quality of the angle. If there are more
+// than 2 candidates, then the beacons to fuse are selected greedily by GDOP at
+// a preliminary position from all candidates. The pair with the lowest GDOP is
+// selected first, and the beacon that reduces the GDOP the most is added while
+// it reduces the GDOP by at least LOCATOR_FUSION_GDOP_REDUCTION_MIN, up to
+// LOCATOR_FUSION_BEACONS_MAX beacons. See the
+// locator_estimate_position_from_bearings() function.
+// The result argument is optional, see the
+// locator_estimate_position_from_bearings() function.
+// Returns 0 (0 ~ "Success") if a position is estimated.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL.
+// Returns -ENODATA (-61 ~ "No data available") if fewer than 2 beacons have
+// fresh angles.
+// Returns -LOCATOR_ERROR_PARALLEL_LINES (-92 ~ "Parallel lines") if all lines
+// are nearly parallel.
+int locator_estimate_position_from_angle_cache(
+        struct locator *locator,
+        int64_t timestamp,
+        struct line_intersection_result *result);
+
+// Estimate a locator position robustly from the recent angles of all beacons
+// in the angle cache of a locator.
+// Each angle within the time window of the timestamp contributes one line,
+// weighted by the quality of the angle. Up to BEACON_ANGLE_CACHE_HISTORY_DEPTH
+// angles per beacon are used. Outlier lines are rejected by the robust solver
+// with locator->robust_config. See the robust_line_intersection_solve()
+// function. The estimated position is put into the position history, with the
+// residual RMS of the consensus set as error radius.
+// The result argument is optional. If result is not NULL, then result is set
+// to the full robust result.
+// Returns 0 (0 ~ "Success") if a position is estimated.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL.
+// Returns -ENODATA (-61 ~ "No data available") if fewer than 2 beacons have
+// fresh angles.
+// Returns -ROBUST_LINE_INTERSECTION_ERROR_NO_CONSENSUS (-95 ~ "No consensus")
+// if there is no consensus set.
+int locator_estimate_position_robust(
+        struct locator *locator,
+        int64_t timestamp,
+        struct robust_line_intersection_result *result);
+
+// Get the latest position in the position history of a locator.
+// Returns 0 (0 ~ "Success") if position is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
+// position pointer is NULL.
+// Returns -ENODATA (-61 ~ "No data available") if the position history is
+// empty.
+int locator_get_latest_position(
+        const struct locator *locator,
+        struct locator_position *position);
+
+// Get a geometry score for each beacon in the beacon database of a locator, at
+// a reference position (x, y, z), for example the latest position.
+// The score of a beacon is GDOP(without the beacon) / GDOP(with the beacon),
+// for all beacons within LOCATOR_GEOMETRY_RANGE_MAX of the reference position.
+// A score near 1 means that the beacon adds little, and a larger score means
+// that the beacon reduces the GDOP. A beacon that is required for a
+// non-degenerate geometry is scored LOCATOR_GEOMETRY_SCORE_MAX. A beacon out
+// of range is scored 0. The scores are intended for prioritizing which beacons
+// to sync.
+// scores[i] is set for each beacon index i in [0, beacon_db->count).
+// Returns 0 (0 ~ "Success") if scores are set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if locator pointer is NULL, or if
+// scores pointer is NULL.
+int locator_get_beacon_geometry_scores(
+        const struct locator *locator,
+        float x,
+        float y,
+        float z,
+        float scores[BEACON_DATABASE_CAPACITY]);
+
 #endif // LOCATOR_H
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "locator_kconfig.h"
+#include <errno.h> // For EINVAL (22).
+#include <stddef.h> // For NULL ((void *)0).
+#include "locator.h" // For locator structure, locator mode enum, locator_set_mode(), and locator_set_angle_window().
+#include "locator_tracker.h" // For locator tracker configuration structure and locator_tracker_config_default().
+
+int locator_kconfig_apply(struct locator *locator) {
+    if (locator == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+#if defined(CONFIG_LOCATOR_MODE_TRACKING)
+    struct locator_tracker_config tracker_config;
+    locator_tracker_config_default(&tracker_config);
+    tracker_config.output_interval_ms = CONFIG_LOCATOR_TRACKER_OUTPUT_INTERVAL_MS;
+
+    return locator_set_mode(locator, LOCATOR_MODE_TRACKING, &tracker_config);
+#else
+    int ret = locator_set_angle_window(locator, CONFIG_LOCATOR_ANGLE_WINDOW_MS);
+    if (ret != 0) {
+        return ret;
+    }
+
+#if defined(CONFIG_LOCATOR_MODE_ROBUST)
+    return locator_set_mode(locator, LOCATOR_MODE_ROBUST, NULL);
+#else
+    return locator_set_mode(locator, LOCATOR_MODE_SNAPSHOT, NULL);
+#endif
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#ifndef LOCATOR_KCONFIG_H
+#define LOCATOR_KCONFIG_H
+
+#include "locator.h" // For locator structure.
+
+// Apply the locator Kconfig options to an initialized locator: the locator
+// mode, CONFIG_LOCATOR_MODE_*, the tracker output interval of the tracking
+// mode, CONFIG_LOCATOR_TRACKER_OUTPUT_INTERVAL_MS, and the angle window of
+// the other modes, CONFIG_LOCATOR_ANGLE_WINDOW_MS.
+// See the locator_set_mode() and locator_set_angle_window() functions.
+// Returns 0 (0 ~ "Success") if the options are applied.
+// Returns a negative error number otherwise.
+int locator_kconfig_apply(struct locator *locator);
+
+#endif // LOCATOR_KCONFIG_H
\ No newline at end of file
@@ -0,0 +1,343 @@
+#include "locator_tracker.h" // For locator tracker structure, locator tracker configuration structure, and LOCATOR_TRACKER_* constants.
+#include <errno.h> // For EINVAL (22) and ENODATA (61).
+#include <math.h> // For sqrtf().
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For int64_t.
+#include "beacon.h" // For beacon structure and beacon_get_global_direction_cosines().
+
+#ifndef ENODATA
+#define ENODATA 61
+#endif
+
+// Minimum range from a beacon in the measurement model, in meters. Guards the
+// division by r in the measurement Jacobian.
+#define LOCATOR_TRACKER_RANGE_MIN 0.1f
+
+int locator_tracker_config_default(struct locator_tracker_config *config) {
+    if (config == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    config->acceleration_noise = LOCATOR_TRACKER_DEFAULT_ACCELERATION_NOISE;
+    config->direction_cosine_noise =
+            LOCATOR_TRACKER_DEFAULT_DIRECTION_COSINE_NOISE;
+    config->output_interval_ms = LOCATOR_TRACKER_DEFAULT_OUTPUT_INTERVAL_MS;
+
+    return 0; // 0 ~ "Success".
+}
+
+int locator_tracker_init(
+        struct locator_tracker *tracker,
+        const struct locator_tracker_config *config) {
+    if (tracker == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (config != NULL) {
+        tracker->config = *config;
+    } else {
+        locator_tracker_config_default(&tracker->config);
+    }
+
+    tracker->initialized = false;
+    tracker->timestamp = 0;
+    tracker->output_timestamp = 0;
+    tracker->consecutive_outliers = 0;
+
+    return 0; // 0 ~ "Success".
+}
+
+// Set the initial state of a locator tracker from a single bearing.
+// The position is set at LOCATOR_TRACKER_INITIAL_RANGE along the bearing, and
+// the velocity is set to zero.
+static void locator_tracker_initialize_state(
+        struct locator_tracker *tracker,
+        const struct beacon *beacon,
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        int64_t timestamp) {
+    float dx;
+    float dy;
+    float dz;
+    beacon_get_global_direction_cosines(
+            beacon,
+            local_direction_cosine_x,
+            local_direction_cosine_y,
+            local_direction_cosine_z,
+            &dx,
+            &dy,
+            &dz);
+
+    tracker->state[0] = beacon->x + LOCATOR_TRACKER_INITIAL_RANGE * dx;
+    tracker->state[1] = beacon->y + LOCATOR_TRACKER_INITIAL_RANGE * dy;
+    tracker->state[2] = beacon->z + LOCATOR_TRACKER_INITIAL_RANGE * dz;
+    tracker->state[3] = 0.0f;
+    tracker->state[4] = 0.0f;
+    tracker->state[5] = 0.0f;
+
+    const float position_variance =
+            LOCATOR_TRACKER_INITIAL_POSITION_STD *
+            LOCATOR_TRACKER_INITIAL_POSITION_STD;
+    const float velocity_variance =
+            LOCATOR_TRACKER_INITIAL_VELOCITY_STD *
+            LOCATOR_TRACKER_INITIAL_VELOCITY_STD;
+    for (int a = 0; a < LOCATOR_TRACKER_STATE_SIZE; a++) {
+        for (int b = 0; b < LOCATOR_TRACKER_STATE_SIZE; b++) {
+            tracker->covariance[a][b] = 0.0f;
+        }
+    }
+    for (int a = 0; a < 3; a++) {
+        tracker->covariance[a][a] = position_variance;
+        tracker->covariance[a + 3][a + 3] = velocity_variance;
+    }
+
+    tracker->timestamp = timestamp;
+    tracker->output_timestamp = timestamp;
+    tracker->consecutive_outliers = 0;
+    tracker->initialized = true;
+}
+
+// Predict the state and state covariance of a locator tracker dt seconds
+// forward with the constant velocity motion model.
+// The position and velocity axes are independent in F and Q, so the
+// covariance is propagated with 2x2 blocks instead of full 6x6 products.
+static void locator_tracker_predict(struct locator_tracker *tracker, float dt) {
+    if (dt <= 0.0f) {
+        return;
+    }
+
+    float (*p)[LOCATOR_TRACKER_STATE_SIZE] = tracker->covariance;
+
+    // s = F s
+    tracker->state[0] = tracker->state[0] + dt * tracker->state[3];
+    tracker->state[1] = tracker->state[1] + dt * tracker->state[4];
+    tracker->state[2] = tracker->state[2] + dt * tracker->state[5];
+
+    // P = F P F^T
+    // With F = [ I dt*I; 0 I ], the blocks of P are updated as:
+    // P_pp = P_pp + dt*(P_pv + P_vp) + dt^2*P_vv
+    // P_pv = P_pv + dt*P_vv
+    // P_vp = P_vp + dt*P_vv
+    // P_vv = P_vv
+    for (int a = 0; a < 3; a++) {
+        for (int b = 0; b < 3; b++) {
+            p[a][b] = p[a][b] +
+                    dt * (p[a][b + 3] + p[a + 3][b]) +
+                    dt * dt * p[a + 3][b + 3];
+        }
+    }
+    for (int a = 0; a < 3; a++) {
+        for (int b = 0; b < 3; b++) {
+            p[a][b + 3] = p[a][b + 3] + dt * p[a + 3][b + 3];
+            p[a + 3][b] = p[a + 3][b] + dt * p[a + 3][b + 3];
+        }
+    }
+
+    // P = P + Q
+    const float q = tracker->config.acceleration_noise;
+    const float q_pp = q * dt * dt * dt / 3.0f;
+    const float q_pv = q * dt * dt / 2.0f;
+    const float q_vv = q * dt;
+    for (int a = 0; a < 3; a++) {
+        p[a][a] = p[a][a] + q_pp;
+        p[a][a + 3] = p[a][a + 3] + q_pv;
+        p[a + 3][a] = p[a + 3][a] + q_pv;
+        p[a + 3][a + 3] = p[a + 3][a + 3] + q_vv;
+    }
+}
+
+int locator_tracker_update(
+        struct locator_tracker *tracker,
+        const struct beacon *beacon,
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        int64_t timestamp) {
+    if (tracker == NULL || beacon == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (!tracker->initialized) {
+        locator_tracker_initialize_state(
+                tracker,
+                beacon,
+                local_direction_cosine_x,
+                local_direction_cosine_y,
+                local_direction_cosine_z,
+                timestamp);
+        return 0; // 0 ~ "Success".
+    }
+
+    // Predict to the timestamp of the measurement. The LIFO work queue may
+    // deliver measurements out of order, older measurements are applied at the
+    // time of the tracker state.
+    if (timestamp > tracker->timestamp) {
+        float dt = (float)(timestamp - tracker->timestamp) / 1000.0f;
+        locator_tracker_predict(tracker, dt);
+        tracker->timestamp = timestamp;
+    }
+
+    float *s = tracker->state;
+    float (*p)[LOCATOR_TRACKER_STATE_SIZE] = tracker->covariance;
+
+    // V = X - B
+    float vx = s[0] - beacon->x;
+    float vy = s[1] - beacon->y;
+    float vz = s[2] - beacon->z;
+    float r = sqrtf(vx*vx + vy*vy + vz*vz);
+    if (r < LOCATOR_TRACKER_RANGE_MIN) {
+        r = LOCATOR_TRACKER_RANGE_MIN;
+    }
+
+    // U = V / r
+    float ux = vx / r;
+    float uy = vy / r;
+    float uz = vz / r;
+
+    // Predicted measurement h(s).
+    float h0 = beacon->i_x * ux + beacon->i_y * uy + beacon->i_z * uz;
+    float h1 = beacon->j_x * ux + beacon->j_y * uy + beacon->j_z * uz;
+
+    // Innovation y = z - h(s).
+    float y0 = local_direction_cosine_x - h0;
+    float y1 = local_direction_cosine_y - h1;
+
+    // Measurement Jacobian H, position columns only. The velocity columns are
+    // zero.
+    float h[2][3] = {
+        {
+            (beacon->i_x - h0 * ux) / r,
+            (beacon->i_y - h0 * uy) / r,
+            (beacon->i_z - h0 * uz) / r,
+        },
+        {
+            (beacon->j_x - h1 * ux) / r,
+            (beacon->j_y - h1 * uy) / r,
+            (beacon->j_z - h1 * uz) / r,
+        },
+    };
+
+    // P H^T (6x2).
+    float pht[LOCATOR_TRACKER_STATE_SIZE][2];
+    for (int a = 0; a < LOCATOR_TRACKER_STATE_SIZE; a++) {
+        for (int m = 0; m < 2; m++) {
+            pht[a][m] =
+                    p[a][0] * h[m][0] +
+                    p[a][1] * h[m][1] +
+                    p[a][2] * h[m][2];
+        }
+    }
+
+    // Innovation covariance S = H P H^T + R (2x2).
+    const float noise = tracker->config.direction_cosine_noise;
+    const float measurement_variance = noise * noise;
+    float s00 = h[0][0]*pht[0][0] + h[0][1]*pht[1][0] + h[0][2]*pht[2][0] +
+            measurement_variance;
+    float s01 = h[0][0]*pht[0][1] + h[0][1]*pht[1][1] + h[0][2]*pht[2][1];
+    float s11 = h[1][0]*pht[0][1] + h[1][1]*pht[1][1] + h[1][2]*pht[2][1] +
+            measurement_variance;
+
+    float determinant = s00 * s11 - s01 * s01;
+    if (!(determinant > 0.0f)) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // S^-1
+    float si00 = s11 / determinant;
+    float si01 = -s01 / determinant;
+    float si11 = s00 / determinant;
+
+    // Innovation gate, squared Mahalanobis distance y^T S^-1 y.
+    float mahalanobis = y0 * (si00 * y0 + si01 * y1) +
+            y1 * (si01 * y0 + si11 * y1);
+    if (mahalanobis > LOCATOR_TRACKER_GATE) {
+        tracker->consecutive_outliers++;
+        if (tracker->consecutive_outliers >=
+                LOCATOR_TRACKER_MAX_CONSECUTIVE_OUTLIERS) {
+            // The track is lost. Restart from this measurement.
+            locator_tracker_initialize_state(
+                    tracker,
+                    beacon,
+                    local_direction_cosine_x,
+                    local_direction_cosine_y,
+                    local_direction_cosine_z,
+                    timestamp);
+        }
+        return -LOCATOR_TRACKER_ERROR_OUTLIER; // -94 ~ "Outlier".
+    }
+    tracker->consecutive_outliers = 0;
+
+    // Kalman gain K = P H^T S^-1 (6x2).
+    float k[LOCATOR_TRACKER_STATE_SIZE][2];
+    for (int a = 0; a < LOCATOR_TRACKER_STATE_SIZE; a++) {
+        k[a][0] = pht[a][0] * si00 + pht[a][1] * si01;
+        k[a][1] = pht[a][0] * si01 + pht[a][1] * si11;
+    }
+
+    // s = s + K y
+    for (int a = 0; a < LOCATOR_TRACKER_STATE_SIZE; a++) {
+        s[a] = s[a] + k[a][0] * y0 + k[a][1] * y1;
+    }
+
+    // P = P - K (P H^T)^T, kept symmetric.
+    for (int a = 0; a < LOCATOR_TRACKER_STATE_SIZE; a++) {
+        for (int b = a; b < LOCATOR_TRACKER_STATE_SIZE; b++) {
+            float value = p[a][b] -
+                    (k[a][0] * pht[b][0] + k[a][1] * pht[b][1]);
+            p[a][b] = value;
+            p[b][a] = value;
+        }
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+bool locator_tracker_output_due(
+        const struct locator_tracker *tracker,
+        int64_t timestamp) {
+    if (tracker == NULL || !tracker->initialized) {
+        return false;
+    }
+
+    return (timestamp - tracker->output_timestamp) >=
+            tracker->config.output_interval_ms;
+}
+
+int locator_tracker_output(
+        struct locator_tracker *tracker,
+        int64_t timestamp,
+        float *x,
+        float *y,
+        float *z,
+        float *error_radius) {
+    if (tracker == NULL || x == NULL || y == NULL || z == NULL ||
+            error_radius == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (!tracker->initialized) {
+        return -ENODATA; // -61 ~ "No data available".
+    }
+
+    // Extrapolate the position without modifying the tracker state.
+    float dt = 0.0f;
+    if (timestamp > tracker->timestamp) {
+        dt = (float)(timestamp - tracker->timestamp) / 1000.0f;
+    }
+
+    const float *s = tracker->state;
+    *x = s[0] + dt * s[3];
+    *y = s[1] + dt * s[4];
+    *z = s[2] + dt * s[5];
+
+    const float (*p)[LOCATOR_TRACKER_STATE_SIZE] =
+            (const float (*)[LOCATOR_TRACKER_STATE_SIZE])tracker->covariance;
+    float trace = p[0][0] + p[1][1] + p[2][2];
+    *error_radius = sqrtf(trace);
+
+    tracker->output_timestamp = timestamp;
+
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#ifndef LOCATOR_TRACKER_H
+#define LOCATOR_TRACKER_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For int64_t.
+#include "beacon.h" // For beacon structure.
+
+#define LOCATOR_TRACKER_ERROR_OUTLIER 94 // An arbitrary error number.
+
+// Tracker state dimension, position (x, y, z) and velocity (vx, vy, vz).
+#define LOCATOR_TRACKER_STATE_SIZE 6
+
+// Default spectral density of the white noise acceleration, in (m/s^2)^2 / Hz.
+// A person walking or a slow vehicle in a tunnel.
+#define LOCATOR_TRACKER_DEFAULT_ACCELERATION_NOISE 0.5f
+
+// Default standard deviation of a measured local direction cosine.
+#define LOCATOR_TRACKER_DEFAULT_DIRECTION_COSINE_NOISE 0.05f
+
+// Default interval between tracker outputs, in milliseconds.
+#define LOCATOR_TRACKER_DEFAULT_OUTPUT_INTERVAL_MS 500
+
+// Initial range along the first measured bearing, in meters.
+#define LOCATOR_TRACKER_INITIAL_RANGE 10.0f
+
+// Initial standard deviation of each position coordinate, in meters.
+#define LOCATOR_TRACKER_INITIAL_POSITION_STD 10.0f
+
+// Initial standard deviation of each velocity coordinate, in meters/second.
+#define LOCATOR_TRACKER_INITIAL_VELOCITY_STD 1.0f
+
+// Innovation gate, chi-squared with 2 degrees of freedom at 99.9%.
+#define LOCATOR_TRACKER_GATE 13.8f
+
+// Number of consecutive gated measurements before the tracker is reset.
+#define LOCATOR_TRACKER_MAX_CONSECUTIVE_OUTLIERS 10
+
+// Locator tracker configuration structure.
+// See the locator_tracker_init() function.
+struct locator_tracker_config {
+    // Spectral density of the white noise acceleration, in (m/s^2)^2 / Hz.
+    float acceleration_noise;
+
+    // Standard deviation of a measured local direction cosine.
+    float direction_cosine_noise;
+
+    // Interval between tracker outputs, in milliseconds. The tracker is
+    // updated for every measurement, but a position is only output when at
+    // least output_interval_ms has elapsed since the previous output.
+    int64_t output_interval_ms;
+};
+
+// Locator tracker structure.
+// Extended Kalman filter (EKF) with a constant velocity motion model.
+// Each measurement is a pair of local direction cosines (x, y) from a single
+// beacon, and updates the filter directly. There is no pairing of
+// measurements from different beacons. Each update costs a constant amount of
+// computation, independent of the number of beacons.
+//
+// State:
+//     [ x  y  z  vx  vy  vz ]^T
+//
+// Prediction over dt seconds:
+//     s(k+1) = F s(k)
+//     P(k+1) = F P(k) F^T + Q
+//
+//         [ I  dt*I ]
+//     F = [ 0    I  ]
+//
+//             [ dt^3/3*I  dt^2/2*I ]
+//     Q = q * [ dt^2/2*I    dt*I   ]
+//
+// Measurement from a beacon at global position B with rotation matrix
+// R = [ i j k ], for the position X = (x, y, z):
+//     U = (X - B) / |X - B|
+//     h(s) = [ i dot U ]
+//            [ j dot U ]
+//
+// Jacobian with respect to the position, where r = |X - B|:
+//     dh/dX = [ (i - (i dot U) U)^T ] / r
+//             [ (j - (j dot U) U)^T ]
+//
+// See the locator_tracker_init() function.
+struct locator_tracker {
+    struct locator_tracker_config config;
+
+    // See the locator_tracker_init() function.
+    bool initialized;
+
+    // State vector.
+    float state[LOCATOR_TRACKER_STATE_SIZE];
+
+    // State covariance matrix.
+    float covariance[LOCATOR_TRACKER_STATE_SIZE][LOCATOR_TRACKER_STATE_SIZE];
+
+    // Timestamp of the state, in milliseconds.
+    int64_t timestamp;
+
+    // Timestamp of the previous output, in milliseconds.
+    int64_t output_timestamp;
+
+    // Number of consecutive measurements rejected by the innovation gate.
+    int consecutive_outliers;
+};
+
+// Set a locator tracker configuration structure to default values.
+// Returns 0 (0 ~ "Success") if the configuration structure is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if config pointer is NULL.
+int locator_tracker_config_default(struct locator_tracker_config *config);
+
+// Initialize a locator tracker structure.
+// The config argument is optional. If config is NULL, then default values are
+// used. See the locator_tracker_config_default() function.
+// The tracker state is set on the first measurement.
+// Returns 0 (0 ~ "Success") if the locator tracker structure is initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if tracker pointer is NULL.
+int locator_tracker_init(
+        struct locator_tracker *tracker,
+        const struct locator_tracker_config *config);
+
+// Update a locator tracker with local direction cosines from a beacon.
+// The state is predicted to the timestamp of the measurement, and then
+// corrected by the measurement. The first measurement sets the initial state
+// at LOCATOR_TRACKER_INITIAL_RANGE along the measured bearing. Measurements
+// older than the tracker state are treated as if they arrived at the time of
+// the tracker state.
+// Returns 0 (0 ~ "Success") if the tracker is updated.
+// Returns -EINVAL (-22 ~ "Invalid argument") if tracker pointer is NULL, or if
+// beacon pointer is NULL.
+// Returns -LOCATOR_TRACKER_ERROR_OUTLIER (-94 ~ "Outlier") if the measurement
+// is rejected by the innovation gate. The tracker is reset after
+// LOCATOR_TRACKER_MAX_CONSECUTIVE_OUTLIERS consecutive rejections.
+int locator_tracker_update(
+        struct locator_tracker *tracker,
+        const struct beacon *beacon,
+        float local_direction_cosine_x,
+        float local_direction_cosine_y,
+        float local_direction_cosine_z,
+        int64_t timestamp);
+
+// Check if a locator tracker output is due.
+// Returns true if the tracker is initialized and at least output_interval_ms
+// has elapsed since the previous output.
+bool locator_tracker_output_due(
+        const struct locator_tracker *tracker,
+        int64_t timestamp);
+
+// Get the predicted position of a locator tracker at a timestamp, and mark the
+// output as done. The error radius is the square root of the trace of the
+// position covariance.
+// Returns 0 (0 ~ "Success") if the position is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if tracker pointer is NULL, or if
+// x, y, z, or error_radius pointers are NULL.
+// Returns -ENODATA (-61 ~ "No data available") if the tracker is not yet
+// initialized by a measurement.
+int locator_tracker_output(
+        struct locator_tracker *tracker,
+        int64_t timestamp,
+        float *x,
+        float *y,
+        float *z,
+        float *error_radius);
+
+#endif // LOCATOR_TRACKER_H
\ No newline at end of file
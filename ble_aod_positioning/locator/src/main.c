@@ -14,37 +14,37 @@
 #include <zephyr/sys/printk.h> // For printk().
 
 #include "beacon.h"
+#include "beacon_adv_data.h"
+#include "beacon_deployment.h"
+#include "cte_report.h"
+#include "cte_rx_controller.h"
 #include "beacon_database.h"
 #include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
 #include "iq_data.h"
 #include "iq_data_work_queue.h"
+#if defined(CONFIG_LOCATOR_IQ_CAPTURE)
+#include "iq_capture_stream.h"
+#endif
 #include "locator.h"
+#include "locator_kconfig.h"
+#include "sync_context.h"
+#include "sync_manager.h"
+#include "sync_scheduler.h"
 
 // TODO(wathne): Revise all #include directives, with comments.
 
-// TODO(wathne): Implement a per_adv_context_manager to manage when to sync to
-// known beacons and when to scan for new beacons. Responses will include
-// enumerated actions, for example 0 ~ "stop syncing and start scanning", and
-// 1 ~ "stop scanning and start syncing".
-
 // NOTE(wathne): This main.c file has intentionally been reverted to a version
 // that is minimally different from the initial BLE AoD connectionless receiver
 // sample. "git diff" and "git difftool" will reveal minimally invasive
 // additions to the initial sample code. Tabular indentation has also been
 // preserved to avoid artifical differences. This aims to make it easy to
 // contrast this version against the initial sample code. Maybe this will be
-// appreciated by the next person working on this code. Unfortunately, this
-// version is not able to properly cycle between beacons. It tends to sync to
-// the same beacon indefinitely. It will repeatedly calculate direction cosines,
-// azimuth, and elevation from the first beacon it encounters, but it will not
-// be able to calculate a locator position without direction cosines from a
-// second beacon. The locator can be tricked into syncing with a second beacon
-// by power cycling both beacons. Each beacon transition will result in a new
-// locator position. There has been a version of main.c capable of cycling
-// between beacons, but that version was rushed in preparation of a simple
-// proof-of-concept demonstration. The rushed modifications were reverted
-// beacuse they were not appropriate for the longterm development of the
-// locator.
+// appreciated by the next person working on this code. The main() loop of the
+// initial sample synced to one periodic advertiser at a time. It has been
+// replaced by a loop that performs the enumerated actions of a sync manager.
+// The sync manager keeps up to CONFIG_BT_PER_ADV_SYNC_MAX simultaneous syncs
+// to known beacons, each with CTE RX enabled, and decides when to scan for new
+// beacons. See sync_manager.h.
 
 #define DEVICE_NAME CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
@@ -56,20 +56,36 @@
 #define SYNC_CREATE_TIMEOUT_INTERVAL_NUM 7
 /* Maximum length of advertising data represented in hexadecimal format */
 #define ADV_DATA_HEX_STR_LEN_MAX (BT_GAP_ADV_MAX_EXT_ADV_DATA_LEN * 2 + 1)
+// Maximum time between sync manager actions, in milliseconds. Pending syncs
+// are checked for timeout at least this often.
+#define SYNC_MANAGER_POLL_INTERVAL_MS 100
 
 // IQ data work queue.
 static struct iq_data_work_queue iq_data_work_queue;
 
-static struct bt_le_per_adv_sync *sync;
-static bt_addr_le_t per_addr;
-static volatile bool per_adv_found;
+// Context of each periodic advertising sync, indexed by the sync index. Set
+// once per sync in sync_cb(), and looked up per IQ samples report in
+// cte_recv_cb().
+static struct sync_context_table sync_context_table;
+
+// Sync manager for periodic advertising syncs to known beacons.
+static struct sync_manager sync_manager;
+
 static bool scan_enabled;
-static uint8_t per_sid;
-static uint32_t sync_create_timeout_ms;
 
-static K_SEM_DEFINE(sem_per_adv, 0, 1);
-static K_SEM_DEFINE(sem_per_sync, 0, 1);
-static K_SEM_DEFINE(sem_per_sync_lost, 0, 1);
+// Given when the sync manager may have a new action.
+static K_SEM_DEFINE(sem_sync_manager, 0, 1);
+
+// Sync scheduler for rotating syncs when more beacons are in range than there
+// are sync slots. Updated on the system work queue, which also processes IQ
+// data and updates the global locator.
+static struct sync_scheduler sync_scheduler;
+static struct k_work_delayable sync_scheduler_work;
+
+// CTE RX controller for adapting the CTE RX parameters to the load of the IQ
+// data pipeline. Updated on the system work queue.
+static struct cte_rx_controller cte_rx_controller;
+static struct k_work_delayable cte_rx_controller_work;
 
 #if defined(CONFIG_BT_DF_CTE_RX_AOA)
 /* Example sequence of antenna switch patterns for antenna matrix designed by
@@ -79,6 +95,32 @@ static const uint8_t ant_patterns[] = { 0x2, 0x0, 0x5, 0x6, 0x1, 0x4,
 					0xC, 0x9, 0xE, 0xD, 0x8, 0xA };
 #endif /* CONFIG_BT_DF_CTE_RX_AOA */
 
+#if defined(CONFIG_LOCATOR_TIMING_LOG)
+// Elapsed time since the system booted, in microseconds, for the timing log.
+// See CONFIG_LOCATOR_TIMING_LOG.
+static unsigned long long timing_now_us(void)
+{
+	return (unsigned long long)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+// Process IQ data, and log the end of processing with the advertising event of
+// the report, and whether a new position was put in the position history of
+// the global locator.
+static void iq_data_process_timed(const struct iq_raw_samples *iq_raw_samples)
+{
+	int history_next = g_locator.history_next;
+
+	iq_data_process(iq_raw_samples);
+
+	const uint8_t *mac = iq_raw_samples->beacon_mac;
+	printk("TIMING processed %02X:%02X:%02X:%02X:%02X:%02X %u %d %llu\n",
+	       mac[5], mac[4], mac[3], mac[2], mac[1], mac[0],
+	       iq_raw_samples->event_counter,
+	       g_locator.history_next != history_next ? 1 : 0,
+	       timing_now_us());
+}
+#endif
+
 static inline uint32_t adv_interval_to_ms(uint16_t interval)
 {
 	return interval * 5 / 4;
@@ -106,17 +148,6 @@ static const char *cte_type2str(uint8_t type)
 	}
 }
 
-static const char *packet_status2str(uint8_t status)
-{
-	switch (status) {
-	case BT_DF_CTE_CRC_OK: return "CRC OK";
-	case BT_DF_CTE_CRC_ERR_CTE_BASED_TIME: return "CRC not OK, CTE Info OK";
-	case BT_DF_CTE_CRC_ERR_CTE_BASED_OTHER: return "CRC not OK, Sampled other way";
-	case BT_DF_CTE_INSUFFICIENT_RESOURCES: return "No resources";
-	default: return "Unknown";
-	}
-}
-
 static bool data_cb(struct bt_data *data, void *user_data)
 {
 	char *name = user_data;
@@ -146,7 +177,20 @@ static void sync_cb(struct bt_le_per_adv_sync *sync,
 	       bt_le_per_adv_sync_get_index(sync), le_addr, info->interval,
 	       adv_interval_to_ms(info->interval), phy2str(info->phy));
 
-	k_sem_give(&sem_per_sync);
+#if defined(CONFIG_LOCATOR_TIMING_LOG)
+	char addr_str[BT_ADDR_STR_LEN];
+
+	bt_addr_to_str(&info->addr->a, addr_str, sizeof(addr_str));
+	printk("TIMING synced %u %s %u %u %llu\n", bt_le_per_adv_sync_get_index(sync),
+	       addr_str, info->sid, info->interval, timing_now_us());
+#endif
+
+	sync_context_table_set(&sync_context_table, bt_le_per_adv_sync_get_index(sync),
+			       info->addr, &g_beacon_db);
+
+	sync_manager_on_synced(&sync_manager, sync, info->addr, info->sid);
+
+	k_sem_give(&sem_sync_manager);
 }
 
 static void term_cb(struct bt_le_per_adv_sync *sync,
@@ -159,7 +203,16 @@ static void term_cb(struct bt_le_per_adv_sync *sync,
 	printk("PER_ADV_SYNC[%u]: [DEVICE]: %s sync terminated\n",
 	       bt_le_per_adv_sync_get_index(sync), le_addr);
 
-	k_sem_give(&sem_per_sync_lost);
+#if defined(CONFIG_LOCATOR_TIMING_LOG)
+	printk("TIMING sync_term %u %llu\n", bt_le_per_adv_sync_get_index(sync),
+	       timing_now_us());
+#endif
+
+	sync_context_table_clear(&sync_context_table, bt_le_per_adv_sync_get_index(sync));
+
+	sync_manager_on_term(&sync_manager, sync);
+
+	k_sem_give(&sem_sync_manager);
 }
 
 static void recv_cb(struct bt_le_per_adv_sync *sync,
@@ -169,6 +222,18 @@ static void recv_cb(struct bt_le_per_adv_sync *sync,
 	static char data_str[ADV_DATA_HEX_STR_LEN_MAX];
 	char le_addr[BT_ADDR_LE_STR_LEN];
 
+	sync_scheduler_put_rssi(&sync_scheduler, info->addr->a.val, info->rssi,
+				k_uptime_get());
+
+	// Antenna pattern of the CTEs, advertised in the periodic advertising data.
+	// Beacons that do not advertise a pattern keep the default pattern.
+	uint8_t antenna_pattern_id;
+	if (beacon_adv_data_parse(buf->data, buf->len, &antenna_pattern_id) == 0) {
+		sync_context_table_set_antenna_pattern(&sync_context_table,
+						       bt_le_per_adv_sync_get_index(sync),
+						       antenna_pattern_id);
+	}
+
 	bt_addr_le_to_str(info->addr, le_addr, sizeof(le_addr));
 	bin2hex(buf->data, buf->len, data_str, sizeof(data_str));
 
@@ -181,51 +246,15 @@ static void recv_cb(struct bt_le_per_adv_sync *sync,
 static void cte_recv_cb(struct bt_le_per_adv_sync *sync,
 			struct bt_df_per_adv_sync_iq_samples_report const *report)
 {
-	// Timestamp of when the IQ samples report arrived in this cte_recv_cb()
-	// callback function. Elapsed time since the system booted, in milliseconds.
-	int64_t report_timestamp = k_uptime_get();
-
-	struct bt_le_per_adv_sync_info info;
-
-	printk("Retrieving Periodic Advertising Sync Info...");
-	int err = bt_le_per_adv_sync_get_info(sync, &info);
-	if (err) {
-		printk("failed (err %d)\n", err);
-	}
-	printk("success\n");
-
-	char addr_s[BT_ADDR_LE_STR_LEN];
-	bt_addr_le_to_str(&info.addr, addr_s, sizeof(addr_s));
-	printk("Periodic Advertiser Address: %s\n", addr_s);
-	//printk("Advertiser SID: %u\n", info.sid);
-	//printk("Advertiser PHY: %u\n", info.phy);
-	//printk("Periodic advertising interval (N * 1.25 ms): %u\n", info.interval);
-
-	printk("Channel index: %u\n", report->chan_idx);
-
-	/*
-	printk("CTE[%u]: samples count %d, cte type %s, slot durations: %u [us], "
-	       "packet status %s, RSSI %i\n",
-	       bt_le_per_adv_sync_get_index(sync), report->sample_count,
-	       cte_type2str(report->cte_type), report->slot_durations,
-	       packet_status2str(report->packet_status), report->rssi);
-	*/
-
-	// Intermediate structure for raw IQ samples extracted from an IQ samples
-	// report.
-	struct iq_raw_samples iq_raw_samples;
-
-	// Initialize the raw IQ samples structure from the IQ samples report.
-	iq_raw_samples_init(&iq_raw_samples, report, &info, report_timestamp);
-
-	// Submit the raw IQ samples structure to the IQ data work queue.
-	// This is a specialized work queue with LIFO processing and FIFO eviction.
-	// The work queue is unfair and will process the most recently submitted
-	// work first (LIFO processing). It is expected that more work will be
-	// submitted to the work queue than the work queue is able to process. The
-	// oldest work will be evicted from the work queue when the work queue is
-	// full (FIFO eviction).
-	iq_data_work_queue_submit(&iq_data_work_queue, &iq_raw_samples);
+	// Shared with the simulated CTE report source of native_sim, see
+	// cte_report.h and cte_sim.h.
+	cte_report_handle(&sync_context_table, &iq_data_work_queue,
+			  bt_le_per_adv_sync_get_index(sync), report);
+
+#if defined(CONFIG_LOCATOR_TIMING_LOG)
+	printk("TIMING cte %u %u %llu\n", bt_le_per_adv_sync_get_index(sync),
+	       report->per_evt_counter, timing_now_us());
+#endif
 }
 
 static struct bt_le_per_adv_sync_cb sync_callbacks = {
@@ -241,6 +270,12 @@ static void scan_recv(const struct bt_le_scan_recv_info *info,
 	char le_addr[BT_ADDR_LE_STR_LEN];
 	char name[PEER_NAME_LEN_MAX];
 
+	// Only beacons in the beacon database. Reports from other advertisers are
+	// dropped before any parsing or formatting.
+	if (beacon_database_index_of(&g_beacon_db, info->addr->a.val) < 0) {
+		return;
+	}
+
 	(void)memset(name, 0, sizeof(name));
 
 	bt_data_parse(buf, data_cb, name);
@@ -259,14 +294,18 @@ static void scan_recv(const struct bt_le_scan_recv_info *info,
 	       phy2str(info->secondary_phy), info->interval, adv_interval_to_ms(info->interval),
 	       info->sid);
 
-	if (!per_adv_found && info->interval) {
-		sync_create_timeout_ms =
+	if (info->interval) {
+		int64_t timestamp = k_uptime_get();
+		uint32_t sync_create_timeout_ms =
 			adv_interval_to_ms(info->interval) * SYNC_CREATE_TIMEOUT_INTERVAL_NUM;
-		per_adv_found = true;
-		per_sid = info->sid;
-		bt_addr_le_copy(&per_addr, info->addr);
 
-		k_sem_give(&sem_per_adv);
+		sync_scheduler_put_rssi(&sync_scheduler, info->addr->a.val, info->rssi,
+					timestamp);
+
+		if (sync_manager_on_scan_recv(&sync_manager, info->addr, info->sid,
+					      sync_create_timeout_ms, timestamp)) {
+			k_sem_give(&sem_sync_manager);
+		}
 	}
 }
 
@@ -274,26 +313,66 @@ static struct bt_le_scan_cb scan_callbacks = {
 	.recv = scan_recv,
 };
 
-static void create_sync(void)
+static int create_sync(const bt_addr_le_t *addr, uint8_t sid, uint16_t skip,
+		       uint16_t timeout, bool use_per_adv_list,
+		       struct bt_le_per_adv_sync **sync)
 {
 	struct bt_le_per_adv_sync_param sync_create_param;
 	int err;
 
-	printk("Creating Periodic Advertising Sync...");
-	bt_addr_le_copy(&sync_create_param.addr, &per_addr);
-	sync_create_param.options = 0;
-	sync_create_param.sid = per_sid;
-	sync_create_param.skip = 0;
-	sync_create_param.timeout = 0xa;
-	err = bt_le_per_adv_sync_create(&sync_create_param, &sync);
+	printk("Creating Periodic Advertising Sync%s...",
+	       use_per_adv_list ? " (Periodic Advertiser List)" : "");
+	bt_addr_le_copy(&sync_create_param.addr, addr);
+	sync_create_param.options =
+		use_per_adv_list ? BT_LE_PER_ADV_SYNC_OPT_USE_PER_ADV_LIST : 0;
+	sync_create_param.sid = sid;
+	sync_create_param.skip = skip;
+	sync_create_param.timeout = timeout;
+	err = bt_le_per_adv_sync_create(&sync_create_param, sync);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return;
+		return err;
 	}
 	printk("success.\n");
+
+#if defined(CONFIG_LOCATOR_TIMING_LOG)
+	if (use_per_adv_list) {
+		printk("TIMING sync_create list %llu\n", timing_now_us());
+	} else {
+		char addr_str[BT_ADDR_STR_LEN];
+
+		bt_addr_to_str(&addr->a, addr_str, sizeof(addr_str));
+		printk("TIMING sync_create %s %llu\n", addr_str, timing_now_us());
+	}
+#endif
+
+	return 0;
+}
+
+static int update_per_adv_list(const bt_addr_le_t *addrs, const uint8_t *sids,
+			       int count)
+{
+	int err;
+
+	printk("Updating Periodic Advertiser List (%d)...", count);
+	err = bt_le_per_adv_list_clear();
+	if (err) {
+		printk("failed (err %d)\n", err);
+		return err;
+	}
+	for (int i = 0; i < count; i++) {
+		err = bt_le_per_adv_list_add(&addrs[i], sids[i]);
+		if (err) {
+			printk("failed (err %d)\n", err);
+			return err;
+		}
+	}
+	printk("success\n");
+
+	return 0;
 }
 
-static int delete_sync(void)
+static int delete_sync(struct bt_le_per_adv_sync *sync)
 {
 	int err;
 
@@ -308,12 +387,13 @@ static int delete_sync(void)
 	return 0;
 }
 
-static void enable_cte_rx(void)
+static int enable_cte_rx(struct bt_le_per_adv_sync *sync, uint8_t max_cte_count,
+			 bool cte_rx_enabled)
 {
 	int err;
 
 	const struct bt_df_per_adv_sync_cte_rx_param cte_rx_params = {
-		.max_cte_count = 5,
+		.max_cte_count = max_cte_count,
 #if defined(CONFIG_BT_DF_CTE_RX_AOA)
 		.cte_types = BT_DF_CTE_TYPE_ALL,
 		.slot_durations = 0x2,
@@ -324,13 +404,25 @@ static void enable_cte_rx(void)
 #endif /* CONFIG_BT_DF_CTE_RX_AOA */
 	};
 
-	printk("Enable receiving of CTE...\n");
+	if (cte_rx_enabled) {
+		printk("Disable receiving of CTE...");
+		err = bt_df_per_adv_sync_cte_rx_disable(sync);
+		if (err) {
+			printk("failed (err %d)\n", err);
+			return err;
+		}
+		printk("success.\n");
+	}
+
+	printk("Enable receiving of CTE (max CTE count %u)...\n", max_cte_count);
 	err = bt_df_per_adv_sync_cte_rx_enable(sync, &cte_rx_params);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return;
+		return err;
 	}
 	printk("success. CTE receive enabled.\n");
+
+	return 0;
 }
 
 static int scan_init(void)
@@ -349,7 +441,9 @@ static int scan_init(void)
 static int scan_enable(void)
 {
 	struct bt_le_scan_param param = {
-		.type = BT_LE_SCAN_TYPE_ACTIVE,
+		// Passive scanning. The beacons are not scannable, and scan
+		// requests only cost radio time.
+		.type = BT_LE_SCAN_TYPE_PASSIVE,
 		.options = BT_LE_SCAN_OPT_FILTER_DUPLICATE,
 		.interval = BT_GAP_SCAN_FAST_INTERVAL,
 		.window = BT_GAP_SCAN_FAST_WINDOW,
@@ -367,12 +461,15 @@ static int scan_enable(void)
 		}
 		printk("success\n");
 		scan_enabled = true;
+#if defined(CONFIG_LOCATOR_TIMING_LOG)
+		printk("TIMING scan_start %llu\n", timing_now_us());
+#endif
 	}
 
 	return 0;
 }
 
-static void scan_disable(void)
+static int scan_disable(void)
 {
 	int err;
 
@@ -380,11 +477,121 @@ static void scan_disable(void)
 	err = bt_le_scan_stop();
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return;
+		return err;
 	}
 	printk("Success.\n");
 
 	scan_enabled = false;
+
+	return 0;
+}
+
+// Perform a sync manager action with the Bluetooth API, and report the result
+// back to the sync manager.
+// Returns 0 (0 ~ "Success") if the action is performed.
+// Returns a negative error code if the action failed.
+static int sync_manager_action_perform(const struct sync_manager_action *action)
+{
+	struct bt_le_per_adv_sync *sync = NULL;
+	int err = 0;
+
+	switch (action->type) {
+	case SYNC_MANAGER_ACTION_CREATE_SYNC:
+		if (action->recovery) {
+			printk("Recovering lost sync to beacon %d...\n", action->beacon_index);
+		}
+		err = create_sync(&action->addr, action->sid, action->skip,
+				  action->sync_timeout, action->use_per_adv_list, &sync);
+		sync_manager_on_create_sync(&sync_manager, action, sync,
+					    k_uptime_get(), err);
+		break;
+	case SYNC_MANAGER_ACTION_DELETE_SYNC:
+		// The slot is freed even if the sync could not be deleted. The
+		// slot is otherwise stuck, and a failed delete is retried forever.
+		err = delete_sync(action->sync);
+		// No more callbacks arrive for a deleted sync.
+		sync_context_table_clear(&sync_context_table, action->slot_index);
+		sync_manager_on_delete_sync(&sync_manager, action->slot_index);
+		break;
+	case SYNC_MANAGER_ACTION_ENABLE_CTE_RX:
+		err = enable_cte_rx(action->sync, action->max_cte_count,
+				    action->cte_rx_enabled);
+		sync_manager_on_enable_cte_rx(&sync_manager, action, err);
+		if (!err) {
+			printk("Active periodic syncs: %d\n",
+			       sync_manager_active_count(&sync_manager));
+		}
+		break;
+	case SYNC_MANAGER_ACTION_UPDATE_PER_ADV_LIST:
+		err = update_per_adv_list(action->list_addrs, action->list_sids,
+					  action->list_count);
+		sync_manager_on_update_per_adv_list(&sync_manager, action, err);
+		break;
+	case SYNC_MANAGER_ACTION_START_SCAN:
+		err = scan_enable();
+		sync_manager_on_scan(&sync_manager, scan_enabled);
+		break;
+	case SYNC_MANAGER_ACTION_STOP_SCAN:
+		/* Disable scan to cleanup output */
+		err = scan_disable();
+		sync_manager_on_scan(&sync_manager, scan_enabled);
+		break;
+	default:
+		break;
+	}
+
+	return err;
+}
+
+static void sync_scheduler_work_handler(struct k_work *work)
+{
+	sync_scheduler_update(&sync_scheduler, &g_locator, k_uptime_get());
+	sync_manager_set_beacon_values(&sync_manager, sync_scheduler.values);
+
+	k_work_reschedule(&sync_scheduler_work,
+			  K_MSEC(SYNC_SCHEDULER_UPDATE_INTERVAL_MS));
+}
+
+static void cte_rx_controller_work_handler(struct k_work *work)
+{
+	static int64_t previous_timestamp;
+	static int previous_history_next = -1;
+
+	int64_t timestamp = k_uptime_get();
+
+	struct iq_data_work_queue_stats stats;
+	iq_data_work_queue_get_stats(&iq_data_work_queue, &stats, true);
+
+	// Position quality is poor if there is no new position, or if the latest
+	// position has a poor GDOP. A negative GDOP is not available.
+	struct locator_position position;
+	bool position_quality_poor = g_locator.history_next == previous_history_next ||
+		(locator_get_latest_position(&g_locator, &position) == 0 &&
+		 position.gdop > CTE_RX_CONTROLLER_GDOP_POOR);
+	previous_history_next = g_locator.history_next;
+
+	const struct cte_rx_controller_input input = {
+		.interval_ms = (uint32_t)(timestamp - previous_timestamp),
+		.submitted_count = stats.submitted_count,
+		.processed_count = stats.processed_count,
+		.processing_time_us_total = stats.processing_time_us_total,
+		.position_quality_poor = position_quality_poor,
+	};
+	previous_timestamp = timestamp;
+
+	if (cte_rx_controller_update(&cte_rx_controller, &input) > 0) {
+		printk("CTE RX controller: max CTE count %u, skip %u "
+		       "(submitted %u, evicted %u, processed %u, max %u us)\n",
+		       cte_rx_controller.max_cte_count, cte_rx_controller.skip,
+		       stats.submitted_count, stats.evicted_count, stats.processed_count,
+		       stats.processing_time_us_max);
+		sync_manager_set_cte_rx_params(&sync_manager, cte_rx_controller.max_cte_count,
+					       cte_rx_controller.skip);
+		k_sem_give(&sem_sync_manager);
+	}
+
+	k_work_reschedule(&cte_rx_controller_work,
+			  K_MSEC(CTE_RX_CONTROLLER_UPDATE_INTERVAL_MS));
 }
 
 int main(void)
@@ -401,127 +608,121 @@ int main(void)
 	}
 	printk("success\n");
 
-	// TODO(wathne): Populating the beacon database with beacon data from within
-	// this main() function is a temporary solution. Beacon data for the beacon
-	// database should instead be sourced from a local file or from an external
-	// server.
-
-	// Beacon 1, 1050638918, F6:66:CD:FD:DC:EB.
-	printk("Initializing beacon 1 struct (1050638918, F6:66:CD:FD:DC:EB)...");
-	struct beacon beacon_1;
-	uint8_t beacon_1_mac[BT_ADDR_SIZE] = {0xF6, 0x66, 0xCD, 0xFD, 0xDC, 0xEB};
-	err = beacon_init(&beacon_1, beacon_1_mac, 10, 0, 0, 0, 0, 0);
+	// Beacons of the test site, shared with the host tools so that IQ captures
+	// are replayed with the same beacon database. See beacon_deployment.c.
+	printk("Adding %d deployed beacons to global beacon database...",
+	       beacon_deployment_count);
+	err = beacon_deployment_put_all(&g_beacon_db);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	printk("Adding beacon 1 struct to global beacon database...");
-	err = beacon_database_put(&g_beacon_db, &beacon_1);
+	printk("Printing global beacon database entries:\n");
+	for (int i = 0; i < g_beacon_db.count; i++) {
+		const struct beacon *beacon_temp = &g_beacon_db.beacons[i];
+		printk(
+				"mac = %02X:%02X:%02X:%02X:%02X:%02X\n"
+				"\n"
+				"(x, y, z) = (%.2f, %.2f, %.2f)\n"
+				"\n"
+				"    [ i_x j_x k_x ]   [ %6.2f %6.2f %6.2f ]\n"
+				"R = [ i_y j_y k_y ] = [ %6.2f %6.2f %6.2f ]\n"
+				"    [ i_z j_z k_z ]   [ %6.2f %6.2f %6.2f ]\n"
+				"\n",
+				beacon_temp->mac_big_endian[0], beacon_temp->mac_big_endian[1],
+				beacon_temp->mac_big_endian[2], beacon_temp->mac_big_endian[3],
+				beacon_temp->mac_big_endian[4], beacon_temp->mac_big_endian[5],
+				beacon_temp->x, beacon_temp->y, beacon_temp->z,
+				beacon_temp->i_x, beacon_temp->j_x, beacon_temp->k_x,
+				beacon_temp->i_y, beacon_temp->j_y, beacon_temp->k_y,
+				beacon_temp->i_z, beacon_temp->j_z, beacon_temp->k_z);
+	}
+
+	printk("Initializing global locator with global beacon database...");
+	err = locator_init_global(&g_beacon_db);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	// TODO(wathne): The debugger on Beacon 2 has become unresponsive. It may be
-	// possible to flash Beacon 2 from another NRF52833DK. Beacon 2 is currently
-	// decomissioned.
-	// Beacon 2, 1050625843, CE:96:F5:15:D2:45.
-	printk("Initializing beacon 2 struct (1050625843, CE:96:F5:15:D2:45)...");
-	struct beacon beacon_2;
-	uint8_t beacon_2_mac[BT_ADDR_SIZE] = {0xCE, 0x96, 0xF5, 0x15, 0xD2, 0x45};
-	err = beacon_init(&beacon_2, beacon_2_mac, 0, 0, 0, 0, 0, 0);
+	printk("Setting locator mode from Kconfig...");
+	err = locator_kconfig_apply(&g_locator);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	printk("Adding beacon 2 struct to global beacon database...");
-	err = beacon_database_put(&g_beacon_db, &beacon_2);
+	printk("Initializing work queue with LIFO processing and FIFO eviction...");
+#if defined(CONFIG_LOCATOR_TIMING_LOG)
+	iq_data_work_queue_init(
+			&iq_data_work_queue,
+			&k_sys_work_q,
+			iq_data_process_timed);
+#else
+	iq_data_work_queue_init(
+			&iq_data_work_queue,
+			&k_sys_work_q,
+			iq_data_process);
+#endif
+	printk("success\n");
+
+#if defined(CONFIG_LOCATOR_IQ_CAPTURE)
+	printk("Initializing IQ capture stream...");
+	err = iq_capture_stream_init();
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
+#endif
 
-	// Beacon 3,  685689749, D5:55:32:1F:94:9F.
-	printk("Initializing beacon 3 struct ( 685689749, D5:55:32:1F:94:9F)...");
-	struct beacon beacon_3;
-	uint8_t beacon_3_mac[BT_ADDR_SIZE] = {0xD5, 0x55, 0x32, 0x1F, 0x94, 0x9F};
-	err = beacon_init(&beacon_3, beacon_3_mac, 0, 0, 0, 0, 0, 0);
+	printk("Bluetooth initialization...");
+	err = bt_enable(NULL);
 	if (err) {
 		printk("failed (err %d)\n", err);
-		return 0;
 	}
 	printk("success\n");
 
-	printk("Adding beacon 3 struct to global beacon database...");
-	err = beacon_database_put(&g_beacon_db, &beacon_3);
+	sync_context_table_init(&sync_context_table);
+
+	printk("Initializing sync manager with global beacon database...");
+	err = sync_manager_init(&sync_manager, &g_beacon_db);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	// Beacon 1, 1050638918, F6:66:CD:FD:DC:EB.
-	// Beacon 2, 1050625843, CE:96:F5:15:D2:45.
-	// Beacon 3,  685689749, D5:55:32:1F:94:9F.
-	printk("Printing global beacon database entries:\n");
-	struct beacon beacon_temp;
-	uint8_t beacons_mac_big_endian[3][6] = {
-			{0xF6, 0x66, 0xCD, 0xFD, 0xDC, 0xEB},
-			{0xCE, 0x96, 0xF5, 0x15, 0xD2, 0x45},
-			{0xD5, 0x55, 0x32, 0x1F, 0x94, 0x9F}};
-	uint8_t beacons_mac_little_endian[3][6] = {
-			{0xEB, 0xDC, 0xFD, 0xCD, 0x66, 0xF6},
-			{0x45, 0xD2, 0x15, 0xF5, 0x96, 0xCE},
-			{0x9F, 0x94, 0x1F, 0x32, 0x55, 0xD5}};
-	for (int i = 0; i < 3; i++) {
-		beacon_database_get(
-				&g_beacon_db,
-				&beacon_temp,
-				beacons_mac_little_endian[i]);
-		printk(
-				"mac = %02X:%02X:%02X:%02X:%02X:%02X\n"
-				"\n"
-				"(x, y, z) = (%.2f, %.2f, %.2f)\n"
-				"\n"
-				"    [ i_x j_x k_x ]   [ %6.2f %6.2f %6.2f ]\n"
-				"R = [ i_y j_y k_y ] = [ %6.2f %6.2f %6.2f ]\n"
-				"    [ i_z j_z k_z ]   [ %6.2f %6.2f %6.2f ]\n"
-				"\n",
-				beacon_temp.mac_big_endian[0], beacon_temp.mac_big_endian[1],
-				beacon_temp.mac_big_endian[2], beacon_temp.mac_big_endian[3],
-				beacon_temp.mac_big_endian[4], beacon_temp.mac_big_endian[5],
-				beacon_temp.x, beacon_temp.y, beacon_temp.z,
-				beacon_temp.i_x, beacon_temp.j_x, beacon_temp.k_x,
-				beacon_temp.i_y, beacon_temp.j_y, beacon_temp.k_y,
-				beacon_temp.i_z, beacon_temp.j_z, beacon_temp.k_z);
-	}
-
-	printk("Initializing global locator with global beacon database...");
-	err = locator_init_global(&g_beacon_db);
+	// The tracking set by default in the tracking mode, see Kconfig.
+	uint8_t sid = CONFIG_LOCATOR_ADV_SET_SID;
+	printk("Syncing to advertising set SID %u of each beacon...", sid);
+	err = sync_manager_set_sid(&sync_manager, sid);
 	if (err) {
 		printk("failed (err %d)\n", err);
 		return 0;
 	}
 	printk("success\n");
 
-	printk("Initializing work queue with LIFO processing and FIFO eviction...");
-	iq_data_work_queue_init(
-			&iq_data_work_queue,
-			&k_sys_work_q,
-			iq_data_process);
-	printk("success\n");
-
-	printk("Bluetooth initialization...");
-	err = bt_enable(NULL);
+	printk("Initializing sync scheduler with global beacon database...");
+	err = sync_scheduler_init(&sync_scheduler, &g_beacon_db);
 	if (err) {
 		printk("failed (err %d)\n", err);
+		return 0;
 	}
+	k_work_init_delayable(&sync_scheduler_work, sync_scheduler_work_handler);
+	k_work_schedule(&sync_scheduler_work, K_MSEC(SYNC_SCHEDULER_UPDATE_INTERVAL_MS));
+	printk("success\n");
+
+	printk("Initializing CTE RX controller...");
+	cte_rx_controller_init(&cte_rx_controller);
+	sync_manager_set_cte_rx_params(&sync_manager, cte_rx_controller.max_cte_count,
+				       cte_rx_controller.skip);
+	k_work_init_delayable(&cte_rx_controller_work, cte_rx_controller_work_handler);
+	k_work_schedule(&cte_rx_controller_work, K_MSEC(CTE_RX_CONTROLLER_UPDATE_INTERVAL_MS));
 	printk("success\n");
 
 	scan_init();
@@ -529,42 +730,19 @@ int main(void)
 	scan_enabled = false;
 
 	while (true) {
-		per_adv_found = false;
-		scan_enable();
-
-		printk("Waiting for periodic advertising...\n");
-		err = k_sem_take(&sem_per_adv, K_FOREVER);
-		if (err) {
-			printk("failed (err %d)\n", err);
-			return 0;
-		}
-		printk("success. Found periodic advertising.\n");
-
-		create_sync();
+		struct sync_manager_action action;
 
-		printk("Waiting for periodic sync...\n");
-		err = k_sem_take(&sem_per_sync, K_MSEC(sync_create_timeout_ms));
-		if (err) {
-			printk("failed (err %d)\n", err);
-			err = delete_sync();
+		// Perform actions until the sync manager has nothing to do. A failed
+		// action is retried after the next wait.
+		while (sync_manager_get_action(&sync_manager, k_uptime_get(), &action)) {
+			err = sync_manager_action_perform(&action);
 			if (err) {
-				return 0;
+				break;
 			}
-			continue;
 		}
-		printk("success. Periodic sync established.\n");
-
-		enable_cte_rx();
 
-		/* Disable scan to cleanup output */
-		scan_disable();
-
-		printk("Waiting for periodic sync lost...\n");
-		err = k_sem_take(&sem_per_sync_lost, K_FOREVER);
-		if (err) {
-			printk("failed (err %d)\n", err);
-			return 0;
-		}
-		printk("Periodic sync lost.\n");
+		// Wait for a callback to report an event, or for the poll interval to
+		// elapse. A timeout is expected.
+		(void)k_sem_take(&sem_sync_manager, K_MSEC(SYNC_MANAGER_POLL_INTERVAL_MS));
 	}
 }
@@ -0,0 +1,125 @@
+// Locator on native_sim with the simulated CTE report source.
+//
+// Runs the IQ data pipeline of the locator, from the cte_recv_cb() path to the
+// global locator, on reports of the simulated CTE report source instead of the
+// Bluetooth stack, see cte_sim.h. Replaces main.c when CONFIG_LOCATOR_CTE_SIM
+// is enabled. Prints the load of the pipeline once per second of simulated
+// time: the report rate, the work queue counters and the share of reports
+// evicted from a full queue, the reports overrun by the source, the CPU load
+// of processing, and the latency from the report to the end of processing.
+// The run time is set by the -stop_at=SECONDS option of native_sim.
+
+#include <stdint.h> // For uint32_t and int64_t.
+#include <stdio.h> // For printf().
+#include <zephyr/kernel.h> // For k_sleep(), k_uptime_get(), and k_sys_work_q.
+#include "beacon_database.h" // For beacon_database_init_global() and g_beacon_db.
+#include "beacon_deployment.h" // For beacon_deployment_put_all().
+#include "cte_sim.h" // For cte_sim_init(), cte_sim_start(), cte_sim_process(), and cte_sim_get_stats().
+#include "iq_data_work_queue.h" // For IQ data work queue structure, iq_data_work_queue_init(), and iq_data_work_queue_get_stats().
+#include "locator.h" // For g_locator instance and locator_init_global().
+#include "locator_kconfig.h" // For locator_kconfig_apply().
+#include "sync_context.h" // For sync context table structure and sync_context_table_init().
+
+// Interval between printed statistics, in milliseconds.
+#define STATS_INTERVAL_MS 1000
+
+// IQ data work queue.
+static struct iq_data_work_queue iq_data_work_queue;
+
+// Context of each simulated sync, indexed by the sync index.
+static struct sync_context_table sync_context_table;
+
+static void print_stats(int64_t uptime_ms, int64_t interval_ms) {
+    struct iq_data_work_queue_stats queue_stats;
+    struct cte_sim_stats sim_stats;
+    (void)iq_data_work_queue_get_stats(&iq_data_work_queue, &queue_stats, true);
+    (void)cte_sim_get_stats(&sim_stats, true);
+
+    float evicted_percent = queue_stats.submitted_count > 0
+            ? 100.0f * (float)queue_stats.evicted_count / (float)queue_stats.submitted_count
+            : 0.0f;
+    float cpu_percent = interval_ms > 0
+            ? 100.0f * (float)sim_stats.busy_us / (1000.0f * (float)interval_ms)
+            : 0.0f;
+    float latency_mean_ms = sim_stats.processed_count > 0
+            ? (float)sim_stats.latency_ms_total / (float)sim_stats.processed_count
+            : 0.0f;
+
+    printf("t=%lld ms: delivered %u, overrun %u, skipped %u, "
+            "submitted %u, evicted %u (%.1f%%), processed %u, "
+            "CPU %.1f%%, latency mean %.1f ms, max %lld ms\n",
+            (long long)uptime_ms,
+            (unsigned int)sim_stats.delivered_count,
+            (unsigned int)sim_stats.overrun_count,
+            (unsigned int)sim_stats.skipped_count,
+            (unsigned int)queue_stats.submitted_count,
+            (unsigned int)queue_stats.evicted_count,
+            (double)evicted_percent,
+            (unsigned int)queue_stats.processed_count,
+            (double)cpu_percent,
+            (double)latency_mean_ms,
+            (long long)sim_stats.latency_ms_max);
+}
+
+int main(void) {
+    int err;
+
+    printf("Starting Connectionless Locator Demo with simulated CTE reports\n");
+
+    err = beacon_database_init_global();
+    if (err) {
+        printf("Beacon database initialization failed (err %d)\n", err);
+        return 0;
+    }
+
+    err = beacon_deployment_put_all(&g_beacon_db);
+    if (err) {
+        printf("Beacon deployment failed (err %d)\n", err);
+        return 0;
+    }
+
+    err = locator_init_global(&g_beacon_db);
+    if (err) {
+        printf("Locator initialization failed (err %d)\n", err);
+        return 0;
+    }
+
+    err = locator_kconfig_apply(&g_locator);
+    if (err) {
+        printf("Locator mode failed (err %d)\n", err);
+        return 0;
+    }
+
+    iq_data_work_queue_init(&iq_data_work_queue, &k_sys_work_q, cte_sim_process);
+
+    sync_context_table_init(&sync_context_table);
+
+    err = cte_sim_init(&sync_context_table, &iq_data_work_queue, &g_beacon_db);
+    if (err) {
+        printf("Simulated CTE report source initialization failed (err %d)\n", err);
+        return 0;
+    }
+
+    printf("Simulated CTE reports at %u reports/s from %d beacons\n",
+            (unsigned int)cte_sim_get_rate(),
+            g_beacon_db.count < SYNC_CONTEXT_TABLE_CAPACITY
+                    ? g_beacon_db.count
+                    : SYNC_CONTEXT_TABLE_CAPACITY);
+
+    err = cte_sim_start();
+    if (err) {
+        printf("Simulated CTE report source start failed (err %d)\n", err);
+        return 0;
+    }
+
+    int64_t last_ms = k_uptime_get();
+    while (true) {
+        k_sleep(K_MSEC(STATS_INTERVAL_MS));
+
+        int64_t now_ms = k_uptime_get();
+        print_stats(now_ms, now_ms - last_ms);
+        last_ms = now_ms;
+    }
+
+    return 0;
+}
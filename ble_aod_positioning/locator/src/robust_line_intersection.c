@@ -0,0 +1,343 @@
+#include "robust_line_intersection.h" // For robust line structure, robust line intersection configuration structure, robust line intersection result structure, and ROBUST_LINE_INTERSECTION_* constants.
+#include <errno.h> // For EINVAL (22).
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint32_t.
+#include "line_intersection.h" // For line intersection structure, line_intersection_solve(), and line_intersection_distance().
+
+int robust_line_intersection_config_default(
+        struct robust_line_intersection_config *config) {
+    if (config == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    config->max_iterations = ROBUST_LINE_INTERSECTION_DEFAULT_MAX_ITERATIONS;
+    config->inlier_distance = ROBUST_LINE_INTERSECTION_DEFAULT_INLIER_DISTANCE;
+    config->seed = ROBUST_LINE_INTERSECTION_DEFAULT_SEED;
+
+    return 0; // 0 ~ "Success".
+}
+
+// Xorshift32 pseudorandom number generator.
+// The state must not be 0.
+static uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Score lines against a candidate point (x, y, z).
+// Sets inliers[i] for each line if inliers is not NULL.
+// Sets inlier_count to the number of inlier lines, and sets has_two_groups to
+// true if the inlier lines are from at least 2 different groups.
+// Returns the total score. See the robust_line_intersection_solve() function.
+static float score_point(
+        const struct robust_line *lines,
+        int line_count,
+        float inlier_distance,
+        float x,
+        float y,
+        float z,
+        bool *inliers,
+        int *inlier_count,
+        bool *has_two_groups) {
+    float score = 0.0f;
+    int count = 0;
+    int first_group = 0;
+    bool two_groups = false;
+
+    for (int i = 0; i < line_count; i++) {
+        const struct robust_line *line = &lines[i];
+        bool inlier = false;
+
+        // The candidate point must be in front of the line origin.
+        float t = (x - line->px) * line->dx +
+                (y - line->py) * line->dy +
+                (z - line->pz) * line->dz;
+        if (t > 0.0f) {
+            float distance = line_intersection_distance(
+                    x,
+                    y,
+                    z,
+                    line->px,
+                    line->py,
+                    line->pz,
+                    line->dx,
+                    line->dy,
+                    line->dz);
+            if (distance <= inlier_distance) {
+                float ratio = distance / inlier_distance;
+                score = score + line->weight * (1.0f - ratio * ratio);
+                inlier = true;
+            }
+        }
+
+        if (inlier) {
+            if (count == 0) {
+                first_group = line->group;
+            } else if (line->group != first_group) {
+                two_groups = true;
+            }
+            count++;
+        }
+
+        if (inliers != NULL) {
+            inliers[i] = inlier;
+        }
+    }
+
+    *inlier_count = count;
+    *has_two_groups = two_groups;
+
+    return score;
+}
+
+// Least squares intersection of the lines marked in inliers.
+// Returns 0 (0 ~ "Success") if the result is set, or a negative error number
+// from the line_intersection_solve() function.
+static int solve_inliers(
+        const struct robust_line *lines,
+        int line_count,
+        const bool *inliers,
+        struct line_intersection_result *result) {
+    struct line_intersection line_intersection;
+    line_intersection_init(&line_intersection);
+
+    int ret;
+    for (int i = 0; i < line_count; i++) {
+        if (!inliers[i]) {
+            continue;
+        }
+
+        ret = line_intersection_add_line(
+                &line_intersection,
+                lines[i].px,
+                lines[i].py,
+                lines[i].pz,
+                lines[i].dx,
+                lines[i].dy,
+                lines[i].dz,
+                lines[i].weight);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    return line_intersection_solve(&line_intersection, result);
+}
+
+// Candidate point of a minimal subset, the least squares intersection of two
+// lines.
+// Returns 0 (0 ~ "Success") if the candidate point is set, or a negative error
+// number from the line_intersection_solve() function.
+static int solve_pair(
+        const struct robust_line *line_1,
+        const struct robust_line *line_2,
+        struct line_intersection_result *result) {
+    struct line_intersection line_intersection;
+    line_intersection_init(&line_intersection);
+
+    // Equal weights for the candidate point.
+    line_intersection_add_line(
+            &line_intersection,
+            line_1->px,
+            line_1->py,
+            line_1->pz,
+            line_1->dx,
+            line_1->dy,
+            line_1->dz,
+            1.0f);
+    line_intersection_add_line(
+            &line_intersection,
+            line_2->px,
+            line_2->py,
+            line_2->pz,
+            line_2->dx,
+            line_2->dy,
+            line_2->dz,
+            1.0f);
+
+    return line_intersection_solve(&line_intersection, result);
+}
+
+int robust_line_intersection_solve(
+        const struct robust_line *lines,
+        int line_count,
+        const struct robust_line_intersection_config *config,
+        struct robust_line_intersection_result *result,
+        bool *inliers) {
+    if (lines == NULL || result == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (line_count < 2 || line_count > ROBUST_LINE_INTERSECTION_LINES_MAX) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    struct robust_line_intersection_config default_config;
+    if (config == NULL) {
+        robust_line_intersection_config_default(&default_config);
+        config = &default_config;
+    }
+
+    const int max_iterations = config->max_iterations;
+    const float inlier_distance = config->inlier_distance;
+
+    // Count valid pairs, up to max_iterations + 1. If all valid pairs fit in
+    // the iteration budget, then all pairs are evaluated exhaustively.
+    int pair_count = 0;
+    for (int a = 0; a < line_count && pair_count <= max_iterations; a++) {
+        for (int b = a + 1; b < line_count; b++) {
+            if (lines[a].group != lines[b].group) {
+                pair_count++;
+            }
+        }
+    }
+    bool exhaustive = (pair_count <= max_iterations);
+
+    uint32_t random_state = config->seed;
+    if (random_state == 0) {
+        random_state = ROBUST_LINE_INTERSECTION_DEFAULT_SEED;
+    }
+
+    float best_score = 0.0f;
+    bool best_found = false;
+    float best_x = 0.0f;
+    float best_y = 0.0f;
+    float best_z = 0.0f;
+
+    int iteration_count = 0;
+    int a = 0;
+    int b = 0;
+    for (int iteration = 0; iteration < max_iterations; iteration++) {
+        if (exhaustive) {
+            // Next valid pair (a, b) with a < b, in lexicographic order.
+            bool found = false;
+            while (!found) {
+                b++;
+                if (b >= line_count) {
+                    a++;
+                    b = a + 1;
+                }
+                if (a >= line_count - 1) {
+                    break;
+                }
+                found = (lines[a].group != lines[b].group);
+            }
+            if (!found) {
+                break;
+            }
+        } else {
+            a = (int)(xorshift32(&random_state) % (uint32_t)line_count);
+            b = (int)(xorshift32(&random_state) % (uint32_t)(line_count - 1));
+            if (b >= a) {
+                b++;
+            }
+        }
+        iteration_count++;
+
+        if (lines[a].group == lines[b].group) {
+            continue;
+        }
+
+        struct line_intersection_result candidate;
+        if (solve_pair(&lines[a], &lines[b], &candidate) != 0) {
+            continue;
+        }
+
+        int inlier_count;
+        bool has_two_groups;
+        float score = score_point(
+                lines,
+                line_count,
+                inlier_distance,
+                candidate.x,
+                candidate.y,
+                candidate.z,
+                NULL,
+                &inlier_count,
+                &has_two_groups);
+        if (!has_two_groups) {
+            continue;
+        }
+
+        if (!best_found || score > best_score) {
+            best_found = true;
+            best_score = score;
+            best_x = candidate.x;
+            best_y = candidate.y;
+            best_z = candidate.z;
+        }
+    }
+
+    if (!best_found) {
+        return -ROBUST_LINE_INTERSECTION_ERROR_NO_CONSENSUS; // -95 ~ "No consensus".
+    }
+
+    bool consensus[ROBUST_LINE_INTERSECTION_LINES_MAX];
+    int inlier_count;
+    bool has_two_groups;
+    int ret;
+
+    // Refine on the consensus set of the best candidate point.
+    score_point(
+            lines,
+            line_count,
+            inlier_distance,
+            best_x,
+            best_y,
+            best_z,
+            consensus,
+            &inlier_count,
+            &has_two_groups);
+    struct line_intersection_result solution;
+    ret = solve_inliers(lines, line_count, consensus, &solution);
+    if (ret != 0) {
+        return -ROBUST_LINE_INTERSECTION_ERROR_NO_CONSENSUS; // -95 ~ "No consensus".
+    }
+
+    // Select the consensus set once more from the refined point. Keep the
+    // first refinement if the new consensus set is not usable.
+    bool refined_consensus[ROBUST_LINE_INTERSECTION_LINES_MAX];
+    int refined_inlier_count;
+    score_point(
+            lines,
+            line_count,
+            inlier_distance,
+            solution.x,
+            solution.y,
+            solution.z,
+            refined_consensus,
+            &refined_inlier_count,
+            &has_two_groups);
+    if (has_two_groups) {
+        struct line_intersection_result refined_solution;
+        ret = solve_inliers(
+                lines,
+                line_count,
+                refined_consensus,
+                &refined_solution);
+        if (ret == 0) {
+            solution = refined_solution;
+            inlier_count = refined_inlier_count;
+            for (int i = 0; i < line_count; i++) {
+                consensus[i] = refined_consensus[i];
+            }
+        }
+    }
+
+    result->solution = solution;
+    result->inlier_count = inlier_count;
+    result->iteration_count = iteration_count;
+
+    if (inliers != NULL) {
+        for (int i = 0; i < line_count; i++) {
+            inliers[i] = consensus[i];
+        }
+    }
+
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
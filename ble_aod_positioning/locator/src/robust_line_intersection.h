@@ -0,0 +1,116 @@
+#ifndef ROBUST_LINE_INTERSECTION_H
+#define ROBUST_LINE_INTERSECTION_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For uint32_t.
+#include "line_intersection.h" // For line intersection result structure.
+
+#define ROBUST_LINE_INTERSECTION_ERROR_NO_CONSENSUS 95 // An arbitrary error number.
+
+// Maximum number of lines in a robust line intersection.
+#define ROBUST_LINE_INTERSECTION_LINES_MAX 64
+
+// Default maximum number of minimal subsets to evaluate.
+#define ROBUST_LINE_INTERSECTION_DEFAULT_MAX_ITERATIONS 32
+
+// Default maximum perpendicular distance from a candidate point to an inlier
+// line, in meters.
+#define ROBUST_LINE_INTERSECTION_DEFAULT_INLIER_DISTANCE 1.0f
+
+// Default seed for the pseudorandom selection of minimal subsets.
+#define ROBUST_LINE_INTERSECTION_DEFAULT_SEED 0x2545f491u
+
+// Robust line structure.
+// A line with an origin P, a normalized direction D, and a relative weight.
+// Lines in the same group are never paired in a minimal subset, since lines
+// from the same beacon are nearly parallel.
+// See the robust_line_intersection_solve() function.
+struct robust_line {
+    // Line origin.
+    float px;
+    float py;
+    float pz;
+
+    // Normalized line direction.
+    float dx;
+    float dy;
+    float dz;
+
+    // Relative weight of the line, must be positive.
+    float weight;
+
+    // Group of the line, for example the index of the beacon.
+    int group;
+};
+
+// Robust line intersection configuration structure.
+// See the robust_line_intersection_config_default() function.
+struct robust_line_intersection_config {
+    // Maximum number of minimal subsets to evaluate. If there are no more
+    // valid pairs of lines than max_iterations, then all pairs are evaluated
+    // exhaustively. Otherwise, pairs are sampled pseudorandomly.
+    int max_iterations;
+
+    // Maximum perpendicular distance from a candidate point to an inlier line,
+    // in meters.
+    float inlier_distance;
+
+    // Seed for the pseudorandom selection of minimal subsets. The same seed
+    // and the same lines give the same result.
+    uint32_t seed;
+};
+
+// Robust line intersection result structure.
+// See the robust_line_intersection_solve() function.
+struct robust_line_intersection_result {
+    // Least squares intersection of the consensus set.
+    struct line_intersection_result solution;
+
+    // Number of lines in the consensus set.
+    int inlier_count;
+
+    // Number of minimal subsets evaluated.
+    int iteration_count;
+};
+
+// Set a robust line intersection configuration structure to default values.
+// Returns 0 (0 ~ "Success") if the configuration structure is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if config pointer is NULL.
+int robust_line_intersection_config_default(
+        struct robust_line_intersection_config *config);
+
+// Find the least squares intersection of the largest consensus set of lines,
+// in the style of RANSAC (random sample consensus).
+//
+// Each minimal subset is a pair of lines from different groups. The candidate
+// point of a pair is the least squares intersection of the two lines. Each
+// line is scored against the candidate point with a truncated quadratic:
+//     score(i) = w(i) * (1 - (distance(i) / inlier_distance)^2)
+// for lines where distance(i) <= inlier_distance and the candidate point is in
+// front of the line origin, and 0 otherwise. The candidate point with the
+// highest total score wins. The consensus set of the winning candidate point
+// is refined with a least squares intersection, and the consensus set is
+// selected once more from the refined point and solved again.
+//
+// The number of minimal subsets is bounded by config->max_iterations, and each
+// minimal subset costs O(line_count). The cost is therefore bounded by
+// O(max_iterations * line_count), independent of the data.
+//
+// The config argument is optional. If config is NULL, then default values are
+// used. See the robust_line_intersection_config_default() function.
+// The inliers argument is optional. If inliers is not NULL, then inliers[i] is
+// set to true for each line in the consensus set, and false otherwise.
+// Returns 0 (0 ~ "Success") if the result is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if lines pointer is NULL, or if
+// result pointer is NULL, or if line_count is less than 2 or greater than
+// ROBUST_LINE_INTERSECTION_LINES_MAX.
+// Returns -ROBUST_LINE_INTERSECTION_ERROR_NO_CONSENSUS (-95 ~ "No consensus")
+// if no candidate point has at least 2 inliers from different groups.
+int robust_line_intersection_solve(
+        const struct robust_line *lines,
+        int line_count,
+        const struct robust_line_intersection_config *config,
+        struct robust_line_intersection_result *result,
+        bool *inliers);
+
+#endif // ROBUST_LINE_INTERSECTION_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "sync_context.h" // For sync context structure, sync context table structure, and SYNC_CONTEXT_TABLE_CAPACITY.
+#include <errno.h> // For EINVAL (22) and ENOENT (2).
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0).
+#include <string.h> // For memcpy().
+#include <zephyr/bluetooth/addr.h> // For BLE device address structure.
+#include "beacon_database.h" // For beacon database structure and beacon_database_index_of().
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "chw1010_ant2_specs.h" // For CHW1010_ANT2_PATTERN_ALL and CHW1010_ANT2_PATTERN_COUNT.
+
+int sync_context_table_init(struct sync_context_table *table) {
+    if (table == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    for (int i = 0; i < SYNC_CONTEXT_TABLE_CAPACITY; i++) {
+        table->contexts[i].valid = false;
+        table->contexts[i].beacon_index = -1;
+        table->contexts[i].beacon = NULL;
+        table->contexts[i].antenna_pattern_id = CHW1010_ANT2_PATTERN_ALL;
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+int sync_context_table_set(
+        struct sync_context_table *table,
+        int sync_index,
+        const bt_addr_le_t *addr,
+        const struct beacon_database *beacon_db) {
+    if (table == NULL || addr == NULL || beacon_db == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (sync_index < 0 || sync_index >= SYNC_CONTEXT_TABLE_CAPACITY) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    struct sync_context *context = &table->contexts[sync_index];
+
+    int beacon_index = beacon_database_index_of(beacon_db, addr->a.val);
+    if (beacon_index < 0) {
+        context->valid = false;
+        return beacon_index;
+    }
+
+    memcpy(context->beacon_mac, addr->a.val, BT_ADDR_SIZE);
+    context->beacon_index = beacon_index;
+    context->beacon = &beacon_db->beacons[beacon_index];
+    context->antenna_pattern_id = CHW1010_ANT2_PATTERN_ALL;
+    context->valid = true;
+
+    return 0; // 0 ~ "Success".
+}
+
+int sync_context_table_set_antenna_pattern(
+        struct sync_context_table *table,
+        int sync_index,
+        uint8_t antenna_pattern_id) {
+    if (table == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    if (sync_index < 0 || sync_index >= SYNC_CONTEXT_TABLE_CAPACITY ||
+            antenna_pattern_id >= CHW1010_ANT2_PATTERN_COUNT) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    struct sync_context *context = &table->contexts[sync_index];
+    if (!context->valid) {
+        return -ENOENT; // -2 ~ "No such file or directory".
+    }
+
+    context->antenna_pattern_id = antenna_pattern_id;
+
+    return 0; // 0 ~ "Success".
+}
+
+void sync_context_table_clear(
+        struct sync_context_table *table,
+        int sync_index) {
+    if (table == NULL) {
+        return;
+    }
+
+    if (sync_index < 0 || sync_index >= SYNC_CONTEXT_TABLE_CAPACITY) {
+        return;
+    }
+
+    table->contexts[sync_index].valid = false;
+}
+
+const struct sync_context *sync_context_table_get(
+        const struct sync_context_table *table,
+        int sync_index) {
+    if (table == NULL) {
+        return NULL;
+    }
+
+    if (sync_index < 0 || sync_index >= SYNC_CONTEXT_TABLE_CAPACITY) {
+        return NULL;
+    }
+
+    const struct sync_context *context = &table->contexts[sync_index];
+    if (!context->valid) {
+        return NULL;
+    }
+
+    return context;
+}
\ No newline at end of file
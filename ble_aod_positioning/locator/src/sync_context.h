@@ -0,0 +1,105 @@
+#ifndef SYNC_CONTEXT_H
+#define SYNC_CONTEXT_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For uint8_t.
+#include <zephyr/bluetooth/addr.h> // For BLE device address structure.
+#include "beacon.h" // For beacon structure.
+#include "beacon_database.h" // For beacon database structure.
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "chw1010_ant2_specs.h" // For CoreHW CHW1010-ANT2-1.1 antenna pattern enum.
+
+// Sync context table capacity. One context per periodic advertising sync
+// supported by the host, indexed by the sync index.
+// See the bt_le_per_adv_sync_get_index() function.
+// Without Bluetooth, one context per simulated sync of the simulated CTE
+// report source, see cte_sim.h.
+#if defined(CONFIG_LOCATOR_CTE_SIM)
+#define SYNC_CONTEXT_TABLE_CAPACITY CONFIG_LOCATOR_CTE_SIM_SYNC_MAX
+#else
+#define SYNC_CONTEXT_TABLE_CAPACITY CONFIG_BT_PER_ADV_SYNC_MAX
+#endif
+
+// Sync context structure.
+// What the cte_recv_cb() callback function needs to know about the periodic
+// advertiser of a sync, resolved once when the sync is established.
+// See the sync_context_table_set() function.
+struct sync_context {
+    // The context is set for an established sync to a known beacon.
+    bool valid;
+
+    // Bluetooth LE device address (MAC address) of the beacon in little-endian
+    // format (protocol/reversed octet order).
+    uint8_t beacon_mac[BT_ADDR_SIZE];
+
+    // Index of the beacon in the beacon database, and the beacon entry. The
+    // entry is stable, since beacons are only ever updated in place or
+    // appended. See the beacon_database_index_of() function.
+    int beacon_index;
+    const struct beacon *beacon;
+
+    // Antenna pattern of the CTEs, as advertised in the periodic advertising
+    // data. CHW1010_ANT2_PATTERN_ALL until advertised, which is the pattern of
+    // beacons that do not advertise a pattern.
+    // See the sync_context_table_set_antenna_pattern() function.
+    uint8_t antenna_pattern_id;
+};
+
+// Sync context table structure.
+// The table is written by the periodic advertising synced and term callback
+// functions, and read by the cte_recv_cb() callback function. All of these
+// run in the Bluetooth RX thread, so the table is not locked. A context is
+// only cleared from another thread after its sync is deleted, when no more
+// callbacks arrive for the sync.
+// See the sync_context_table_init() function.
+struct sync_context_table {
+    struct sync_context contexts[SYNC_CONTEXT_TABLE_CAPACITY];
+};
+
+// Initialize a sync context table structure. All contexts are set as invalid.
+// Returns 0 (0 ~ "Success") if the sync context table structure is
+// initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if table pointer is NULL.
+int sync_context_table_init(struct sync_context_table *table);
+
+// Set the context of a sync, from the address of the periodic advertiser. The
+// context is set as invalid if the advertiser is not a beacon in the beacon
+// database.
+// Returns 0 (0 ~ "Success") if the context is set as valid.
+// Returns -EINVAL (-22 ~ "Invalid argument") if table pointer is NULL, or if
+// addr pointer is NULL, or if beacon_db pointer is NULL, or if sync_index is
+// out of range.
+// Returns -ENOENT (-2 ~ "No such file or directory") if the advertiser is not
+// a beacon in the beacon database.
+int sync_context_table_set(
+        struct sync_context_table *table,
+        int sync_index,
+        const bt_addr_le_t *addr,
+        const struct beacon_database *beacon_db);
+
+// Set the antenna pattern of a sync, from the periodic advertising data.
+// Returns 0 (0 ~ "Success") if the antenna pattern is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if table pointer is NULL, or if
+// sync_index is out of range, or if antenna_pattern_id is not less than
+// CHW1010_ANT2_PATTERN_COUNT.
+// Returns -ENOENT (-2 ~ "No such file or directory") if the context is
+// invalid.
+int sync_context_table_set_antenna_pattern(
+        struct sync_context_table *table,
+        int sync_index,
+        uint8_t antenna_pattern_id);
+
+// Set the context of a sync as invalid.
+void sync_context_table_clear(
+        struct sync_context_table *table,
+        int sync_index);
+
+// Get the context of a sync, in constant time.
+// Returns a pointer to the context if it is valid.
+// Returns NULL if table pointer is NULL, or if sync_index is out of range, or
+// if the context is invalid.
+const struct sync_context *sync_context_table_get(
+        const struct sync_context_table *table,
+        int sync_index);
+
+#endif // SYNC_CONTEXT_H
\ No newline at end of file
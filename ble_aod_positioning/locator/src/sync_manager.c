@@ -0,0 +1,775 @@
+#include "sync_manager.h" // For sync manager structure, sync slot structure, sync manager action structure, and SYNC_MANAGER_SLOT_COUNT.
+#include <errno.h> // For EINVAL (22).
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For uint8_t, uint16_t, uint32_t, and int64_t.
+#include <string.h> // For memcpy().
+#include <zephyr/bluetooth/addr.h> // For BT_ADDR_LE_ANY, BT_ADDR_LE_RANDOM, bt_addr_le_copy(), and bt_addr_le_eq().
+#include <zephyr/bluetooth/bluetooth.h> // For bt_le_per_adv_sync_get_index().
+#include <zephyr/bluetooth/gap.h> // For BT_GAP_SID_MAX (0x0F).
+#include <zephyr/spinlock.h> // For k_spinlock_key_t, k_spin_lock(), and k_spin_unlock().
+#include "beacon.h" // For beacon structure.
+#include "beacon_database.h" // For beacon database structure, BEACON_DATABASE_CAPACITY, and beacon_database_index_of().
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+
+// Set a sync slot as free.
+static void sync_slot_free(struct sync_slot *slot) {
+    slot->state = SYNC_SLOT_FREE;
+    slot->sync = NULL;
+    slot->beacon_index = -1;
+    slot->delete_requested = false;
+    slot->per_adv_list = false;
+}
+
+// Check if a sync slot holds an established sync to a beacon.
+static bool sync_slot_is_synced(const struct sync_slot *slot) {
+    return slot->state == SYNC_SLOT_SYNCED || slot->state == SYNC_SLOT_ACTIVE;
+}
+
+// Get the slot index of a periodic advertising sync.
+// Returns the slot index (>= 0), or -1 if the sync index is out of range.
+static int sync_manager_slot_index(struct bt_le_per_adv_sync *sync) {
+    int slot_index = (int)bt_le_per_adv_sync_get_index(sync);
+    if (slot_index < 0 || slot_index >= SYNC_MANAGER_SLOT_COUNT) {
+        return -1;
+    }
+    return slot_index;
+}
+
+// Mark the periodic advertiser list of a sync manager as outdated.
+static void sync_manager_outdate_per_adv_list(
+        struct sync_manager *sync_manager) {
+    sync_manager->per_adv_list_generation++;
+}
+
+// Check if the periodic advertiser list of a sync manager is outdated.
+static bool sync_manager_per_adv_list_outdated(
+        const struct sync_manager *sync_manager) {
+    return sync_manager->per_adv_list_generation !=
+            sync_manager->per_adv_list_updated_generation;
+}
+
+// Get the periodic advertiser list of a sync manager. The list holds every
+// beacon in the beacon database that is not synced, with the SID of the sync
+// manager. The addresses and SIDs are set if addrs pointer and sids pointer
+// are not NULL.
+// Returns the number of beacons in the list (>= 0).
+static int sync_manager_get_per_adv_list(
+        const struct sync_manager *sync_manager,
+        bt_addr_le_t addrs[BEACON_DATABASE_CAPACITY],
+        uint8_t sids[BEACON_DATABASE_CAPACITY]) {
+    const struct beacon_database *beacon_db = sync_manager->beacon_db;
+
+    bool synced[BEACON_DATABASE_CAPACITY] = {false};
+    for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+        const struct sync_slot *slot = &sync_manager->slots[i];
+        if (sync_slot_is_synced(slot) &&
+                slot->beacon_index >= 0 &&
+                slot->beacon_index < BEACON_DATABASE_CAPACITY) {
+            synced[slot->beacon_index] = true;
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < beacon_db->count; i++) {
+        if (synced[i]) {
+            continue;
+        }
+        if (addrs != NULL && sids != NULL) {
+            // The beacons use static random addresses.
+            addrs[count].type = BT_ADDR_LE_RANDOM;
+            memcpy(
+                    addrs[count].a.val,
+                    beacon_db->beacons[i].mac_little_endian,
+                    BT_ADDR_SIZE);
+            sids[count] = sync_manager->sid;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+// Check if a sync manager rotates syncs. Rotation is needed if it is enabled
+// and the beacon database has more beacons than slots.
+static bool sync_manager_rotation_needed(
+        const struct sync_manager *sync_manager) {
+    return sync_manager->rotation_enabled &&
+            sync_manager->beacon_db->count > SYNC_MANAGER_SLOT_COUNT;
+}
+
+// Get the beacon value of a slot. A slot without a beacon index is worth 0.
+static float sync_manager_slot_value(
+        const struct sync_manager *sync_manager,
+        const struct sync_slot *slot) {
+    if (slot->beacon_index < 0 ||
+            slot->beacon_index >= BEACON_DATABASE_CAPACITY) {
+        return 0.0f;
+    }
+    return sync_manager->beacon_values[slot->beacon_index];
+}
+
+// Get the synchronization timeout for a sync, in units of 10 ms. The sync
+// tolerates as many missed events as the sync establishment, counting the
+// events that may be skipped.
+static uint16_t sync_manager_sync_timeout(
+        uint32_t create_timeout_ms,
+        uint16_t skip) {
+    uint32_t sync_timeout = (create_timeout_ms * (skip + 1) + 9) / 10;
+    if (sync_timeout < SYNC_MANAGER_SYNC_TIMEOUT_MIN) {
+        sync_timeout = SYNC_MANAGER_SYNC_TIMEOUT_MIN;
+    }
+    if (sync_timeout > SYNC_MANAGER_SYNC_TIMEOUT_MAX) {
+        sync_timeout = SYNC_MANAGER_SYNC_TIMEOUT_MAX;
+    }
+    return (uint16_t)sync_timeout;
+}
+
+int sync_manager_init(
+        struct sync_manager *sync_manager,
+        struct beacon_database *beacon_db) {
+    if (sync_manager == NULL || beacon_db == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    sync_manager->beacon_db = beacon_db;
+
+    for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+        sync_slot_free(&sync_manager->slots[i]);
+    }
+
+    sync_manager->candidate_found = false;
+    sync_manager->candidate_beacon_index = -1;
+    sync_manager->pending_slot_index = -1;
+    sync_manager->scan_enabled = false;
+
+    sync_manager->max_cte_count = SYNC_MANAGER_DEFAULT_MAX_CTE_COUNT;
+    sync_manager->skip = 0;
+
+    for (int i = 0; i < BEACON_DATABASE_CAPACITY; i++) {
+        sync_manager->beacon_values[i] = 0.0f;
+        sync_manager->beacon_backoff_until[i] = 0;
+        sync_manager->beacon_recovery_attempts[i] = 0;
+    }
+    sync_manager->rotation_enabled = false;
+
+    sync_manager->sid = SYNC_MANAGER_DEFAULT_SID;
+
+    sync_manager->per_adv_list_generation = 1;
+    sync_manager->per_adv_list_updated_generation = 0;
+
+    return 0; // 0 ~ "Success".
+}
+
+bool sync_manager_on_scan_recv(
+        struct sync_manager *sync_manager,
+        const bt_addr_le_t *addr,
+        uint8_t sid,
+        uint32_t create_timeout_ms,
+        int64_t timestamp) {
+    if (sync_manager == NULL || addr == NULL) {
+        return false;
+    }
+
+    // Only beacons in the beacon database. The MAC address of a BLE device
+    // address is stored in little-endian format.
+    int beacon_index = beacon_database_index_of(
+            sync_manager->beacon_db,
+            addr->a.val);
+    if (beacon_index < 0) {
+        return false;
+    }
+
+    bool accepted = false;
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    if (sid != sync_manager->sid ||
+            sync_manager->candidate_found ||
+            sync_manager->pending_slot_index >= 0 ||
+            timestamp < sync_manager->beacon_backoff_until[beacon_index]) {
+        goto unlock;
+    }
+
+    bool free_slot = false;
+    float slot_value_min = 0.0f;
+    bool slot_value_min_set = false;
+    for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+        const struct sync_slot *slot = &sync_manager->slots[i];
+        if (slot->state == SYNC_SLOT_FREE) {
+            free_slot = true;
+            continue;
+        }
+        if (bt_addr_le_eq(&slot->addr, addr)) {
+            // Already in a slot.
+            goto unlock;
+        }
+        float slot_value = sync_manager_slot_value(sync_manager, slot);
+        if (!slot_value_min_set || slot_value < slot_value_min) {
+            slot_value_min = slot_value;
+            slot_value_min_set = true;
+        }
+    }
+    // Free slots are filled through the periodic advertiser list. Otherwise,
+    // rotation. The dwell time is checked by sync_manager_get_action().
+    if (free_slot ||
+            !sync_manager_rotation_needed(sync_manager) ||
+            !(sync_manager->beacon_values[beacon_index] >
+                    slot_value_min + SYNC_MANAGER_ROTATION_HYSTERESIS)) {
+        goto unlock;
+    }
+
+    sync_manager->candidate_found = true;
+    bt_addr_le_copy(&sync_manager->candidate_addr, addr);
+    sync_manager->candidate_sid = sid;
+    sync_manager->candidate_create_timeout_ms = create_timeout_ms;
+    sync_manager->candidate_beacon_index = beacon_index;
+    accepted = true;
+
+unlock:
+    k_spin_unlock(&sync_manager->lock, key);
+
+    return accepted;
+}
+
+void sync_manager_on_synced(
+        struct sync_manager *sync_manager,
+        struct bt_le_per_adv_sync *sync,
+        const bt_addr_le_t *addr,
+        uint8_t sid) {
+    if (sync_manager == NULL || sync == NULL || addr == NULL) {
+        return;
+    }
+
+    int slot_index = sync_manager_slot_index(sync);
+    if (slot_index < 0) {
+        return;
+    }
+
+    int beacon_index = beacon_database_index_of(
+            sync_manager->beacon_db,
+            addr->a.val);
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    // The synced callback may arrive before the result of the create sync
+    // action is reported. The slot is then completed by the
+    // sync_manager_on_create_sync() function.
+    struct sync_slot *slot = &sync_manager->slots[slot_index];
+    slot->state = SYNC_SLOT_SYNCED;
+    slot->sync = sync;
+    bt_addr_le_copy(&slot->addr, addr);
+    slot->sid = sid;
+    slot->beacon_index = beacon_index;
+    if (beacon_index < 0) {
+        // Not a beacon, only occupies a slot.
+        slot->delete_requested = true;
+    } else {
+        // Recovered, or synced through the periodic advertiser list.
+        sync_manager->beacon_recovery_attempts[beacon_index] = 0;
+    }
+    if (sync_manager->pending_slot_index == slot_index) {
+        sync_manager->pending_slot_index = -1;
+    }
+
+    // The beacon is removed from the periodic advertiser list.
+    sync_manager_outdate_per_adv_list(sync_manager);
+
+    k_spin_unlock(&sync_manager->lock, key);
+}
+
+void sync_manager_on_term(
+        struct sync_manager *sync_manager,
+        struct bt_le_per_adv_sync *sync) {
+    if (sync_manager == NULL || sync == NULL) {
+        return;
+    }
+
+    int slot_index = sync_manager_slot_index(sync);
+    if (slot_index < 0) {
+        return;
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    // The beacon of a synced slot is returned to the periodic advertiser list.
+    // The sync was lost, so the beacon is likely still in range, and is
+    // synced again directly. A sync that was about to be deleted is not.
+    struct sync_slot *slot = &sync_manager->slots[slot_index];
+    if (sync_slot_is_synced(slot)) {
+        sync_manager_outdate_per_adv_list(sync_manager);
+        if (slot->beacon_index >= 0 &&
+                slot->beacon_index < BEACON_DATABASE_CAPACITY &&
+                !slot->delete_requested) {
+            sync_manager->beacon_recovery_attempts[slot->beacon_index] =
+                    SYNC_MANAGER_RECOVERY_ATTEMPTS;
+        }
+    }
+
+    sync_slot_free(slot);
+    if (sync_manager->pending_slot_index == slot_index) {
+        sync_manager->pending_slot_index = -1;
+    }
+
+    k_spin_unlock(&sync_manager->lock, key);
+}
+
+bool sync_manager_get_action(
+        struct sync_manager *sync_manager,
+        int64_t timestamp,
+        struct sync_manager_action *action) {
+    if (sync_manager == NULL || action == NULL) {
+        return false;
+    }
+
+    action->type = SYNC_MANAGER_ACTION_NONE;
+    action->slot_index = -1;
+    action->sync = NULL;
+    action->use_per_adv_list = false;
+    action->recovery = false;
+    action->beacon_index = -1;
+    action->cte_rx_enabled = false;
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    // 1. Enable CTE RX for a synced slot, or for an active slot with an
+    // outdated maximum CTE count.
+    for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+        struct sync_slot *slot = &sync_manager->slots[i];
+        if (slot->delete_requested) {
+            continue;
+        }
+        bool synced = slot->state == SYNC_SLOT_SYNCED;
+        bool outdated = slot->state == SYNC_SLOT_ACTIVE &&
+                slot->max_cte_count != sync_manager->max_cte_count;
+        if (synced || outdated) {
+            action->type = SYNC_MANAGER_ACTION_ENABLE_CTE_RX;
+            action->slot_index = i;
+            action->sync = slot->sync;
+            action->max_cte_count = sync_manager->max_cte_count;
+            action->cte_rx_enabled = outdated;
+            goto unlock;
+        }
+    }
+
+    const bool per_adv_list_outdated =
+            sync_manager_per_adv_list_outdated(sync_manager);
+
+    // 2. Delete a pending sync that has timed out, or a sync without CTE RX,
+    // or a pending sync through an outdated periodic advertiser list.
+    for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+        struct sync_slot *slot = &sync_manager->slots[i];
+        bool creating = slot->state == SYNC_SLOT_CREATING;
+        bool timed_out = creating &&
+                (timestamp - slot->create_timestamp) >
+                        (int64_t)slot->create_timeout_ms;
+        if (timed_out && slot->beacon_index >= 0) {
+            sync_manager->beacon_backoff_until[slot->beacon_index] =
+                    timestamp + SYNC_MANAGER_CREATE_BACKOFF_MS;
+        }
+        bool list_outdated =
+                creating && slot->per_adv_list && per_adv_list_outdated;
+        if (timed_out || list_outdated || slot->delete_requested) {
+            action->type = SYNC_MANAGER_ACTION_DELETE_SYNC;
+            action->slot_index = i;
+            action->sync = slot->sync;
+            goto unlock;
+        }
+    }
+
+    // Count free slots.
+    int free_count = 0;
+    for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+        if (sync_manager->slots[i].state == SYNC_SLOT_FREE) {
+            free_count++;
+        }
+    }
+
+    // 3. Update an outdated periodic advertiser list.
+    if (per_adv_list_outdated && sync_manager->pending_slot_index < 0) {
+        action->type = SYNC_MANAGER_ACTION_UPDATE_PER_ADV_LIST;
+        action->list_count = sync_manager_get_per_adv_list(
+                sync_manager,
+                action->list_addrs,
+                action->list_sids);
+        action->list_generation = sync_manager->per_adv_list_generation;
+        goto unlock;
+    }
+
+    const bool rotation_needed = sync_manager_rotation_needed(sync_manager);
+    uint16_t skip = sync_manager->skip;
+    if (rotation_needed && skip < SYNC_MANAGER_ROTATION_SKIP) {
+        skip = SYNC_MANAGER_ROTATION_SKIP;
+    }
+
+    // 4. Create a sync to a lost beacon with recovery attempts left.
+    if (free_count > 0 && sync_manager->pending_slot_index < 0) {
+        for (int i = 0; i < sync_manager->beacon_db->count; i++) {
+            if (sync_manager->beacon_recovery_attempts[i] == 0) {
+                continue;
+            }
+            action->type = SYNC_MANAGER_ACTION_CREATE_SYNC;
+            // The beacons use static random addresses.
+            action->addr.type = BT_ADDR_LE_RANDOM;
+            memcpy(
+                    action->addr.a.val,
+                    sync_manager->beacon_db->beacons[i].mac_little_endian,
+                    BT_ADDR_SIZE);
+            action->sid = sync_manager->sid;
+            action->create_timeout_ms = SYNC_MANAGER_RECOVERY_CREATE_TIMEOUT_MS;
+            action->recovery = true;
+            action->beacon_index = i;
+            action->skip = skip;
+            // The recovered sync is as tolerant as any other sync.
+            action->sync_timeout = sync_manager_sync_timeout(
+                    SYNC_MANAGER_PER_ADV_LIST_CREATE_TIMEOUT_MS,
+                    skip);
+            goto unlock;
+        }
+    }
+
+    // Otherwise, create a sync to the candidate advertiser.
+    if (sync_manager->candidate_found &&
+            sync_manager->pending_slot_index < 0) {
+        if (free_count > 0) {
+            action->type = SYNC_MANAGER_ACTION_CREATE_SYNC;
+            bt_addr_le_copy(&action->addr, &sync_manager->candidate_addr);
+            action->sid = sync_manager->candidate_sid;
+            action->create_timeout_ms =
+                    sync_manager->candidate_create_timeout_ms;
+            action->skip = skip;
+            action->sync_timeout = sync_manager_sync_timeout(
+                    sync_manager->candidate_create_timeout_ms,
+                    skip);
+            goto unlock;
+        }
+
+        if (rotation_needed) {
+            // Find the active slot with the lowest beacon value, among slots
+            // older than the dwell time.
+            int worst_index = -1;
+            float worst_value = 0.0f;
+            for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+                const struct sync_slot *slot = &sync_manager->slots[i];
+                if (slot->state != SYNC_SLOT_ACTIVE ||
+                        (timestamp - slot->create_timestamp) <
+                                SYNC_MANAGER_ROTATION_DWELL_MS) {
+                    continue;
+                }
+                float slot_value = sync_manager_slot_value(sync_manager, slot);
+                if (worst_index < 0 || slot_value < worst_value) {
+                    worst_index = i;
+                    worst_value = slot_value;
+                }
+            }
+
+            float candidate_value = sync_manager->beacon_values[
+                    sync_manager->candidate_beacon_index];
+            if (worst_index >= 0 &&
+                    candidate_value >
+                            worst_value + SYNC_MANAGER_ROTATION_HYSTERESIS) {
+                // Free the slot. The candidate is kept, and the sync to the
+                // candidate is created by a later action.
+                action->type = SYNC_MANAGER_ACTION_DELETE_SYNC;
+                action->slot_index = worst_index;
+                action->sync = sync_manager->slots[worst_index].sync;
+                goto unlock;
+            }
+        }
+
+        // No slot is worth replacing, drop the candidate.
+        sync_manager->candidate_found = false;
+        sync_manager->candidate_beacon_index = -1;
+    }
+
+    // Otherwise, create a sync through the periodic advertiser list.
+    if (free_count > 0 &&
+            sync_manager->pending_slot_index < 0 &&
+            sync_manager_get_per_adv_list(sync_manager, NULL, NULL) > 0) {
+        action->type = SYNC_MANAGER_ACTION_CREATE_SYNC;
+        action->use_per_adv_list = true;
+        action->create_timeout_ms = SYNC_MANAGER_PER_ADV_LIST_CREATE_TIMEOUT_MS;
+        action->skip = skip;
+        action->sync_timeout = sync_manager_sync_timeout(
+                SYNC_MANAGER_PER_ADV_LIST_CREATE_TIMEOUT_MS,
+                skip);
+        goto unlock;
+    }
+
+    // 5. Start or stop scanning.
+    bool scan_needed = free_count > 0 ||
+            sync_manager->pending_slot_index >= 0 ||
+            rotation_needed;
+    if (scan_needed && !sync_manager->scan_enabled) {
+        action->type = SYNC_MANAGER_ACTION_START_SCAN;
+    } else if (!scan_needed && sync_manager->scan_enabled) {
+        action->type = SYNC_MANAGER_ACTION_STOP_SCAN;
+    }
+
+unlock:
+    k_spin_unlock(&sync_manager->lock, key);
+
+    return action->type != SYNC_MANAGER_ACTION_NONE;
+}
+
+void sync_manager_on_create_sync(
+        struct sync_manager *sync_manager,
+        const struct sync_manager_action *action,
+        struct bt_le_per_adv_sync *sync,
+        int64_t timestamp,
+        int err) {
+    if (sync_manager == NULL || action == NULL) {
+        return;
+    }
+
+    int slot_index = -1;
+    if (err == 0 && sync != NULL) {
+        slot_index = sync_manager_slot_index(sync);
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    int beacon_index = -1;
+    if (action->recovery) {
+        beacon_index = action->beacon_index;
+
+        // Consume a recovery attempt. A failed or timed out recovery is
+        // attempted again until no attempts are left.
+        if (beacon_index >= 0 && beacon_index < BEACON_DATABASE_CAPACITY &&
+                sync_manager->beacon_recovery_attempts[beacon_index] > 0) {
+            sync_manager->beacon_recovery_attempts[beacon_index]--;
+        }
+    } else if (!action->use_per_adv_list) {
+        beacon_index = sync_manager->candidate_beacon_index;
+
+        // Consume the candidate.
+        sync_manager->candidate_found = false;
+        sync_manager->candidate_beacon_index = -1;
+    }
+
+    if (slot_index < 0 && beacon_index >= 0 && !action->recovery) {
+        sync_manager->beacon_backoff_until[beacon_index] =
+                timestamp + SYNC_MANAGER_CREATE_BACKOFF_MS;
+    }
+
+    if (slot_index >= 0) {
+        struct sync_slot *slot = &sync_manager->slots[slot_index];
+        slot->create_timestamp = timestamp;
+        slot->create_timeout_ms = action->create_timeout_ms;
+        slot->per_adv_list = action->use_per_adv_list;
+
+        // The synced callback may already have set the slot as synced, with
+        // the address, SID, and beacon index of the advertiser.
+        if (slot->state != SYNC_SLOT_SYNCED) {
+            slot->state = SYNC_SLOT_CREATING;
+            slot->sync = sync;
+            if (action->use_per_adv_list) {
+                bt_addr_le_copy(&slot->addr, BT_ADDR_LE_ANY);
+                slot->sid = 0;
+            } else {
+                bt_addr_le_copy(&slot->addr, &action->addr);
+                slot->sid = action->sid;
+            }
+            slot->beacon_index = beacon_index;
+            slot->delete_requested = false;
+            sync_manager->pending_slot_index = slot_index;
+        }
+    }
+
+    k_spin_unlock(&sync_manager->lock, key);
+}
+
+void sync_manager_on_delete_sync(
+        struct sync_manager *sync_manager,
+        int slot_index) {
+    if (sync_manager == NULL) {
+        return;
+    }
+
+    if (slot_index < 0 || slot_index >= SYNC_MANAGER_SLOT_COUNT) {
+        return;
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    // The beacon of a synced slot is returned to the periodic advertiser list.
+    if (sync_slot_is_synced(&sync_manager->slots[slot_index])) {
+        sync_manager_outdate_per_adv_list(sync_manager);
+    }
+
+    sync_slot_free(&sync_manager->slots[slot_index]);
+    if (sync_manager->pending_slot_index == slot_index) {
+        sync_manager->pending_slot_index = -1;
+    }
+
+    k_spin_unlock(&sync_manager->lock, key);
+}
+
+void sync_manager_on_enable_cte_rx(
+        struct sync_manager *sync_manager,
+        const struct sync_manager_action *action,
+        int err) {
+    if (sync_manager == NULL || action == NULL) {
+        return;
+    }
+
+    const int slot_index = action->slot_index;
+
+    if (slot_index < 0 || slot_index >= SYNC_MANAGER_SLOT_COUNT) {
+        return;
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    struct sync_slot *slot = &sync_manager->slots[slot_index];
+    if (slot->state == SYNC_SLOT_SYNCED || slot->state == SYNC_SLOT_ACTIVE) {
+        if (err == 0) {
+            slot->state = SYNC_SLOT_ACTIVE;
+            slot->max_cte_count = action->max_cte_count;
+        } else {
+            // A sync without CTE RX only occupies a slot.
+            slot->delete_requested = true;
+        }
+    }
+
+    k_spin_unlock(&sync_manager->lock, key);
+}
+
+void sync_manager_on_update_per_adv_list(
+        struct sync_manager *sync_manager,
+        const struct sync_manager_action *action,
+        int err) {
+    if (sync_manager == NULL || action == NULL) {
+        return;
+    }
+
+    if (err) {
+        return;
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    sync_manager->per_adv_list_updated_generation = action->list_generation;
+
+    k_spin_unlock(&sync_manager->lock, key);
+}
+
+void sync_manager_on_scan(
+        struct sync_manager *sync_manager,
+        bool scan_enabled) {
+    if (sync_manager == NULL) {
+        return;
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    sync_manager->scan_enabled = scan_enabled;
+
+    k_spin_unlock(&sync_manager->lock, key);
+}
+
+int sync_manager_set_beacon_values(
+        struct sync_manager *sync_manager,
+        const float values[BEACON_DATABASE_CAPACITY]) {
+    if (sync_manager == NULL || values == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    for (int i = 0; i < BEACON_DATABASE_CAPACITY; i++) {
+        sync_manager->beacon_values[i] = values[i];
+    }
+    sync_manager->rotation_enabled = true;
+
+    k_spin_unlock(&sync_manager->lock, key);
+
+    return 0; // 0 ~ "Success".
+}
+
+int sync_manager_set_cte_rx_params(
+        struct sync_manager *sync_manager,
+        uint8_t max_cte_count,
+        uint16_t skip) {
+    if (sync_manager == NULL || max_cte_count == 0) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    sync_manager->max_cte_count = max_cte_count;
+    sync_manager->skip = skip;
+
+    k_spin_unlock(&sync_manager->lock, key);
+
+    return 0; // 0 ~ "Success".
+}
+
+int sync_manager_set_sid(
+        struct sync_manager *sync_manager,
+        uint8_t sid) {
+    if (sync_manager == NULL || sid > BT_GAP_SID_MAX) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    if (sync_manager->sid != sid) {
+        sync_manager->sid = sid;
+        for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+            struct sync_slot *slot = &sync_manager->slots[i];
+            // Pending syncs through the periodic advertiser list are
+            // deleted when the outdated list is found.
+            bool per_adv_list_pending =
+                    slot->state == SYNC_SLOT_CREATING && slot->per_adv_list;
+            if (slot->state != SYNC_SLOT_FREE &&
+                    !per_adv_list_pending &&
+                    slot->sid != sid) {
+                slot->delete_requested = true;
+            }
+        }
+        if (sync_manager->candidate_found &&
+                sync_manager->candidate_sid != sid) {
+            sync_manager->candidate_found = false;
+            sync_manager->candidate_beacon_index = -1;
+        }
+        sync_manager_outdate_per_adv_list(sync_manager);
+    }
+
+    k_spin_unlock(&sync_manager->lock, key);
+
+    return 0; // 0 ~ "Success".
+}
+
+int sync_manager_active_count(struct sync_manager *sync_manager) {
+    if (sync_manager == NULL) {
+        return 0;
+    }
+
+    int count = 0;
+
+    // Ensure atomic access to sync manager state variables.
+    k_spinlock_key_t key = k_spin_lock(&sync_manager->lock);
+
+    for (int i = 0; i < SYNC_MANAGER_SLOT_COUNT; i++) {
+        if (sync_manager->slots[i].state == SYNC_SLOT_ACTIVE) {
+            count++;
+        }
+    }
+
+    k_spin_unlock(&sync_manager->lock, key);
+
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,424 @@
+#ifndef SYNC_MANAGER_H
+#define SYNC_MANAGER_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For uint8_t, uint32_t, and int64_t.
+#include <zephyr/bluetooth/addr.h> // For BLE device address structure.
+#include <zephyr/bluetooth/bluetooth.h> // For BLE periodic advertising sync structure.
+#include <zephyr/spinlock.h> // For spinlock structure.
+#include "beacon_database.h" // For beacon database structure and BEACON_DATABASE_CAPACITY.
+
+// Number of sync slots. One slot per periodic advertising sync supported by
+// the host. Slot i is used by the sync with index i.
+// See the bt_le_per_adv_sync_get_index() function.
+#define SYNC_MANAGER_SLOT_COUNT CONFIG_BT_PER_ADV_SYNC_MAX
+
+// Minimum value difference for replacing the sync of a slot with a sync to a
+// candidate beacon. Prevents two beacons with similar values from repeatedly
+// replacing each other.
+// See the sync_manager_set_beacon_values() function.
+#define SYNC_MANAGER_ROTATION_HYSTERESIS 0.2f
+
+// Minimum time a sync is kept before it can be replaced, in milliseconds.
+// Sync establishment costs up to SYNC_CREATE_TIMEOUT_INTERVAL_NUM periodic
+// advertising intervals without angles, which must be amortized over the
+// angles received while synced.
+#define SYNC_MANAGER_ROTATION_DWELL_MS 3000
+
+// Number of periodic advertising events the controller may skip after a
+// received event, while rotating. Scanning must continue while rotating, and
+// skipping every other event gives the scanner radio time next to the syncs.
+#define SYNC_MANAGER_ROTATION_SKIP 1
+
+// Time a beacon is not synced to after a failed or timed out sync creation,
+// in milliseconds. Prevents a beacon that can be scanned but not synced from
+// repeatedly replacing the sync of a slot.
+#define SYNC_MANAGER_CREATE_BACKOFF_MS 5000
+
+// Advertising set identifier synced to on each beacon, until set by the
+// sync_manager_set_sid() function. The beacons run one periodic advertising
+// set per SID, see beacon_adv_data.h.
+#define SYNC_MANAGER_DEFAULT_SID 0
+
+// Time to wait for sync establishment through the periodic advertiser list,
+// in milliseconds. The periodic advertising interval is unknown until a beacon
+// is synced, so this covers SYNC_CREATE_TIMEOUT_INTERVAL_NUM intervals of the
+// slowest beacon advertising interval (BT_GAP_PER_ADV_SLOW_INT_MAX, 1.2 s).
+#define SYNC_MANAGER_PER_ADV_LIST_CREATE_TIMEOUT_MS 8400
+
+// Number of attempts to sync again to a beacon after its sync is lost, before
+// the beacon is left to the periodic advertiser list and scanning.
+// See the sync_manager_on_term() function.
+#define SYNC_MANAGER_RECOVERY_ATTEMPTS 3
+
+// Time to wait for sync establishment when syncing again to a lost beacon, in
+// milliseconds. Covers 3 intervals of the slowest beacon advertising interval
+// (BT_GAP_PER_ADV_SLOW_INT_MAX, 1.2 s), since a transient fade is expected to
+// be over within a few intervals.
+#define SYNC_MANAGER_RECOVERY_CREATE_TIMEOUT_MS 3600
+
+// Maximum number of CTEs sampled per periodic advertising event, until set by
+// the sync_manager_set_cte_rx_params() function.
+#define SYNC_MANAGER_DEFAULT_MAX_CTE_COUNT 5
+
+// Synchronization timeout range, in units of 10 ms.
+// See the bt_le_per_adv_sync_param structure.
+#define SYNC_MANAGER_SYNC_TIMEOUT_MIN 0x000A
+#define SYNC_MANAGER_SYNC_TIMEOUT_MAX 0x4000
+
+// Sync slot state.
+enum sync_slot_state {
+    // The slot is not used.
+    SYNC_SLOT_FREE,
+
+    // Periodic advertising sync is being created.
+    SYNC_SLOT_CREATING,
+
+    // Periodic advertising sync is established, CTE RX is not yet enabled.
+    SYNC_SLOT_SYNCED,
+
+    // Periodic advertising sync is established, and CTE RX is enabled.
+    SYNC_SLOT_ACTIVE,
+};
+
+// Sync slot structure.
+// See the sync manager structure.
+struct sync_slot {
+    enum sync_slot_state state;
+
+    // Periodic advertising sync, NULL if the slot is free.
+    struct bt_le_per_adv_sync *sync;
+
+    // Periodic advertiser address and advertising set identifier.
+    bt_addr_le_t addr;
+    uint8_t sid;
+
+    // Index of the beacon in the beacon database.
+    // See the beacon_database_index_of() function.
+    int beacon_index;
+
+    // Timestamp of when the sync was created, in milliseconds.
+    int64_t create_timestamp;
+
+    // Time to wait for sync establishment, in milliseconds.
+    uint32_t create_timeout_ms;
+
+    // The sync of the slot should be deleted.
+    // See the sync_manager_on_enable_cte_rx() function.
+    bool delete_requested;
+
+    // Maximum CTE count of the enabled CTE RX, for SYNC_SLOT_ACTIVE.
+    uint8_t max_cte_count;
+
+    // The sync was created through the periodic advertiser list. The address,
+    // SID, and beacon index are unknown until the sync is established.
+    bool per_adv_list;
+};
+
+// Sync manager action type.
+// See the sync_manager_get_action() function.
+enum sync_manager_action_type {
+    // Nothing to do.
+    SYNC_MANAGER_ACTION_NONE,
+
+    // Create a periodic advertising sync to the candidate advertiser, or to
+    // any advertiser in the periodic advertiser list.
+    // See the sync_manager_on_create_sync() function.
+    SYNC_MANAGER_ACTION_CREATE_SYNC,
+
+    // Delete the periodic advertising sync of a slot.
+    // See the sync_manager_on_delete_sync() function.
+    SYNC_MANAGER_ACTION_DELETE_SYNC,
+
+    // Enable CTE RX for the periodic advertising sync of a slot, or enable it
+    // again with new parameters.
+    // See the sync_manager_on_enable_cte_rx() function.
+    SYNC_MANAGER_ACTION_ENABLE_CTE_RX,
+
+    // Start scanning for periodic advertisers.
+    // See the sync_manager_on_scan() function.
+    SYNC_MANAGER_ACTION_START_SCAN,
+
+    // Stop scanning for periodic advertisers.
+    // See the sync_manager_on_scan() function.
+    SYNC_MANAGER_ACTION_STOP_SCAN,
+
+    // Replace the periodic advertiser list of the controller.
+    // See the sync_manager_on_update_per_adv_list() function.
+    SYNC_MANAGER_ACTION_UPDATE_PER_ADV_LIST,
+};
+
+// Sync manager action structure.
+// See the sync_manager_get_action() function.
+struct sync_manager_action {
+    enum sync_manager_action_type type;
+
+    // Slot index and periodic advertising sync for
+    // SYNC_MANAGER_ACTION_DELETE_SYNC and SYNC_MANAGER_ACTION_ENABLE_CTE_RX.
+    int slot_index;
+    struct bt_le_per_adv_sync *sync;
+
+    // Maximum CTE count for SYNC_MANAGER_ACTION_ENABLE_CTE_RX. CTE RX is
+    // already enabled if cte_rx_enabled is true, and must be disabled first.
+    uint8_t max_cte_count;
+    bool cte_rx_enabled;
+
+    // Advertiser address, advertising set identifier, and time to wait for
+    // sync establishment, for SYNC_MANAGER_ACTION_CREATE_SYNC. The address and
+    // SID are ignored if use_per_adv_list is true, and the controller syncs to
+    // any advertiser in the periodic advertiser list.
+    bt_addr_le_t addr;
+    uint8_t sid;
+    uint32_t create_timeout_ms;
+    bool use_per_adv_list;
+
+    // The sync is created to a lost beacon, with the beacon index, for
+    // SYNC_MANAGER_ACTION_CREATE_SYNC. See the sync_manager_on_term()
+    // function.
+    bool recovery;
+    int beacon_index;
+
+    // Number of periodic advertising events that can be skipped, and
+    // synchronization timeout in units of 10 ms, for
+    // SYNC_MANAGER_ACTION_CREATE_SYNC. See the bt_le_per_adv_sync_param
+    // structure.
+    uint16_t skip;
+    uint16_t sync_timeout;
+
+    // New content of the periodic advertiser list, for
+    // SYNC_MANAGER_ACTION_UPDATE_PER_ADV_LIST.
+    bt_addr_le_t list_addrs[BEACON_DATABASE_CAPACITY];
+    uint8_t list_sids[BEACON_DATABASE_CAPACITY];
+    int list_count;
+    uint32_t list_generation;
+};
+
+// Sync manager structure.
+// Keeps up to SYNC_MANAGER_SLOT_COUNT simultaneous periodic advertising syncs
+// to beacons in a beacon database, each with CTE RX enabled.
+//
+// The sync manager does not call the Bluetooth API. Bluetooth callbacks report
+// events to the sync manager with the sync_manager_on_*() functions. These
+// functions only update the state and are safe to call from callbacks. A
+// single thread, for example the main thread, repeatedly asks the sync manager
+// for the next action with the sync_manager_get_action() function, performs
+// the action with the Bluetooth API, and reports the result back.
+//
+// Only one sync is created at a time, since the controller only accepts one
+// pending LE Periodic Advertising Create Sync command. Scanning stays enabled
+// while there are free slots or a pending sync, since sync establishment
+// requires scanning.
+//
+// Periodic advertiser list: The list of the controller holds every beacon in
+// the beacon database that is not synced. Free slots are filled by syncs
+// created through the list, so the controller syncs to the first beacon it
+// finds without a round trip through the scan recv callback, and never to an
+// unknown advertiser. The list is updated whenever a beacon is synced or
+// unsynced. The list can not be changed while a sync is pending, so a pending
+// sync through an outdated list is cancelled first.
+//
+// Recovery: When the sync to a beacon is lost, for example in a transient
+// fade, a sync to the last address and SID of the beacon is created directly,
+// ahead of other candidates, with a short timeout. After
+// SYNC_MANAGER_RECOVERY_ATTEMPTS failed attempts, the beacon is left to the
+// periodic advertiser list and scanning.
+//
+// Rotation: When all slots are active and the beacon database has more beacons
+// than slots, a scanned beacon may replace the slot with the lowest beacon
+// value. See the sync_manager_set_beacon_values() function. Scanning then
+// stays enabled, and syncs are created with SYNC_MANAGER_ROTATION_SKIP.
+// See the sync_manager_init() function.
+struct sync_manager {
+    struct beacon_database *beacon_db;
+
+    struct sync_slot slots[SYNC_MANAGER_SLOT_COUNT];
+
+    // Candidate periodic advertiser for the next sync.
+    // See the sync_manager_on_scan_recv() function.
+    bool candidate_found;
+    bt_addr_le_t candidate_addr;
+    uint8_t candidate_sid;
+    uint32_t candidate_create_timeout_ms;
+    int candidate_beacon_index;
+
+    // Index of the slot with a pending sync, or -1.
+    int pending_slot_index;
+
+    // See the sync_manager_on_scan() function.
+    bool scan_enabled;
+
+    // CTE RX parameters for all syncs.
+    // See the sync_manager_set_cte_rx_params() function.
+    uint8_t max_cte_count;
+    uint16_t skip;
+
+    // Value of each beacon, indexed by the beacon index.
+    // See the sync_manager_set_beacon_values() function.
+    float beacon_values[BEACON_DATABASE_CAPACITY];
+    bool rotation_enabled;
+
+    // Time until each beacon can be a candidate again, in milliseconds.
+    // See SYNC_MANAGER_CREATE_BACKOFF_MS.
+    int64_t beacon_backoff_until[BEACON_DATABASE_CAPACITY];
+
+    // Advertising set identifier synced to on each beacon.
+    // See the sync_manager_set_sid() function.
+    uint8_t sid;
+
+    // Remaining recovery attempts of each beacon.
+    // See SYNC_MANAGER_RECOVERY_ATTEMPTS.
+    uint8_t beacon_recovery_attempts[BEACON_DATABASE_CAPACITY];
+
+    // The periodic advertiser list is outdated if the generations differ.
+    // See the sync_manager_on_update_per_adv_list() function.
+    uint32_t per_adv_list_generation;
+    uint32_t per_adv_list_updated_generation;
+
+    // Spinlock to ensure atomic access to the sync manager state.
+    struct k_spinlock lock;
+};
+
+// Initialize a sync manager structure. All slots are set as free, rotation is
+// disabled, the SID is set to SYNC_MANAGER_DEFAULT_SID, and the periodic
+// advertiser list is outdated.
+// Returns 0 (0 ~ "Success") if the sync manager structure is initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if sync_manager pointer is NULL,
+// or if beacon_db pointer is NULL.
+int sync_manager_init(
+        struct sync_manager *sync_manager,
+        struct beacon_database *beacon_db);
+
+// Report a scanned advertiser to a sync manager, at a timestamp in
+// milliseconds.
+// Advertising sets with another SID than the SID of the sync manager are
+// ignored. Free slots are filled through the periodic advertiser list, so a
+// scanned advertiser is only a candidate for rotation. The advertiser becomes the
+// candidate for the next sync if it is a beacon in the beacon database, if it
+// is not already in a slot or backed off, if there is no pending sync, if all
+// slots are full, if rotation is enabled, and if the beacon value exceeds the
+// lowest slot value by SYNC_MANAGER_ROTATION_HYSTERESIS.
+// Safe to call from the scan recv callback.
+// Returns true if the advertiser is the new candidate.
+bool sync_manager_on_scan_recv(
+        struct sync_manager *sync_manager,
+        const bt_addr_le_t *addr,
+        uint8_t sid,
+        uint32_t create_timeout_ms,
+        int64_t timestamp);
+
+// Report an established periodic advertising sync to a sync manager, with the
+// address and SID of the periodic advertiser.
+// Safe to call from the periodic advertising synced callback.
+void sync_manager_on_synced(
+        struct sync_manager *sync_manager,
+        struct bt_le_per_adv_sync *sync,
+        const bt_addr_le_t *addr,
+        uint8_t sid);
+
+// Report a terminated periodic advertising sync to a sync manager. The slot of
+// the sync is freed. If the sync was established to a beacon, the beacon gets
+// SYNC_MANAGER_RECOVERY_ATTEMPTS recovery attempts.
+// Safe to call from the periodic advertising term callback.
+void sync_manager_on_term(
+        struct sync_manager *sync_manager,
+        struct bt_le_per_adv_sync *sync);
+
+// Get the next action for a sync manager, at a timestamp in milliseconds.
+// See the k_uptime_get() function.
+// Actions are prioritized as follows:
+// 1. Enable CTE RX for a synced slot, or for an active slot with an outdated
+//    maximum CTE count.
+// 2. Delete a pending sync that has timed out, or a sync without CTE RX, or a
+//    pending sync through an outdated periodic advertiser list.
+// 3. Update an outdated periodic advertiser list.
+// 4. Create a sync to a lost beacon with recovery attempts left, if there is
+//    a free slot. Otherwise, create a sync to the candidate advertiser. If
+//    rotation is enabled and all
+//    slots are full, first delete the sync of the slot with the lowest beacon
+//    value, among slots older than SYNC_MANAGER_ROTATION_DWELL_MS. The
+//    candidate is dropped if no slot is worth replacing. Otherwise, create a
+//    sync through the periodic advertiser list if there is a free slot.
+// 5. Start or stop scanning.
+// Returns true if action is set to an action other than
+// SYNC_MANAGER_ACTION_NONE.
+bool sync_manager_get_action(
+        struct sync_manager *sync_manager,
+        int64_t timestamp,
+        struct sync_manager_action *action);
+
+// Report the result of SYNC_MANAGER_ACTION_CREATE_SYNC to a sync manager.
+// The sync argument must be the created sync if err is 0.
+// The candidate is consumed in either case, and backed off if err is not 0.
+// A recovery attempt is consumed in either case, for a sync to a lost beacon.
+void sync_manager_on_create_sync(
+        struct sync_manager *sync_manager,
+        const struct sync_manager_action *action,
+        struct bt_le_per_adv_sync *sync,
+        int64_t timestamp,
+        int err);
+
+// Report the result of SYNC_MANAGER_ACTION_DELETE_SYNC to a sync manager. The
+// slot is freed.
+void sync_manager_on_delete_sync(
+        struct sync_manager *sync_manager,
+        int slot_index);
+
+// Report the result of SYNC_MANAGER_ACTION_ENABLE_CTE_RX to a sync manager.
+// The slot is set as active if err is 0. Otherwise, the sync of the slot is
+// deleted by a later SYNC_MANAGER_ACTION_DELETE_SYNC.
+void sync_manager_on_enable_cte_rx(
+        struct sync_manager *sync_manager,
+        const struct sync_manager_action *action,
+        int err);
+
+// Report the result of SYNC_MANAGER_ACTION_UPDATE_PER_ADV_LIST to a sync
+// manager. The list is up to date if err is 0 and the list has not been
+// outdated since the action.
+void sync_manager_on_update_per_adv_list(
+        struct sync_manager *sync_manager,
+        const struct sync_manager_action *action,
+        int err);
+
+// Report the result of SYNC_MANAGER_ACTION_START_SCAN or
+// SYNC_MANAGER_ACTION_STOP_SCAN to a sync manager.
+void sync_manager_on_scan(
+        struct sync_manager *sync_manager,
+        bool scan_enabled);
+
+// Set the value of each beacon in the beacon database of a sync manager, and
+// enable rotation. Values are indexed by the beacon index, and a larger value
+// is a more useful beacon to sync. See the sync scheduler structure.
+// Returns 0 (0 ~ "Success") if the values are set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if sync_manager pointer is NULL,
+// or if values pointer is NULL.
+int sync_manager_set_beacon_values(
+        struct sync_manager *sync_manager,
+        const float values[BEACON_DATABASE_CAPACITY]);
+
+// Set the CTE RX parameters of a sync manager. Active slots with another
+// maximum CTE count get CTE RX enabled again. The skip applies to new syncs,
+// and the larger of skip and SYNC_MANAGER_ROTATION_SKIP is used while
+// rotating. See the CTE RX controller structure.
+// Returns 0 (0 ~ "Success") if the parameters are set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if sync_manager pointer is NULL,
+// or if max_cte_count is 0.
+int sync_manager_set_cte_rx_params(
+        struct sync_manager *sync_manager,
+        uint8_t max_cte_count,
+        uint16_t skip);
+
+// Set the advertising set identifier synced to on each beacon. The beacons
+// advertise one periodic advertising set per SID, for example a set with more
+// CTEs per event for accuracy and a faster set for tracking. Syncs to another
+// SID are deleted, and the periodic advertiser list is outdated.
+// Returns 0 (0 ~ "Success") if the SID is set.
+// Returns -EINVAL (-22 ~ "Invalid argument") if sync_manager pointer is NULL,
+// or if sid is larger than BT_GAP_SID_MAX (0x0F).
+int sync_manager_set_sid(
+        struct sync_manager *sync_manager,
+        uint8_t sid);
+
+// Get the number of active slots of a sync manager.
+int sync_manager_active_count(struct sync_manager *sync_manager);
+
+#endif // SYNC_MANAGER_H
\ No newline at end of file
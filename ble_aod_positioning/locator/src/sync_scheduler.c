@@ -0,0 +1,150 @@
+#include "sync_scheduler.h" // For sync scheduler structure and SYNC_SCHEDULER_* constants.
+#include <errno.h> // For EINVAL (22) and ENOENT (2).
+#include <stdbool.h> // For bool.
+#include <stddef.h> // For NULL ((void *)0).
+#include <stdint.h> // For int8_t and int64_t.
+#include <zephyr/spinlock.h> // For k_spinlock_key_t, k_spin_lock(), and k_spin_unlock().
+#include "beacon_angle_cache.h" // For beacon angle structure.
+#include "beacon_database.h" // For beacon database structure, BEACON_DATABASE_CAPACITY, and beacon_database_index_of().
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "locator.h" // For locator structure, locator position structure, locator_get_latest_position(), and locator_get_beacon_geometry_scores().
+
+// RSSI value for "not available". See the BT_HCI_LE_RSSI_NOT_AVAILABLE macro.
+#define RSSI_NOT_AVAILABLE 127
+
+// Constrain a value to the range [0, 1].
+static float clamp_unit(float value) {
+    if (value < 0.0f) {
+        return 0.0f;
+    }
+    if (value > 1.0f) {
+        return 1.0f;
+    }
+    return value;
+}
+
+int sync_scheduler_init(
+        struct sync_scheduler *scheduler,
+        struct beacon_database *beacon_db) {
+    if (scheduler == NULL || beacon_db == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    scheduler->beacon_db = beacon_db;
+
+    for (int i = 0; i < BEACON_DATABASE_CAPACITY; i++) {
+        scheduler->rssi[i] = 0;
+        scheduler->rssi_timestamp[i] = 0;
+        scheduler->rssi_valid[i] = false;
+        scheduler->values[i] = 0.0f;
+    }
+
+    return 0; // 0 ~ "Success".
+}
+
+int sync_scheduler_put_rssi(
+        struct sync_scheduler *scheduler,
+        const uint8_t mac_little_endian[BT_ADDR_SIZE],
+        int8_t rssi,
+        int64_t timestamp) {
+    if (scheduler == NULL || mac_little_endian == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    int beacon_index = beacon_database_index_of(
+            scheduler->beacon_db,
+            mac_little_endian);
+    if (beacon_index < 0) {
+        return beacon_index;
+    }
+
+    if (rssi == RSSI_NOT_AVAILABLE) {
+        return 0; // 0 ~ "Success".
+    }
+
+    // Ensure atomic access to the RSSI arrays.
+    k_spinlock_key_t key = k_spin_lock(&scheduler->lock);
+
+    scheduler->rssi[beacon_index] = rssi;
+    scheduler->rssi_timestamp[beacon_index] = timestamp;
+    scheduler->rssi_valid[beacon_index] = true;
+
+    k_spin_unlock(&scheduler->lock, key);
+
+    return 0; // 0 ~ "Success".
+}
+
+int sync_scheduler_update(
+        struct sync_scheduler *scheduler,
+        const struct locator *locator,
+        int64_t timestamp) {
+    if (scheduler == NULL || locator == NULL) {
+        return -EINVAL; // -22 ~ "Invalid argument".
+    }
+
+    const int beacon_count = scheduler->beacon_db->count;
+
+    // Geometry terms. Neutral if there is no position yet.
+    float geometry[BEACON_DATABASE_CAPACITY];
+    struct locator_position position;
+    float scores[BEACON_DATABASE_CAPACITY];
+    bool scores_set = locator_get_latest_position(locator, &position) == 0 &&
+            locator_get_beacon_geometry_scores(
+                    locator,
+                    position.x,
+                    position.y,
+                    position.z,
+                    scores) == 0;
+    for (int i = 0; i < beacon_count; i++) {
+        if (!scores_set) {
+            geometry[i] = SYNC_SCHEDULER_GEOMETRY_NEUTRAL;
+        } else if (scores[i] < 1.0f) {
+            // Out of range.
+            geometry[i] = 0.0f;
+        } else {
+            geometry[i] = 1.0f - 1.0f / scores[i];
+        }
+    }
+
+    // Staleness terms. A beacon without any angle is maximally stale.
+    float staleness[BEACON_DATABASE_CAPACITY];
+    for (int i = 0; i < beacon_count; i++) {
+        const struct beacon_angle *angle = &locator->angle_cache.angles[i];
+        if (!angle->valid) {
+            staleness[i] = 1.0f;
+            continue;
+        }
+        float age_ms = (float)(timestamp - angle->timestamp);
+        staleness[i] = clamp_unit(
+                age_ms / (float)SYNC_SCHEDULER_STALENESS_MAX_MS);
+    }
+
+    // RSSI terms. A beacon without a recent RSSI is scored 0.
+    float rssi[BEACON_DATABASE_CAPACITY];
+
+    // Ensure atomic access to the RSSI arrays.
+    k_spinlock_key_t key = k_spin_lock(&scheduler->lock);
+
+    for (int i = 0; i < beacon_count; i++) {
+        if (!scheduler->rssi_valid[i] ||
+                (timestamp - scheduler->rssi_timestamp[i]) >
+                        SYNC_SCHEDULER_RSSI_TIMEOUT_MS) {
+            rssi[i] = 0.0f;
+            continue;
+        }
+        rssi[i] = clamp_unit(
+                (float)(scheduler->rssi[i] - SYNC_SCHEDULER_RSSI_MIN) /
+                (float)(SYNC_SCHEDULER_RSSI_MAX - SYNC_SCHEDULER_RSSI_MIN));
+    }
+
+    k_spin_unlock(&scheduler->lock, key);
+
+    for (int i = 0; i < beacon_count; i++) {
+        scheduler->values[i] =
+                SYNC_SCHEDULER_GEOMETRY_WEIGHT * geometry[i] +
+                SYNC_SCHEDULER_STALENESS_WEIGHT * staleness[i] +
+                SYNC_SCHEDULER_RSSI_WEIGHT * rssi[i];
+    }
+
+    return 0; // 0 ~ "Success".
+}
\ No newline at end of file
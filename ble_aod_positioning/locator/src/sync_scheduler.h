@@ -0,0 +1,107 @@
+#ifndef SYNC_SCHEDULER_H
+#define SYNC_SCHEDULER_H
+
+#include <stdbool.h> // For bool.
+#include <stdint.h> // For int8_t and int64_t.
+#include <zephyr/spinlock.h> // For spinlock structure.
+#include "beacon_database.h" // For beacon database structure and BEACON_DATABASE_CAPACITY.
+#include "bt_addr_utils.h" // For BT_ADDR_SIZE (6).
+#include "locator.h" // For locator structure.
+
+// Interval between sync scheduler updates, in milliseconds.
+// See the sync_scheduler_update() function.
+#define SYNC_SCHEDULER_UPDATE_INTERVAL_MS 500
+
+// Weights of the geometry, staleness, and RSSI terms of a beacon value. The
+// weights sum to 1, and each term is in the range [0, 1].
+#define SYNC_SCHEDULER_GEOMETRY_WEIGHT 0.5f
+#define SYNC_SCHEDULER_STALENESS_WEIGHT 0.3f
+#define SYNC_SCHEDULER_RSSI_WEIGHT 0.2f
+
+// Geometry term of all beacons when there is no position yet.
+#define SYNC_SCHEDULER_GEOMETRY_NEUTRAL 0.5f
+
+// Age of the latest angle of a beacon at which the staleness term saturates
+// at 1, in milliseconds.
+#define SYNC_SCHEDULER_STALENESS_MAX_MS 5000
+
+// RSSI range mapped to the RSSI term [0, 1], in dBm.
+#define SYNC_SCHEDULER_RSSI_MIN -100
+#define SYNC_SCHEDULER_RSSI_MAX -40
+
+// Age at which an RSSI is forgotten, in milliseconds.
+#define SYNC_SCHEDULER_RSSI_TIMEOUT_MS 5000
+
+// Sync scheduler structure.
+// Computes a value in the range [0, 1] for each beacon in a beacon database.
+// The sync manager uses the values to rotate syncs when more beacons are in
+// range than there are sync slots. See the sync_manager_set_beacon_values()
+// function. The value of a beacon is a weighted sum of three terms:
+//
+// Geometry: 1 - 1/score, with the geometry score of the beacon at the latest
+// position. A beacon that reduces the GDOP is worth more. See the
+// locator_get_beacon_geometry_scores() function.
+//
+// Staleness: Age of the latest angle of the beacon, relative to
+// SYNC_SCHEDULER_STALENESS_MAX_MS. A beacon without a recent angle is worth
+// more, which rotates syncs through all beacons in range.
+//
+// RSSI: Latest RSSI of the beacon, from scanning or from the sync. A strong
+// beacon is more likely to give a valid angle.
+//
+// See the sync_scheduler_init() function.
+struct sync_scheduler {
+    struct beacon_database *beacon_db;
+
+    // Latest RSSI of each beacon, indexed by the beacon index.
+    // See the sync_scheduler_put_rssi() function.
+    int8_t rssi[BEACON_DATABASE_CAPACITY];
+    int64_t rssi_timestamp[BEACON_DATABASE_CAPACITY];
+    bool rssi_valid[BEACON_DATABASE_CAPACITY];
+
+    // Value of each beacon, indexed by the beacon index.
+    // See the sync_scheduler_update() function.
+    float values[BEACON_DATABASE_CAPACITY];
+
+    // Spinlock to ensure atomic access to the RSSI arrays.
+    struct k_spinlock lock;
+};
+
+// Initialize a sync scheduler structure. All RSSIs are set as invalid, and
+// all values are set to 0.
+// Returns 0 (0 ~ "Success") if the sync scheduler structure is initialized.
+// Returns -EINVAL (-22 ~ "Invalid argument") if scheduler pointer is NULL, or
+// if beacon_db pointer is NULL.
+int sync_scheduler_init(
+        struct sync_scheduler *scheduler,
+        struct beacon_database *beacon_db);
+
+// Put the RSSI of an advertiser into a sync scheduler. The RSSI is ignored if
+// the advertiser is not a beacon in the beacon database, or if the RSSI is not
+// available (127).
+// Safe to call from the scan recv callback and the periodic advertising recv
+// callback.
+// Returns 0 (0 ~ "Success") if the RSSI is put.
+// Returns -EINVAL (-22 ~ "Invalid argument") if scheduler pointer is NULL, or
+// if mac_little_endian pointer is NULL.
+// Returns -ENOENT (-2 ~ "No such file or directory") if the advertiser is not
+// a beacon in the beacon database.
+int sync_scheduler_put_rssi(
+        struct sync_scheduler *scheduler,
+        const uint8_t mac_little_endian[BT_ADDR_SIZE],
+        int8_t rssi,
+        int64_t timestamp);
+
+// Update the values of a sync scheduler, at a timestamp in milliseconds.
+// The latest position and the angle cache are read from the locator. Must not
+// run concurrently with locator updates, for example from the same work queue
+// as the IQ data processing.
+// Returns 0 (0 ~ "Success") if the values are updated.
+// Returns -EINVAL (-22 ~ "Invalid argument") if scheduler pointer is NULL, or
+// if locator pointer is NULL.
+int sync_scheduler_update(
+        struct sync_scheduler *scheduler,
+        const struct locator *locator,
+        int64_t timestamp);
+
+#endif // SYNC_SCHEDULER_H
\ No newline at end of file